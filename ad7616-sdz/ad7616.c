@@ -376,6 +376,56 @@ int32_t ad7616_set_oversampling_ratio(ad7616_dev *dev,
 	return ret;
 }
 
+/**
+ * Set the channel sequence used by the sequencer and burst modes.
+ * @param dev - The device structure.
+ * @param layers - The channel pairs to convert, A channels on ch_a and B
+ * 				   channels on ch_b.
+ * @param no_of_layers - The number of layers, 0 disables the sequencer.
+ * @param burst - Convert the whole sequence on each CONVST when set, one
+ * 				  layer per CONVST otherwise.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad7616_set_sequence(ad7616_dev *dev,
+							ad7616_seq_layer *layers,
+							uint8_t no_of_layers,
+							uint8_t burst)
+{
+	uint16_t reg_data;
+	uint8_t i;
+	int32_t ret = 0;
+
+	if ((dev->mode != AD7616_SW) ||
+			(no_of_layers > AD7616_STREAM_MAX_LAYERS))
+		return -1;
+
+	if (!no_of_layers) {
+		dev->burst_length = 1;
+		return ad7616_write_mask(dev, AD7616_REG_CONFIG,
+				AD7616_SEQEN | AD7616_BURSTEN, 0);
+	}
+
+	for (i = 0; i < no_of_layers; i++) {
+		if ((layers[i].ch_a > AD7616_VA7) ||
+				(layers[i].ch_b < AD7616_VB0))
+			return -1;
+		reg_data = AD7616_ASEL(layers[i].ch_a) |
+				AD7616_BSEL(layers[i].ch_b - AD7616_VB0);
+		/* The last layer ends the sequence. */
+		if (i == no_of_layers - 1)
+			reg_data |= AD7616_SSREN;
+		ret |= ad7616_write(dev, AD7616_REG_SEQUENCER_STACK(i), reg_data);
+	}
+
+	ret |= ad7616_write_mask(dev, AD7616_REG_CONFIG,
+			AD7616_SEQEN | AD7616_BURSTEN,
+			AD7616_SEQEN | (burst ? AD7616_BURSTEN : 0));
+
+	dev->burst_length = burst ? no_of_layers : 1;
+
+	return ret;
+}
+
 /**
  * Initialize the device.
  * @param device - The device structure.
@@ -398,6 +448,7 @@ int32_t ad7616_setup(ad7616_dev **device,
 	}
 
 	dev->core = core;
+	dev->burst_length = 1;
 	ad7616_core_read(*dev->core, AD7616_REG_UP_IF_TYPE, &if_type);
 	if (if_type)
 		dev->interface = AD7616_PARALLEL;
@@ -139,8 +139,14 @@ typedef struct {
 	ad7616_range		vb[8];
 	ad7616_osr			osr;
 	adc_core			*core;
+	uint8_t				burst_length;
 } ad7616_dev;
 
+typedef struct {
+	ad7616_ch			ch_a;
+	ad7616_ch			ch_b;
+} ad7616_seq_layer;
+
 typedef struct {
 	/* SPI */
 	uint8_t				spi_chip_select;
@@ -212,6 +218,11 @@ int32_t ad7616_set_mode(ad7616_dev *dev,
 /* Set the oversampling ratio. */
 int32_t ad7616_set_oversampling_ratio(ad7616_dev *dev,
 									  ad7616_osr osr);
+/* Set the channel sequence used by the sequencer and burst modes. */
+int32_t ad7616_set_sequence(ad7616_dev *dev,
+							ad7616_seq_layer *layers,
+							uint8_t no_of_layers,
+							uint8_t burst);
 /* Initialize the device. */
 int32_t ad7616_setup(ad7616_dev **device,
 					 adc_core *core,
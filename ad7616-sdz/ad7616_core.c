@@ -121,118 +121,227 @@ int32_t ad7616_core_setup(adc_core core)
 }
 
 /***************************************************************************//**
- * @brief ad7616_capture_serial
+ * @brief ad7616_offload_setup
+ * Loads the SPI Engine offload program that reads burst_length results from
+ * each SDO line after every conversion.
 *******************************************************************************/
-int32_t ad7616_capture_serial(adc_core core,
-							  uint32_t no_of_samples,
-							  uint32_t start_address)
+static void ad7616_offload_setup(uint8_t burst_length)
 {
-	uint32_t reg_val;
-	uint32_t transfer_id;
-	uint32_t length;
-
-	mdelay(10);
 	spi_engine_write(SPI_ENGINE_REG_OFFLOAD_CTRL(0), 0x0);
 	mdelay(10);
 	spi_engine_write(SPI_ENGINE_REG_OFFLOAD_RESET(0), 0x1);
 	spi_engine_write(SPI_ENGINE_REG_OFFLOAD_SDO_MEM(0), 0x00);
-	spi_engine_write(SPI_ENGINE_REG_OFFLOAD_CMD_MEM(0), 0x2103);
-	spi_engine_write(SPI_ENGINE_REG_OFFLOAD_CMD_MEM(0), 0x2000);
-	spi_engine_write(SPI_ENGINE_REG_OFFLOAD_CMD_MEM(0), 0x11fe);
-	spi_engine_write(SPI_ENGINE_REG_OFFLOAD_CMD_MEM(0), 0x0201);
-	spi_engine_write(SPI_ENGINE_REG_OFFLOAD_CMD_MEM(0), 0x3000);
-	spi_engine_write(SPI_ENGINE_REG_OFFLOAD_CMD_MEM(0), 0x11ff);
+	spi_engine_write(SPI_ENGINE_REG_OFFLOAD_CMD_MEM(0),
+			SPI_ENGINE_CMD_WRITE(SPI_ENGINE_CMD_REG_CONFIG, 0x03));
+	spi_engine_write(SPI_ENGINE_REG_OFFLOAD_CMD_MEM(0),
+			SPI_ENGINE_CMD_WRITE(SPI_ENGINE_CMD_REG_CLK_DIV, 0x00));
+	spi_engine_write(SPI_ENGINE_REG_OFFLOAD_CMD_MEM(0),
+			SPI_ENGINE_CMD_ASSERT(1, 0xfe));
+	spi_engine_write(SPI_ENGINE_REG_OFFLOAD_CMD_MEM(0),
+			SPI_ENGINE_CMD_TRANSFER(0, 1, 2 * burst_length - 1));
+	spi_engine_write(SPI_ENGINE_REG_OFFLOAD_CMD_MEM(0),
+			SPI_ENGINE_CMD_SYNC(0));
+	spi_engine_write(SPI_ENGINE_REG_OFFLOAD_CMD_MEM(0),
+			SPI_ENGINE_CMD_ASSERT(1, 0xff));
 	spi_engine_write(SPI_ENGINE_REG_OFFLOAD_CTRL(0), 0x1);
+}
 
-	ad7616_core_write(core, AD7616_REG_UP_CTRL,
-								AD7616_CTRL_RESETN | AD7616_CTRL_CNVST_EN);
-
-	length = no_of_samples * core.no_of_channels * ((core.resolution + 7) / 8);
-
-	ad7616_dma_write(core, ADC_DMAC_REG_CTRL, 0x0);
-	ad7616_dma_write(core, ADC_DMAC_REG_CTRL, ADC_DMAC_CTRL_ENABLE);
-
-	ad7616_dma_write(core, ADC_DMAC_REG_IRQ_MASK, 0x0);
-
-	ad7616_dma_read(core, ADC_DMAC_REG_TRANSFER_ID, &transfer_id);
-	ad7616_dma_read(core, ADC_DMAC_REG_IRQ_PENDING, &reg_val);
-	ad7616_dma_write(core, ADC_DMAC_REG_IRQ_PENDING, reg_val);
-
-	ad7616_dma_write(core, ADC_DMAC_REG_DEST_ADDRESS, start_address);
-	ad7616_dma_write(core, ADC_DMAC_REG_DEST_STRIDE, 0x0);
-	ad7616_dma_write(core, ADC_DMAC_REG_X_LENGTH, length - 1);
-	ad7616_dma_write(core, ADC_DMAC_REG_Y_LENGTH, 0x0);
-
-	ad7616_dma_write(core, ADC_DMAC_REG_START_TRANSFER, 0x1);
-	/* Wait until the new transfer is queued. */
-	do {
-		ad7616_dma_read(core, ADC_DMAC_REG_START_TRANSFER, &reg_val);
-	} while (reg_val == 1);
-
-	/* Wait until the current transfer is completed. */
-	do {
-		ad7616_dma_read(core, ADC_DMAC_REG_IRQ_PENDING, &reg_val);
-	} while ((reg_val != (ADC_DMAC_IRQ_SOT | ADC_DMAC_IRQ_EOT)));
-	ad7616_dma_write(core, ADC_DMAC_REG_IRQ_PENDING, reg_val);
+/***************************************************************************//**
+ * @brief ad7616_stream_chunk_done
+ * Ring segment callback, forwards the filled chunk to the stream callback.
+*******************************************************************************/
+static void ad7616_stream_chunk_done(void *ctx,
+				     uint32_t chunk,
+				     uint32_t address)
+{
+	ad7616_stream *stream = ctx;
 
-	/* Wait until the transfer with the ID transfer_id is completed. */
-	do {
-		ad7616_dma_read(core, ADC_DMAC_REG_TRANSFER_DONE, &reg_val);
-	} while ((reg_val & (1 << transfer_id)) != (1 << transfer_id));
+	if (stream->callback)
+		stream->callback(stream->ctx, chunk, address,
+				 stream->chunk_size);
+}
 
-	ad7616_core_write(core, AD7616_REG_UP_CTRL, AD7616_CTRL_RESETN);
+/***************************************************************************//**
+ * @brief ad7616_stream_start
+ * Starts a capture into no_of_chunks buffers of chunk_size bytes each, laid
+ * out back to back from start_address. The next chunk is queued as soon as
+ * the current one starts, so consecutive chunks are captured without gaps.
+ * Works with both the serial and the parallel interface of the core.
+*******************************************************************************/
+int32_t ad7616_stream_start(ad7616_stream *stream)
+{
+	dmac_ring *ring = &stream->ring;
+	int32_t ret;
+
+	if (!stream->burst_length ||
+	    stream->burst_length > AD7616_STREAM_MAX_LAYERS)
+		return -1;
+
+	ring->dmac_baseaddr = stream->core.dmac_baseaddr;
+	ring->start_address = stream->start_address;
+	ring->segment_size = stream->chunk_size;
+	ring->no_of_segments = stream->no_of_chunks;
+	ring->discard_address = 0;
+	ring->no_of_transfers = stream->total_chunks;
+	ring->callback = ad7616_stream_chunk_done;
+	ring->ctx = stream;
+
+	ad7616_core_read(stream->core, AD7616_REG_UP_IF_TYPE, &stream->if_type);
+	/* The parallel core keeps its reset burst length for single results. */
+	if (stream->if_type && stream->burst_length > 1)
+		ad7616_core_write(stream->core, AD7616_REG_UP_BURST_LENGTH,
+				  2 * stream->burst_length - 1);
+	else if (!stream->if_type)
+		ad7616_offload_setup(stream->burst_length);
+
+	if (stream->conv_rate)
+		ad7616_core_write(stream->core, AD7616_REG_UP_CONV_RATE,
+				  stream->conv_rate);
+
+	ret = dmac_ring_start(ring);
+	if (ret)
+		return ret;
+
+	ad7616_core_write(stream->core, AD7616_REG_UP_CTRL,
+			  AD7616_CTRL_RESETN | AD7616_CTRL_CNVST_EN);
 
 	return 0;
 }
 
 /***************************************************************************//**
- * @brief ad7616_capture_parallel
+ * @brief ad7616_stream_stop
+ * Stops the conversions and the DMAC. Completed chunks can still be read.
 *******************************************************************************/
-int32_t ad7616_capture_parallel(adc_core core,
-								uint32_t no_of_samples,
-								uint32_t start_address)
+int32_t ad7616_stream_stop(ad7616_stream *stream)
 {
-	uint32_t reg_val;
-	uint32_t transfer_id;
-	uint32_t length;
+	ad7616_core_write(stream->core, AD7616_REG_UP_CTRL, AD7616_CTRL_RESETN);
+	if (!stream->if_type)
+		spi_engine_write(SPI_ENGINE_REG_OFFLOAD_CTRL(0), 0x0);
 
-	ad7616_core_write(core, AD7616_REG_UP_CTRL,
-								AD7616_CTRL_RESETN | AD7616_CTRL_CNVST_EN);
+	return dmac_ring_stop(&stream->ring);
+}
 
-	length = no_of_samples * core.no_of_channels * ((core.resolution + 7) / 8);
+/***************************************************************************//**
+ * @brief ad7616_stream_process
+ * Handles the pending DMAC events without blocking. Can be polled from the
+ * main loop or called from the DMAC interrupt through ad7616_stream_isr(),
+ * but not both. Returns the number of filled chunks not yet released by the
+ * consumer.
+*******************************************************************************/
+int32_t ad7616_stream_process(ad7616_stream *stream)
+{
+	uint8_t busy;
 
-	ad7616_dma_write(core, ADC_DMAC_REG_CTRL, 0x0);
-	ad7616_dma_write(core, ADC_DMAC_REG_CTRL, ADC_DMAC_CTRL_ENABLE);
+	busy = dmac_ring_busy(&stream->ring);
+	dmac_ring_isr(&stream->ring);
+	/* The last chunk of a bounded capture was filled. */
+	if (busy && !dmac_ring_busy(&stream->ring))
+		ad7616_stream_stop(stream);
 
-	ad7616_dma_write(core, ADC_DMAC_REG_IRQ_MASK, 0x0);
+	return dmac_ring_available(&stream->ring);
+}
 
-	ad7616_dma_read(core, ADC_DMAC_REG_TRANSFER_ID, &transfer_id);
-	ad7616_dma_read(core, ADC_DMAC_REG_IRQ_PENDING, &reg_val);
-	ad7616_dma_write(core, ADC_DMAC_REG_IRQ_PENDING, reg_val);
+/***************************************************************************//**
+ * @brief ad7616_stream_isr
+ * DMAC interrupt handler, instance is the ad7616_stream.
+*******************************************************************************/
+void ad7616_stream_isr(void *instance)
+{
+	ad7616_stream_process(instance);
+}
 
-	ad7616_dma_write(core, ADC_DMAC_REG_DEST_ADDRESS, start_address);
-	ad7616_dma_write(core, ADC_DMAC_REG_DEST_STRIDE, 0x0);
-	ad7616_dma_write(core, ADC_DMAC_REG_X_LENGTH, length - 1);
-	ad7616_dma_write(core, ADC_DMAC_REG_Y_LENGTH, 0x0);
+/***************************************************************************//**
+ * @brief ad7616_stream_get
+ * Returns the address of the oldest filled chunk, without releasing it.
+ * Returns -1 if no chunk is ready.
+*******************************************************************************/
+int32_t ad7616_stream_get(ad7616_stream *stream,
+						  uint32_t *address)
+{
+	return dmac_ring_get(&stream->ring, address);
+}
 
-	ad7616_dma_write(core, ADC_DMAC_REG_START_TRANSFER, 0x1);
-	/* Wait until the new transfer is queued. */
-	do {
-		ad7616_dma_read(core, ADC_DMAC_REG_START_TRANSFER, &reg_val);
-	} while (reg_val == 1);
+/***************************************************************************//**
+ * @brief ad7616_stream_put
+ * Releases the oldest filled chunk back to the DMAC.
+*******************************************************************************/
+int32_t ad7616_stream_put(ad7616_stream *stream)
+{
+	return dmac_ring_put(&stream->ring);
+}
 
-	/* Wait until the current transfer is completed. */
-	do {
-		ad7616_dma_read(core, ADC_DMAC_REG_IRQ_PENDING, &reg_val);
-	} while ((reg_val != (ADC_DMAC_IRQ_SOT | ADC_DMAC_IRQ_EOT)));
-	ad7616_dma_write(core, ADC_DMAC_REG_IRQ_PENDING, reg_val);
+/***************************************************************************//**
+ * @brief ad7616_stream_get_stats
+ * Fills in the capture statistics. elapsed_us is the capture time measured
+ * by the caller and is only used for the throughput, it may be 0.
+*******************************************************************************/
+int32_t ad7616_stream_get_stats(ad7616_stream *stream,
+								uint32_t elapsed_us,
+								ad7616_stream_stats *stats)
+{
+	uint64_t rate;
+
+	stats->chunks = stream->ring.completed;
+	stats->bytes = (uint64_t)stream->ring.completed * stream->chunk_size;
+	stats->samples = stats->bytes / ((stream->core.resolution + 7) / 8);
+	stats->overruns = stream->ring.overruns;
+	stats->throughput = 0;
+	if (elapsed_us) {
+		rate = stats->bytes * 1000000;
+		do_div(&rate, elapsed_us);
+		stats->throughput = rate;
+	}
 
-	/* Wait until the transfer with the ID transfer_id is completed. */
-	do {
-		ad7616_dma_read(core, ADC_DMAC_REG_TRANSFER_DONE, &reg_val);
-	} while ((reg_val & (1 << transfer_id)) != (1 << transfer_id));
+	return 0;
+}
 
-	ad7616_core_write(core, AD7616_REG_UP_CTRL, AD7616_CTRL_RESETN);
+/***************************************************************************//**
+ * @brief ad7616_capture
+ * One-shot capture of no_of_samples samples on top of the stream engine.
+*******************************************************************************/
+static int32_t ad7616_capture(adc_core core,
+							  uint32_t no_of_samples,
+							  uint32_t start_address)
+{
+	ad7616_stream stream;
+	int32_t ret;
+
+	stream.core = core;
+	stream.start_address = start_address;
+	stream.chunk_size = no_of_samples * core.no_of_channels *
+			    ((core.resolution + 7) / 8);
+	stream.no_of_chunks = 2;
+	stream.total_chunks = 1;
+	stream.burst_length = 1;
+	stream.conv_rate = 0;
+	stream.callback = NULL;
+	stream.ctx = NULL;
+
+	ret = ad7616_stream_start(&stream);
+	if (ret)
+		return ret;
+
+	while (!ad7616_stream_process(&stream));
 
 	return 0;
 }
+
+/***************************************************************************//**
+ * @brief ad7616_capture_serial
+*******************************************************************************/
+int32_t ad7616_capture_serial(adc_core core,
+							  uint32_t no_of_samples,
+							  uint32_t start_address)
+{
+	return ad7616_capture(core, no_of_samples, start_address);
+}
+
+/***************************************************************************//**
+ * @brief ad7616_capture_parallel
+*******************************************************************************/
+int32_t ad7616_capture_parallel(adc_core core,
+								uint32_t no_of_samples,
+								uint32_t start_address)
+{
+	return ad7616_capture(core, no_of_samples, start_address);
+}
@@ -39,6 +39,11 @@
 #ifndef AD7616_CORE_H_
 #define AD7616_CORE_H_
 
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include "dmac_ring.h"
+
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
 /******************************************************************************/
@@ -84,6 +89,8 @@
 #define ADC_DMAC_IRQ_SOT				(1 << 0)
 #define ADC_DMAC_IRQ_EOT				(1 << 1)
 
+#define AD7616_STREAM_MAX_LAYERS		32
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -94,6 +101,41 @@ typedef struct {
 	uint8_t		resolution;
 } adc_core;
 
+/* Called each time a stream chunk has been filled. */
+typedef void (*ad7616_stream_callback)(void *ctx,
+									   uint32_t chunk,
+									   uint32_t address,
+									   uint32_t length);
+
+typedef struct {
+	adc_core				core;
+	/* Ring layout, no_of_chunks + 1 chunks for continuous captures */
+	uint32_t				start_address;
+	uint32_t				chunk_size;
+	uint32_t				no_of_chunks;
+	/* Number of chunks to capture before stopping, 0 for continuous */
+	uint32_t				total_chunks;
+	/* Results per channel pair for each conversion, > 1 in burst mode */
+	uint8_t					burst_length;
+	/* Conversion rate divider, 0 keeps the current setting */
+	uint32_t				conv_rate;
+	/* Chunk ready notification, may be NULL */
+	ad7616_stream_callback	callback;
+	void					*ctx;
+	/* State, updated by ad7616_stream_process() */
+	uint32_t				if_type;
+	dmac_ring				ring;
+} ad7616_stream;
+
+typedef struct {
+	uint32_t	chunks;
+	uint64_t	bytes;
+	uint64_t	samples;
+	uint32_t	overruns;
+	/* Bytes per second over the elapsed time given by the caller */
+	uint32_t	throughput;
+} ad7616_stream_stats;
+
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
@@ -116,4 +158,14 @@ int32_t ad7616_capture_serial(adc_core core,
 int32_t ad7616_capture_parallel(adc_core core,
 				uint32_t no_of_samples,
 				uint32_t start_address);
+int32_t ad7616_stream_start(ad7616_stream *stream);
+int32_t ad7616_stream_stop(ad7616_stream *stream);
+int32_t ad7616_stream_process(ad7616_stream *stream);
+void ad7616_stream_isr(void *instance);
+int32_t ad7616_stream_get(ad7616_stream *stream,
+			  uint32_t *address);
+int32_t ad7616_stream_put(ad7616_stream *stream);
+int32_t ad7616_stream_get_stats(ad7616_stream *stream,
+				uint32_t elapsed_us,
+				ad7616_stream_stats *stats);
 #endif
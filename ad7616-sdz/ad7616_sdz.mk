@@ -12,6 +12,7 @@
 ##		if you want to hand pick files, use this variable to list source files.
 
 M_INC_DIRS += $(NOOS-DIR)/ad7616-sdz
+M_INC_DIRS += $(NOOS-DIR)/common_drivers/dmac_ring
 
 M_HDR_FILES :=
 
@@ -13,6 +13,7 @@
 
 M_INC_DIRS +=  $(NOOS-DIR)/ad7768-evb
 M_INC_DIRS +=  $(NOOS-DIR)/drivers/adc/ad7768
+M_INC_DIRS +=  $(NOOS-DIR)/common_drivers/dmac_ring
 
 M_HDR_FILES :=
 
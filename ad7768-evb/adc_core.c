@@ -52,9 +52,7 @@
 /************************ Variables Definitions *******************************/
 /******************************************************************************/
 #ifdef ADC_DMAC_INTERRUPTS
-uint8_t  adc_sot_flag			= 0;
-uint8_t  adc_eot_flag			= 0;
-uint32_t adc_dmac_start_address	= 0;
+static XScuGic	adc_gic;
 #endif
 
 /******************************************************************************/
@@ -151,26 +149,38 @@ int32_t adc_setup(adc_core core)
 
 #ifdef ADC_DMAC_INTERRUPTS
 /***************************************************************************//**
- * @brief adc_dmac_isr
+ * @brief adc_ring_irq_setup
+ * Connects dmac_ring_isr() to the DMAC interrupt of the PS7 GIC.
 *******************************************************************************/
-void adc_dmac_isr(void *instance)
+int32_t adc_ring_irq_setup(dmac_ring *ring)
 {
-	uint32_t reg_val;
+	XScuGic_Config	*gic_config;
+	int32_t			status;
 
-	adc_dmac_read(core, ADC_DMAC_REG_IRQ_PENDING, &reg_val);
-	adc_dmac_write(core, ADC_DMAC_REG_IRQ_PENDING, reg_val);
-	if(reg_val & ADC_DMAC_IRQ_SOT)
-	{
-		adc_sot_flag = 1;
-		adc_dmac_start_address += ADC_DMAC_TRANSFER_SIZE;
-		adc_dmac_write(core, ADC_DMAC_REG_DEST_ADDRESS, adc_dmac_start_address);
-		/* The current transfer was started and a new one is queued. */
-		adc_dmac_write(core, ADC_DMAC_REG_START_TRANSFER, 0x1);
-	}
-	if(reg_val & ADC_DMAC_IRQ_EOT)
-	{
-		adc_eot_flag = 1;
-	}
+	gic_config = XScuGic_LookupConfig(XPAR_PS7_SCUGIC_0_DEVICE_ID);
+	if (gic_config == NULL)
+		return -1;
+
+	status = XScuGic_CfgInitialize(&adc_gic, gic_config,
+			gic_config->CpuBaseAddress);
+	if (status)
+		return -1;
+
+	XScuGic_SetPriorityTriggerType(&adc_gic, ADC_DMAC_INT_ID, 0x0, 0x3);
+
+	status = XScuGic_Connect(&adc_gic, ADC_DMAC_INT_ID,
+			(Xil_ExceptionHandler)dmac_ring_isr, ring);
+	if (status)
+		return -1;
+
+	XScuGic_Enable(&adc_gic, ADC_DMAC_INT_ID);
+
+	Xil_ExceptionInit();
+	Xil_ExceptionRegisterHandler(XIL_EXCEPTION_ID_INT,
+			(Xil_ExceptionHandler)XScuGic_InterruptHandler, &adc_gic);
+	Xil_ExceptionEnable();
+
+	return 0;
 }
 #endif
 
@@ -223,42 +233,26 @@ int32_t adc_capture(adc_core core,
 	}
 	while((reg_val & (1 << transfer_id)) != (1 << transfer_id));
 #else
-	XScuGic_Config	*gic_config;
-	XScuGic			gic;
-	int32_t			status;
-
-	gic_config = XScuGic_LookupConfig(XPAR_PS7_SCUGIC_0_DEVICE_ID);
-	if(gic_config == NULL)
-		xil_printf("Error\n");
-
-	status = XScuGic_CfgInitialize(&gic, gic_config, gic_config->CpuBaseAddress);
-	if(status)
+	dmac_ring ring;
+
+	ring.dmac_baseaddr = core.dmac_baseaddr;
+	ring.start_address = start_address;
+	ring.segment_size = ADC_DMAC_TRANSFER_SIZE;
+	ring.no_of_transfers = (length + ADC_DMAC_TRANSFER_SIZE - 1) /
+			ADC_DMAC_TRANSFER_SIZE;
+	if (!ring.no_of_transfers)
+		ring.no_of_transfers = 1;
+	ring.no_of_segments = ring.no_of_transfers < 2 ? 2 : ring.no_of_transfers;
+	ring.discard_address = 0;
+	ring.callback = NULL;
+	ring.ctx = NULL;
+
+	if (adc_ring_irq_setup(&ring))
 		xil_printf("Error\n");
 
-	XScuGic_SetPriorityTriggerType(&gic, ADC_DMAC_INT_ID, 0x0, 0x3);
-
-	status = XScuGic_Connect(&gic, ADC_DMAC_INT_ID, (Xil_ExceptionHandler)adc_dmac_isr, NULL);
-	if(status)
-		xil_printf("Error\n");
-
-	XScuGic_Enable(&gic, ADC_DMAC_INT_ID);
-
-	Xil_ExceptionInit();
-
-	Xil_ExceptionRegisterHandler(XIL_EXCEPTION_ID_INT, (Xil_ExceptionHandler)XScuGic_InterruptHandler, (void *)&gic);
-	Xil_ExceptionEnable();
-
-	adc_dmac_start_address = start_address;
-
-	adc_dmac_write(core, ADC_DMAC_REG_DEST_ADDRESS, adc_dmac_start_address);
-	adc_dmac_write(core, ADC_DMAC_REG_DEST_STRIDE, 0x0);
-	adc_dmac_write(core, ADC_DMAC_REG_X_LENGTH, ADC_DMAC_TRANSFER_SIZE - 1);
-	adc_dmac_write(core, ADC_DMAC_REG_Y_LENGTH, 0x0);
-
-	adc_dmac_write(core, ADC_DMAC_REG_START_TRANSFER, 0x1);
-
-	while(adc_dmac_start_address < (start_address + length + ADC_DMAC_TRANSFER_SIZE));
-	adc_dmac_write(core, ADC_DMAC_REG_CTRL, 0x0);
+	dmac_ring_start(&ring);
+	while(dmac_ring_busy(&ring));
+	dmac_ring_stop(&ring);
 #endif
 
 	return 0;
@@ -43,6 +43,7 @@
 /***************************** Include Files **********************************/
 /******************************************************************************/
 #include <stdint.h>
+#include "dmac_ring.h"
 
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
@@ -170,4 +171,7 @@ int32_t adc_pn_mon(adc_core core,
 int32_t adc_ramp_test(adc_core core,
 					  uint32_t no_of_samples,
 					  uint32_t start_address);
+#ifdef ADC_DMAC_INTERRUPTS
+int32_t adc_ring_irq_setup(dmac_ring *ring);
+#endif
 #endif
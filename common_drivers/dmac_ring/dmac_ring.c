@@ -0,0 +1,283 @@
+/***************************************************************************//**
+* @file dmac_ring.c
+* @brief Implementation of the DMAC ring capture helper.
+* @author Analog Devices Inc.
+********************************************************************************
+* Copyright 2020(c) Analog Devices, Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+* - Redistributions of source code must retain the above copyright
+* notice, this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright
+* notice, this list of conditions and the following disclaimer in
+* the documentation and/or other materials provided with the
+* distribution.
+* - Neither the name of Analog Devices, Inc. nor the names of its
+* contributors may be used to endorse or promote products derived
+* from this software without specific prior written permission.
+* - The use of this software may or may not infringe the patent rights
+* of one or more patent holders. This license does not release you
+* from the requirement that you obtain separate licenses from these
+* patent holders to use this software.
+* - Use of the software either in source or binary form, must be run
+* on or directly connected to an Analog Devices Inc. component.
+*
+* THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+* IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+* IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <xil_io.h>
+#include "dmac_ring.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define DMAC_REG_IRQ_MASK		0x80
+#define DMAC_REG_IRQ_PENDING		0x84
+#define DMAC_REG_CTRL			0x400
+#define DMAC_REG_TRANSFER_ID		0x404
+#define DMAC_REG_START_TRANSFER		0x408
+#define DMAC_REG_DEST_ADDRESS		0x410
+#define DMAC_REG_X_LENGTH		0x418
+#define DMAC_REG_Y_LENGTH		0x41c
+#define DMAC_REG_DEST_STRIDE		0x420
+#define DMAC_REG_TRANSFER_DONE		0x428
+
+#define DMAC_CTRL_ENABLE		(1 << 0)
+
+#define DMAC_IRQ_SOT			(1 << 0)
+#define DMAC_IRQ_EOT			(1 << 1)
+
+/***************************************************************************//**
+ * @brief dmac_ring_read
+*******************************************************************************/
+static uint32_t dmac_ring_read(dmac_ring *ring,
+			       uint32_t reg_addr)
+{
+	return Xil_In32(ring->dmac_baseaddr + reg_addr);
+}
+
+/***************************************************************************//**
+ * @brief dmac_ring_write
+*******************************************************************************/
+static void dmac_ring_write(dmac_ring *ring,
+			    uint32_t reg_addr,
+			    uint32_t reg_data)
+{
+	Xil_Out32(ring->dmac_baseaddr + reg_addr, reg_data);
+}
+
+/***************************************************************************//**
+ * @brief dmac_ring_submit
+ * Submits the next transfer to the DMAC. A segment the consumer did not
+ * release yet may still be read, so when the ring is full the transfer goes
+ * to the discard segment instead and is counted as an overrun.
+*******************************************************************************/
+static void dmac_ring_submit(dmac_ring *ring)
+{
+	uint32_t address;
+	uint8_t drop;
+
+	drop = ring->queued - ring->consumed >= ring->no_of_segments;
+	if (drop) {
+		address = ring->discard_address ? ring->discard_address :
+			  ring->start_address +
+			  ring->no_of_segments * ring->segment_size;
+		ring->overruns++;
+	} else {
+		address = ring->start_address +
+			  (ring->queued % ring->no_of_segments) *
+			  ring->segment_size;
+		ring->queued++;
+	}
+
+	ring->pending_id[ring->pending] = dmac_ring_read(ring,
+					  DMAC_REG_TRANSFER_ID);
+	ring->pending_drop[ring->pending] = drop;
+
+	dmac_ring_write(ring, DMAC_REG_DEST_ADDRESS, address);
+	dmac_ring_write(ring, DMAC_REG_DEST_STRIDE, 0x0);
+	dmac_ring_write(ring, DMAC_REG_X_LENGTH, ring->segment_size - 1);
+	dmac_ring_write(ring, DMAC_REG_Y_LENGTH, 0x0);
+	dmac_ring_write(ring, DMAC_REG_START_TRANSFER, 0x1);
+	/* TRANSFER_DONE keeps the bit of the previous use of the ID until the
+	 * transfer is accepted. */
+	while (dmac_ring_read(ring, DMAC_REG_START_TRANSFER));
+
+	ring->pending++;
+	ring->submitted++;
+}
+
+/***************************************************************************//**
+ * @brief dmac_ring_fill
+ * Keeps DMAC_RING_DEPTH transfers in the DMAC queue until the capture ends.
+*******************************************************************************/
+static void dmac_ring_fill(dmac_ring *ring)
+{
+	while (ring->running && ring->pending < DMAC_RING_DEPTH) {
+		if (ring->no_of_transfers &&
+		    ring->submitted >= ring->no_of_transfers) {
+			ring->running = 0;
+			break;
+		}
+		dmac_ring_submit(ring);
+	}
+}
+
+/***************************************************************************//**
+ * @brief dmac_ring_isr
+ * DMAC interrupt handler, instance is the dmac_ring. Completions are taken
+ * from TRANSFER_DONE, so several transfers finishing behind a single
+ * interrupt are all accounted for, then the DMAC queue is refilled.
+*******************************************************************************/
+void dmac_ring_isr(void *instance)
+{
+	dmac_ring *ring = instance;
+	uint32_t reg_val;
+	uint32_t segment;
+	uint8_t drop;
+	uint8_t i;
+
+	reg_val = dmac_ring_read(ring, DMAC_REG_IRQ_PENDING);
+	dmac_ring_write(ring, DMAC_REG_IRQ_PENDING, reg_val);
+
+	reg_val = dmac_ring_read(ring, DMAC_REG_TRANSFER_DONE);
+	while (ring->pending && (reg_val & (1 << ring->pending_id[0]))) {
+		drop = ring->pending_drop[0];
+		for (i = 1; i < ring->pending; i++) {
+			ring->pending_id[i - 1] = ring->pending_id[i];
+			ring->pending_drop[i - 1] = ring->pending_drop[i];
+		}
+		ring->pending--;
+		if (drop)
+			continue;
+
+		segment = ring->completed % ring->no_of_segments;
+		ring->completed++;
+		if (ring->callback)
+			ring->callback(ring->ctx, segment,
+				       ring->start_address +
+				       segment * ring->segment_size);
+	}
+
+	dmac_ring_fill(ring);
+}
+
+/***************************************************************************//**
+ * @brief dmac_ring_start
+ * Starts a capture into no_of_segments buffers of segment_size bytes each,
+ * laid out back to back from start_address. Continuous captures also need
+ * the discard segment, bounded ones with no_of_transfers <= no_of_segments
+ * never overrun. dmac_ring_isr() must be connected to the DMAC interrupt or
+ * polled.
+*******************************************************************************/
+int32_t dmac_ring_start(dmac_ring *ring)
+{
+	uint32_t reg_val;
+
+	if (ring->no_of_segments < 2 || !ring->segment_size)
+		return -1;
+
+	ring->queued = 0;
+	ring->submitted = 0;
+	ring->completed = 0;
+	ring->overruns = 0;
+	ring->consumed = 0;
+	ring->pending = 0;
+	ring->running = 1;
+
+	dmac_ring_write(ring, DMAC_REG_IRQ_MASK, DMAC_IRQ_SOT | DMAC_IRQ_EOT);
+	dmac_ring_write(ring, DMAC_REG_CTRL, 0x0);
+	dmac_ring_write(ring, DMAC_REG_CTRL, DMAC_CTRL_ENABLE);
+
+	reg_val = dmac_ring_read(ring, DMAC_REG_IRQ_PENDING);
+	dmac_ring_write(ring, DMAC_REG_IRQ_PENDING, reg_val);
+
+	/* The interrupt stays masked until the queue is set up. */
+	dmac_ring_fill(ring);
+	dmac_ring_write(ring, DMAC_REG_IRQ_MASK, 0x0);
+
+	return 0;
+}
+
+/***************************************************************************//**
+ * @brief dmac_ring_stop
+ * Stops the capture and disables the DMAC, the transfers in flight are
+ * aborted. Completed segments can still be read.
+*******************************************************************************/
+int32_t dmac_ring_stop(dmac_ring *ring)
+{
+	ring->running = 0;
+
+	dmac_ring_write(ring, DMAC_REG_IRQ_MASK, DMAC_IRQ_SOT | DMAC_IRQ_EOT);
+	dmac_ring_write(ring, DMAC_REG_CTRL, 0x0);
+
+	ring->pending = 0;
+
+	return 0;
+}
+
+/***************************************************************************//**
+ * @brief dmac_ring_busy
+ * Returns nonzero while transfers are queued or still to be submitted.
+*******************************************************************************/
+uint32_t dmac_ring_busy(dmac_ring *ring)
+{
+	return ring->running || ring->pending;
+}
+
+/***************************************************************************//**
+ * @brief dmac_ring_available
+ * Returns the number of filled segments not yet released by the consumer.
+*******************************************************************************/
+uint32_t dmac_ring_available(dmac_ring *ring)
+{
+	return ring->completed - ring->consumed;
+}
+
+/***************************************************************************//**
+ * @brief dmac_ring_get
+ * Returns the address of the oldest filled segment, without releasing it.
+ * The DMAC does not write the segment until dmac_ring_put() is called.
+ * Returns -1 if no segment is ready.
+*******************************************************************************/
+int32_t dmac_ring_get(dmac_ring *ring,
+		      uint32_t *address)
+{
+	if (!dmac_ring_available(ring))
+		return -1;
+
+	*address = ring->start_address +
+		   (ring->consumed % ring->no_of_segments) * ring->segment_size;
+
+	return 0;
+}
+
+/***************************************************************************//**
+ * @brief dmac_ring_put
+ * Releases the oldest filled segment back to the DMAC. The consumer is the
+ * only writer of consumed, the interrupt handler only reads it.
+*******************************************************************************/
+int32_t dmac_ring_put(dmac_ring *ring)
+{
+	if (!dmac_ring_available(ring))
+		return -1;
+
+	ring->consumed++;
+
+	return 0;
+}
@@ -0,0 +1,99 @@
+/***************************************************************************//**
+* @file dmac_ring.h
+* @brief Header file of the DMAC ring capture helper.
+* @author Analog Devices Inc.
+********************************************************************************
+* Copyright 2020(c) Analog Devices, Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+* - Redistributions of source code must retain the above copyright
+* notice, this list of conditions and the following disclaimer.
+* - Redistributions in binary form must reproduce the above copyright
+* notice, this list of conditions and the following disclaimer in
+* the documentation and/or other materials provided with the
+* distribution.
+* - Neither the name of Analog Devices, Inc. nor the names of its
+* contributors may be used to endorse or promote products derived
+* from this software without specific prior written permission.
+* - The use of this software may or may not infringe the patent rights
+* of one or more patent holders. This license does not release you
+* from the requirement that you obtain separate licenses from these
+* patent holders to use this software.
+* - Use of the software either in source or binary form, must be run
+* on or directly connected to an Analog Devices Inc. component.
+*
+* THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+* IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+* IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+#ifndef DMAC_RING_H_
+#define DMAC_RING_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdint.h>
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+/* Transfers kept in the DMAC queue: the active one and the next one. */
+#define DMAC_RING_DEPTH		2
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+/* Called from dmac_ring_isr() each time a ring segment has been filled. */
+typedef void (*dmac_ring_callback)(void *ctx,
+				   uint32_t segment,
+				   uint32_t address);
+
+typedef struct {
+	uint32_t		dmac_baseaddr;
+	/* Ring layout */
+	uint32_t		start_address;
+	uint32_t		segment_size;
+	uint32_t		no_of_segments;
+	/* Receives the transfers dropped on overrun, 0 for the segment that
+	 * follows the ring */
+	uint32_t		discard_address;
+	/* Number of transfers to run before stopping, 0 for continuous */
+	uint32_t		no_of_transfers;
+	/* Segment ready notification, may be NULL */
+	dmac_ring_callback	callback;
+	void			*ctx;
+	/* Written by dmac_ring_isr() only, or with the interrupt masked */
+	volatile uint32_t	queued;
+	volatile uint32_t	submitted;
+	volatile uint32_t	completed;
+	volatile uint32_t	overruns;
+	volatile uint8_t	running;
+	volatile uint8_t	pending;
+	uint8_t			pending_id[DMAC_RING_DEPTH];
+	uint8_t			pending_drop[DMAC_RING_DEPTH];
+	/* Written by the consumer only, through dmac_ring_put() */
+	volatile uint32_t	consumed;
+} dmac_ring;
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+int32_t dmac_ring_start(dmac_ring *ring);
+int32_t dmac_ring_stop(dmac_ring *ring);
+void dmac_ring_isr(void *instance);
+uint32_t dmac_ring_busy(dmac_ring *ring);
+uint32_t dmac_ring_available(dmac_ring *ring);
+int32_t dmac_ring_get(dmac_ring *ring,
+		      uint32_t *address);
+int32_t dmac_ring_put(dmac_ring *ring);
+#endif
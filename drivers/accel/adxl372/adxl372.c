@@ -533,15 +533,161 @@ int32_t adxl372_configure_fifo(struct adxl372_dev *dev,
 	return ret;
 }
 
+/* Axes stored in the FIFO for each format, in the order they are stored. */
+static const uint8_t adxl372_fifo_axes[] = {
+	[ADXL372_XYZ_FIFO] = BIT(ADXL372_X_AXIS) | BIT(ADXL372_Y_AXIS) |
+			     BIT(ADXL372_Z_AXIS),
+	[ADXL372_X_FIFO] = BIT(ADXL372_X_AXIS),
+	[ADXL372_Y_FIFO] = BIT(ADXL372_Y_AXIS),
+	[ADXL372_XY_FIFO] = BIT(ADXL372_X_AXIS) | BIT(ADXL372_Y_AXIS),
+	[ADXL372_Z_FIFO] = BIT(ADXL372_Z_AXIS),
+	[ADXL372_XZ_FIFO] = BIT(ADXL372_X_AXIS) | BIT(ADXL372_Z_AXIS),
+	[ADXL372_YZ_FIFO] = BIT(ADXL372_Y_AXIS) | BIT(ADXL372_Z_AXIS),
+	[ADXL372_XYZ_PEAK_FIFO] = BIT(ADXL372_X_AXIS) | BIT(ADXL372_Y_AXIS) |
+				  BIT(ADXL372_Z_AXIS),
+};
+
+/**
+ * Number of FIFO samples making up one sample set.
+ * @param dev - The device structure.
+ * @return The number of axes stored by the FIFO format.
+ */
+static uint8_t adxl372_fifo_set_size(struct adxl372_dev *dev)
+{
+	uint8_t axes = adxl372_fifo_axes[dev->fifo_config.fifo_format & 0x7];
+
+	return (axes & 0x1) + ((axes >> 1) & 0x1) + ((axes >> 2) & 0x1);
+}
+
+/**
+ * Number of FIFO samples that can be read now. When reading data from
+ * multiple axes, at least one sample set must be left in the FIFO after every
+ * read so that the data is not overwritten and stored out of order.
+ * @param dev - The device structure.
+ * @param fifo_entries - Number of samples in the FIFO.
+ * @return Number of samples to read, a whole number of sets.
+ */
+static uint16_t adxl372_fifo_readable(struct adxl372_dev *dev,
+				      uint16_t fifo_entries)
+{
+	uint8_t set_size = adxl372_fifo_set_size(dev);
+	uint16_t keep = set_size > 1 ? set_size : 0;
+
+	if (fifo_entries <= keep)
+		return 0;
+
+	fifo_entries -= keep;
+
+	return fifo_entries - fifo_entries % set_size;
+}
+
+/**
+ * Decode raw FIFO samples into sample sets. A partial set is kept in the
+ * device structure until the next call. The series start flag of each sample
+ * is checked against the position in the set; on a mismatch, or after an
+ * overrun, samples are skipped up to the next series start.
+ * @param dev - The device structure.
+ * @param buf - The raw FIFO data, 2 bytes per sample.
+ * @param cnt - Number of samples in buf.
+ * @param sets - Array receiving the completed sample sets.
+ * @return Number of sample sets completed.
+ */
+static uint16_t adxl372_fifo_decode(struct adxl372_dev *dev,
+				    const uint8_t *buf,
+				    uint16_t cnt,
+				    struct adxl372_xyz_accel_data *sets)
+{
+	uint8_t axes = adxl372_fifo_axes[dev->fifo_config.fifo_format & 0x7];
+	uint8_t set_size = adxl372_fifo_set_size(dev);
+	uint16_t i, val, nb_sets = 0;
+	uint8_t axis, pos, start;
+
+	for (i = 0; i < cnt; i++, buf += 2) {
+		val = (buf[0] << 4) | (buf[1] >> 4);
+		start = ADXL372_FIFO_SERIES_START(buf[1]);
+
+		if (dev->fifo_resync) {
+			if (!start)
+				continue;
+			dev->fifo_resync = false;
+			dev->fifo_pos = 0;
+		} else if (start != (dev->fifo_pos == 0)) {
+			dev->fifo_stats.resyncs++;
+			dev->fifo_pos = 0;
+			if (!start) {
+				dev->fifo_resync = true;
+				continue;
+			}
+		}
+
+		/* The FIFO stores the enabled axes in x, y, z order */
+		for (axis = 0, pos = 0; axis <= ADXL372_Z_AXIS; axis++) {
+			if (!(axes & BIT(axis)))
+				continue;
+			if (pos++ == dev->fifo_pos)
+				break;
+		}
+
+		if (axis == ADXL372_X_AXIS)
+			dev->fifo_set.x = val;
+		else if (axis == ADXL372_Y_AXIS)
+			dev->fifo_set.y = val;
+		else
+			dev->fifo_set.z = val;
+
+		if (++dev->fifo_pos == set_size) {
+			sets[nb_sets++] = dev->fifo_set;
+			memset(&dev->fifo_set, 0, sizeof(dev->fifo_set));
+			dev->fifo_pos = 0;
+		}
+	}
+
+	dev->fifo_stats.sets += nb_sets;
+
+	return nb_sets;
+}
+
+/**
+ * Handle a FIFO overrun: drop the FIFO content and realign on the next
+ * series start.
+ * @param dev - The device structure.
+ * @param fifo_entries - Number of samples in the FIFO.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t adxl372_fifo_overrun(struct adxl372_dev *dev,
+				    uint16_t fifo_entries)
+{
+	uint8_t buf[ADXL372_FIFO_BURST * 2];
+	uint16_t n;
+	int32_t ret;
+
+	dev->fifo_stats.overruns++;
+	dev->fifo_resync = true;
+	memset(&dev->fifo_set, 0, sizeof(dev->fifo_set));
+
+	while (fifo_entries) {
+		n = min_t(uint16_t, fifo_entries, ADXL372_FIFO_BURST);
+		ret = adxl372_read_reg_multiple(dev, ADXL372_FIFO_DATA, buf,
+						n * 2);
+		if (ret < 0)
+			return ret;
+		fifo_entries -= n;
+	}
+
+	return 0;
+}
+
 /**
  * Retrieve data stored in FIFO. Can be used in polling mode,
- * but works best when interrupts are used
+ * but works best when interrupts are used. A FIFO overrun is counted, the
+ * FIFO content is dropped and the decoder realigns on the next sample set.
  * @param dev - The device structure.
  * @param fifo_data - pointer to an array of type adxl372_xyz_accel_data
  *		      where (x, y, z) values will be stored. Array max size
- *		      should be 170, as the FIFO can hold up to 512 samples.
+ *		      should be 512, as the FIFO can hold up to 512 samples.
  * @param fifo_entries - pointer which will store the number of valid data
- *			 samples present in the FIFO buffer
+ *			 samples present in the FIFO buffer, then the number
+ *			 of samples read
  * @return 0 in case of success, negative error code otherwise.
  */
 int32_t adxl372_service_fifo_ev(struct adxl372_dev *dev,
@@ -556,20 +702,16 @@ int32_t adxl372_service_fifo_ev(struct adxl372_dev *dev,
 		return ret;
 
 	if (ADXL372_STATUS_1_FIFO_OVR(status1)) {
-		printf("FIFO overrun\n");
-		return -1;
+		ret = adxl372_fifo_overrun(dev, *fifo_entries);
+		*fifo_entries = 0;
+		return ret;
 	}
 
 	if (dev->fifo_config.fifo_mode != ADXL372_FIFO_BYPASSED) {
 		if ((ADXL372_STATUS_1_FIFO_RDY(status1)) ||
 		    (ADXL372_STATUS_1_FIFO_FULL(status1))) {
-			/*
-			 * When reading data from multiple axes from the FIFO,
-			 * to ensure that data is not overwritten and stored out
-			 * of order, at least one sample set must be left in the
-			 * FIFO after every read.
-			 */
-			*fifo_entries -= 3;
+			*fifo_entries = adxl372_fifo_readable(dev,
+							      *fifo_entries);
 			ret = adxl372_get_fifo_xyz_data(dev, fifo_data,
 							*fifo_entries);
 			if (ret < 0)
@@ -581,9 +723,12 @@ int32_t adxl372_service_fifo_ev(struct adxl372_dev *dev,
 }
 
 /**
- * Get the data stored in FIFO.
+ * Get the data stored in FIFO, decoded according to the FIFO format. The
+ * FIFO is read in bursts of ADXL372_FIFO_BURST samples.
  * @param dev - The device structure.
- * @param samples - pointer to the raw data stored in the ADXL372_FIFO_DATA
+ * @param samples - pointer to an array of type adxl372_xyz_accel_data
+ *		    where the sample sets will be stored. Axes not stored by
+ *		    the FIFO format are set to 0.
  * @param cnt - How many samples should be retrieved from the FIFO DATA reg
  * @return 0 in case of success, negative error code otherwise.
  */
@@ -591,32 +736,208 @@ int32_t adxl372_get_fifo_xyz_data(struct adxl372_dev *dev,
 				  struct adxl372_xyz_accel_data *samples,
 				  uint16_t cnt)
 {
-	uint8_t buf[1024];
-	uint16_t i;
-	int32_t ret;
+	uint8_t buf[ADXL372_FIFO_BURST * 2];
+	uint16_t n;
+	int32_t ret = 0;
+
+	if (cnt > ADXL372_FIFO_MAX_SAMPLES)
+		return -1;
+
+	while (cnt) {
+		n = min_t(uint16_t, cnt, ADXL372_FIFO_BURST);
+		/* Each sample is 2 bytes */
+		ret = adxl372_read_reg_multiple(dev, ADXL372_FIFO_DATA, buf,
+						n * 2);
+		if (ret < 0)
+			return ret;
+
+		samples += adxl372_fifo_decode(dev, buf, n, samples);
+		cnt -= n;
+	}
+
+	return ret;
+}
+
+/**
+ * Get the FIFO counters.
+ * @param dev - The device structure.
+ * @param stats - The counters.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t adxl372_get_fifo_stats(struct adxl372_dev *dev,
+			       struct adxl372_fifo_stats *stats)
+{
+	*stats = dev->fifo_stats;
 
+	return 0;
+}
 
-	if (cnt > 512)
+/**
+ * Start streaming FIFO data into a ring of timestamped sample sets. The
+ * FIFO must be configured in a mode other than bypassed; the FIFO_FULL
+ * (watermark) and FIFO_OVR events are mapped to INT1. The INT1 interrupt,
+ * edge triggered, should then call adxl372_fifo_stream_isr() and the main loop
+ * adxl372_fifo_stream_process(). Without the interrupt, irq_driven is left
+ * cleared and the main loop only polls adxl372_fifo_stream_process().
+ * @param dev - The device structure.
+ * @param stream - The stream, with the ring and the time source set.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t adxl372_fifo_stream_start(struct adxl372_dev *dev,
+				  struct adxl372_fifo_stream *stream)
+{
+	if (!stream->ring || stream->ring_size < 2 ||
+	    dev->fifo_config.fifo_mode == ADXL372_FIFO_BYPASSED)
 		return -1;
-	/*
-	 * The FIFO can hold up to 512 samples.
-	 * Each sample is 2 bytes, that's why we read (cnt * 2) bytes
-	 */
-	ret = adxl372_read_reg_multiple(dev,
-					ADXL372_FIFO_DATA,
-					buf,
-					cnt * 2);
+
+	stream->head = 0;
+	stream->tail = 0;
+	memset(&dev->fifo_stats, 0, sizeof(dev->fifo_stats));
+	memset(&dev->fifo_set, 0, sizeof(dev->fifo_set));
+	dev->fifo_resync = true;
+	dev->stream = stream;
+	dev->irq_pending = 0;
+	dev->stream_on = true;
+
+	return adxl372_write_mask(dev, ADXL372_INT1_MAP,
+				  ADXL372_INT1_MAP_FIFO_FULL_MSK |
+				  ADXL372_INT1_MAP_FIFO_OVR_MSK,
+				  ADXL372_INT1_MAP_FIFO_FULL_MODE(1) |
+				  ADXL372_INT1_MAP_FIFO_OVR_MODE(1));
+}
+
+/**
+ * Stop streaming FIFO data. The FIFO events are unmapped from INT1 and the
+ * FIFO is no longer read; the stream stays attached so the sample sets left
+ * in the ring can still be read.
+ * @param dev - The device structure.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t adxl372_fifo_stream_stop(struct adxl372_dev *dev)
+{
+	dev->stream_on = false;
+	dev->irq_pending = 0;
+
+	return adxl372_write_mask(dev, ADXL372_INT1_MAP,
+				  ADXL372_INT1_MAP_FIFO_FULL_MSK |
+				  ADXL372_INT1_MAP_FIFO_OVR_MSK, 0);
+}
+
+/**
+ * Move the FIFO content into the stream ring. Each sample set is timestamped
+ * from the time of the call, going back one ODR period per set still
+ * behind it in the FIFO. When the ring is full, new sets are dropped.
+ * For an interrupt driven stream, the FIFO is only read when
+ * adxl372_fifo_stream_isr() latched an event. Must be called from the main
+ * loop.
+ * @param dev - The device structure.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t adxl372_fifo_stream_process(struct adxl372_dev *dev)
+{
+	struct adxl372_xyz_accel_data sets[ADXL372_FIFO_BURST];
+	struct adxl372_fifo_stream *stream = dev->stream;
+	struct adxl372_fifo_sample *sample;
+	uint8_t buf[ADXL372_FIFO_BURST * 2];
+	uint8_t status1, status2, set_size;
+	uint16_t fifo_entries, cnt, n, nb_sets, i, next;
+	uint32_t now, period_us, pending;
+	int32_t ret;
+
+	if (!stream || !dev->stream_on)
+		return -1;
+
+	if (stream->irq_driven) {
+		if (!dev->irq_pending)
+			return 0;
+		dev->irq_pending = 0;
+	}
+
+	ret = adxl372_get_status(dev, &status1, &status2, &fifo_entries);
 	if (ret < 0)
 		return ret;
 
-	for (i = 0; i < cnt * 2; i += 6) {
-		samples->x = ((buf[i] << 4) | (buf[i+1] >> 4));
-		samples->y = ((buf[i+2] << 4) | (buf[i+3] >> 4));
-		samples->z = ((buf[i+4] << 4) | (buf[i+5] >> 4));
-		samples++;
+	now = stream->get_time_us ? stream->get_time_us() : 0;
+
+	if (ADXL372_STATUS_1_FIFO_OVR(status1))
+		return adxl372_fifo_overrun(dev, fifo_entries);
+
+	set_size = adxl372_fifo_set_size(dev);
+	cnt = adxl372_fifo_readable(dev, fifo_entries);
+	period_us = 1000000 / (400 << dev->odr);
+	/* Sample sets in the FIFO newer than the next one decoded */
+	pending = fifo_entries / set_size;
+
+	while (cnt) {
+		n = min_t(uint16_t, cnt, ADXL372_FIFO_BURST);
+		ret = adxl372_read_reg_multiple(dev, ADXL372_FIFO_DATA, buf,
+						n * 2);
+		if (ret < 0)
+			return ret;
+		cnt -= n;
+
+		nb_sets = adxl372_fifo_decode(dev, buf, n, sets);
+		for (i = 0; i < nb_sets; i++) {
+			if (pending)
+				pending--;
+			next = (stream->head + 1) % stream->ring_size;
+			if (next == stream->tail) {
+				dev->fifo_stats.dropped++;
+				continue;
+			}
+			sample = &stream->ring[stream->head];
+			sample->timestamp = stream->get_time_us ?
+					    now - pending * period_us : 0;
+			sample->data = sets[i];
+			stream->head = next;
+		}
 	}
 
-	return ret;
+	return 0;
+}
+
+/**
+ * INT1 interrupt handler, to be registered with irq_register_callback(). It
+ * only latches the event, the FIFO is read by adxl372_fifo_stream_process()
+ * so the bus is used from one context.
+ * @param ctx - The device structure.
+ * @param event - Unused.
+ * @param extra - Unused.
+ */
+void adxl372_fifo_stream_isr(void *ctx, uint32_t event, void *extra)
+{
+	((struct adxl372_dev *)ctx)->irq_pending = 1;
+}
+
+/**
+ * Read sample sets from the stream ring.
+ * @param dev - The device structure.
+ * @param samples - Array receiving the sample sets, oldest first.
+ * @param max_samples - Size of the array.
+ * @param count - Number of sample sets read.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t adxl372_fifo_stream_read(struct adxl372_dev *dev,
+				 struct adxl372_fifo_sample *samples,
+				 uint16_t max_samples,
+				 uint16_t *count)
+{
+	struct adxl372_fifo_stream *stream = dev->stream;
+	uint16_t tail, head;
+
+	*count = 0;
+	if (!stream)
+		return -1;
+
+	tail = stream->tail;
+	head = stream->head;
+	while (tail != head && *count < max_samples) {
+		samples[(*count)++] = stream->ring[tail];
+		tail = (tail + 1) % stream->ring_size;
+	}
+	stream->tail = tail;
+
+	return 0;
 }
 
 /**
@@ -703,7 +1024,7 @@ int32_t adxl372_init(struct adxl372_dev **device,
 	uint8_t dev_id, part_id, rev_id;
 	int32_t ret;
 
-	dev = (struct adxl372_dev *)malloc(sizeof(*dev));
+	dev = (struct adxl372_dev *)calloc(1, sizeof(*dev));
 	if (!dev)
 		goto error;
 
@@ -161,6 +161,12 @@
 #define ADXL372_FIFO_CTL_SAMPLES_MSK		BIT(0)
 #define ADXL372_FIFO_CTL_SAMPLES_MODE(x)	(((x) > 0xFF) ? 1 : 0)
 
+/* ADXL372_FIFO_DATA */
+#define ADXL372_FIFO_SERIES_START(x)		((x) & 0x1)
+#define ADXL372_FIFO_MAX_SAMPLES		512
+/* FIFO samples fetched per burst read, a whole number of sets */
+#define ADXL372_FIFO_BURST			48
+
 /* ADXL372_STATUS_1 */
 #define ADXL372_STATUS_1_DATA_RDY(x)		(((x) >> 0) & 0x1)
 #define ADXL372_STATUS_1_FIFO_RDY(x)		(((x) >> 1) & 0x1)
@@ -341,6 +347,41 @@ struct adxl372_xyz_accel_data {
 	uint16_t z;
 } ;
 
+struct adxl372_fifo_sample {
+	/* Time of the sample set, in us, 0 without a time source */
+	uint32_t			timestamp;
+	/* Axes not stored by the FIFO format are 0 */
+	struct adxl372_xyz_accel_data	data;
+};
+
+struct adxl372_fifo_stats {
+	/* Sample sets read from the FIFO */
+	uint32_t	sets;
+	/* FIFO overruns, the FIFO content is dropped on each */
+	uint32_t	overruns;
+	/* Samples found out of place in a set, the decoder realigns */
+	uint32_t	resyncs;
+	/* Sample sets lost because the stream ring was full */
+	uint32_t	dropped;
+};
+
+struct adxl372_fifo_stream {
+	/* Ring of sample sets, provided by the caller */
+	struct adxl372_fifo_sample	*ring;
+	uint16_t			ring_size;
+	/* Time source in us, may be NULL */
+	uint32_t			(*get_time_us)(void);
+	/*
+	 * Set when INT1 calls adxl372_fifo_stream_isr(), the FIFO is then
+	 * only read after an interrupt. Otherwise every
+	 * adxl372_fifo_stream_process() call reads it.
+	 */
+	bool				irq_driven;
+	/* State, updated by adxl372_fifo_stream_process() */
+	volatile uint16_t		head;
+	volatile uint16_t		tail;
+};
+
 struct adxl372_irq_config {
 	bool data_rdy;
 	bool fifo_rdy;
@@ -384,6 +425,14 @@ struct adxl372_dev {
 	enum adxl372_instant_on_th_mode	th_mode;
 	struct adxl372_fifo_config	fifo_config;
 	enum adxl372_comm_type		comm_type;
+	/* FIFO decoder state */
+	struct adxl372_xyz_accel_data	fifo_set;
+	uint8_t				fifo_pos;
+	bool				fifo_resync;
+	struct adxl372_fifo_stats	fifo_stats;
+	struct adxl372_fifo_stream	*stream;
+	bool				stream_on;
+	volatile uint8_t		irq_pending;
 };
 
 struct adxl372_init_param {
@@ -480,6 +529,17 @@ int32_t adxl372_get_fifo_xyz_data(struct adxl372_dev *dev,
 int32_t adxl372_service_fifo_ev(struct adxl372_dev *dev,
 				struct adxl372_xyz_accel_data *fifo_data,
 				uint16_t *fifo_entries);
+int32_t adxl372_get_fifo_stats(struct adxl372_dev *dev,
+			       struct adxl372_fifo_stats *stats);
+int32_t adxl372_fifo_stream_start(struct adxl372_dev *dev,
+				  struct adxl372_fifo_stream *stream);
+int32_t adxl372_fifo_stream_stop(struct adxl372_dev *dev);
+int32_t adxl372_fifo_stream_process(struct adxl372_dev *dev);
+void adxl372_fifo_stream_isr(void *ctx, uint32_t event, void *extra);
+int32_t adxl372_fifo_stream_read(struct adxl372_dev *dev,
+				 struct adxl372_fifo_sample *samples,
+				 uint16_t max_samples,
+				 uint16_t *count);
 int32_t adxl372_get_highest_peak_data(struct adxl372_dev *dev,
 				      struct adxl372_xyz_accel_data *max_peak);
 int32_t adxl372_get_accel_data(struct adxl372_dev *dev,
@@ -76,10 +76,18 @@ enum ad5592r_registers {
 	AD5592R_REG_RESET		= 0xF,
 };
 
+#define AD5592R_REG_ADC_SEQ_REP		BIT(9)
 #define AD5592R_REG_PD_EN_REF		BIT(9)
 #define AD5592R_REG_CTRL_ADC_RANGE	BIT(5)
 #define AD5592R_REG_CTRL_DAC_RANGE	BIT(4)
 
+/* Channel ID and result fields of an ADC conversion frame */
+#define AD5592R_ADC_RESULT_ID(x)	(((x) >> 12) & 0x7)
+#define AD5592R_ADC_RESULT_DATA(x)	((x) & 0xFFF)
+
+/* Number of results stored per scan by multi_read_adc */
+#define AD5592R_ADC_SCAN_SIZE		8
+
 struct ad5592r_dev;
 
 struct ad5592r_rw_ops {
@@ -92,6 +100,8 @@ struct ad5592r_rw_ops {
 	int32_t (*reg_read)(struct ad5592r_dev *dev, uint8_t reg,
 			    uint16_t *value);
 	int32_t (*gpio_read)(struct ad5592r_dev *dev, uint8_t *value);
+	int32_t (*multi_read_adc)(struct ad5592r_dev *dev, uint8_t chans,
+				  uint16_t *values, uint16_t num_scans);
 };
 
 struct ad5592r_init_param {
@@ -112,6 +122,11 @@ struct ad5592r_dev {
 	uint8_t gpio_out;
 	uint8_t gpio_in;
 	uint8_t gpio_val;
+	/*
+	 * ADC_SEQ value left running by multi_read_adc, 0 once any other
+	 * access may have disturbed the conversion readback
+	 */
+	uint16_t adc_seq;
 };
 
 int32_t ad5592r_base_reg_write(struct ad5592r_dev *dev, uint8_t reg,
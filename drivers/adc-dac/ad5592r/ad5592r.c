@@ -46,6 +46,7 @@ const struct ad5592r_rw_ops ad5592r_rw_ops = {
 	.reg_write = ad5592r_reg_write,
 	.reg_read = ad5592r_reg_read,
 	.gpio_read = ad5592r_gpio_read,
+	.multi_read_adc = ad5592r_multi_read_adc,
 };
 
 /**
@@ -84,6 +85,7 @@ int32_t ad5592r_write_dac(struct ad5592r_dev *dev, uint8_t chan,
 	if (!dev)
 		return FAILURE;
 
+	dev->adc_seq = 0;
 	dev->spi_msg = swab16( BIT(15) | (uint16_t)(chan << 12) | value);
 
 	return spi_write_and_read(dev->spi, (uint8_t *)&dev->spi_msg,
@@ -114,6 +116,9 @@ int32_t ad5592r_read_adc(struct ad5592r_dev *dev, uint8_t chan,
 	if (ret < 0)
 		return ret;
 
+	/* A repeating sequence, if any, was replaced */
+	dev->adc_seq = 0;
+
 	/*
 	 * Invalid data:
 	 * See Figure 40. Single-Channel ADC Conversion Sequence
@@ -131,6 +136,72 @@ int32_t ad5592r_read_adc(struct ad5592r_dev *dev, uint8_t chan,
 	return 0;
 }
 
+/**
+ * Read several ADC channels, num_scans times.
+ *
+ * The sequence is programmed in repeat mode and left running, so a following
+ * call for the same channels only clocks the conversion frames: one frame per
+ * result instead of a sequence write and two frames per channel. Each result
+ * is stored by the channel ID it carries, at
+ * values[scan * AD5592R_ADC_SCAN_SIZE + channel], so the order in which the
+ * sequencer returns the channels does not matter. chans = 0 stops the
+ * sequencer. After any other access to the device, the sequence is
+ * programmed again.
+ *
+ * @param dev - The device structure.
+ * @param chans - Bitmask of the channels to convert.
+ * @param values - Results, num_scans * AD5592R_ADC_SCAN_SIZE entries.
+ * @param num_scans - Number of conversions of each channel.
+ * @return 0 in case of success, negative error code otherwise
+ */
+int32_t ad5592r_multi_read_adc(struct ad5592r_dev *dev, uint8_t chans,
+			       uint16_t *values, uint16_t num_scans)
+{
+	uint32_t i, num_chans, num_results;
+	uint16_t seq, result;
+	int32_t ret;
+
+	if (!dev)
+		return FAILURE;
+
+	seq = chans ? (AD5592R_REG_ADC_SEQ_REP | chans) : 0;
+	if (!seq || seq != dev->adc_seq) {
+		ret = ad5592r_reg_write(dev, AD5592R_REG_ADC_SEQ, seq);
+		if (ret < 0)
+			return ret;
+		dev->adc_seq = seq;
+		if (!seq)
+			return 0;
+
+		/*
+		 * Invalid data:
+		 * See Figure 41. Multichannel ADC Conversion Sequence
+		 */
+		ret = ad5592r_spi_wnop_r16(dev, &dev->spi_msg);
+		if (ret < 0)
+			return ret;
+	}
+	if (!seq)
+		return 0;
+
+	for (num_chans = 0, i = 0; i < AD5592R_ADC_SCAN_SIZE; i++)
+		if (chans & BIT(i))
+			num_chans++;
+
+	num_results = num_chans * num_scans;
+	for (i = 0; i < num_results; i++) {
+		ret = ad5592r_spi_wnop_r16(dev, &result);
+		if (ret < 0)
+			return ret;
+
+		values[(i / num_chans) * AD5592R_ADC_SCAN_SIZE +
+		       AD5592R_ADC_RESULT_ID(result)] =
+			       AD5592R_ADC_RESULT_DATA(result);
+	}
+
+	return 0;
+}
+
 /**
  * Write register.
  *
@@ -144,6 +215,7 @@ int32_t ad5592r_reg_write(struct ad5592r_dev *dev, uint8_t reg, uint16_t value)
 	if (!dev)
 		return FAILURE;
 
+	dev->adc_seq = 0;
 	dev->spi_msg = swab16((reg << 11) | value);
 
 	return spi_write_and_read(dev->spi, (uint8_t *)&dev->spi_msg,
@@ -165,6 +237,7 @@ int32_t ad5592r_reg_read(struct ad5592r_dev *dev, uint8_t reg, uint16_t *value)
 	if (!dev)
 		return FAILURE;
 
+	dev->adc_seq = 0;
 	dev->spi_msg = swab16((AD5592R_REG_LDAC << 11) |
 			      AD5592R_LDAC_READBACK_EN | (reg << 2));
 
@@ -48,12 +48,16 @@
 #define AD5593R_MODE_GPIO_READBACK	(6 << 4)
 #define AD5593R_MODE_REG_READBACK	(7 << 4)
 
+/* Bytes read per I2C transaction by ad5593r_multi_read_adc() */
+#define AD5593R_ADC_READ_CHUNK		64
+
 const struct ad5592r_rw_ops ad5593r_rw_ops = {
 	.write_dac = ad5593r_write_dac,
 	.read_adc = ad5593r_read_adc,
 	.reg_write = ad5593r_reg_write,
 	.reg_read = ad5593r_reg_read,
 	.gpio_read = ad5593r_gpio_read,
+	.multi_read_adc = ad5593r_multi_read_adc,
 };
 
 /**
@@ -72,6 +76,7 @@ int32_t ad5593r_write_dac(struct ad5592r_dev *dev, uint8_t chan,
 	if (!dev)
 		return FAILURE;
 
+	dev->adc_seq = 0;
 	data[0] = AD5593R_MODE_DAC_WRITE | chan;
 	data[1] = (value >> 8) & 0xF ;
 	data[2] = value & 0xFF;
@@ -107,6 +112,9 @@ int32_t ad5593r_read_adc(struct ad5592r_dev *dev, uint8_t chan,
 	if (ret < 0)
 		return ret;
 
+	/* A repeating sequence, if any, was replaced */
+	dev->adc_seq = 0;
+
 	data[0] = AD5593R_MODE_ADC_READBACK;
 	ret = i2c_write(dev->i2c, data, 1, 0);
 	if (ret < 0)
@@ -121,6 +129,74 @@ int32_t ad5593r_read_adc(struct ad5592r_dev *dev, uint8_t chan,
 	return 0;
 }
 
+/**
+ * Read several ADC channels, num_scans times.
+ *
+ * The sequence is programmed in repeat mode and left running. In ADC
+ * readback mode the device returns the conversions back to back, so the
+ * results are read AD5593R_ADC_READ_CHUNK bytes per transaction. Each result
+ * is stored by the channel ID it carries, at
+ * values[scan * AD5592R_ADC_SCAN_SIZE + channel]. chans = 0 stops the
+ * sequencer.
+ *
+ * @param dev - The device structure.
+ * @param chans - Bitmask of the channels to convert.
+ * @param values - Results, num_scans * AD5592R_ADC_SCAN_SIZE entries.
+ * @param num_scans - Number of conversions of each channel.
+ * @return 0 in case of success, negative error code otherwise
+ */
+int32_t ad5593r_multi_read_adc(struct ad5592r_dev *dev, uint8_t chans,
+			       uint16_t *values, uint16_t num_scans)
+{
+	uint8_t data[AD5593R_ADC_READ_CHUNK];
+	uint32_t i, j, n, chunk, num_chans, num_results;
+	uint16_t seq, result;
+	int32_t ret;
+
+	if (!dev)
+		return FAILURE;
+
+	seq = chans ? (AD5592R_REG_ADC_SEQ_REP | chans) : 0;
+	if (!seq || seq != dev->adc_seq) {
+		ret = ad5593r_reg_write(dev, AD5592R_REG_ADC_SEQ, seq);
+		if (ret < 0)
+			return ret;
+		dev->adc_seq = seq;
+	}
+	if (!seq)
+		return 0;
+
+	data[0] = AD5593R_MODE_ADC_READBACK;
+	ret = i2c_write(dev->i2c, data, 1, 0);
+	if (ret < 0)
+		return ret;
+
+	for (num_chans = 0, i = 0; i < AD5592R_ADC_SCAN_SIZE; i++)
+		if (chans & BIT(i))
+			num_chans++;
+
+	/* Whole scans per transaction */
+	chunk = sizeof(data) / 2 / num_chans * num_chans;
+	num_results = num_chans * num_scans;
+	for (i = 0; i < num_results; i += n) {
+		n = num_results - i;
+		if (n > chunk)
+			n = chunk;
+		ret = i2c_read(dev->i2c, data, n * 2, 0);
+		if (ret < 0)
+			return ret;
+
+		for (j = 0; j < n; j++) {
+			result = (uint16_t)(data[2 * j] << 8) + data[2 * j + 1];
+			values[((i + j) / num_chans) * AD5592R_ADC_SCAN_SIZE +
+			       AD5592R_ADC_RESULT_ID(result)] =
+				       AD5592R_ADC_RESULT_DATA(result);
+		}
+	}
+
+	return 0;
+}
+
 /**
  * Write register.
  *
@@ -137,6 +213,7 @@ int32_t ad5593r_reg_write(struct ad5592r_dev *dev, uint8_t reg,
 	if (!dev)
 		return FAILURE;
 
+	dev->adc_seq = 0;
 	data[0] = AD5593R_MODE_CONF | reg;
 	data[1] = value >> 8;
 	data[2] = value;
@@ -161,6 +238,7 @@ int32_t ad5593r_reg_read(struct ad5592r_dev *dev, uint8_t reg,
 	if (!dev)
 		return FAILURE;
 
+	dev->adc_seq = 0;
 	data[0] = AD5593R_MODE_REG_READBACK | reg;
 
 	ret = i2c_write(dev->i2c, data, 1, 0);
@@ -191,6 +269,7 @@ int32_t ad5593r_gpio_read(struct ad5592r_dev *dev, uint8_t *value)
 	if (!dev)
 		return FAILURE;
 
+	dev->adc_seq = 0;
 	data[0] = AD5593R_MODE_GPIO_READBACK;
 	ret = i2c_write(dev->i2c, data, 1, 0);
 	if (ret < 0)
@@ -402,6 +402,221 @@ int32_t ad7124_read_data(struct ad7124_dev *dev,
 	return ret;
 }
 
+/***************************************************************************//**
+ * @brief Waits for the DOUT/RDY line to go low, when it is available as a GPIO.
+ *
+ * @param dev     - The handler of the instance of the driver.
+ * @param timeout - Count representing the number of polls to be done until the
+ *                  function returns if no new data is available.
+ *
+ * @return Returns 0 for success or negative error code.
+*******************************************************************************/
+static int32_t ad7124_wait_for_rdy_low(struct ad7124_dev *dev,
+				       uint32_t timeout)
+{
+	uint8_t rdy = GPIO_HIGH;
+	int32_t ret;
+
+	if (!dev->gpio_rdy)
+		return 0;
+
+	while (timeout--) {
+		ret = gpio_get_value(dev->gpio_rdy, &rdy);
+		if (ret < 0)
+			return ret;
+		if (rdy == GPIO_LOW)
+			return 0;
+	}
+
+	return TIMEOUT;
+}
+
+/***************************************************************************//**
+ * @brief Enters continuous read mode and starts filling a sample ring. The
+ *        status byte is appended to each result so that samples can be
+ *        tagged with their channel. From now on the device accepts no
+ *        register access until ad7124_cont_read_stop() is called.
+ *
+ * @param dev       - The handler of the instance of the driver.
+ * @param cont_read - The stream, with the sample ring set.
+ *
+ * @return Returns 0 for success or negative error code.
+*******************************************************************************/
+int32_t ad7124_cont_read_start(struct ad7124_dev *dev,
+			       struct ad7124_cont_read *cont_read)
+{
+	struct ad7124_st_reg *regs;
+	int32_t ret;
+
+	if(!dev || !cont_read || !cont_read->ring || cont_read->ring_size < 2)
+		return INVALID_VAL;
+
+	regs = dev->regs;
+
+	cont_read->head = 0;
+	cont_read->tail = 0;
+	cont_read->dropped = 0;
+	cont_read->crc_errors = 0;
+
+	regs[AD7124_ADC_Control].value |= AD7124_ADC_CTRL_REG_CONT_READ |
+					  AD7124_ADC_CTRL_REG_DATA_STATUS;
+	ret = ad7124_write_register(dev, regs[AD7124_ADC_Control]);
+	if (ret < 0)
+		return ret;
+
+	dev->cont_read = cont_read;
+
+	return ret;
+}
+
+/***************************************************************************//**
+ * @brief Reads one data and status frame into the sample ring. In continuous
+ *        read mode the result is clocked out without a command, so a sample
+ *        costs a single 4 byte transfer (5 with CRC). Must be called after a
+ *        DOUT/RDY falling edge; when the line is available as a GPIO and is
+ *        still high, nothing is read.
+ *
+ * @param dev - The handler of the instance of the driver.
+ *
+ * @return Returns 0 for success or negative error code.
+*******************************************************************************/
+int32_t ad7124_cont_read_process(struct ad7124_dev *dev)
+{
+	struct ad7124_cont_read *cont_read;
+	struct ad7124_sample *sample;
+	uint8_t buffer[6] = {0, 0, 0, 0, 0, 0};
+	uint8_t size = 4, rdy;
+	uint16_t next;
+	int32_t ret;
+
+	if(!dev || !dev->cont_read)
+		return INVALID_VAL;
+
+	cont_read = dev->cont_read;
+
+	if (dev->gpio_rdy) {
+		ret = gpio_get_value(dev->gpio_rdy, &rdy);
+		if (ret < 0)
+			return ret;
+		if (rdy != GPIO_LOW)
+			return 0;
+	}
+
+	if (dev->use_crc != AD7124_DISABLE_CRC)
+		size++;
+
+	/* buffer[0] stands for the read command the frame is checked with */
+	ret = spi_write_and_read(dev->spi_desc, &buffer[1], size);
+	if(ret < 0)
+		return ret;
+
+	if (dev->use_crc == AD7124_USE_CRC) {
+		buffer[0] = AD7124_COMM_REG_WEN | AD7124_COMM_REG_RD |
+			    AD7124_COMM_REG_RA(AD7124_DATA_REG);
+		if (ad7124_compute_crc8(buffer, size + 1)) {
+			cont_read->crc_errors++;
+			return COMM_ERR;
+		}
+	}
+
+	next = (cont_read->head + 1) % cont_read->ring_size;
+	if (next == cont_read->tail) {
+		cont_read->dropped++;
+		return 0;
+	}
+
+	sample = &cont_read->ring[cont_read->head];
+	sample->data = (buffer[1] << 16) | (buffer[2] << 8) | buffer[3];
+	sample->status = buffer[4];
+	sample->channel = AD7124_STATUS_REG_CH_ACTIVE(buffer[4]);
+	cont_read->head = next;
+	dev->regs[AD7124_Status].value = buffer[4];
+
+	return 0;
+}
+
+/***************************************************************************//**
+ * @brief DOUT/RDY falling edge handler, to be registered with
+ *        irq_register_callback(). The frame is read from the handler itself:
+ *        a result is only held until the next conversion ends, so deferring
+ *        the read would lose samples. While continuous read is active the
+ *        handler owns the SPI bus of the device; other devices on the same
+ *        bus may only be accessed with this interrupt masked.
+ *        ad7124_cont_read_stop() detaches the stream before it uses the bus.
+ *
+ * @param ctx   - The handler of the instance of the driver.
+ * @param event - Unused.
+ * @param extra - Unused.
+ *
+ * @return None.
+*******************************************************************************/
+void ad7124_cont_read_isr(void *ctx, uint32_t event, void *extra)
+{
+	ad7124_cont_read_process((struct ad7124_dev *)ctx);
+}
+
+/***************************************************************************//**
+ * @brief Takes samples out of the sample ring, oldest first.
+ *
+ * @param dev         - The handler of the instance of the driver.
+ * @param samples     - Array receiving the samples.
+ * @param max_samples - Size of the array.
+ * @param count       - Number of samples taken.
+ *
+ * @return Returns 0 for success or negative error code.
+*******************************************************************************/
+int32_t ad7124_cont_read_get(struct ad7124_dev *dev,
+			     struct ad7124_sample *samples,
+			     uint16_t max_samples,
+			     uint16_t *count)
+{
+	struct ad7124_cont_read *cont_read;
+	uint16_t tail, head;
+
+	*count = 0;
+	if(!dev || !dev->cont_read)
+		return INVALID_VAL;
+
+	cont_read = dev->cont_read;
+	tail = cont_read->tail;
+	head = cont_read->head;
+	while (tail != head && *count < max_samples) {
+		samples[(*count)++] = cont_read->ring[tail];
+		tail = (tail + 1) % cont_read->ring_size;
+	}
+	cont_read->tail = tail;
+
+	return 0;
+}
+
+/***************************************************************************//**
+ * @brief Leaves continuous read mode. The device exits on a read data command
+ *        sent while DOUT/RDY is low, so the function waits for the next
+ *        result and drops it.
+ *
+ * @param dev - The handler of the instance of the driver.
+ *
+ * @return Returns 0 for success or negative error code.
+*******************************************************************************/
+int32_t ad7124_cont_read_stop(struct ad7124_dev *dev)
+{
+	int32_t ret;
+
+	if(!dev || !dev->cont_read)
+		return INVALID_VAL;
+
+	dev->cont_read = NULL;
+
+	ret = ad7124_wait_for_rdy_low(dev, dev->spi_rdy_poll_cnt);
+	if (ret < 0)
+		return ret;
+
+	ret = ad7124_no_check_read_register(dev, &dev->regs[AD7124_Data]);
+	dev->regs[AD7124_ADC_Control].value &= ~AD7124_ADC_CTRL_REG_CONT_READ;
+
+	return ret;
+}
+
 /***************************************************************************//**
  * @brief Computes the CRC checksum for a data buffer.
  *
@@ -495,7 +710,7 @@ int32_t ad7124_setup(struct ad7124_dev **device,
 	enum ad7124_registers reg_nr;
 	struct ad7124_dev *dev;
 
-	dev = (struct ad7124_dev *)malloc(sizeof(*dev));
+	dev = (struct ad7124_dev *)calloc(1, sizeof(*dev));
 	if (!dev)
 		return INVALID_VAL;
 
@@ -507,6 +722,17 @@ int32_t ad7124_setup(struct ad7124_dev **device,
 	if (ret < 0)
 		return ret;
 
+	/* DOUT/RDY line, used in continuous read mode. */
+	ret = gpio_get_optional(&dev->gpio_rdy, init_param.gpio_rdy);
+	if (ret < 0)
+		return ret;
+
+	if (dev->gpio_rdy) {
+		ret = gpio_direction_input(dev->gpio_rdy);
+		if (ret < 0)
+			return ret;
+	}
+
 	/*  Reset the device interface.*/
 	ret = ad7124_reset(dev);
 	if (ret < 0)
@@ -548,6 +774,8 @@ int32_t ad7124_remove(struct ad7124_dev *dev)
 	int32_t ret;
 
 	ret = spi_remove(dev->spi_desc);
+	if (dev->gpio_rdy)
+		ret |= gpio_remove(dev->gpio_rdy);
 
 	free(dev);
 
@@ -46,6 +46,7 @@
 /******************************************************************************/
 #include <stdint.h>
 #include "spi.h"
+#include "gpio.h"
 #include "delay.h"
 
 /******************************************************************************/
@@ -331,6 +332,36 @@ enum ad7124_registers {
 	AD7124_REG_NO
 };
 
+/*
+ * One conversion read in continuous read mode.
+ * @data: The conversion result.
+ * @channel: The channel that produced it, from the status byte.
+ * @status: The status byte sent with the result.
+ */
+struct ad7124_sample {
+	uint32_t	data;
+	uint8_t		channel;
+	uint8_t		status;
+};
+
+/*
+ * Continuous read stream, filled on each DOUT/RDY falling edge.
+ * @ring: Sample ring provided by the caller.
+ * @ring_size: Number of samples in the ring.
+ * @head: Write index, updated by ad7124_cont_read_process().
+ * @tail: Read index, updated by ad7124_cont_read_get().
+ * @dropped: Samples lost because the ring was full.
+ * @crc_errors: Frames discarded because of a checksum mismatch.
+ */
+struct ad7124_cont_read {
+	struct ad7124_sample	*ring;
+	uint16_t		ring_size;
+	volatile uint16_t	head;
+	volatile uint16_t	tail;
+	uint32_t		dropped;
+	uint32_t		crc_errors;
+};
+
 /*
  * The structure describes the device and is used with the ad7124 driver.
  * @spi_desc: A reference to the SPI configuration of the device.
@@ -342,15 +373,20 @@ enum ad7124_registers {
  * @spi_rdy_poll_cnt: Number of times the driver should read the Error register
  *                    to check if the device is ready to accept user requests,
  *                    before a timeout error will be issued.
+ * @gpio_rdy: The DOUT/RDY line read as a GPIO, may be NULL.
+ * @cont_read: The active continuous read stream, NULL when not streaming.
  */
 struct ad7124_dev {
 	/* SPI */
 	spi_desc		*spi_desc;
+	/* GPIO */
+	struct gpio_desc	*gpio_rdy;
 	/* Device Settings */
 	struct ad7124_st_reg	*regs;
 	int16_t use_crc;
 	int16_t check_ready;
 	int16_t spi_rdy_poll_cnt;
+	struct ad7124_cont_read	*cont_read;
 };
 
 struct ad7124_init_param {
@@ -359,6 +395,8 @@ struct ad7124_init_param {
 	/* Device Settings */
 	struct ad7124_st_reg	*regs;
 	int16_t spi_rdy_poll_cnt;
+	/* GPIO, optional, the DOUT/RDY line used in continuous read mode */
+	struct gpio_init_param	*gpio_rdy;
 };
 
 /******************************************************************************/
@@ -407,6 +445,25 @@ int32_t ad7124_wait_for_conv_ready(struct ad7124_dev *dev,
 int32_t ad7124_read_data(struct ad7124_dev *dev,
 			 int32_t* p_data);
 
+/*! Enters continuous read mode and starts filling a sample ring. */
+int32_t ad7124_cont_read_start(struct ad7124_dev *dev,
+			       struct ad7124_cont_read *cont_read);
+
+/*! Reads one data and status frame into the sample ring. */
+int32_t ad7124_cont_read_process(struct ad7124_dev *dev);
+
+/*! DOUT/RDY falling edge handler, for irq_register_callback(). */
+void ad7124_cont_read_isr(void *ctx, uint32_t event, void *extra);
+
+/*! Takes samples out of the sample ring. */
+int32_t ad7124_cont_read_get(struct ad7124_dev *dev,
+			     struct ad7124_sample *samples,
+			     uint16_t max_samples,
+			     uint16_t *count);
+
+/*! Leaves continuous read mode. */
+int32_t ad7124_cont_read_stop(struct ad7124_dev *dev);
+
 /*! Computes the CRC checksum for a data buffer. */
 uint8_t ad7124_compute_crc8(uint8_t* p_buf,
 			    uint8_t buf_size);
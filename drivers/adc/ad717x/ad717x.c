@@ -333,6 +333,225 @@ int32_t AD717X_ComputeDataregSize(ad717x_dev *device)
 	return 0;
 }
 
+/***************************************************************************//**
+* @brief Enters continuous read mode and starts filling a sample ring. The
+*        status byte is appended to each result so that samples can be tagged
+*        with their channel. From now on the device accepts no register access
+*        until AD717X_ContReadStop() is called.
+*
+* @param device    - The handler of the instance of the driver.
+* @param cont_read - The stream, with the sample ring set.
+*
+* @return Returns 0 for success or negative error code.
+*******************************************************************************/
+int32_t AD717X_ContReadStart(ad717x_dev *device,
+			     ad717x_cont_read *cont_read)
+{
+	ad717x_st_reg *interfaceReg;
+	int32_t ret;
+
+	if(!device || !device->regs || !cont_read || !cont_read->ring ||
+	    cont_read->ring_size < 2)
+		return INVALID_VAL;
+
+	interfaceReg = AD717X_GetReg(device, AD717X_IFMODE_REG);
+	if (!interfaceReg)
+		return INVALID_VAL;
+
+	cont_read->head = 0;
+	cont_read->tail = 0;
+	cont_read->dropped = 0;
+	cont_read->crc_errors = 0;
+
+	interfaceReg->value |= AD717X_IFMODE_REG_CONT_READ |
+			       AD717X_IFMODE_REG_DATA_STAT;
+	ret = AD717X_WriteRegister(device, AD717X_IFMODE_REG);
+	if(ret < 0)
+		return ret;
+
+	ret = AD717X_ComputeDataregSize(device);
+	if(ret < 0)
+		return ret;
+
+	device->cont_read = cont_read;
+
+	return ret;
+}
+
+/***************************************************************************//**
+* @brief Reads one data and status frame into the sample ring. In continuous
+*        read mode the result is clocked out without a command, so a sample
+*        costs a single transfer. Must be called after a DOUT/RDY falling
+*        edge; when the line is available as a GPIO and is still high, nothing
+*        is read.
+*
+* @param device - The handler of the instance of the driver.
+*
+* @return Returns 0 for success or negative error code.
+*******************************************************************************/
+int32_t AD717X_ContReadProcess(ad717x_dev *device)
+{
+	ad717x_cont_read *cont_read;
+	ad717x_st_reg *dataReg;
+	ad717x_sample *sample;
+	uint8_t buffer[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+	uint8_t i, size, rdy;
+	uint8_t check8 = 0;
+	uint16_t next;
+	int32_t ret;
+
+	if(!device || !device->cont_read)
+		return INVALID_VAL;
+
+	cont_read = device->cont_read;
+
+	dataReg = AD717X_GetReg(device, AD717X_DATA_REG);
+	if (!dataReg)
+		return INVALID_VAL;
+
+	if (device->gpio_rdy) {
+		ret = gpio_get_value(device->gpio_rdy, &rdy);
+		if(ret < 0)
+			return ret;
+		if (rdy != GPIO_LOW)
+			return 0;
+	}
+
+	/* Data bytes followed by the status byte */
+	size = dataReg->size;
+	if (device->useCRC != AD717X_DISABLE)
+		size++;
+
+	/* buffer[0] stands for the read command the frame is checked with */
+	ret = spi_write_and_read(device->spi_desc, &buffer[1], size);
+	if(ret < 0)
+		return ret;
+
+	buffer[0] = AD717X_COMM_REG_WEN | AD717X_COMM_REG_RD |
+		    AD717X_COMM_REG_RA(AD717X_DATA_REG);
+	if(device->useCRC == AD717X_USE_CRC)
+		check8 = AD717X_ComputeCRC8(buffer, size + 1);
+	if(device->useCRC == AD717X_USE_XOR)
+		check8 = AD717X_ComputeXOR8(buffer, size + 1);
+	if(check8 != 0) {
+		cont_read->crc_errors++;
+		return COMM_ERR;
+	}
+
+	next = (cont_read->head + 1) % cont_read->ring_size;
+	if (next == cont_read->tail) {
+		cont_read->dropped++;
+		return 0;
+	}
+
+	sample = &cont_read->ring[cont_read->head];
+	sample->data = 0;
+	for(i = 1; i < dataReg->size; i++) {
+		sample->data <<= 8;
+		sample->data += buffer[i];
+	}
+	sample->status = buffer[dataReg->size];
+	sample->channel = AD717X_STATUS_REG_CH(sample->status);
+	cont_read->head = next;
+
+	return 0;
+}
+
+/***************************************************************************//**
+* @brief DOUT/RDY falling edge handler, to be registered with
+*        irq_register_callback(). The frame is read from the handler itself:
+*        a result is only held until the next conversion ends, so deferring
+*        the read would lose samples. While continuous read is active the
+*        handler owns the SPI bus of the device; other devices on the same
+*        bus may only be accessed with this interrupt masked.
+*        AD717X_ContReadStop() detaches the stream before it uses the bus.
+*
+* @param ctx   - The handler of the instance of the driver.
+* @param event - Unused.
+* @param extra - Unused.
+*
+* @return None.
+*******************************************************************************/
+void AD717X_ContReadIsr(void *ctx, uint32_t event, void *extra)
+{
+	AD717X_ContReadProcess((ad717x_dev *)ctx);
+}
+
+/***************************************************************************//**
+* @brief Takes samples out of the sample ring, oldest first.
+*
+* @param device      - The handler of the instance of the driver.
+* @param samples     - Array receiving the samples.
+* @param max_samples - Size of the array.
+* @param count       - Number of samples taken.
+*
+* @return Returns 0 for success or negative error code.
+*******************************************************************************/
+int32_t AD717X_ContReadGet(ad717x_dev *device,
+			   ad717x_sample *samples,
+			   uint16_t max_samples,
+			   uint16_t *count)
+{
+	ad717x_cont_read *cont_read;
+	uint16_t tail, head;
+
+	*count = 0;
+	if(!device || !device->cont_read)
+		return INVALID_VAL;
+
+	cont_read = device->cont_read;
+	tail = cont_read->tail;
+	head = cont_read->head;
+	while (tail != head && *count < max_samples) {
+		samples[(*count)++] = cont_read->ring[tail];
+		tail = (tail + 1) % cont_read->ring_size;
+	}
+	cont_read->tail = tail;
+
+	return 0;
+}
+
+/***************************************************************************//**
+* @brief Leaves continuous read mode. The device exits on a read data command
+*        sent while DOUT/RDY is low, so the function waits for the next result
+*        and drops it.
+*
+* @param device - The handler of the instance of the driver.
+*
+* @return Returns 0 for success or negative error code.
+*******************************************************************************/
+int32_t AD717X_ContReadStop(ad717x_dev *device)
+{
+	ad717x_st_reg *interfaceReg;
+	uint8_t rdy = GPIO_LOW;
+	uint32_t timeout = AD717X_CONT_READ_TIMEOUT;
+	int32_t ret;
+
+	if(!device || !device->cont_read)
+		return INVALID_VAL;
+
+	interfaceReg = AD717X_GetReg(device, AD717X_IFMODE_REG);
+	if (!interfaceReg)
+		return INVALID_VAL;
+
+	device->cont_read = NULL;
+
+	if (device->gpio_rdy) {
+		do {
+			ret = gpio_get_value(device->gpio_rdy, &rdy);
+			if(ret < 0)
+				return ret;
+		} while (rdy != GPIO_LOW && --timeout);
+		if (!timeout)
+			return TIMEOUT;
+	}
+
+	ret = AD717X_ReadRegister(device, AD717X_DATA_REG);
+	interfaceReg->value &= ~AD717X_IFMODE_REG_CONT_READ;
+
+	return ret;
+}
+
 /***************************************************************************//**
 * @brief Computes the CRC checksum for a data buffer.
 *
@@ -430,7 +649,7 @@ int32_t AD717X_Init(ad717x_dev **device,
 	int32_t ret;
 	ad717x_st_reg *preg;
 
-	dev = (ad717x_dev *)malloc(sizeof(*dev));
+	dev = (ad717x_dev *)calloc(1, sizeof(*dev));
 	if (!dev)
 		return -1;
 
@@ -442,6 +661,17 @@ int32_t AD717X_Init(ad717x_dev **device,
 	if (ret < 0)
 		return ret;
 
+	/* DOUT/RDY line, used in continuous read mode. */
+	ret = gpio_get_optional(&dev->gpio_rdy, init_param.gpio_rdy);
+	if (ret < 0)
+		return ret;
+
+	if (dev->gpio_rdy) {
+		ret = gpio_direction_input(dev->gpio_rdy);
+		if (ret < 0)
+			return ret;
+	}
+
 	/*  Reset the device interface.*/
 	ret = AD717X_Reset(dev);
 	if (ret < 0)
@@ -499,6 +729,8 @@ int32_t AD717X_remove(ad717x_dev *dev)
 	int32_t ret;
 
 	ret = spi_remove(dev->spi_desc);
+	if (dev->gpio_rdy)
+		ret |= gpio_remove(dev->gpio_rdy);
 
 	free(dev);
 
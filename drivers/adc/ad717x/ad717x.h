@@ -48,6 +48,7 @@
 /******************************************************************************/
 #include <stdint.h>
 #include "spi.h"
+#include "gpio.h"
 
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
@@ -66,6 +67,34 @@ typedef struct {
 	int32_t size;
 } ad717x_st_reg;
 
+/*! AD717X continuous read sample */
+typedef struct {
+	/* Conversion result */
+	uint32_t	data;
+	/* Channel the result belongs to */
+	uint8_t		channel;
+	/* Status byte appended to the result */
+	uint8_t		status;
+} ad717x_sample;
+
+/*
+ * The structure describes a continuous read stream.
+ * @ring: Sample ring, provided by the user.
+ * @ring_size: Number of entries of the ring, holding ring_size - 1 samples.
+ * @head: Ring write index, advanced by AD717X_ContReadProcess().
+ * @tail: Ring read index, advanced by AD717X_ContReadGet().
+ * @dropped: Samples lost because the ring was full.
+ * @crc_errors: Frames discarded because of a checksum mismatch.
+ */
+typedef struct {
+	ad717x_sample		*ring;
+	uint16_t		ring_size;
+	volatile uint16_t	head;
+	volatile uint16_t	tail;
+	uint32_t		dropped;
+	uint32_t		crc_errors;
+} ad717x_cont_read;
+
 /*
  * The structure describes the device and is used with the ad717x driver.
  * @slave_select_id: The ID of the Slave Select to be passed to the SPI calls.
@@ -73,14 +102,19 @@ typedef struct {
  *       provide when calling the Setup() function.
  * @num_regs: The length of the register list.
  * @userCRC: Error check type to use on SPI transfers.
+ * @gpio_rdy: Optional GPIO sensing the DOUT/RDY line.
+ * @cont_read: Active continuous read stream, NULL when not streaming.
  */
 typedef struct {
 	/* SPI */
 	spi_desc		*spi_desc;
+	/* GPIO */
+	gpio_desc		*gpio_rdy;
 	/* Device Settings */
 	ad717x_st_reg		*regs;
 	uint8_t			num_regs;
 	ad717x_crc_mode		useCRC;
+	ad717x_cont_read	*cont_read;
 } ad717x_dev;
 
 typedef struct {
@@ -89,6 +123,8 @@ typedef struct {
 	/* Device Settings */
 	ad717x_st_reg		*regs;
 	uint8_t			num_regs;
+	/* GPIO, optional, the DOUT/RDY line used in continuous read mode */
+	gpio_init_param		*gpio_rdy;
 } ad717x_init_param;
 
 /*****************************************************************************/
@@ -281,6 +317,7 @@ typedef struct {
 /******************* AD717X Constants ****************************************/
 /*****************************************************************************/
 #define AD717X_CRC8_POLYNOMIAL_REPRESENTATION 0x07 /* x8 + x2 + x + 1 */
+#define AD717X_CONT_READ_TIMEOUT 10000 /* DOUT/RDY polls on exit */
 
 /*****************************************************************************/
 /************************ Functions Declarations *****************************/
@@ -328,6 +365,25 @@ int32_t AD717X_UpdateCRCSetting(ad717x_dev *device);
 int32_t AD717X_Init(ad717x_dev **device,
 		    ad717x_init_param init_param);
 
+/*! Enters continuous read mode and starts filling a sample ring. */
+int32_t AD717X_ContReadStart(ad717x_dev *device,
+			     ad717x_cont_read *cont_read);
+
+/*! Reads one data and status frame into the sample ring. */
+int32_t AD717X_ContReadProcess(ad717x_dev *device);
+
+/*! DOUT/RDY falling edge handler. */
+void AD717X_ContReadIsr(void *ctx, uint32_t event, void *extra);
+
+/*! Takes samples out of the sample ring. */
+int32_t AD717X_ContReadGet(ad717x_dev *device,
+			   ad717x_sample *samples,
+			   uint16_t max_samples,
+			   uint16_t *count);
+
+/*! Leaves continuous read mode. */
+int32_t AD717X_ContReadStop(ad717x_dev *device);
+
 /*! Free the resources allocated by AD717X_Init(). */
 int32_t AD717X_remove(ad717x_dev *dev);
 
@@ -43,7 +43,48 @@
 /***************************** Include Files **********************************/
 /******************************************************************************/
 #include <stdlib.h>
+#include <errno.h>
 #include "ad7280a.h"
+#include "error.h"
+
+/******************************************************************************/
+/************************ Variables Definitions *******************************/
+/******************************************************************************/
+/* CRC-8 lookup table for AD7280A_CRC_POLYNOMIAL */
+static const uint8_t ad7280a_crc8_table[256] = {
+	0x00, 0x2F, 0x5E, 0x71, 0xBC, 0x93, 0xE2, 0xCD,
+	0x57, 0x78, 0x09, 0x26, 0xEB, 0xC4, 0xB5, 0x9A,
+	0xAE, 0x81, 0xF0, 0xDF, 0x12, 0x3D, 0x4C, 0x63,
+	0xF9, 0xD6, 0xA7, 0x88, 0x45, 0x6A, 0x1B, 0x34,
+	0x73, 0x5C, 0x2D, 0x02, 0xCF, 0xE0, 0x91, 0xBE,
+	0x24, 0x0B, 0x7A, 0x55, 0x98, 0xB7, 0xC6, 0xE9,
+	0xDD, 0xF2, 0x83, 0xAC, 0x61, 0x4E, 0x3F, 0x10,
+	0x8A, 0xA5, 0xD4, 0xFB, 0x36, 0x19, 0x68, 0x47,
+	0xE6, 0xC9, 0xB8, 0x97, 0x5A, 0x75, 0x04, 0x2B,
+	0xB1, 0x9E, 0xEF, 0xC0, 0x0D, 0x22, 0x53, 0x7C,
+	0x48, 0x67, 0x16, 0x39, 0xF4, 0xDB, 0xAA, 0x85,
+	0x1F, 0x30, 0x41, 0x6E, 0xA3, 0x8C, 0xFD, 0xD2,
+	0x95, 0xBA, 0xCB, 0xE4, 0x29, 0x06, 0x77, 0x58,
+	0xC2, 0xED, 0x9C, 0xB3, 0x7E, 0x51, 0x20, 0x0F,
+	0x3B, 0x14, 0x65, 0x4A, 0x87, 0xA8, 0xD9, 0xF6,
+	0x6C, 0x43, 0x32, 0x1D, 0xD0, 0xFF, 0x8E, 0xA1,
+	0xE3, 0xCC, 0xBD, 0x92, 0x5F, 0x70, 0x01, 0x2E,
+	0xB4, 0x9B, 0xEA, 0xC5, 0x08, 0x27, 0x56, 0x79,
+	0x4D, 0x62, 0x13, 0x3C, 0xF1, 0xDE, 0xAF, 0x80,
+	0x1A, 0x35, 0x44, 0x6B, 0xA6, 0x89, 0xF8, 0xD7,
+	0x90, 0xBF, 0xCE, 0xE1, 0x2C, 0x03, 0x72, 0x5D,
+	0xC7, 0xE8, 0x99, 0xB6, 0x7B, 0x54, 0x25, 0x0A,
+	0x3E, 0x11, 0x60, 0x4F, 0x82, 0xAD, 0xDC, 0xF3,
+	0x69, 0x46, 0x37, 0x18, 0xD5, 0xFA, 0x8B, 0xA4,
+	0x05, 0x2A, 0x5B, 0x74, 0xB9, 0x96, 0xE7, 0xC8,
+	0x52, 0x7D, 0x0C, 0x23, 0xEE, 0xC1, 0xB0, 0x9F,
+	0xAB, 0x84, 0xF5, 0xDA, 0x17, 0x38, 0x49, 0x66,
+	0xFC, 0xD3, 0xA2, 0x8D, 0x40, 0x6F, 0x1E, 0x31,
+	0x76, 0x59, 0x28, 0x07, 0xCA, 0xE5, 0x94, 0xBB,
+	0x21, 0x0E, 0x7F, 0x50, 0x9D, 0xB2, 0xC3, 0xEC,
+	0xD8, 0xF7, 0x86, 0xA9, 0x64, 0x4B, 0x3A, 0x15,
+	0x8F, 0xA0, 0xD1, 0xFE, 0x33, 0x1C, 0x6D, 0x42,
+};
 
 /*****************************************************************************/
 /************************ Functions Definitions ******************************/
@@ -66,11 +107,21 @@ int8_t ad7280a_init(struct ad7280a_dev **device,
 	struct ad7280a_dev *dev;
 	int8_t status;
 	uint32_t value;
+	uint8_t i;
+
+	if (init_param.nb_devices > AD7280A_MAX_DEVICES)
+		return -1;
 
-	dev = (struct ad7280a_dev *)malloc(sizeof(*dev));
+	dev = (struct ad7280a_dev *)calloc(1, sizeof(*dev));
 	if (!dev)
 		return -1;
 
+	dev->nb_devices = init_param.nb_devices ? init_param.nb_devices :
+			  AD7280A_DEFAULT_DEVICES;
+	dev->acq_state = AD7280A_ACQ_IDLE;
+	dev->acq_callback = init_param.acq_callback;
+	dev->acq_ctx = init_param.acq_ctx;
+
 	/* GPIO */
 	status = gpio_get(&dev->gpio_pd, &init_param.gpio_pd);
 	status |= gpio_get(&dev->gpio_cnvst, &init_param.gpio_cnvst);
@@ -83,7 +134,7 @@ int8_t ad7280a_init(struct ad7280a_dev **device,
 	AD7280A_ALERT_IN;
 
 	/* Wait 250us */
-	mdelay(250);
+	udelay(AD7280A_T_POWERUP_US);
 
 	status |= spi_init(&dev->spi_desc, &init_param.spi_init);
 
@@ -102,14 +153,10 @@ int8_t ad7280a_init(struct ad7280a_dev **device,
 				  (1 << 12));
 	ad7280a_transfer_32bits(dev,
 				value);
-	/* Read master address */
-	value = ad7280a_transfer_32bits(dev,
-					AD7280A_READ_TXVAL);
-	//printf("Master address=0x%x\r\n",(value >> 27));
-	/* Read slave address */
-	value = ad7280a_transfer_32bits(dev,
+	/* Read back the address of every device in the chain */
+	for (i = 0; i < dev->nb_devices; i++)
+		ad7280a_transfer_32bits(dev,
 					AD7280A_READ_TXVAL);
-	//printf("Slave address=0x%x\r\n",(value >> 27));
 
 	*device = dev;
 
@@ -170,6 +217,27 @@ uint32_t ad7280a_transfer_32bits(struct ad7280a_dev *dev,
 	return received_data;
 }
 
+/******************************************************************************
+ * @brief Computes the CRC-8 of the 24 bit payload of a frame.
+ *
+ * The payload is processed as two table lookups followed by the XOR of the
+ * least significant byte, which is equivalent to shifting the bits one at a
+ * time through the CRC register described in the datasheet.
+ *
+ * @param value - The frame payload (21 bits for writes, 22 bits for reads).
+ *
+ * @return The CRC-8 value.
+******************************************************************************/
+static uint8_t ad7280a_crc8(uint32_t value)
+{
+	uint8_t crc;
+
+	crc = ad7280a_crc8_table[(value >> 16) & 0xFF];
+	crc = ad7280a_crc8_table[crc ^ ((value >> 8) & 0xFF)];
+
+	return crc ^ (value & 0xFF);
+}
+
 /******************************************************************************
  * @brief Computes the CRC value for a write transmission, and prepares the
  *        complete write codeword
@@ -181,45 +249,12 @@ uint32_t ad7280a_transfer_32bits(struct ad7280a_dev *dev,
 ******************************************************************************/
 uint32_t ad7280a_crc_write(uint32_t message)
 {
-	int32_t i;
-	int32_t crc;
-	int32_t xor1 = 0;
-	int32_t xor2 = 0;
-	int32_t xor3 = 0;
-	int32_t xor4 = 0;
-	int32_t xor5 = 0;
-	uint32_t data_out = 0;
-	int32_t crc0 = 0;
-	int32_t crc1 = 0;
-	int32_t crc2 = 0;
-	int32_t crc3 = 0;
-	int32_t crc4 = 0;
-	int32_t crc5 = 0;
-	int32_t crc6 = 0;
-	int32_t crc7 = 0;
+	uint32_t crc;
 
 	message = message >> 11;
-	for (i = NUMBITS_WRITE; i >= 0; i--) {
-		xor5 = (crc4 ^ crc7) ? 1 : 0;
-		xor4 = (crc2 ^ crc7) ? 1 : 0;
-		xor3 = (crc1 ^ crc7) ? 1 : 0;
-		xor2 = (crc0 ^ crc7) ? 1 : 0;
-		xor1 = ((message & (1 << i)) ? 1 : 0) ^ (crc7 ? 1 : 0);
-		crc7 = crc6;
-		crc6 = crc5;
-		crc5 = xor5;
-		crc4 = crc3;
-		crc3 = xor4;
-		crc2 = xor3;
-		crc1 = xor2;
-		crc0 = xor1;
-	}
-	crc = (crc0 ? (1 << 0) : 0) | (crc1 ? (1 << 1) : 0) | (crc2 ? (1 << 2) : 0) |
-	      (crc3 ? (1 << 3) : 0) | (crc4 ? (1 << 4) : 0) | (crc5 ? (1 << 5) : 0) |
-	      (crc6 ? (1 << 6) : 0) | (crc7 ? (1 << 7) : 0);
-	data_out = (message << 11) | (crc << 3) | 2;
+	crc = ad7280a_crc8(message);
 
-	return data_out;
+	return (message << 11) | (crc << 3) | 2;
 }
 
 /******************************************************************************
@@ -233,65 +268,51 @@ uint32_t ad7280a_crc_write(uint32_t message)
 ******************************************************************************/
 int32_t ad7280a_crc_read(uint32_t message)
 {
-	int32_t i;
-	uint32_t data_in = 0;
-	int32_t crc_rec;
-	int32_t crc_computed;
-	int32_t xor1 = 0;
-	int32_t xor2 = 0;
-	int32_t xor3 = 0;
-	int32_t xor4 = 0;
-	int32_t xor5 = 0;
-	int32_t crc0 = 0;
-	int32_t crc1 = 0;
-	int32_t crc2 = 0;
-	int32_t crc3 = 0;
-	int32_t crc4 = 0;
-	int32_t crc5 = 0;
-	int32_t crc6 = 0;
-	int32_t crc7 = 0;
-
-	crc_rec= (message >> 2) & 0xFF;
-	data_in = message >> 10;
-	for (i = NUMBITS_READ; i >= 0; i--) {
-		xor5 = (crc4 ^ crc7) ? 1 : 0;
-		xor4 = (crc2 ^ crc7) ? 1 : 0;
-		xor3 = (crc1 ^ crc7) ? 1 : 0;
-		xor2 = (crc0 ^ crc7) ? 1 : 0;
-		xor1 = ((data_in & (1 << i)) ? 1 : 0) ^ (crc7 ? 1 : 0);
-		crc7 = crc6;
-		crc6 = crc5;
-		crc5 = xor5;
-		crc4 = crc3;
-		crc3 = xor4;
-		crc2 = xor3;
-		crc1 = xor2;
-		crc0 = xor1;
-	}
-	crc_computed = (crc0 ? (1 << 0) : 0) | (crc1 ? (1 << 1) : 0) |
-		       (crc2 ? (1 << 2) : 0) | (crc3 ? (1 << 3) : 0) |
-		       (crc4 ? (1 << 4) : 0) | (crc5 ? (1 << 5) : 0) |
-		       (crc6 ? (1 << 6) : 0) | (crc7 ? (1 << 7) : 0);
-	if (crc_rec == crc_computed) {
-		return 1;
-	} else {
+	return ad7280a_crc8(message >> 10) == ((message >> 2) & 0xFF);
+}
+
+/******************************************************************************
+ * @brief Checks whether a deadline of the acquisition engine has passed.
+ *
+ * @param dev    - The device structure.
+ *        now_us - Current time in microseconds.
+ *        wait_us - Set to the time left until the deadline.
+ *
+ * @return 1 if the deadline has passed, 0 otherwise.
+******************************************************************************/
+static uint8_t ad7280a_acq_expired(struct ad7280a_dev *dev, uint32_t now_us,
+				   uint32_t *wait_us)
+{
+	int32_t left = (int32_t)(dev->acq_deadline_us - now_us);
+
+	if (left > 0) {
+		*wait_us = left;
 		return 0;
 	}
+
+	return 1;
 }
 
 /******************************************************************************
- * @brief Performs a read from all registers on 2 devices.
+ * @brief Starts a non-blocking acquisition of all registers on all chained
+ *        devices.
  *
- * @param dev - The device structure.
+ * Configures the chain to convert and read back all channels and arms the
+ * engine. The caller then drives it with ad7280a_acq_process(), either from
+ * its main loop or from a timer callback armed with the returned wait time.
  *
- * @return 1.
+ * @param dev    - The device structure.
+ *        now_us - Current time in microseconds (free running, may wrap).
+ *
+ * @return SUCCESS, or -EBUSY if an acquisition is already in progress.
 ******************************************************************************/
-int8_t ad7280a_convert_read_all(struct ad7280a_dev *dev)
+int32_t ad7280a_acq_start(struct ad7280a_dev *dev, uint32_t now_us)
 {
-	uint8_t i;
-	//long err = 1;
 	uint32_t value;
 
+	if (dev->acq_state != AD7280A_ACQ_IDLE)
+		return -EBUSY;
+
 	/* Configure Control HB register. Read all register, convert all registers,
 	average 8 values for all devices */
 	value = ad7280a_crc_write((uint32_t) (AD7280A_CONTROL_HB << 21) |
@@ -299,9 +320,9 @@ int8_t ad7280a_convert_read_all(struct ad7280a_dev *dev)
 				    AD7280A_CTRL_HB_CONV_INPUT_ALL |
 				    AD7280A_CTRL_HB_CONV_AVG_8) << 13) |
 				  (1 << 12));
-	/* Configure the Read register for all devices */
 	ad7280a_transfer_32bits(dev,
 				value);
+	/* Configure the Read register for all devices */
 	value = ad7280a_crc_write((uint32_t) (AD7280A_READ << 21) |
 				  (AD7280A_CELL_VOLTAGE_1 << 15) |
 				  (1 << 12));
@@ -313,34 +334,123 @@ int8_t ad7280a_convert_read_all(struct ad7280a_dev *dev)
 				  (1 << 12));
 	ad7280a_transfer_32bits(dev,
 				value);
-	/* Wait 100us */
-	mdelay(100);
-	/* Toggle CNVST pin */
-	AD7280A_CNVST_LOW;
-	/* Wait 50us */
-	mdelay(50);
-	AD7280A_CNVST_HIGH;
-	/* Wait 300us */
-	mdelay(300);
-	/* Read data from both devices */
-	for(i = 0; i < 24; i++) {
+
+	dev->acq_deadline_us = now_us + AD7280A_T_SETUP_US;
+	dev->acq_state = AD7280A_ACQ_SETUP;
+
+	return SUCCESS;
+}
+
+/******************************************************************************
+ * @brief Reads back the conversion results of all chained devices.
+ *
+ * @param dev - The device structure.
+ *
+ * @return SUCCESS, or -EBADMSG if at least one frame failed the CRC check.
+******************************************************************************/
+static int32_t ad7280a_acq_read(struct ad7280a_dev *dev)
+{
+	uint32_t nb_frames = dev->nb_devices * AD7280A_CHANNELS_PER_DEV;
+	uint32_t errors = 0;
+	uint32_t i;
+
+	for (i = 0; i < nb_frames; i++) {
 		dev->read_data[i] = ad7280a_transfer_32bits(dev,
 				    AD7280A_READ_TXVAL);
+		if (!ad7280a_crc_read(dev->read_data[i]))
+			errors++;
 	}
-
-	// Optionally check all received data to make sure CRC is correct
-	/*for(i=0;i<24;i++)
-	{
-	    if ( crc_read(dev->readData[i]) == 0 )
-	    {
-	        err = 0;
-	    }
-	}*/
+	dev->crc_errors += errors;
 
 	/* Convert the received data to float values. */
 	ad7280a_convert_data_all(dev);
 
-	return (1);
+	return errors ? -EBADMSG : SUCCESS;
+}
+
+/******************************************************************************
+ * @brief Advances the acquisition engine.
+ *
+ * Performs every step whose deadline has passed and never sleeps. When the
+ * conversion results have been read back the completion callback is called
+ * and the engine returns to idle.
+ *
+ * @param dev     - The device structure.
+ *        now_us  - Current time in microseconds, same time base as the one
+ *                  used for ad7280a_acq_start().
+ *        wait_us - Set to the time until the next step, or 0 if the engine is
+ *                  idle.
+ *
+ * @return SUCCESS in case of success, negative error code otherwise.
+******************************************************************************/
+int32_t ad7280a_acq_process(struct ad7280a_dev *dev, uint32_t now_us,
+			    uint32_t *wait_us)
+{
+	*wait_us = 0;
+
+	switch (dev->acq_state) {
+	case AD7280A_ACQ_IDLE:
+		return SUCCESS;
+	case AD7280A_ACQ_SETUP:
+		if (!ad7280a_acq_expired(dev, now_us, wait_us))
+			return SUCCESS;
+		/* Toggle CNVST pin */
+		AD7280A_CNVST_LOW;
+		dev->acq_deadline_us = now_us + AD7280A_T_CNVST_US;
+		dev->acq_state = AD7280A_ACQ_CNVST;
+		*wait_us = AD7280A_T_CNVST_US;
+		return SUCCESS;
+	case AD7280A_ACQ_CNVST:
+		if (!ad7280a_acq_expired(dev, now_us, wait_us))
+			return SUCCESS;
+		AD7280A_CNVST_HIGH;
+		dev->acq_deadline_us = now_us + AD7280A_T_CONV_US;
+		dev->acq_state = AD7280A_ACQ_CONVERT;
+		*wait_us = AD7280A_T_CONV_US;
+		return SUCCESS;
+	case AD7280A_ACQ_CONVERT:
+		if (!ad7280a_acq_expired(dev, now_us, wait_us))
+			return SUCCESS;
+		dev->acq_status = ad7280a_acq_read(dev);
+		dev->acq_state = AD7280A_ACQ_IDLE;
+		if (dev->acq_callback)
+			dev->acq_callback(dev->acq_ctx, dev, dev->acq_status);
+		return SUCCESS;
+	default:
+		dev->acq_state = AD7280A_ACQ_IDLE;
+		return -EINVAL;
+	}
+}
+
+/******************************************************************************
+ * @brief Performs a read from all registers on all chained devices.
+ *
+ * Blocking wrapper over the acquisition engine which waits out each step
+ * with udelay().
+ *
+ * @param dev - The device structure.
+ *
+ * @return 1 if all frames passed the CRC check, -1 otherwise.
+******************************************************************************/
+int8_t ad7280a_convert_read_all(struct ad7280a_dev *dev)
+{
+	uint32_t now_us = 0;
+	uint32_t wait_us;
+	int32_t ret;
+
+	ret = ad7280a_acq_start(dev, now_us);
+	if (ret != SUCCESS)
+		return -1;
+
+	do {
+		ret = ad7280a_acq_process(dev, now_us, &wait_us);
+		if (ret != SUCCESS)
+			return -1;
+		udelay(wait_us);
+		now_us += wait_us;
+	} while (wait_us);
+
+	return (dev->acq_status == SUCCESS) ? 1 : -1;
 }
 
 /******************************************************************************
@@ -352,17 +462,19 @@ int8_t ad7280a_convert_read_all(struct ad7280a_dev *dev)
 ******************************************************************************/
 int8_t ad7280a_convert_data_all(struct ad7280a_dev *dev)
 {
+	uint32_t *data;
+	uint8_t d;
 	uint8_t i;
 
-	for(i = 0; i < 6; i++) {
-		dev->cell_voltage[i]     = 1 + ((dev->read_data[i]    >> 11) & 0xfff) *
-					   0.0009765625;
-		dev->aux_adc[i]          = ((dev->read_data[i+6]      >> 11) & 0xfff) *
-					   0.001220703125;
-		dev->cell_voltage[i + 6] = 1 + ((dev->read_data[i+12] >> 11) & 0xfff) *
-					   0.0009765625;
-		dev->aux_adc[i + 6]      = ((dev->read_data[i+18]     >> 11) & 0xfff) *
-					   0.001220703125;
+	for (d = 0; d < dev->nb_devices; d++) {
+		data = &dev->read_data[d * AD7280A_CHANNELS_PER_DEV];
+		for (i = 0; i < AD7280A_CELLS_PER_DEV; i++) {
+			dev->cell_voltage[d * AD7280A_CELLS_PER_DEV + i] =
+				1 + ((data[i] >> 11) & 0xfff) * 0.0009765625;
+			dev->aux_adc[d * AD7280A_AUX_PER_DEV + i] =
+				((data[AD7280A_CELLS_PER_DEV + i] >> 11) &
+				 0xfff) * 0.001220703125;
+		}
 	}
 
 	return (1);
@@ -407,7 +519,7 @@ int16_t ad7280a_read_register(struct ad7280a_dev *dev,
 	ad7280a_transfer_32bits(dev,
 				value);
 	/* Wait 100us */
-	mdelay(100);
+	udelay(100);
 	/* Configure the Read register */
 	value = ad7280a_crc_write((uint32_t) (dev_addr << 31) |
 				  (AD7280A_READ << 21) |
@@ -465,7 +577,7 @@ int16_t ad7280a_read_conversion(struct ad7280a_dev *dev,
 	ad7280a_transfer_32bits(dev,
 				value);
 	/* Wait 100us */
-	mdelay(100);
+	udelay(100);
 	/*  */
 	value = ad7280a_crc_write((uint32_t)(dev_addr << 31) |
 				  (AD7280A_CONTROL_HB << 21) |
@@ -474,7 +586,7 @@ int16_t ad7280a_read_conversion(struct ad7280a_dev *dev,
 	ad7280a_transfer_32bits(dev,
 				value);
 	/* Wait 100us */
-	mdelay(100);
+	udelay(100);
 	/* Allow conversions to be initiated using CNVST pin on selected part */
 	value=ad7280a_crc_write((uint32_t)(dev_addr << 31) |
 				(AD7280A_CNVST_N_CONTROL << 21) |
@@ -486,10 +598,10 @@ int16_t ad7280a_read_conversion(struct ad7280a_dev *dev,
 	AD7280A_CNVST_LOW;
 	/* Allow sufficient time for all conversions to be completed */
 	/* Wait 50us */
-	mdelay(50);
+	udelay(50);
 	AD7280A_CNVST_HIGH;
 	/* Wait 300us */
-	mdelay(300);
+	udelay(300);
 	/* Perform the read */
 	value = ad7280a_transfer_32bits(dev,
 					AD7280A_READ_TXVAL);
@@ -701,7 +813,7 @@ void ad7280a_selftest_all(struct ad7280a_dev *dev,
 	ad7280a_transfer_32bits(dev,
 				value);
 	/* Wait 100us */
-	mdelay(100);
+	udelay(100);
 	value = ad7280a_crc_write((uint32_t) (AD7280A_READ << 21) |
 				  (AD7280A_SELF_TEST << 15)            |
 				  (1 << 12));
@@ -716,10 +828,10 @@ void ad7280a_selftest_all(struct ad7280a_dev *dev,
 				value);
 	AD7280A_CNVST_LOW;
 	/* wait 100us */
-	mdelay(100);
+	udelay(100);
 	AD7280A_CNVST_HIGH;
 	/* wait 300us */
-	mdelay(300);
+	udelay(300);
 	value = ad7280a_crc_write((uint32_t) (AD7280A_CNVST_N_CONTROL << 21) |
 				  (1 << 13)                       |
 				  (1 << 12));
@@ -165,9 +165,51 @@
 #define NUMBITS_READ        22   // Number of bits for CRC when reading
 #define NUMBITS_WRITE       21   // Number of bits for CRC when writing
 
+/* CRC-8 polynomial x^8 + x^5 + x^3 + x^2 + x + 1 */
+#define AD7280A_CRC_POLYNOMIAL                  0x2F
+
+/* Daisy chain */
+#define AD7280A_MAX_DEVICES                     8
+#define AD7280A_DEFAULT_DEVICES                 2
+#define AD7280A_CELLS_PER_DEV                   6
+#define AD7280A_AUX_PER_DEV                     6
+#define AD7280A_CHANNELS_PER_DEV                12
+
+/* Acquisition timings (us) */
+#define AD7280A_T_POWERUP_US                    250
+#define AD7280A_T_SETUP_US                      100
+#define AD7280A_T_CNVST_US                      50
+#define AD7280A_T_CONV_US                       300
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
+struct ad7280a_dev;
+
+/**
+ * @enum ad7280a_acq_state
+ * @brief States of the non-blocking acquisition engine.
+ */
+enum ad7280a_acq_state {
+	/** No acquisition in progress */
+	AD7280A_ACQ_IDLE,
+	/** Chain configured, waiting before the CNVST pulse */
+	AD7280A_ACQ_SETUP,
+	/** CNVST held low */
+	AD7280A_ACQ_CNVST,
+	/** Conversion in progress on all devices */
+	AD7280A_ACQ_CONVERT,
+};
+
+/**
+ * @brief Called when an acquisition completes.
+ * @param ctx - Context registered with the callback.
+ * @param dev - The device structure; results are in cell_voltage/aux_adc.
+ * @param status - SUCCESS, or -EBADMSG if at least one frame failed CRC.
+ */
+typedef void (*ad7280a_acq_callback)(void *ctx, struct ad7280a_dev *dev,
+				     int32_t status);
+
 struct ad7280a_dev {
 	/* SPI */
 	spi_desc		*spi_desc;
@@ -176,9 +218,20 @@ struct ad7280a_dev {
 	struct gpio_desc	*gpio_cnvst;
 	struct gpio_desc	*gpio_alert;
 	/* Device Settings */
-	uint32_t		read_data[24];
-	float			cell_voltage[12];
-	float			aux_adc[12];
+	uint8_t			nb_devices;
+	uint32_t		read_data[AD7280A_MAX_DEVICES *
+						 AD7280A_CHANNELS_PER_DEV];
+	float			cell_voltage[AD7280A_MAX_DEVICES *
+					     AD7280A_CELLS_PER_DEV];
+	float			aux_adc[AD7280A_MAX_DEVICES *
+					AD7280A_AUX_PER_DEV];
+	/* Acquisition engine */
+	enum ad7280a_acq_state	acq_state;
+	uint32_t		acq_deadline_us;
+	int32_t			acq_status;
+	uint32_t		crc_errors;
+	ad7280a_acq_callback	acq_callback;
+	void			*acq_ctx;
 };
 
 struct ad7280a_init_param {
@@ -188,6 +241,11 @@ struct ad7280a_init_param {
 	struct gpio_init_param	gpio_pd;
 	struct gpio_init_param	gpio_cnvst;
 	struct gpio_init_param	gpio_alert;
+	/* Number of chained devices, 0 selects AD7280A_DEFAULT_DEVICES */
+	uint8_t		nb_devices;
+	/* Optional acquisition completion callback */
+	ad7280a_acq_callback	acq_callback;
+	void		*acq_ctx;
 };
 
 /*****************************************************************************/
@@ -212,9 +270,16 @@ uint32_t ad7280a_crc_write(uint32_t message);
 the same. */
 int32_t ad7280a_crc_read(uint32_t message);
 
-/* Performs a read from all registers on 2 devices. */
+/* Performs a read from all registers on all chained devices. */
 int8_t ad7280a_convert_read_all(struct ad7280a_dev *dev);
 
+/* Starts a non-blocking acquisition of all chained devices. */
+int32_t ad7280a_acq_start(struct ad7280a_dev *dev, uint32_t now_us);
+
+/* Advances the acquisition engine. */
+int32_t ad7280a_acq_process(struct ad7280a_dev *dev, uint32_t now_us,
+			    uint32_t *wait_us);
+
 /* Converts acquired data to float values. */
 int8_t ad7280a_convert_data_all(struct ad7280a_dev *dev);
 
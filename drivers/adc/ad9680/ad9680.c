@@ -43,6 +43,8 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include "ad9680.h"
+#include "spi_seq.h"
+#include "util.h"
 
 /***************************************************************************//**
  * @brief ad9680_spi_read
@@ -119,6 +121,36 @@ int32_t ad9680_setup(struct ad9680_dev **device,
 	uint8_t pll_stat;
 	int32_t ret;
 	struct ad9680_dev *dev;
+	/*
+	 * The device streams with a decrementing address after reset, the
+	 * subclass and CSN registers are listed top-down to share a transaction.
+	 */
+	const struct spi_seq_entry setup_seq[] = {
+		SPI_SEQ_WR(AD9680_REG_INTERFACE_CONF_A, 0x81),	// RESET
+		SPI_SEQ_DELAY_MS(250),
+		SPI_SEQ_WR(AD9680_REG_LINK_CONTROL,
+			   0x15),	// disable link, ilas enable
+		SPI_SEQ_WR(AD9680_REG_JESD204B_MF_CTRL,
+			   0x1f),	// mf-frame-count
+		SPI_SEQ_WR(AD9680_REG_JESD204B_SUBCLASS_CONFIG,
+			   0x2f),	// subclass-1, N'=16
+		SPI_SEQ_WR(AD9680_REG_JESD204B_CSN_CONFIG,
+			   0x2d),	// 14-bit
+		SPI_SEQ_WR(AD9680_REG_JESD204B_QUICK_CONFIG,
+			   0x88),	// m=2, l=4, f= 1
+		/* low line rate mode must be enabled below 6.25 Gbps */
+		SPI_SEQ_WR(AD9680_REG_JESD204B_LANE_RATE_CTRL,
+			   init_param->lane_rate_kbps < 6250000 ? 0x10 : 0x00),
+		SPI_SEQ_WR(AD9680_REG_LINK_CONTROL,
+			   0x14),	// link enable
+		SPI_SEQ_DELAY_MS(250),
+	};
+	struct spi_seq_config cfg = {
+		.read_flag = 0x8000,
+		.addr_mask = 0x7FFF,
+		.addr_ascending = false,
+		.max_stream = SPI_SEQ_MAX_STREAM,
+	};
 
 	ret = 0;
 
@@ -137,38 +169,10 @@ int32_t ad9680_setup(struct ad9680_dev **device,
 		return -1;
 	}
 
-	ad9680_spi_write(dev,
-			 AD9680_REG_INTERFACE_CONF_A,
-			 0x81);	// RESET
-	mdelay(250);
-
-	ad9680_spi_write(dev,
-			 AD9680_REG_LINK_CONTROL,
-			 0x15);	// disable link, ilas enable
-	ad9680_spi_write(dev,
-			 AD9680_REG_JESD204B_MF_CTRL,
-			 0x1f);	// mf-frame-count
-	ad9680_spi_write(dev,
-			 AD9680_REG_JESD204B_CSN_CONFIG,
-			 0x2d);	// 14-bit
-	ad9680_spi_write(dev,
-			 AD9680_REG_JESD204B_SUBCLASS_CONFIG,
-			 0x2f);	// subclass-1, N'=16
-	ad9680_spi_write(dev,
-			 AD9680_REG_JESD204B_QUICK_CONFIG,
-			 0x88);	// m=2, l=4, f= 1
-	if (init_param->lane_rate_kbps < 6250000)
-		ad9680_spi_write(dev,
-				 AD9680_REG_JESD204B_LANE_RATE_CTRL,
-				 0x10);	// low line rate mode must be enabled
-	else
-		ad9680_spi_write(dev,
-				 AD9680_REG_JESD204B_LANE_RATE_CTRL,
-				 0x00);	// low line rate mode must be disabled
-	ad9680_spi_write(dev,
-			 AD9680_REG_LINK_CONTROL,
-			 0x14);	// link enable
-	mdelay(250);
+	cfg.spi = dev->spi_desc;
+	ret = spi_seq_run(&cfg, setup_seq, ARRAY_SIZE(setup_seq));
+	if (ret < 0)
+		return ret;
 
 	ad9680_spi_read(dev,
 			AD9680_REG_JESD204B_PLL_LOCK_STATUS,
@@ -121,6 +121,81 @@ int32_t axi_adc_pn_mon(struct axi_adc *adc,
 	return SUCCESS;
 }
 
+/***************************************************************************//**
+ * @brief axi_adc_ber_test
+ * Runs the PN monitors of all channels at once until enough bits were
+ * checked for the requested BER and confidence level, or until the timeout
+ * expires. The channel status flags are sticky, so they are sampled and
+ * cleared every AXI_ADC_BER_POLL_MS; result must hold num_channels entries.
+ * Returns SUCCESS if all channels pass, FAILURE otherwise.
+*******************************************************************************/
+int32_t axi_adc_ber_test(struct axi_adc *adc,
+			 const struct axi_adc_ber_param *param,
+			 struct axi_adc_ber_result *result)
+{
+	uint64_t sampling_freq;
+	uint64_t bits_required;
+	uint64_t poll_bits;
+	uint32_t elapsed_ms;
+	uint32_t reg_data;
+	uint8_t ch;
+	uint8_t done;
+	int32_t ret = SUCCESS;
+
+	bits_required = ber_bits_required(param->ber_exp, param->confidence);
+	axi_adc_get_sampling_freq(adc, 0, &sampling_freq);
+	poll_bits = sampling_freq * param->sample_bits * AXI_ADC_BER_POLL_MS;
+	do_div(&poll_bits, 1000);
+	if (!bits_required || !poll_bits)
+		return FAILURE;
+
+	for (ch = 0; ch < adc->num_channels; ch++) {
+		result[ch].bits = 0;
+		result[ch].errors = 0;
+		result[ch].oos_events = 0;
+		result[ch].pass = 0;
+		axi_adc_read(adc, AXI_ADC_REG_CHAN_CNTRL(ch), &reg_data);
+		reg_data |= AXI_ADC_ENABLE;
+		axi_adc_write(adc, AXI_ADC_REG_CHAN_CNTRL(ch), reg_data);
+		axi_adc_set_pnsel(adc, ch, param->sel);
+	}
+	mdelay(1);
+
+	for (ch = 0; ch < adc->num_channels; ch++)
+		axi_adc_write(adc, AXI_ADC_REG_CHAN_STATUS(ch), 0xff);
+
+	elapsed_ms = 0;
+	do {
+		mdelay(AXI_ADC_BER_POLL_MS);
+		elapsed_ms += AXI_ADC_BER_POLL_MS;
+
+		done = 1;
+		for (ch = 0; ch < adc->num_channels; ch++) {
+			axi_adc_read(adc, AXI_ADC_REG_CHAN_STATUS(ch), &reg_data);
+			axi_adc_write(adc, AXI_ADC_REG_CHAN_STATUS(ch), reg_data);
+			if (reg_data & AXI_ADC_PN_OOS) {
+				result[ch].oos_events++;
+			} else {
+				result[ch].bits += poll_bits;
+				if (reg_data & AXI_ADC_PN_ERR)
+					result[ch].errors++;
+			}
+			if (result[ch].bits < bits_required)
+				done = 0;
+		}
+	} while (!done &&
+		 (!param->timeout_ms || elapsed_ms < param->timeout_ms));
+
+	for (ch = 0; ch < adc->num_channels; ch++) {
+		result[ch].pass = !result[ch].errors && !result[ch].oos_events &&
+				  result[ch].bits >= bits_required;
+		if (!result[ch].pass)
+			ret = FAILURE;
+	}
+
+	return ret;
+}
+
 /***************************************************************************//**
  * @brief axi_adc_get_sampling_freq
 *******************************************************************************/
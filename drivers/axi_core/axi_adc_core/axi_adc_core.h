@@ -106,6 +106,8 @@
 
 #define AXI_ADC_REG_DELAY(l)		(0x0800 + (l) * 0x4)
 
+#define AXI_ADC_BER_POLL_MS		1
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -133,6 +135,29 @@ enum axi_adc_pn_sel {
 	AXI_ADC_PN_END = 10,
 };
 
+struct axi_adc_ber_param {
+	enum axi_adc_pn_sel	sel;
+	/* Bits carried by each sample */
+	uint32_t		sample_bits;
+	/* Target bit error rate is 10^-ber_exp */
+	uint32_t		ber_exp;
+	/* Confidence level in per mille */
+	uint32_t		confidence;
+	/* Upper limit of the test duration, 0 for no limit */
+	uint32_t		timeout_ms;
+};
+
+struct axi_adc_ber_result {
+	/* Bits checked while the monitor was in sync */
+	uint64_t	bits;
+	/* Poll intervals with errors, a lower bound of the bit errors */
+	uint32_t	errors;
+	/* Poll intervals with the monitor out of sync */
+	uint32_t	oos_events;
+	/* Error free over the bits required by the target */
+	uint8_t		pass;
+};
+
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
@@ -151,6 +176,9 @@ int32_t axi_adc_set_pnsel(struct axi_adc *adc,
 int32_t axi_adc_pn_mon(struct axi_adc *adc,
 		       enum axi_adc_pn_sel sel,
 		       uint32_t delay_ms);
+int32_t axi_adc_ber_test(struct axi_adc *adc,
+			 const struct axi_adc_ber_param *param,
+			 struct axi_adc_ber_result *result);
 int32_t axi_adc_get_sampling_freq(struct axi_adc *adc,
 				  uint32_t chan,
 				  uint64_t *sampling_freq);
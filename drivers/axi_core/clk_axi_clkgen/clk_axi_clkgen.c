@@ -48,6 +48,7 @@
 #include "error.h"
 #include "delay.h"
 #include "clk_axi_clkgen.h"
+#include "clk_solver.h"
 #include "xil_io.h"
 
 /******************************************************************************/
@@ -322,62 +323,35 @@ void axi_clkgen_calc_params(struct axi_clkgen *axi_clkgen,
 			    uint32_t *best_m,
 			    uint32_t *best_dout)
 {
-	uint32_t fpfd_min	= 10000;
-	uint32_t fpfd_max	= 300000;
-	uint32_t fvco_min	= 600000;
-	uint32_t fvco_max	= 1200000;
-	uint32_t	   d		= 0;
-	uint32_t	   d_min	= 0;
-	uint32_t	   d_max	= 0;
-	uint32_t	   _d_min	= 0;
-	uint32_t	   _d_max	= 0;
-	uint32_t	   m		= 0;
-	uint32_t	   m_min	= 0;
-	uint32_t	   m_max	= 0;
-	uint32_t	   dout		= 0;
-	uint32_t	   fvco		= 0;
-	int32_t		   f		= 0;
-	int32_t		   best_f	= 0;
+	struct clk_solver_mmcm_limits limits = {
+		.fpfd_min = 10000,
+		.fpfd_max = 300000,
+		.fvco_min = 600000,
+		.fvco_max = 1200000,
+	};
+	uint32_t params[3];
 	uint32_t pcore_version;
 
+	if (clk_solver_cache_lookup(&axi_clkgen->cache, fin, fout, params, 3)) {
+		*best_d = params[0];
+		*best_m = params[1];
+		*best_dout = params[2];
+		return;
+	}
+
 	axi_clkgen_read(axi_clkgen, AXI_REG_VERSION, &pcore_version);
 	if (AXI_PCORE_VER_MAJOR(pcore_version) > 0x04)
-		axi_clkgen_setup_ranges(axi_clkgen, &fpfd_min, &fpfd_max,
-					&fvco_min, &fvco_max);
-
-	fin /= 1000;
-	fout /= 1000;
-
-	best_f = 0x7fffffff;
-	*best_d = 0;
-	*best_m = 0;
-	*best_dout = 0;
-
-	d_min = max(DIV_ROUND_UP(fin, fpfd_max), 1);
-	d_max = min(fin / fpfd_min, 80);
-
-	m_min = max(DIV_ROUND_UP(fvco_min, fin) * d_min, 1);
-	m_max = min(fvco_max * d_max / fin, 64);
-
-	for(m = m_min; m <= m_max; m++) {
-		_d_min = max(d_min, DIV_ROUND_UP(fin * m, fvco_max));
-		_d_max = min(d_max, fin * m / fvco_min);
-
-		for (d = _d_min; d <= _d_max; d++) {
-			fvco = fin * m / d;
-			dout = DIV_ROUND_CLOSEST(fvco, fout);
-			dout = clamp(dout, 1, 128);
-			f = fvco / dout;
-			if (abs(f - (int32_t)fout) < abs(best_f - (int32_t)fout)) {
-				best_f = f;
-				*best_d = d;
-				*best_m = m;
-				*best_dout = dout;
-				if (best_f == (int32_t)fout)
-					return;
-			}
-		}
-	}
+		axi_clkgen_setup_ranges(axi_clkgen, &limits.fpfd_min,
+					&limits.fpfd_max, &limits.fvco_min,
+					&limits.fvco_max);
+
+	clk_solver_mmcm(&limits, fin / 1000, fout / 1000, best_d, best_m,
+			best_dout);
+
+	params[0] = *best_d;
+	params[1] = *best_m;
+	params[2] = *best_dout;
+	clk_solver_cache_store(&axi_clkgen->cache, fin, fout, params, 3);
 }
 
 /**
@@ -533,6 +507,7 @@ int32_t axi_clkgen_init(struct axi_clkgen **clk,
 	clkgen->base = init->base;
 	clkgen->name = init->name;
 	clkgen->parent_rate = init->parent_rate;
+	clk_solver_cache_flush(&clkgen->cache);
 
 	*clk = clkgen;
 
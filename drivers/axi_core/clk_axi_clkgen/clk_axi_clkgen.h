@@ -43,6 +43,7 @@
 /***************************** Include Files **********************************/
 /******************************************************************************/
 #include <stdint.h>
+#include "clk_solver.h"
 
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
@@ -51,6 +52,7 @@ struct axi_clkgen {
 	const char	*name;
 	uint32_t	base;
 	uint32_t	parent_rate;
+	struct clk_solver_cache	cache;
 };
 
 struct axi_clkgen_init {
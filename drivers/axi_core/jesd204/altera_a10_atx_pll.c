@@ -42,6 +42,7 @@
 /******************************************************************************/
 #include <limits.h>
 #include "util.h"
+#include "clk_solver.h"
 #include "altera_a10_atx_pll.h"
 
 /******************************************************************************/
@@ -59,6 +60,9 @@ static const uint32_t altera_a10_atx_bands[] = {
 	8800000,  8600000,  8200000,  7800000,  7400000,
 };
 
+/* Solved (N, M, L, VCO) settings of the most recent rates */
+static struct clk_solver_cache altera_a10_atx_cache;
+
 /******************************************************************************/
 /************************** Functions Implementation **************************/
 /******************************************************************************/
@@ -146,13 +150,23 @@ static void altera_a10_atx_calc_params(uint32_t fref,
 				       uint32_t fout, uint32_t *best_n, uint32_t *best_m,
 				       uint32_t *best_l, uint32_t *best_fvco)
 {
-	uint32_t m, m_min, m_max;
+	uint32_t m, m_min, m_max, m_est;
 	uint32_t n, l;
-	uint32_t f, fvco, best_f;
+	uint32_t f, fvco, err, best_err;
 	uint32_t pfd;
+	uint32_t params[4];
+
+	if (clk_solver_cache_lookup(&altera_a10_atx_cache, fref, fout, params,
+				    4)) {
+		*best_n = params[0];
+		*best_m = params[1];
+		*best_l = params[2];
+		*best_fvco = params[3];
+		return;
+	}
 
 	*best_n = *best_m = *best_l = *best_fvco = 0;
-	best_f = ULONG_MAX;
+	best_err = UINT32_MAX;
 
 	m_min = max_t(uint32_t, DIV_ROUND_UP(A10_ATX_PLL_VCO_MIN / 2, fref), 8);
 	m_max = min_t(uint32_t, A10_ATX_PLL_VCO_MAX / 2 * 8 / fref, 127);
@@ -164,24 +178,37 @@ static void altera_a10_atx_calc_params(uint32_t fref,
 		if (pfd > A10_ATX_PLL_VCO_MAX)
 			continue;
 
-		for (m = m_min; m <= m_max; m++) {
-			fvco = fref * m * 2 / n;
-
-			for (l = 1; l <= 16; l *= 2) {
+		for (l = 1; l <= 16; l *= 2) {
+			/* f = 4 * fref * m / (n * l), only the M closest to
+			 * the target and its neighbours need to be checked */
+			m_est = DIV_ROUND_CLOSEST((uint64_t)fout * n * l,
+						  4ULL * fref);
+			m_est = clamp_t(uint32_t, m_est, m_min, m_max);
+			m = max_t(uint32_t, m_est - 1, m_min);
+			for (; m <= min_t(uint32_t, m_est + 1, m_max); m++) {
+				fvco = fref * m * 2 / n;
 				f = (fvco * 2) / l;
+				err = f > fout ? f - fout : fout - f;
 
-				if (abs(f - fout) < abs(best_f - fout)) {
-					best_f = f;
+				if (err < best_err) {
+					best_err = err;
 					*best_n = n;
 					*best_m = m;
 					*best_l = l;
 					*best_fvco = fvco;
-					if (f == fout)
-						return;
 				}
 			}
+			if (!best_err)
+				goto out;
 		}
 	}
+
+out:
+	params[0] = *best_n;
+	params[1] = *best_m;
+	params[2] = *best_l;
+	params[3] = *best_fvco;
+	clk_solver_cache_store(&altera_a10_atx_cache, fref, fout, params, 4);
 }
 
 /**
@@ -42,6 +42,7 @@
 /******************************************************************************/
 #include <limits.h>
 #include "util.h"
+#include "clk_solver.h"
 #include "altera_a10_cdr_pll.h"
 
 /******************************************************************************/
@@ -52,6 +53,9 @@
 #define A10_CDR_PLL_VCO_MIN 4900000  /*   4.90 GHz */
 #define A10_CDR_PLL_VCO_MAX 14150000 /*  14.15 GHz */
 
+/* Solved (N, M, LPFD, LPD, VCO) settings of the most recent rates */
+static struct clk_solver_cache altera_a10_cdr_cache;
+
 /******************************************************************************/
 /************************** Functions Implementation **************************/
 /******************************************************************************/
@@ -284,13 +288,25 @@ void altera_a10_cdr_calc_params(uint32_t fref,
 				uint32_t *best_lpfd, uint32_t *best_lpd,
 				uint32_t *best_fvco)
 {
-	uint32_t m, m_min, m_max;
+	uint32_t m, m_min, m_max, m_est;
 	uint32_t n, lpd, lpfd, lpfd_min;
-	uint32_t fvco, target_fvco;
+	uint32_t fvco, target_fvco, err, best_err;
 	uint32_t pfd;
+	uint32_t rate = fout;
+	uint32_t params[5];
+
+	if (clk_solver_cache_lookup(&altera_a10_cdr_cache, fref, rate, params,
+				    5)) {
+		*best_n = params[0];
+		*best_m = params[1];
+		*best_lpfd = params[2];
+		*best_lpd = params[3];
+		*best_fvco = params[4];
+		return;
+	}
 
 	*best_n = *best_m = *best_lpfd = *best_lpd = *best_fvco = 0;
-
+	best_err = UINT32_MAX;
 
 	fout /= 2;
 
@@ -317,21 +333,38 @@ void altera_a10_cdr_calc_params(uint32_t fref,
 			continue;
 
 		for (lpfd = lpfd_min; lpfd <= 2; lpfd++) {
-			for (m = m_min; m <= m_max; m++) {
+			/* fvco = fref * m * lpfd / n, only the M closest to
+			 * the target and its neighbours need to be checked */
+			m_est = DIV_ROUND_CLOSEST((uint64_t)target_fvco * n,
+						  (uint64_t)fref * lpfd);
+			m_est = clamp_t(uint32_t, m_est, m_min, m_max);
+			m = max_t(uint32_t, m_est - 1, m_min);
+			for (; m <= min_t(uint32_t, m_est + 1, m_max); m++) {
 				fvco = fref * m * lpfd / n;
+				err = fvco > target_fvco ? fvco - target_fvco :
+				      target_fvco - fvco;
 
-				if (abs(fvco - target_fvco) < abs(*best_fvco - target_fvco)) {
+				if (err < best_err) {
+					best_err = err;
 					*best_n = n;
 					*best_m = m;
 					*best_lpfd = lpfd;
 					*best_fvco = fvco;
 					*best_lpd = lpd;
-					if (target_fvco == fvco)
-						return;
 				}
 			}
+			if (!best_err)
+				goto out;
 		}
 	}
+
+out:
+	params[0] = *best_n;
+	params[1] = *best_m;
+	params[2] = *best_lpfd;
+	params[3] = *best_lpd;
+	params[4] = *best_fvco;
+	clk_solver_cache_store(&altera_a10_cdr_cache, fref, rate, params, 5);
 }
 
 /**
@@ -81,11 +81,6 @@
 #define ADXCVR_DRP_PORT_ADDR_COMMON		0x00
 #define ADXCVR_DRP_PORT_ADDR_CHANNEL	0x20
 
-#define ADXCVR_DRP_PORT_COMMON(x)		(x)
-#define ADXCVR_DRP_PORT_CHANNEL(x)		(0x100 + (x))
-
-#define ADXCVR_BROADCAST				0xff
-
 /**
  * @brief adxcvr_write
  */
@@ -0,0 +1,698 @@
+/***************************************************************************//**
+ *   @file   axi_adxcvr_eyescan.c
+ *   @brief  Statistical eye scan for the ADI AXI-ADXCVR Module.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdlib.h>
+#include <stdio.h>
+#include <inttypes.h>
+#include "util.h"
+#include "error.h"
+#include "axi_adxcvr.h"
+#include "axi_adxcvr_eyescan.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+/* ES_CONTROL, ES_ERRDET_EN and ES_EYE_SCAN_EN share one register */
+#define ES_CONTROL_RUN			BIT(10)
+#define ES_CONTROL_MASK			0xFC00
+#define ES_ERRDET_EN			BIT(9)
+#define ES_EYE_SCAN_EN			BIT(8)
+/* ES_PRESCALE is 5 bits, its location depends on the transceiver */
+#define ES_PRESCALE_MASK		0x1F
+
+#define ES_CONTROL_STATUS_DONE		BIT(0)
+
+#define ES_MASK_REGS			5
+#define ES_TIMEOUT			100000
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+struct adxcvr_es_regs {
+	uint32_t control;
+	uint32_t qualifier;
+	uint32_t qual_mask;
+	uint32_t sdata_mask;
+	uint32_t hoffset;
+	uint32_t voffset;
+	uint32_t prescale;
+	uint32_t prescale_shift;
+	uint32_t status;
+	uint32_t error_count;
+	uint32_t sample_count;
+};
+
+/* Per lane register values kept over a scan. */
+struct adxcvr_es_lane_regs {
+	uint32_t control;
+	uint32_t hoffset;
+	uint32_t voffset;
+	/* Settings found before the scan, restored once it is over */
+	bool saved;
+	uint32_t saved_control;
+	uint32_t saved_hoffset;
+	uint32_t saved_voffset;
+	uint32_t saved_qualifier[ES_MASK_REGS];
+	uint32_t saved_qual_mask[ES_MASK_REGS];
+	uint32_t saved_sdata_mask[ES_MASK_REGS];
+};
+
+/* UG476, 7 Series GTX */
+static const struct adxcvr_es_regs adxcvr_es_gtx2_regs = {
+	.control = 0x03D,
+	.qualifier = 0x02C,
+	.qual_mask = 0x031,
+	.sdata_mask = 0x036,
+	.hoffset = 0x03C,
+	.voffset = 0x03B,
+	.prescale = 0x03B,
+	.prescale_shift = 11,
+	.status = 0x151,
+	.error_count = 0x14F,
+	.sample_count = 0x150,
+};
+
+/* UG576, UltraScale GTH */
+static const struct adxcvr_es_regs adxcvr_es_gth3_regs = {
+	.control = 0x03C,
+	.qualifier = 0x03F,
+	.qual_mask = 0x044,
+	.sdata_mask = 0x049,
+	.hoffset = 0x04F,
+	.voffset = 0x097,
+	.prescale = 0x03C,
+	.prescale_shift = 0,
+	.status = 0x153,
+	.error_count = 0x151,
+	.sample_count = 0x152,
+};
+
+/* UG576/UG578, UltraScale+ GTH and GTY */
+static const struct adxcvr_es_regs adxcvr_es_gth4_regs = {
+	.control = 0x03C,
+	.qualifier = 0x03F,
+	.qual_mask = 0x044,
+	.sdata_mask = 0x049,
+	.hoffset = 0x04F,
+	.voffset = 0x097,
+	.prescale = 0x03C,
+	.prescale_shift = 0,
+	.status = 0x253,
+	.error_count = 0x251,
+	.sample_count = 0x252,
+};
+
+/**
+ * @brief adxcvr_es_get_regs
+ */
+static const struct adxcvr_es_regs *adxcvr_es_get_regs(struct adxcvr *xcvr)
+{
+	switch (xcvr->xlx_xcvr.type) {
+	case XILINX_XCVR_TYPE_S7_GTX2:
+		return &adxcvr_es_gtx2_regs;
+	case XILINX_XCVR_TYPE_US_GTH3:
+		return &adxcvr_es_gth3_regs;
+	case XILINX_XCVR_TYPE_US_GTH4:
+	case XILINX_XCVR_TYPE_US_GTY4:
+		return &adxcvr_es_gth4_regs;
+	default:
+		return NULL;
+	}
+}
+
+/**
+ * @brief adxcvr_es_hoffset
+ * The horizontal offset is 12 bits, two's complement with the phase
+ * unification bit on top, in [11:0] on GTX2 and in [15:4] on GTH/GTY.
+ */
+static uint32_t adxcvr_es_hoffset(struct adxcvr *xcvr,
+				  uint32_t base,
+				  int32_t hoffset)
+{
+	if (xcvr->xlx_xcvr.type == XILINX_XCVR_TYPE_S7_GTX2)
+		return (base & ~0xFFF) | (hoffset & 0xFFF);
+
+	return (base & ~0xFFF0) | ((hoffset & 0xFFF) << 4);
+}
+
+/**
+ * @brief adxcvr_es_voffset
+ * The vertical offset is sign-magnitude, with the UT sign selecting the
+ * DFE unrolled tap: {ut, sign, mag[6:0]} on GTX2, RX_EYESCAN_VS
+ * {ut[10], neg_dir[9], code[8:2], range[1:0]} on GTH/GTY.
+ */
+static uint32_t adxcvr_es_voffset(struct adxcvr *xcvr,
+				  uint32_t base,
+				  int32_t voffset,
+				  uint32_t ut)
+{
+	uint32_t mag = abs(voffset) & 0x7F;
+	uint32_t neg = voffset < 0;
+
+	if (xcvr->xlx_xcvr.type == XILINX_XCVR_TYPE_S7_GTX2)
+		return (base & ~0x1FF) | (ut << 8) | (neg << 7) | mag;
+
+	return (base & ~0x7FC) | (ut << 10) | (neg << 9) | (mag << 2);
+}
+
+/**
+ * @brief adxcvr_eyescan_init
+ */
+int32_t adxcvr_eyescan_init(struct adxcvr_eyescan **es,
+			    struct adxcvr *xcvr,
+			    const struct adxcvr_eyescan_init *init)
+{
+	struct adxcvr_eyescan *eyescan;
+	uint32_t points;
+	uint32_t lane;
+	int32_t ret;
+
+	if (xcvr->tx_enable || !adxcvr_es_get_regs(xcvr))
+		return FAILURE;
+
+	eyescan = (struct adxcvr_eyescan *)calloc(1, sizeof(*eyescan));
+	if (!eyescan)
+		return FAILURE;
+
+	eyescan->xcvr = xcvr;
+	eyescan->lane_mask = init->lane_mask ? init->lane_mask :
+			     (1u << xcvr->num_lanes) - 1;
+	eyescan->data_width = init->data_width ? init->data_width :
+			      ADXCVR_ES_DATA_WIDTH;
+	eyescan->ber_exp = init->ber_exp;
+	eyescan->timeout = init->timeout ? init->timeout : ES_TIMEOUT;
+
+	ret = xilinx_xcvr_read_out_div(&xcvr->xlx_xcvr,
+				       ADXCVR_DRP_PORT_CHANNEL(find_first_set_bit(eyescan->lane_mask)),
+				       &eyescan->rx_out_div, NULL);
+	if (ret < 0)
+		goto error;
+
+	if (!init->hoffset_min && !init->hoffset_max) {
+		eyescan->hoffset_max = ADXCVR_ES_HOFFSET_UI / 2 *
+				       eyescan->rx_out_div;
+		eyescan->hoffset_min = -eyescan->hoffset_max;
+	} else {
+		eyescan->hoffset_min = init->hoffset_min;
+		eyescan->hoffset_max = init->hoffset_max;
+	}
+	if (!init->voffset_min && !init->voffset_max) {
+		eyescan->voffset_max = ADXCVR_ES_VOFFSET_MAX;
+		eyescan->voffset_min = -ADXCVR_ES_VOFFSET_MAX;
+	} else {
+		eyescan->voffset_min = init->voffset_min;
+		eyescan->voffset_max = init->voffset_max;
+	}
+	eyescan->hoffset_step = init->hoffset_step ? init->hoffset_step : 1;
+	eyescan->voffset_step = init->voffset_step ? init->voffset_step : 1;
+
+	if ((eyescan->hoffset_min > eyescan->hoffset_max) ||
+	    (eyescan->voffset_min > eyescan->voffset_max) ||
+	    (abs(eyescan->voffset_min) > ADXCVR_ES_VOFFSET_MAX) ||
+	    (abs(eyescan->voffset_max) > ADXCVR_ES_VOFFSET_MAX))
+		goto error;
+
+	eyescan->hsize = (eyescan->hoffset_max - eyescan->hoffset_min) /
+			 eyescan->hoffset_step + 1;
+	eyescan->vsize = (eyescan->voffset_max - eyescan->voffset_min) /
+			 eyescan->voffset_step + 1;
+	points = eyescan->hsize * eyescan->vsize;
+
+	eyescan->lanes = (struct adxcvr_eyescan_lane *)calloc(xcvr->num_lanes,
+			 sizeof(*eyescan->lanes));
+	if (!eyescan->lanes)
+		goto error;
+
+	for (lane = 0; lane < xcvr->num_lanes; lane++) {
+		if (!(eyescan->lane_mask & BIT(lane)))
+			continue;
+		eyescan->lanes[lane].errors = (uint32_t *)calloc(points,
+					      sizeof(uint32_t));
+		eyescan->lanes[lane].bits = (uint64_t *)calloc(points,
+					    sizeof(uint64_t));
+		if (!eyescan->lanes[lane].errors || !eyescan->lanes[lane].bits)
+			goto error;
+		eyescan->lanes[lane].prescale = init->prescale ?
+						min(init->prescale[lane],
+						    ADXCVR_ES_PRESCALE_MAX) : 0;
+	}
+
+	*es = eyescan;
+
+	return SUCCESS;
+
+error:
+	adxcvr_eyescan_remove(eyescan);
+
+	return FAILURE;
+}
+
+/**
+ * @brief adxcvr_eyescan_save
+ * Saves the eye scan settings of a lane, before the scan changes them.
+ */
+static int32_t adxcvr_eyescan_save(struct adxcvr *xcvr,
+				   const struct adxcvr_es_regs *regs,
+				   struct adxcvr_es_lane_regs *lregs,
+				   uint32_t lane)
+{
+	uint32_t port = ADXCVR_DRP_PORT_CHANNEL(lane);
+	uint32_t i;
+	int32_t ret;
+
+	for (i = 0; i < ES_MASK_REGS; i++) {
+		ret = adxcvr_drp_read(xcvr, port, regs->qualifier + i,
+				      &lregs->saved_qualifier[i]);
+		if (ret < 0)
+			return ret;
+		ret = adxcvr_drp_read(xcvr, port, regs->qual_mask + i,
+				      &lregs->saved_qual_mask[i]);
+		if (ret < 0)
+			return ret;
+		ret = adxcvr_drp_read(xcvr, port, regs->sdata_mask + i,
+				      &lregs->saved_sdata_mask[i]);
+		if (ret < 0)
+			return ret;
+	}
+
+	ret = adxcvr_drp_read(xcvr, port, regs->control, &lregs->saved_control);
+	if (ret < 0)
+		return ret;
+	ret = adxcvr_drp_read(xcvr, port, regs->hoffset, &lregs->saved_hoffset);
+	if (ret < 0)
+		return ret;
+	ret = adxcvr_drp_read(xcvr, port, regs->voffset, &lregs->saved_voffset);
+	if (ret < 0)
+		return ret;
+
+	lregs->saved = true;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief adxcvr_eyescan_restore
+ * Writes back the settings saved by adxcvr_eyescan_save() on every lane that
+ * was saved, the control register first so the scan is stopped.
+ */
+static int32_t adxcvr_eyescan_restore(struct adxcvr_eyescan *es,
+				      const struct adxcvr_es_regs *regs,
+				      const struct adxcvr_es_lane_regs *lregs)
+{
+	struct adxcvr *xcvr = es->xcvr;
+	const struct adxcvr_es_lane_regs *l;
+	uint32_t port, i;
+	uint32_t lane;
+	int32_t ret;
+
+	for (lane = 0; lane < xcvr->num_lanes; lane++) {
+		l = &lregs[lane];
+		if (!l->saved)
+			continue;
+		port = ADXCVR_DRP_PORT_CHANNEL(lane);
+
+		ret = adxcvr_drp_write(xcvr, port, regs->control,
+				       l->saved_control);
+		if (ret < 0)
+			return ret;
+
+		for (i = 0; i < ES_MASK_REGS; i++) {
+			ret = adxcvr_drp_write(xcvr, port, regs->qualifier + i,
+					       l->saved_qualifier[i]);
+			if (ret < 0)
+				return ret;
+			ret = adxcvr_drp_write(xcvr, port, regs->qual_mask + i,
+					       l->saved_qual_mask[i]);
+			if (ret < 0)
+				return ret;
+			ret = adxcvr_drp_write(xcvr, port, regs->sdata_mask + i,
+					       l->saved_sdata_mask[i]);
+			if (ret < 0)
+				return ret;
+		}
+
+		ret = adxcvr_drp_write(xcvr, port, regs->hoffset,
+				       l->saved_hoffset);
+		if (ret < 0)
+			return ret;
+		ret = adxcvr_drp_write(xcvr, port, regs->voffset,
+				       l->saved_voffset);
+		if (ret < 0)
+			return ret;
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief adxcvr_eyescan_setup
+ * Saves the eye scan settings of each lane, then unmasks the RX data bits
+ * used for the comparison, masks the qualifier and programs the prescale.
+ * Keeps the control and offset registers of each lane, the offset registers
+ * also hold other settings (the prescale on GTX2).
+ */
+static int32_t adxcvr_eyescan_setup(struct adxcvr_eyescan *es,
+				    const struct adxcvr_es_regs *regs,
+				    struct adxcvr_es_lane_regs *lregs)
+{
+	struct adxcvr *xcvr = es->xcvr;
+	uint32_t port, val, i, bit;
+	int32_t ret;
+	uint32_t lane;
+
+	for (lane = 0; lane < xcvr->num_lanes; lane++) {
+		if (!(es->lane_mask & BIT(lane)))
+			continue;
+		port = ADXCVR_DRP_PORT_CHANNEL(lane);
+
+		ret = adxcvr_eyescan_save(xcvr, regs, &lregs[lane], lane);
+		if (ret < 0)
+			return ret;
+
+		for (i = 0; i < ES_MASK_REGS; i++) {
+			ret = adxcvr_drp_write(xcvr, port, regs->qual_mask + i,
+					       0xFFFF);
+			if (ret < 0)
+				return ret;
+
+			/* Bits [data_width - 1:0] of the 80-bit mask compare */
+			bit = i * 16;
+			if (bit >= es->data_width)
+				val = 0xFFFF;
+			else if (bit + 16 <= es->data_width)
+				val = 0x0000;
+			else
+				val = 0xFFFF << (es->data_width - bit) & 0xFFFF;
+			ret = adxcvr_drp_write(xcvr, port, regs->sdata_mask + i,
+					       val);
+			if (ret < 0)
+				return ret;
+		}
+
+		ret = adxcvr_drp_read(xcvr, port, regs->prescale, &val);
+		if (ret < 0)
+			return ret;
+		val &= ~(ES_PRESCALE_MASK << regs->prescale_shift);
+		val |= es->lanes[lane].prescale << regs->prescale_shift;
+		ret = adxcvr_drp_write(xcvr, port, regs->prescale, val);
+		if (ret < 0)
+			return ret;
+
+		ret = adxcvr_drp_read(xcvr, port, regs->control, &val);
+		if (ret < 0)
+			return ret;
+		val &= ~ES_CONTROL_MASK;
+		val |= ES_ERRDET_EN | ES_EYE_SCAN_EN;
+		ret = adxcvr_drp_write(xcvr, port, regs->control, val);
+		if (ret < 0)
+			return ret;
+		lregs[lane].control = val;
+
+		adxcvr_drp_read(xcvr, port, regs->hoffset,
+				&lregs[lane].hoffset);
+		ret = adxcvr_drp_read(xcvr, port, regs->voffset,
+				      &lregs[lane].voffset);
+		if (ret < 0)
+			return ret;
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief adxcvr_eyescan_offsets
+ * Sets the offsets of the scanned lanes. Each lane is written on its own
+ * port with its own register base, so the other settings sharing the offset
+ * registers and the lanes outside lane_mask are left alone.
+ */
+static int32_t adxcvr_eyescan_offsets(struct adxcvr_eyescan *es,
+				      const struct adxcvr_es_regs *regs,
+				      const struct adxcvr_es_lane_regs *lregs,
+				      int32_t hoffset,
+				      int32_t voffset,
+				      uint32_t ut)
+{
+	struct adxcvr *xcvr = es->xcvr;
+	uint32_t port;
+	uint32_t lane;
+	int32_t ret;
+
+	for (lane = 0; lane < xcvr->num_lanes; lane++) {
+		if (!(es->lane_mask & BIT(lane)))
+			continue;
+		port = ADXCVR_DRP_PORT_CHANNEL(lane);
+
+		ret = adxcvr_drp_write(xcvr, port, regs->hoffset,
+				       adxcvr_es_hoffset(xcvr,
+						       lregs[lane].hoffset,
+						       hoffset));
+		if (ret < 0)
+			return ret;
+
+		ret = adxcvr_drp_write(xcvr, port, regs->voffset,
+				       adxcvr_es_voffset(xcvr,
+						       lregs[lane].voffset,
+						       voffset, ut));
+		if (ret < 0)
+			return ret;
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief adxcvr_eyescan_point
+ * Measures one point on all scanned lanes at once, the offsets must already
+ * be set. Lanes are started back to back and polled together, so the time
+ * per point is set by the slowest lane rather than by the sum of all lanes.
+ */
+static int32_t adxcvr_eyescan_point(struct adxcvr_eyescan *es,
+				    const struct adxcvr_es_regs *regs,
+				    const struct adxcvr_es_lane_regs *lregs,
+				    uint32_t point)
+{
+	struct adxcvr *xcvr = es->xcvr;
+	struct adxcvr_eyescan_lane *l;
+	uint32_t pending = es->lane_mask;
+	uint32_t errors, samples, status;
+	uint32_t timeout = es->timeout;
+	uint32_t port;
+	uint32_t lane;
+	int32_t ret;
+
+	for (lane = 0; lane < xcvr->num_lanes; lane++) {
+		if (!(pending & BIT(lane)))
+			continue;
+		ret = adxcvr_drp_write(xcvr, ADXCVR_DRP_PORT_CHANNEL(lane),
+				       regs->control,
+				       lregs[lane].control | ES_CONTROL_RUN);
+		if (ret < 0)
+			return ret;
+	}
+
+	while (pending) {
+		if (!timeout--) {
+			printf("%s: %s: Timeout!\n", xcvr->name, __func__);
+			return FAILURE;
+		}
+
+		for (lane = 0; lane < xcvr->num_lanes; lane++) {
+			if (!(pending & BIT(lane)))
+				continue;
+			port = ADXCVR_DRP_PORT_CHANNEL(lane);
+
+			ret = adxcvr_drp_read(xcvr, port, regs->status, &status);
+			if (ret < 0)
+				return ret;
+			if (!(status & ES_CONTROL_STATUS_DONE))
+				continue;
+
+			adxcvr_drp_read(xcvr, port, regs->error_count, &errors);
+			adxcvr_drp_read(xcvr, port, regs->sample_count, &samples);
+			ret = adxcvr_drp_write(xcvr, port, regs->control,
+					       lregs[lane].control);
+			if (ret < 0)
+				return ret;
+
+			l = &es->lanes[lane];
+			l->errors[point] += errors;
+			l->bits[point] += ((uint64_t)samples * es->data_width) <<
+					  (1 + l->prescale);
+			pending &= ~BIT(lane);
+		}
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief adxcvr_eyescan_is_open
+ */
+static bool adxcvr_eyescan_is_open(struct adxcvr_eyescan *es,
+				   struct adxcvr_eyescan_lane *l,
+				   uint32_t point)
+{
+	uint64_t limit = l->bits[point];
+	uint32_t i;
+
+	if (!limit)
+		return false;
+
+	for (i = 0; i < es->ber_exp && limit; i++)
+		limit /= 10;
+
+	return l->errors[point] <= limit;
+}
+
+/**
+ * @brief adxcvr_eyescan_measure
+ * Eye width and height are the longest open runs through the row and the
+ * column closest to the eye center.
+ */
+static void adxcvr_eyescan_measure(struct adxcvr_eyescan *es,
+				   struct adxcvr_eyescan_lane *l)
+{
+	uint32_t row, col, i;
+	uint32_t run, best;
+
+	row = clamp(-es->voffset_min, 0, es->voffset_max - es->voffset_min) /
+	      es->voffset_step;
+	col = clamp(-es->hoffset_min, 0, es->hoffset_max - es->hoffset_min) /
+	      es->hoffset_step;
+
+	for (i = 0, run = 0, best = 0; i < es->hsize; i++) {
+		run = adxcvr_eyescan_is_open(es, l, row * es->hsize + i) ?
+		      run + 1 : 0;
+		best = max(best, run);
+	}
+	l->eye_width_mui = best * es->hoffset_step * 1000 /
+			   (ADXCVR_ES_HOFFSET_UI * es->rx_out_div);
+
+	for (i = 0, run = 0, best = 0; i < es->vsize; i++) {
+		run = adxcvr_eyescan_is_open(es, l, i * es->hsize + col) ?
+		      run + 1 : 0;
+		best = max(best, run);
+	}
+	l->eye_height = best * es->voffset_step;
+}
+
+/**
+ * @brief adxcvr_eyescan_run
+ * Sweeps the horizontal and vertical offsets over all selected lanes.
+ * In DFE mode both UT signs are scanned and summed.
+ */
+int32_t adxcvr_eyescan_run(struct adxcvr_eyescan *es)
+{
+	const struct adxcvr_es_regs *regs = adxcvr_es_get_regs(es->xcvr);
+	struct adxcvr *xcvr = es->xcvr;
+	struct adxcvr_es_lane_regs *lregs;
+	uint32_t h, v, ut, lane, point;
+	int32_t hoffset, voffset;
+	int32_t ret;
+
+	lregs = (struct adxcvr_es_lane_regs *)calloc(xcvr->num_lanes,
+			sizeof(*lregs));
+	if (!lregs)
+		return FAILURE;
+
+	ret = adxcvr_eyescan_setup(es, regs, lregs);
+	if (ret < 0)
+		goto out;
+
+	for (lane = 0; lane < xcvr->num_lanes; lane++) {
+		if (!(es->lane_mask & BIT(lane)))
+			continue;
+		for (point = 0; point < es->hsize * es->vsize; point++) {
+			es->lanes[lane].errors[point] = 0;
+			es->lanes[lane].bits[point] = 0;
+		}
+	}
+
+	for (v = 0; v < es->vsize; v++) {
+		voffset = es->voffset_min + v * es->voffset_step;
+		for (h = 0; h < es->hsize; h++) {
+			hoffset = es->hoffset_min + h * es->hoffset_step;
+			for (ut = 0; ut < (xcvr->lpm_enable ? 1 : 2); ut++) {
+				ret = adxcvr_eyescan_offsets(es, regs, lregs,
+							     hoffset, voffset,
+							     ut);
+				if (ret < 0)
+					goto out;
+
+				ret = adxcvr_eyescan_point(es, regs, lregs,
+							   v * es->hsize + h);
+				if (ret < 0)
+					goto out;
+			}
+		}
+	}
+
+	for (lane = 0; lane < xcvr->num_lanes; lane++)
+		if (es->lane_mask & BIT(lane))
+			adxcvr_eyescan_measure(es, &es->lanes[lane]);
+
+out:
+	if (adxcvr_eyescan_restore(es, regs, lregs) < 0 && ret >= 0)
+		ret = FAILURE;
+	free(lregs);
+
+	return ret < 0 ? ret : SUCCESS;
+}
+
+/**
+ * @brief adxcvr_eyescan_remove
+ */
+int32_t adxcvr_eyescan_remove(struct adxcvr_eyescan *es)
+{
+	uint32_t lane;
+
+	if (es->lanes) {
+		for (lane = 0; lane < es->xcvr->num_lanes; lane++) {
+			free(es->lanes[lane].errors);
+			free(es->lanes[lane].bits);
+		}
+		free(es->lanes);
+	}
+	free(es);
+
+	return SUCCESS;
+}
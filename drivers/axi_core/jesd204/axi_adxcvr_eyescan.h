@@ -0,0 +1,119 @@
+/***************************************************************************//**
+ *   @file   axi_adxcvr_eyescan.h
+ *   @brief  Statistical eye scan for the ADI AXI-ADXCVR Module.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+#ifndef AXI_ADXCVR_EYESCAN_H_
+#define AXI_ADXCVR_EYESCAN_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdint.h>
+#include "axi_adxcvr.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define ADXCVR_ES_PRESCALE_MAX		31
+#define ADXCVR_ES_VOFFSET_MAX		127
+/* Horizontal offset range is +/- ADXCVR_ES_HOFFSET_UI / 2 * rx_out_div */
+#define ADXCVR_ES_HOFFSET_UI		64
+#define ADXCVR_ES_DATA_WIDTH		40
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+struct adxcvr_eyescan_lane {
+	/* Errors for each point, row major with voffset rows */
+	uint32_t *errors;
+	/* Bits compared for each point */
+	uint64_t *bits;
+	uint8_t prescale;
+	/* Widest open run on the row closest to voffset 0, in UI / 1000 */
+	uint32_t eye_width_mui;
+	/* Highest open run on the column closest to hoffset 0, in codes */
+	uint32_t eye_height;
+};
+
+struct adxcvr_eyescan {
+	struct adxcvr *xcvr;
+	uint32_t lane_mask;
+	int32_t hoffset_min;
+	int32_t hoffset_max;
+	uint32_t hoffset_step;
+	int32_t voffset_min;
+	int32_t voffset_max;
+	uint32_t voffset_step;
+	uint32_t hsize;
+	uint32_t vsize;
+	uint32_t data_width;
+	uint32_t ber_exp;
+	uint32_t rx_out_div;
+	uint32_t timeout;
+	struct adxcvr_eyescan_lane *lanes;
+};
+
+struct adxcvr_eyescan_init {
+	/* Lanes to scan, 0 for all lanes */
+	uint32_t lane_mask;
+	/* Horizontal sweep, min == max == 0 for the full UI */
+	int32_t hoffset_min;
+	int32_t hoffset_max;
+	uint32_t hoffset_step;
+	/* Vertical sweep, min == max == 0 for the full range */
+	int32_t voffset_min;
+	int32_t voffset_max;
+	uint32_t voffset_step;
+	/* Prescale for each lane, the dwell time doubles with each step */
+	uint8_t *prescale;
+	/* Width of the RX data path, 0 for ADXCVR_ES_DATA_WIDTH */
+	uint32_t data_width;
+	/* Points with a BER below 10^-ber_exp count as open */
+	uint32_t ber_exp;
+	/* Status polls per point before giving up, 0 for the default */
+	uint32_t timeout;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+int32_t adxcvr_eyescan_init(struct adxcvr_eyescan **es,
+			    struct adxcvr *xcvr,
+			    const struct adxcvr_eyescan_init *init);
+int32_t adxcvr_eyescan_run(struct adxcvr_eyescan *es);
+int32_t adxcvr_eyescan_remove(struct adxcvr_eyescan *es);
+#endif
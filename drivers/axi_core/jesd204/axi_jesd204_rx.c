@@ -149,43 +149,202 @@ int32_t axi_jesd204_rx_lane_clk_disable(struct axi_jesd204_rx *jesd)
 }
 
 /**
- * @brief axi_jesd204_rx_status_read
+ * @brief axi_jesd204_rx_link_status_get
+ * Fill the link level status with one read of the link registers.
  */
-uint32_t axi_jesd204_rx_status_read(struct axi_jesd204_rx *jesd)
+int32_t axi_jesd204_rx_link_status_get(struct axi_jesd204_rx *jesd,
+				       struct jesd204_rx_link_status *status)
 {
 	uint32_t link_disabled;
 	uint32_t link_status;
 	uint32_t sysref_status;
 	uint32_t clock_ratio;
-	uint32_t clock_rate;
-	uint32_t link_rate;
 	uint32_t sysref_config;
 
+	if (!jesd || !status)
+		return FAILURE;
+
 	axi_jesd204_rx_read(jesd, JESD204_RX_REG_LINK_STATE, &link_disabled);
 	axi_jesd204_rx_read(jesd, JESD204_RX_REG_LINK_STATUS, &link_status);
 	axi_jesd204_rx_read(jesd, JESD204_RX_REG_SYSREF_STATUS, &sysref_status);
 	axi_jesd204_rx_read(jesd, JESD204_RX_REG_LINK_CLK_RATIO, &clock_ratio);
 	axi_jesd204_rx_read(jesd, JESD204_RX_REG_SYSREF_CONF, &sysref_config);
 
+	status->link_disabled = link_disabled & 0x1;
+	status->external_reset = link_disabled & 0x2;
+	status->link_state = link_status & 0x3;
+	status->measured_clk_khz = clock_ratio ?
+				   DIV_ROUND_CLOSEST_ULL(100000ULL * clock_ratio,
+						   1ULL << 16) : 0;
+	status->reported_clk_khz = jesd->device_clk_khz;
+	status->lane_rate_khz = jesd->lane_clk_khz;
+	status->sysref_disabled = sysref_config &
+				  JESD204_RX_REG_SYSREF_CONF_SYSREF_DISABLE;
+	status->sysref_captured = sysref_status & 1;
+	status->sysref_alignment_error = sysref_status & 2;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief axi_jesd204_rx_decode_ilas
+ */
+static void axi_jesd204_rx_decode_ilas(const uint32_t *val,
+				       struct jesd204_rx_ilas *ilas)
+{
+	ilas->did = (val[0] >> 16) & 0xff;
+	ilas->bid = (val[0] >> 24) & 0xf;
+	ilas->adjcnt = (val[0] >> 28) & 0xf;
+	ilas->lid = (val[1] >> 0) & 0x1f;
+	ilas->phadj = (val[1] >> 5) & 0x1;
+	ilas->adjdir = (val[1] >> 6) & 0x1;
+	ilas->l = ((val[1] >> 8) & 0x1f) + 1;
+	ilas->scr = (val[1] >> 15) & 0x1;
+	ilas->f = ((val[1] >> 16) & 0xff) + 1;
+	ilas->k = ((val[1] >> 24) & 0x1f) + 1;
+	ilas->m = ((val[2] >> 0) & 0xff) + 1;
+	ilas->n = ((val[2] >> 8) & 0x1f) + 1;
+	ilas->cs = (val[2] >> 14) & 0x3;
+	ilas->np = ((val[2] >> 16) & 0x1f) + 1;
+	ilas->subclass = (val[2] >> 21) & 0x7;
+	ilas->s = ((val[2] >> 24) & 0x1f) + 1;
+	ilas->jesdv = (val[2] >> 29) & 0x7;
+	ilas->cf = (val[3] >> 0) & 0x1f;
+	ilas->hd = (val[3] >> 7) & 0x1;
+	ilas->fchk = (val[3] >> 24) & 0xff;
+}
+
+/**
+ * @brief axi_jesd204_rx_lane_status_fill
+ * Only the registers that hold valid data for the current lane state are
+ * read.
+ */
+static void axi_jesd204_rx_lane_status_fill(struct axi_jesd204_rx *jesd,
+		uint32_t lane,
+		uint32_t octets_per_multiframe,
+		struct jesd204_rx_lane_status *status)
+{
+	uint32_t lane_status;
+	uint32_t lane_latency;
+	uint32_t val[4];
+	uint32_t i;
+
+	axi_jesd204_rx_read(jesd, JESD204_RX_REG_LANE_STATUS(lane), &lane_status);
+
+	status->cgs_state = lane_status & 0x3;
+	status->ifs_ready = lane_status & BIT(4);
+	status->ilas_ready = status->ifs_ready && (lane_status & BIT(5));
+	status->errors_valid = PCORE_VERSION_MINOR(jesd->version) >= 2;
+	status->errors = 0;
+	if (status->errors_valid)
+		axi_jesd204_rx_read(jesd, JESD204_RX_REG_LANE_ERRORS(lane),
+				    &status->errors);
+
+	status->latency_multiframes = 0;
+	status->latency_octets = 0;
+	if (status->ifs_ready) {
+		axi_jesd204_rx_read(jesd, JESD204_RX_REG_LANE_LATENCY(lane),
+				    &lane_latency);
+		status->latency_multiframes = lane_latency / octets_per_multiframe;
+		status->latency_octets = lane_latency % octets_per_multiframe;
+	}
+
+	if (!status->ilas_ready)
+		return;
+
+	for (i = 0; i < ARRAY_SIZE(val); i++)
+		axi_jesd204_rx_read(jesd, JESD204_RX_REG_ILAS(lane, i), &val[i]);
+	axi_jesd204_rx_decode_ilas(val, &status->ilas);
+}
+
+/**
+ * @brief axi_jesd204_rx_get_octets_per_multiframe
+ */
+static uint32_t axi_jesd204_rx_get_octets_per_multiframe(
+	struct axi_jesd204_rx *jesd)
+{
+	uint32_t octets_per_multiframe;
+
+	axi_jesd204_rx_read(jesd, JESD204_RX_REG_LINK_CONF0, &octets_per_multiframe);
+
+	return (octets_per_multiframe & 0xffff) + 1;
+}
+
+/**
+ * @brief axi_jesd204_rx_lane_status_get
+ */
+int32_t axi_jesd204_rx_lane_status_get(struct axi_jesd204_rx *jesd,
+				       uint32_t lane,
+				       struct jesd204_rx_lane_status *status)
+{
+	if (!jesd || !status || lane >= jesd->num_lanes)
+		return FAILURE;
+
+	axi_jesd204_rx_lane_status_fill(jesd, lane,
+					axi_jesd204_rx_get_octets_per_multiframe(jesd),
+					status);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief axi_jesd204_rx_status_get
+ * Fill the link and lane status of all the lanes in a single pass over the
+ * core registers.
+ */
+int32_t axi_jesd204_rx_status_get(struct axi_jesd204_rx *jesd,
+				  struct jesd204_rx_status *status)
+{
+	uint32_t octets_per_multiframe;
+	uint32_t i;
+	int32_t ret;
+
+	ret = axi_jesd204_rx_link_status_get(jesd, &status->link);
+	if (ret != SUCCESS)
+		return ret;
+
+	status->num_lanes = min_t(uint32_t, jesd->num_lanes,
+				  JESD204_RX_MAX_LANES);
+	octets_per_multiframe = axi_jesd204_rx_get_octets_per_multiframe(jesd);
+	for (i = 0; i < status->num_lanes; i++)
+		axi_jesd204_rx_lane_status_fill(jesd, i, octets_per_multiframe,
+						&status->lanes[i]);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief axi_jesd204_rx_status_read
+ */
+uint32_t axi_jesd204_rx_status_read(struct axi_jesd204_rx *jesd)
+{
+	struct jesd204_rx_link_status status;
+	uint32_t clock_rate;
+	uint32_t link_rate;
+	int32_t ret;
+
+	ret = axi_jesd204_rx_link_status_get(jesd, &status);
+	if (ret != SUCCESS)
+		return ret;
+
 	printf("%s status:\n", jesd->name);
 
-	printf("\tLink is %s\n", (link_disabled & 0x1) ? "disabled" : "enabled");
+	printf("\tLink is %s\n", status.link_disabled ? "disabled" : "enabled");
 
-	if (clock_ratio == 0) {
+	if (status.measured_clk_khz == 0) {
 		printf("\tMeasured Link Clock: off\n");
 	} else {
-		clock_rate = DIV_ROUND_CLOSEST_ULL(100000ULL * clock_ratio,
-						   1ULL << 16);
+		clock_rate = status.measured_clk_khz;
 		printf("\tMeasured Link Clock: %"PRIu32".%.3"PRIu32" MHz\n",\
 		       clock_rate / 1000, clock_rate % 1000);
 	}
 
-	clock_rate = jesd->device_clk_khz;
+	clock_rate = status.reported_clk_khz;
 	printf("\tReported Link Clock: %"PRIu32".%.3"PRIu32" MHz\n",
 	       clock_rate / 1000, clock_rate % 1000);
 
-	if (!link_disabled) {
-		clock_rate = jesd->lane_clk_khz;
+	if (!status.link_disabled) {
+		clock_rate = status.lane_rate_khz;
 		link_rate = DIV_ROUND_CLOSEST(clock_rate, 40);
 		printf("\tLane rate: %"PRIu32".%.3"PRIu32" MHz\n"
 		       "\tLane rate / 40: %"PRIu32".%.3"PRIu32" MHz\n",
@@ -195,14 +354,14 @@ uint32_t axi_jesd204_rx_status_read(struct axi_jesd204_rx *jesd)
 		printf("\tLink status: %s\n"
 		       "\tSYSREF captured: %s\n"
 		       "\tSYSREF alignment error: %s\n",
-		       axi_jesd204_rx_link_status_label[link_status & 0x3],
-		       (sysref_config & JESD204_RX_REG_SYSREF_CONF_SYSREF_DISABLE) ?
-		       "disabled" : (sysref_status & 1) ? "Yes" : "No",
-		       (sysref_config & JESD204_RX_REG_SYSREF_CONF_SYSREF_DISABLE) ?
-		       "disabled" : (sysref_status & 2) ? "Yes" : "No");
+		       axi_jesd204_rx_link_status_label[status.link_state],
+		       status.sysref_disabled ?
+		       "disabled" : status.sysref_captured ? "Yes" : "No",
+		       status.sysref_disabled ?
+		       "disabled" : status.sysref_alignment_error ? "Yes" : "No");
 	} else {
 		printf("\tExternal reset is %s\n",
-		       (link_disabled & 0x2) ? "asserted" : "deasserted");
+		       status.external_reset ? "asserted" : "deasserted");
 	}
 
 	return SUCCESS;
@@ -222,89 +381,265 @@ int32_t axi_jesd204_rx_get_lane_errors(struct axi_jesd204_rx *jesd,
  */
 int32_t axi_jesd204_rx_laneinfo_read(struct axi_jesd204_rx *jesd, uint32_t lane)
 {
-	uint32_t lane_status;
-	uint32_t errors;
-	uint32_t octets_per_multiframe;
-	uint32_t lane_latency;
-	uint32_t val[4];
+	struct jesd204_rx_lane_status status;
+	struct jesd204_rx_ilas *ilas = &status.ilas;
+	int32_t ret;
 
-	axi_jesd204_rx_read(jesd, JESD204_RX_REG_LANE_STATUS(lane), &lane_status);
+	ret = axi_jesd204_rx_lane_status_get(jesd, lane, &status);
+	if (ret != SUCCESS)
+		return ret;
 
 	printf("%s lane %"PRIu32" status:\n", jesd->name, lane);
 
-	if (PCORE_VERSION_MINOR(jesd->version) >= 2) {
-		axi_jesd204_rx_get_lane_errors(jesd, lane, &errors);
-		printf("Errors: %"PRIu32"\n", errors);
-	}
+	if (status.errors_valid)
+		printf("Errors: %"PRIu32"\n", status.errors);
 
 	printf("\tCGS state: %s\n",
-	       axi_jesd204_rx_lane_status_label[lane_status & 0x3]);
+	       axi_jesd204_rx_lane_status_label[status.cgs_state]);
 
 	printf("\tInitial Frame Synchronization: %s\n",
-	       (lane_status & BIT(4)) ? "Yes" : "No");
-	if (!(lane_status & BIT(4)))
+	       status.ifs_ready ? "Yes" : "No");
+	if (!status.ifs_ready)
 		return FAILURE;
 
-	axi_jesd204_rx_read(jesd, JESD204_RX_REG_LINK_CONF0, &octets_per_multiframe);
-	octets_per_multiframe &= 0xffff;
-	octets_per_multiframe += 1;
-
-	axi_jesd204_rx_read(jesd, JESD204_RX_REG_LANE_LATENCY(lane), &lane_latency);
 	printf("\tLane Latency: %"PRIu32" Multi-frames and %"PRIu32" Octets\n",
-	       lane_latency / octets_per_multiframe,
-	       lane_latency % octets_per_multiframe);
+	       status.latency_multiframes, status.latency_octets);
 
 	printf("\tInitial Lane Alignment Sequence: %s\n",
-	       (lane_status & BIT(5)) ? "Yes" : "No");
+	       status.ilas_ready ? "Yes" : "No");
 
-	if (!(lane_status & BIT(5)))
+	if (!status.ilas_ready)
 		return FAILURE;
 
-	axi_jesd204_rx_read(jesd, JESD204_RX_REG_ILAS(lane, 0), &val[0]);
-	axi_jesd204_rx_read(jesd, JESD204_RX_REG_ILAS(lane, 1), &val[1]);
-	axi_jesd204_rx_read(jesd, JESD204_RX_REG_ILAS(lane, 2), &val[2]);
-	axi_jesd204_rx_read(jesd, JESD204_RX_REG_ILAS(lane, 3), &val[3]);
-
-	printf("\tDID: %"PRIu32", BID: %"PRIu32", LID: %"PRIu32", "
-	       "L: %"PRIu32", SCR: %"PRIu32", F: %"PRIu32"\n",
-	       (val[0] >> 16) & 0xff,
-	       (val[0] >> 24) & 0xf,
-	       (val[1] >> 0) & 0x1f,
-	       ((val[1] >> 8) & 0x1f) + 1,
-	       (val[1] >> 15) & 0x1,
-	       ((val[1] >> 16) & 0xff) + 1
-	      );
-
-	printf("\tK: %"PRIu32", M: %"PRIu32", N: %"PRIu32", CS: %"PRIu32", "
-	       "N': %"PRIu32", S: %"PRIu32", HD: %"PRIu32"\n",
-	       ((val[1] >> 24) & 0x1f) + 1,
-	       ((val[2] >> 0) & 0xff) + 1,
-	       ((val[2] >> 8) & 0x1f) + 1,
-	       (val[2] >> 14) & 0x3,
-	       ((val[2] >> 16) & 0x1f) + 1,
-	       ((val[2] >> 24) & 0x1f) + 1,
-	       (val[3] >> 7) & 0x1
-	      );
-
-	printf("\tFCHK: 0x%"PRIX32", CF: %"PRIu32"\n",
-	       (val[3] >> 24) & 0xff,
-	       (val[3] >> 0) & 0x1f
-	      );
-
-	printf("\tADJCNT: %"PRIu32", PHADJ: %"PRIu32", ADJDIR: %"PRIu32", "
-	       "JESDV: %"PRIu32", SUBCLASS: %"PRIu32"\n",
-	       (val[0] >> 28) & 0xff,
-	       (val[1] >> 5) & 0x1,
-	       (val[1] >> 6) & 0x1,
-	       (val[2] >> 29) & 0x7,
-	       (val[2] >> 21) & 0x7
-	      );
+	printf("\tDID: %d, BID: %d, LID: %d, L: %d, SCR: %d, F: %d\n",
+	       ilas->did, ilas->bid, ilas->lid, ilas->l, ilas->scr, ilas->f);
+
+	printf("\tK: %d, M: %d, N: %d, CS: %d, N': %d, S: %d, HD: %d\n",
+	       ilas->k, ilas->m, ilas->n, ilas->cs, ilas->np, ilas->s, ilas->hd);
+
+	printf("\tFCHK: 0x%X, CF: %d\n", ilas->fchk, ilas->cf);
+
+	printf("\tADJCNT: %d, PHADJ: %d, ADJDIR: %d, JESDV: %d, SUBCLASS: %d\n",
+	       ilas->adjcnt, ilas->phadj, ilas->adjdir, ilas->jesdv,
+	       ilas->subclass);
 
 	printf("\tFC: %"PRIu32" kHz\n", jesd->lane_clk_khz);
 
 	return SUCCESS;
 }
 
+/**
+ * @brief axi_jesd204_rx_monitor_push
+ * Append an event to the monitor ring, overwriting the oldest one when the
+ * ring is full.
+ */
+static void axi_jesd204_rx_monitor_push(struct axi_jesd204_rx_monitor *monitor,
+					const struct jesd204_rx_event *event)
+{
+	uint32_t idx;
+
+	idx = (monitor->head + monitor->count) % monitor->nb_events;
+	monitor->events[idx] = *event;
+	if (monitor->count < monitor->nb_events) {
+		monitor->count++;
+	} else {
+		monitor->head = (monitor->head + 1) % monitor->nb_events;
+		monitor->dropped++;
+	}
+}
+
+/**
+ * @brief axi_jesd204_rx_monitor_poll
+ * Sample the link once and record link state changes, lane CGS state
+ * changes and error counter increments. Meant to be called periodically,
+ * for example from a timer callback.
+ */
+int32_t axi_jesd204_rx_monitor_poll(struct axi_jesd204_rx_monitor *monitor)
+{
+	struct jesd204_rx_lane_status lane_status;
+	struct jesd204_rx_link_status link_status;
+	struct jesd204_rx_event event;
+	uint32_t octets_per_multiframe;
+	uint32_t num_lanes;
+	uint32_t delta;
+	uint32_t i;
+	int32_t ret;
+
+	if (!monitor)
+		return FAILURE;
+
+	ret = axi_jesd204_rx_link_status_get(monitor->jesd, &link_status);
+	if (ret != SUCCESS)
+		return ret;
+
+	monitor->seq++;
+	event.seq = monitor->seq;
+	event.link_state = link_status.link_state;
+
+	if (link_status.link_state != monitor->link_state) {
+		event.lane = JESD204_RX_EVENT_LINK;
+		event.cgs_state = JESD204_RX_CGS_UNKNOWN;
+		event.errors_delta = 0;
+		axi_jesd204_rx_monitor_push(monitor, &event);
+		monitor->link_state = link_status.link_state;
+	}
+
+	if (link_status.link_disabled)
+		return SUCCESS;
+
+	num_lanes = min_t(uint32_t, monitor->jesd->num_lanes,
+			  JESD204_RX_MAX_LANES);
+	octets_per_multiframe =
+		axi_jesd204_rx_get_octets_per_multiframe(monitor->jesd);
+	for (i = 0; i < num_lanes; i++) {
+		axi_jesd204_rx_lane_status_fill(monitor->jesd, i,
+						octets_per_multiframe,
+						&lane_status);
+
+		/* The counter restarts from 0 when the link is reset */
+		if (lane_status.errors >= monitor->last_errors[i])
+			delta = lane_status.errors - monitor->last_errors[i];
+		else
+			delta = lane_status.errors;
+		monitor->last_errors[i] = lane_status.errors;
+		monitor->total_errors[i] += delta;
+
+		if (!delta && lane_status.cgs_state == monitor->last_cgs[i])
+			continue;
+
+		event.lane = i;
+		event.cgs_state = lane_status.cgs_state;
+		event.errors_delta = delta;
+		axi_jesd204_rx_monitor_push(monitor, &event);
+		monitor->last_cgs[i] = lane_status.cgs_state;
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief axi_jesd204_rx_monitor_peek
+ * Copy up to max_events recorded events, starting with the one at position
+ * first from the oldest, without removing them.
+ */
+int32_t axi_jesd204_rx_monitor_peek(struct axi_jesd204_rx_monitor *monitor,
+				    uint32_t first,
+				    struct jesd204_rx_event *events,
+				    uint32_t max_events, uint32_t *nb_events)
+{
+	uint32_t i;
+
+	if (!monitor || !events || !nb_events)
+		return FAILURE;
+
+	for (i = 0; i < max_events && first + i < monitor->count; i++)
+		events[i] = monitor->events[(monitor->head + first + i) %
+							      monitor->nb_events];
+	*nb_events = i;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief axi_jesd204_rx_monitor_clear
+ * Remove up to nb_events of the oldest recorded events.
+ */
+int32_t axi_jesd204_rx_monitor_clear(struct axi_jesd204_rx_monitor *monitor,
+				     uint32_t nb_events)
+{
+	if (!monitor)
+		return FAILURE;
+
+	if (nb_events > monitor->count)
+		nb_events = monitor->count;
+	monitor->head = (monitor->head + nb_events) % monitor->nb_events;
+	monitor->count -= nb_events;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief axi_jesd204_rx_monitor_read
+ * Drain up to max_events of the oldest recorded events.
+ */
+int32_t axi_jesd204_rx_monitor_read(struct axi_jesd204_rx_monitor *monitor,
+				    struct jesd204_rx_event *events,
+				    uint32_t max_events, uint32_t *nb_events)
+{
+	int32_t ret;
+
+	ret = axi_jesd204_rx_monitor_peek(monitor, 0, events, max_events,
+					  nb_events);
+	if (ret != SUCCESS)
+		return ret;
+
+	return axi_jesd204_rx_monitor_clear(monitor, *nb_events);
+}
+
+/**
+ * @brief axi_jesd204_rx_monitor_init
+ * The current error counters are taken as reference, only errors that
+ * occur after this call are recorded.
+ */
+int32_t axi_jesd204_rx_monitor_init(struct axi_jesd204_rx_monitor **monitor,
+				    struct axi_jesd204_rx *jesd,
+				    uint32_t nb_events)
+{
+	struct axi_jesd204_rx_monitor *mon;
+	struct jesd204_rx_status *status;
+	uint32_t i;
+
+	if (!monitor || !jesd || !nb_events)
+		return FAILURE;
+
+	mon = (struct axi_jesd204_rx_monitor *)calloc(1, sizeof(*mon));
+	if (!mon)
+		return FAILURE;
+
+	mon->events = (struct jesd204_rx_event *)calloc(nb_events,
+			sizeof(*mon->events));
+	status = (struct jesd204_rx_status *)calloc(1, sizeof(*status));
+	if (!mon->events || !status)
+		goto error;
+
+	if (axi_jesd204_rx_status_get(jesd, status) != SUCCESS)
+		goto error;
+
+	mon->jesd = jesd;
+	mon->nb_events = nb_events;
+	mon->link_state = status->link.link_state;
+	for (i = 0; i < status->num_lanes; i++) {
+		mon->last_errors[i] = status->lanes[i].errors;
+		mon->last_cgs[i] = status->lanes[i].cgs_state;
+	}
+
+	free(status);
+	*monitor = mon;
+
+	return SUCCESS;
+
+error:
+	free(status);
+	free(mon->events);
+	free(mon);
+
+	return FAILURE;
+}
+
+/**
+ * @brief axi_jesd204_rx_monitor_remove
+ */
+int32_t axi_jesd204_rx_monitor_remove(struct axi_jesd204_rx_monitor *monitor)
+{
+	if (!monitor)
+		return FAILURE;
+
+	free(monitor->events);
+	free(monitor);
+
+	return SUCCESS;
+}
+
 /**
  * @brief axi_jesd204_rx_check_lane_status
  */
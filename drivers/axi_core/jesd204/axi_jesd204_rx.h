@@ -45,9 +45,102 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define JESD204_RX_MAX_LANES		16
+/* Lane index used by monitor events that are not related to a lane. */
+#define JESD204_RX_EVENT_LINK		0xff
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
+enum jesd204_rx_link_state {
+	JESD204_RX_LINK_RESET,
+	JESD204_RX_LINK_WAIT_PHY,
+	JESD204_RX_LINK_CGS,
+	JESD204_RX_LINK_DATA,
+};
+
+enum jesd204_rx_cgs_state {
+	JESD204_RX_CGS_INIT,
+	JESD204_RX_CGS_CHECK,
+	JESD204_RX_CGS_DATA,
+	JESD204_RX_CGS_UNKNOWN,
+};
+
+/* Decoded ILAS configuration, the "minus one" fields are already adjusted. */
+struct jesd204_rx_ilas {
+	uint8_t did;
+	uint8_t bid;
+	uint8_t lid;
+	uint8_t l;
+	uint8_t scr;
+	uint16_t f;
+	uint8_t k;
+	uint16_t m;
+	uint8_t n;
+	uint8_t cs;
+	uint8_t np;
+	uint8_t s;
+	uint8_t hd;
+	uint8_t fchk;
+	uint8_t cf;
+	uint8_t adjcnt;
+	uint8_t phadj;
+	uint8_t adjdir;
+	uint8_t jesdv;
+	uint8_t subclass;
+};
+
+struct jesd204_rx_lane_status {
+	enum jesd204_rx_cgs_state cgs_state;
+	/* Initial frame synchronization done */
+	bool ifs_ready;
+	/* Initial lane alignment sequence received, ilas is valid */
+	bool ilas_ready;
+	/* The core provides an error counter (core version >= 1.2) */
+	bool errors_valid;
+	uint32_t errors;
+	/* Lane latency, valid when ifs_ready is set */
+	uint32_t latency_multiframes;
+	uint32_t latency_octets;
+	struct jesd204_rx_ilas ilas;
+};
+
+struct jesd204_rx_link_status {
+	bool link_disabled;
+	/* Valid when the link is disabled */
+	bool external_reset;
+	enum jesd204_rx_link_state link_state;
+	/* 0 when the link clock is off */
+	uint32_t measured_clk_khz;
+	uint32_t reported_clk_khz;
+	uint32_t lane_rate_khz;
+	bool sysref_disabled;
+	bool sysref_captured;
+	bool sysref_alignment_error;
+};
+
+struct jesd204_rx_status {
+	struct jesd204_rx_link_status link;
+	uint32_t num_lanes;
+	struct jesd204_rx_lane_status lanes[JESD204_RX_MAX_LANES];
+};
+
+struct jesd204_rx_event {
+	/* Monitor poll sequence number */
+	uint32_t seq;
+	/* Lane number or JESD204_RX_EVENT_LINK */
+	uint8_t lane;
+	/* enum jesd204_rx_link_state */
+	uint8_t link_state;
+	/* enum jesd204_rx_cgs_state, for lane events */
+	uint8_t cgs_state;
+	/* New errors since the previous poll, for lane events */
+	uint32_t errors_delta;
+};
+
 struct jesd204_rx_config {
 	uint8_t octets_per_frame;
 	uint8_t frames_per_multiframe;
@@ -65,6 +158,22 @@ struct axi_jesd204_rx {
 	uint32_t lane_clk_khz;
 };
 
+struct axi_jesd204_rx_monitor {
+	struct axi_jesd204_rx *jesd;
+	uint32_t seq;
+	enum jesd204_rx_link_state link_state;
+	uint32_t last_errors[JESD204_RX_MAX_LANES];
+	enum jesd204_rx_cgs_state last_cgs[JESD204_RX_MAX_LANES];
+	/* Accumulated errors since the monitor was started */
+	uint64_t total_errors[JESD204_RX_MAX_LANES];
+	/* Event ring, the oldest events are overwritten when full */
+	struct jesd204_rx_event *events;
+	uint32_t nb_events;
+	uint32_t head;
+	uint32_t count;
+	uint32_t dropped;
+};
+
 struct jesd204_rx_init {
 	const char *name;
 	uint32_t base;
@@ -83,6 +192,27 @@ int32_t axi_jesd204_rx_lane_clk_disable(struct axi_jesd204_rx *jesd);
 uint32_t axi_jesd204_rx_status_read(struct axi_jesd204_rx *jesd);
 int32_t axi_jesd204_rx_laneinfo_read(struct axi_jesd204_rx *jesd,
 				     uint32_t lane);
+int32_t axi_jesd204_rx_link_status_get(struct axi_jesd204_rx *jesd,
+				       struct jesd204_rx_link_status *status);
+int32_t axi_jesd204_rx_lane_status_get(struct axi_jesd204_rx *jesd,
+				       uint32_t lane,
+				       struct jesd204_rx_lane_status *status);
+int32_t axi_jesd204_rx_status_get(struct axi_jesd204_rx *jesd,
+				  struct jesd204_rx_status *status);
+int32_t axi_jesd204_rx_monitor_init(struct axi_jesd204_rx_monitor **monitor,
+				    struct axi_jesd204_rx *jesd,
+				    uint32_t nb_events);
+int32_t axi_jesd204_rx_monitor_poll(struct axi_jesd204_rx_monitor *monitor);
+int32_t axi_jesd204_rx_monitor_read(struct axi_jesd204_rx_monitor *monitor,
+				    struct jesd204_rx_event *events,
+				    uint32_t max_events, uint32_t *nb_events);
+int32_t axi_jesd204_rx_monitor_peek(struct axi_jesd204_rx_monitor *monitor,
+				    uint32_t first,
+				    struct jesd204_rx_event *events,
+				    uint32_t max_events, uint32_t *nb_events);
+int32_t axi_jesd204_rx_monitor_clear(struct axi_jesd204_rx_monitor *monitor,
+				     uint32_t nb_events);
+int32_t axi_jesd204_rx_monitor_remove(struct axi_jesd204_rx_monitor *monitor);
 int32_t axi_jesd204_rx_watchdog(struct axi_jesd204_rx *jesd);
 int32_t axi_jesd204_rx_init(struct axi_jesd204_rx **jesd204,
 			    const struct jesd204_rx_init *init);
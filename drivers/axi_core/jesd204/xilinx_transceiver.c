@@ -1144,9 +1144,9 @@ int32_t xilinx_xcvr_gtx2_read_out_div(struct xilinx_xcvr *xcvr,
 		return ret;
 
 	if (rx_out_div)
-		*rx_out_div = 1 << ((ret >> OUT_DIV_RX_OFFSET) & 7);
+		*rx_out_div = 1 << ((val >> OUT_DIV_RX_OFFSET) & 7);
 	if (tx_out_div)
-		*tx_out_div = 1 << ((ret >> OUT_DIV_TX_OFFSET) & 7);
+		*tx_out_div = 1 << ((val >> OUT_DIV_TX_OFFSET) & 7);
 
 	return SUCCESS;
 }
@@ -43,6 +43,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include "ad9144.h"
+#include "spi_seq.h"
 
 struct ad9144_jesd204_link_mode {
 	uint8_t id;
@@ -136,58 +137,96 @@ int32_t ad9144_spi_check_status(struct ad9144_dev *dev,
 	return -1;
 }
 
-struct ad9144_reg_seq {
-	uint16_t reg;
-	uint16_t val;
-};
-
-int32_t ad9144_spi_write_seq(struct ad9144_dev *dev,
-			     const struct ad9144_reg_seq *seq, uint32_t num)
+/***************************************************************************//**
+ * @brief ad9144_spi_write_seq
+ *
+ * The device is set up for ascending address streaming, so consecutive
+ * registers in the sequence are written in a single SPI transaction.
+ *******************************************************************************/
+static int32_t ad9144_spi_write_seq(struct ad9144_dev *dev,
+				    const struct spi_seq_entry *seq,
+				    uint32_t num)
 {
-	int32_t ret = 0;
-
-	while (num) {
-		ret |= ad9144_spi_write(dev, seq->reg, seq->val);
-		num--;
-		seq++;
-	}
-
-	return 0;
+	const struct spi_seq_config cfg = {
+		.spi = dev->spi_desc,
+		.read_flag = 0x8000,
+		.addr_mask = 0x7FFF,
+		.addr_ascending = true,
+		.max_stream = SPI_SEQ_MAX_STREAM,
+	};
+
+	return spi_seq_run(&cfg, seq, num);
 }
 
 /*
  * Required device configuration as per table 16 from the AD9144
  * datasheet Rev B.
  */
-static const struct ad9144_reg_seq ad9144_required_device_config[] = {
-	{ 0x12d, 0x8b },
-	{ 0x146, 0x01 },
-	{ 0x2a4, 0xff },
-	{ 0x232, 0xff },
-	{ 0x333, 0x01 },
+static const struct spi_seq_entry ad9144_required_device_config[] = {
+	SPI_SEQ_WR(0x12d, 0x8b),
+	SPI_SEQ_WR(0x146, 0x01),
+	SPI_SEQ_WR(0x2a4, 0xff),
+	SPI_SEQ_WR(0x232, 0xff),
+	SPI_SEQ_WR(0x333, 0x01),
 };
 
 /*
  * Optimal settings for the SERDES PLL, as per table 39 of the AD9144 datasheet.
  */
-static const struct ad9144_reg_seq ad9144_optimal_serdes_settings[] = {
-	{ 0x284, 0x62 },
-	{ 0x285, 0xc9 },
-	{ 0x286, 0x0e },
-	{ 0x287, 0x12 },
-	{ 0x28a, 0x7b },
-	{ 0x28b, 0x00 },
-	{ 0x290, 0x89 },
-	{ 0x294, 0x24 },
-	{ 0x296, 0x03 },
-	{ 0x297, 0x0d },
-	{ 0x299, 0x02 },
-	{ 0x29a, 0x8e },
-	{ 0x29c, 0x2a },
-	{ 0x29f, 0x78 },
-	{ 0x2a0, 0x06 },
+static const struct spi_seq_entry ad9144_optimal_serdes_settings[] = {
+	SPI_SEQ_WR(0x284, 0x62),
+	SPI_SEQ_WR(0x285, 0xc9),
+	SPI_SEQ_WR(0x286, 0x0e),
+	SPI_SEQ_WR(0x287, 0x12),
+	SPI_SEQ_WR(0x28a, 0x7b),
+	SPI_SEQ_WR(0x28b, 0x00),
+	SPI_SEQ_WR(0x290, 0x89),
+	SPI_SEQ_WR(0x294, 0x24),
+	SPI_SEQ_WR(0x296, 0x03),
+	SPI_SEQ_WR(0x297, 0x0d),
+	SPI_SEQ_WR(0x299, 0x02),
+	SPI_SEQ_WR(0x29a, 0x8e),
+	SPI_SEQ_WR(0x29c, 0x2a),
+	SPI_SEQ_WR(0x29f, 0x78),
+	SPI_SEQ_WR(0x2a0, 0x06),
 };
 
+/***************************************************************************//**
+ * @brief ad9144_setup_ilas
+ *
+ * Writes the link parameters sent in the ILAS and enables the lanes.
+ *******************************************************************************/
+static int32_t ad9144_setup_ilas(struct ad9144_dev *dev,
+				 const struct ad9144_init_param *init_param,
+				 const struct ad9144_jesd204_link_mode *link_mode,
+				 unsigned int lane_mask,
+				 unsigned int syncb_len)
+{
+	/* The ILAS registers are contiguous and go out as one transaction */
+	const struct spi_seq_entry link_cfg[] = {
+		SPI_SEQ_WR(REG_ILS_DID, 0x00),
+		SPI_SEQ_WR(REG_ILS_BID, 0x00),
+		SPI_SEQ_WR(REG_ILS_LID0, 0x00),
+		SPI_SEQ_WR(REG_ILS_SCR_L, (link_mode->L - 1) |
+			   (init_param->jesd204_scrambling ? 0x80 : 0x00)),
+		SPI_SEQ_WR(REG_ILS_F, link_mode->F - 1),
+		SPI_SEQ_WR(REG_ILS_K, 0x1f),
+		SPI_SEQ_WR(REG_ILS_M, link_mode->M - 1),
+		SPI_SEQ_WR(REG_ILS_CS_N, 0x0f),	// 16 bits per sample
+		SPI_SEQ_WR(REG_ILS_NP, 0x0f |	// 16 bits per sample
+			   (init_param->jesd204_subclass == 1 ? 0x20 : 0x00)),
+		SPI_SEQ_WR(REG_ILS_S, (link_mode->S - 1) |
+			   0x20),	/* JESD204 version B */
+		SPI_SEQ_WR(REG_ILS_HD_CF, link_mode->F == 0 ? 0x80 : 0x00),
+		SPI_SEQ_WR(REG_LANEDESKEW, lane_mask),
+		SPI_SEQ_WR(REG_CTRLREG1, link_mode->F),
+		SPI_SEQ_WR(REG_LANEENABLE, lane_mask),
+		SPI_SEQ_WR(REG_SYNCB_GEN_1, syncb_len << 4),
+	};
+
+	return ad9144_spi_write_seq(dev, link_cfg, ARRAY_SIZE(link_cfg));
+}
+
 int32_t ad9144_setup_jesd204_link(struct ad9144_dev *dev,
 				  const struct ad9144_init_param *init_param)
 {
@@ -195,6 +234,7 @@ int32_t ad9144_setup_jesd204_link(struct ad9144_dev *dev,
 	unsigned int lane_mask;
 	unsigned int val;
 	unsigned int i;
+	int32_t ret;
 
 	for (i = 0; i < ARRAY_SIZE(ad9144_jesd204_link_modes); i++) {
 		if (ad9144_jesd204_link_modes[i].id == init_param->jesd204_mode) {
@@ -208,39 +248,6 @@ int32_t ad9144_setup_jesd204_link(struct ad9144_dev *dev,
 
 	lane_mask = (1 << link_mode->L) - 1;
 
-	ad9144_spi_write(dev, REG_ILS_DID, 0x00);
-	ad9144_spi_write(dev, REG_ILS_BID, 0x00);
-	ad9144_spi_write(dev, REG_ILS_LID0, 0x00);
-
-	val = link_mode->L - 1;
-	if (init_param->jesd204_scrambling)
-		val |= 0x80;
-	ad9144_spi_write(dev, REG_ILS_SCR_L, val);
-
-	val = link_mode->F - 1;
-	ad9144_spi_write(dev, REG_ILS_F, val);
-	ad9144_spi_write(dev, REG_ILS_K, 0x1f);
-
-	val = link_mode->M - 1;
-	ad9144_spi_write(dev, REG_ILS_M, val);
-	ad9144_spi_write(dev, REG_ILS_CS_N, 0x0f); // 16 bits per sample
-
-	val = 0x0f; // 16 bits per sample
-	if (init_param->jesd204_subclass == 1)
-		val |= 0x20;
-	ad9144_spi_write(dev, REG_ILS_NP, val);
-
-	val = link_mode->S - 1;
-	val |= 0x20; /* JESD204 version B */
-	ad9144_spi_write(dev, REG_ILS_S, val);
-
-	val = link_mode->F == 0 ? 0x80 : 0x00;
-	ad9144_spi_write(dev, REG_ILS_HD_CF, val);
-
-	ad9144_spi_write(dev, REG_LANEDESKEW, lane_mask);
-	ad9144_spi_write(dev, REG_CTRLREG1, link_mode->F);
-	ad9144_spi_write(dev, REG_LANEENABLE, lane_mask);
-
 	/*
 	 * Length of the SYNC~ error pulse in PCLK cycles. According to the
 	 * JESD204 standard the pulse length should be two frame clock cycles.
@@ -262,10 +269,14 @@ int32_t ad9144_setup_jesd204_link(struct ad9144_dev *dev,
 		val = 0x2;
 		break;
 	}
-	ad9144_spi_write(dev, REG_SYNCB_GEN_1, val << 4);
+
+	ret = ad9144_setup_ilas(dev, init_param, link_mode, lane_mask, val);
+	if (ret < 0)
+		return ret;
 
 	dev->num_converters = link_mode->M;
 	dev->num_lanes = link_mode->L;
+	dev->lane_rate_kbps = init_param->lane_rate_kbps;
 
 	return 0;
 }
@@ -274,20 +285,20 @@ int32_t ad9144_setup_jesd204_link(struct ad9144_dev *dev,
  * PLL fixed register writes according to table 17 of the
  * AD9144 datasheet Rev. B.
  */
-static const struct ad9144_reg_seq ad9144_pll_fixed_writes[] = {
-	{ 0x87, 0x62 },
-	{ 0x88, 0xc0 },
-	{ 0x89, 0x0e },
-	{ 0x8a, 0x12 },
-	{ 0x8d, 0x7b },
-	{ 0x1b0, 0x00 },
-	{ 0x1b9, 0x24 },
-	{ 0x1bc, 0x0d },
-	{ 0x1be, 0x02 },
-	{ 0x1bf, 0x8e },
-	{ 0x1c0, 0x2a },
-	{ 0x1c1, 0x2a },
-	{ 0x1c4, 0x7e },
+static const struct spi_seq_entry ad9144_pll_fixed_writes[] = {
+	SPI_SEQ_WR(0x87, 0x62),
+	SPI_SEQ_WR(0x88, 0xc0),
+	SPI_SEQ_WR(0x89, 0x0e),
+	SPI_SEQ_WR(0x8a, 0x12),
+	SPI_SEQ_WR(0x8d, 0x7b),
+	SPI_SEQ_WR(0x1b0, 0x00),
+	SPI_SEQ_WR(0x1b9, 0x24),
+	SPI_SEQ_WR(0x1bc, 0x0d),
+	SPI_SEQ_WR(0x1be, 0x02),
+	SPI_SEQ_WR(0x1bf, 0x8e),
+	SPI_SEQ_WR(0x1c0, 0x2a),
+	SPI_SEQ_WR(0x1c1, 0x2a),
+	SPI_SEQ_WR(0x1c4, 0x7e),
 };
 
 static int32_t ad9144_pll_setup(struct ad9144_dev *dev,
@@ -343,8 +354,10 @@ static int32_t ad9144_pll_setup(struct ad9144_dev *dev,
 		vco_param[2] = 0x06;
 	}
 
-	ad9144_spi_write_seq(dev, ad9144_pll_fixed_writes,
-			     ARRAY_SIZE(ad9144_pll_fixed_writes));
+	ret = ad9144_spi_write_seq(dev, ad9144_pll_fixed_writes,
+				   ARRAY_SIZE(ad9144_pll_fixed_writes));
+	if (ret < 0)
+		return ret;
 
 	ad9144_spi_write(dev, REG_DACLOGENCNTRL, lo_div_mode);
 	ad9144_spi_write(dev, REG_DACLDOCNTRL1, ref_div_mode);
@@ -374,8 +387,32 @@ int32_t ad9144_setup(struct ad9144_dev **device,
 	uint8_t chip_id;
 	uint8_t scratchpad;
 	uint32_t val;
+	int32_t pll_status;
 	int32_t ret;
 	struct ad9144_dev *dev;
+	const struct spi_seq_entry link_layer[] = {
+		SPI_SEQ_WR(REG_GENERAL_JRX_CTRL_1, 0x01),	// subclass-1
+		SPI_SEQ_WR(REG_LMFC_DELAY_0, 0x00),	// lmfc delay
+		SPI_SEQ_WR(REG_LMFC_DELAY_1, 0x00),	// lmfc delay
+		SPI_SEQ_WR(REG_LMFC_VAR_0, 0x0a),	// receive buffer delay
+		SPI_SEQ_WR(REG_LMFC_VAR_1, 0x0a),	// receive buffer delay
+		SPI_SEQ_WR(REG_SYNC_CTRL, 0x01),	// sync-oneshot mode
+		SPI_SEQ_WR(REG_SYNC_CTRL, 0x81),	// sync-enable
+		SPI_SEQ_WR(REG_SYNC_CTRL, 0xc1),	// sysref-armed
+		SPI_SEQ_WR(REG_XBAR_LN_0_1,
+			   SRC_LANE0(init_param->jesd204_lane_xbar[0]) |
+			   SRC_LANE1(init_param->jesd204_lane_xbar[1])),
+		SPI_SEQ_WR(REG_XBAR_LN_2_3,
+			   SRC_LANE2(init_param->jesd204_lane_xbar[2]) |
+			   SRC_LANE3(init_param->jesd204_lane_xbar[3])),
+		SPI_SEQ_WR(REG_XBAR_LN_4_5,
+			   SRC_LANE4(init_param->jesd204_lane_xbar[4]) |
+			   SRC_LANE5(init_param->jesd204_lane_xbar[5])),
+		SPI_SEQ_WR(REG_XBAR_LN_6_7,
+			   SRC_LANE6(init_param->jesd204_lane_xbar[6]) |
+			   SRC_LANE7(init_param->jesd204_lane_xbar[7])),
+		SPI_SEQ_WR(REG_GENERAL_JRX_CTRL_0, 0x01),	// enable link
+	};
 
 	dev = (struct ad9144_dev *)malloc(sizeof(*dev));
 	if (!dev)
@@ -383,18 +420,22 @@ int32_t ad9144_setup(struct ad9144_dev **device,
 
 	/* SPI */
 	ret = spi_init(&dev->spi_desc, &init_param->spi_init);
-	if (ret == -1)
+	if (ret == -1) {
 		printf("%s : Device descriptor failed!\n", __func__);
+		goto error_dev;
+	}
 
 	// reset
 	ad9144_spi_write(dev, REG_SPI_INTFCONFA, SOFTRESET_M | SOFTRESET);
-	ad9144_spi_write(dev, REG_SPI_INTFCONFA, init_param->spi3wire ? 0x00 : 0x18);
+	ad9144_spi_write(dev, REG_SPI_INTFCONFA, ADDRINC_M | ADDRINC |
+			 (init_param->spi3wire ? 0x00 : SDOACTIVE_M | SDOACTIVE));
 	mdelay(1);
 
 	ad9144_spi_read(dev, REG_SPI_PRODIDL, &chip_id);
 	if(chip_id != AD9144_CHIP_ID) {
 		printf("%s : Invalid CHIP ID (0x%x).\n", __func__, chip_id);
-		return -1;
+		ret = -1;
+		goto error_spi;
 	}
 
 	ad9144_spi_write(dev, REG_SPI_SCRATCHPAD, 0xAD);
@@ -402,7 +443,8 @@ int32_t ad9144_setup(struct ad9144_dev **device,
 	if(scratchpad != 0xAD) {
 		printf("%s : scratchpad read-write failed (0x%x)!\n", __func__,
 		       scratchpad);
-		return -1;
+		ret = -1;
+		goto error_spi;
 	}
 
 	// power-up and dac initialization
@@ -412,13 +454,20 @@ int32_t ad9144_setup(struct ad9144_dev **device,
 			 0x00);	// sysref - power up/falling edge
 
 	// required device configurations
-	ad9144_spi_write_seq(dev, ad9144_required_device_config,
-			     ARRAY_SIZE(ad9144_required_device_config));
-	ad9144_spi_write_seq(dev, ad9144_optimal_serdes_settings,
-			     ARRAY_SIZE(ad9144_optimal_serdes_settings));
-
-	if (init_param->pll_enable)
-		ad9144_pll_setup(dev, init_param);
+	ret = ad9144_spi_write_seq(dev, ad9144_required_device_config,
+				   ARRAY_SIZE(ad9144_required_device_config));
+	if (ret < 0)
+		goto error_spi;
+	ret = ad9144_spi_write_seq(dev, ad9144_optimal_serdes_settings,
+				   ARRAY_SIZE(ad9144_optimal_serdes_settings));
+	if (ret < 0)
+		goto error_spi;
+
+	if (init_param->pll_enable) {
+		ret = ad9144_pll_setup(dev, init_param);
+		if (ret < 0)
+			goto error_spi;
+	}
 
 	// digital data path
 
@@ -445,7 +494,9 @@ int32_t ad9144_setup(struct ad9144_dev **device,
 	ad9144_spi_write(dev, REG_MASTER_PD, 0x00);	// phy - power up
 	ad9144_spi_write(dev, REG_PHY_PD, 0x00);	// phy - power up
 	ad9144_spi_write(dev, REG_GENERAL_JRX_CTRL_0, 0x00);	// single link - link 0
-	ad9144_setup_jesd204_link(dev, init_param);
+	ret = ad9144_setup_jesd204_link(dev, init_param);
+	if (ret < 0)
+		goto error_spi;
 
 	// physical layer
 
@@ -478,44 +529,233 @@ int32_t ad9144_setup(struct ad9144_dev **device,
 			 0x05);	// enable serdes calibration
 	mdelay(20);
 
-	ret = ad9144_spi_check_status(dev, REG_PLL_STATUS, 0x01, 0x01);
-	if (ret == -1)
+	pll_status = ad9144_spi_check_status(dev, REG_PLL_STATUS, 0x01, 0x01);
+	if (pll_status == -1)
 		printf("%s : PLL NOT locked!.\n", __func__);
 
 	ad9144_spi_write(dev, REG_EQ_BIAS_REG, 0x62);	// equalizer
 
 	// data link layer
 
-	ad9144_spi_write(dev, REG_GENERAL_JRX_CTRL_1, 0x01);	// subclass-1
-	ad9144_spi_write(dev, REG_LMFC_DELAY_0, 0x00);	// lmfc delay
-	ad9144_spi_write(dev, REG_LMFC_DELAY_1, 0x00);	// lmfc delay
-	ad9144_spi_write(dev, REG_LMFC_VAR_0, 0x0a);	// receive buffer delay
-	ad9144_spi_write(dev, REG_LMFC_VAR_1, 0x0a);	// receive buffer delay
-	ad9144_spi_write(dev, REG_SYNC_CTRL, 0x01);	// sync-oneshot mode
-	ad9144_spi_write(dev, REG_SYNC_CTRL, 0x81);	// sync-enable
-	ad9144_spi_write(dev, REG_SYNC_CTRL, 0xc1);	// sysref-armed
-	ad9144_spi_write(dev, REG_XBAR_LN_0_1,
-			 SRC_LANE0(init_param->jesd204_lane_xbar[0]) |
-			 SRC_LANE1(init_param->jesd204_lane_xbar[1]));
-	ad9144_spi_write(dev, REG_XBAR_LN_2_3,
-			 SRC_LANE2(init_param->jesd204_lane_xbar[2]) |
-			 SRC_LANE3(init_param->jesd204_lane_xbar[3]));
-	ad9144_spi_write(dev, REG_XBAR_LN_4_5,
-			 SRC_LANE4(init_param->jesd204_lane_xbar[4]) |
-			 SRC_LANE5(init_param->jesd204_lane_xbar[5]));
-	ad9144_spi_write(dev, REG_XBAR_LN_6_7,
-			 SRC_LANE6(init_param->jesd204_lane_xbar[6]) |
-			 SRC_LANE7(init_param->jesd204_lane_xbar[7]));
-	ad9144_spi_write(dev, REG_GENERAL_JRX_CTRL_0, 0x01);	// enable link
+	ret = ad9144_spi_write_seq(dev, link_layer, ARRAY_SIZE(link_layer));
+	if (ret < 0)
+		goto error_spi;
 
 	// dac calibration
 	ad9144_dac_calibrate(dev);
 
 	*device = dev;
 
+	return pll_status;
+
+error_spi:
+	spi_remove(dev->spi_desc);
+error_dev:
+	free(dev);
+
 	return ret;
 }
 
+/***************************************************************************//**
+ * @brief ad9144_ber_reset
+ *******************************************************************************/
+static void ad9144_ber_reset(struct ad9144_ber_result *result,
+			     uint8_t num)
+{
+	uint8_t i;
+
+	for (i = 0; i < num; i++) {
+		result[i].bits = 0;
+		result[i].errors = 0;
+		result[i].oos_events = 0;
+		result[i].saturations = 0;
+		result[i].pass = 0;
+	}
+}
+
+/***************************************************************************//**
+ * @brief ad9144_ber_done
+ * Returns 1 once every entry has checked at least bits_required bits.
+ *******************************************************************************/
+static uint8_t ad9144_ber_done(struct ad9144_ber_result *result,
+			       uint8_t num,
+			       uint64_t bits_required)
+{
+	uint8_t i;
+
+	for (i = 0; i < num; i++)
+		if (result[i].bits < bits_required)
+			return 0;
+
+	return 1;
+}
+
+/***************************************************************************//**
+ * @brief ad9144_ber_finish
+ *******************************************************************************/
+static int32_t ad9144_ber_finish(struct ad9144_ber_result *result,
+				 uint8_t num,
+				 uint64_t bits_required)
+{
+	int32_t ret = 0;
+	uint8_t i;
+
+	for (i = 0; i < num; i++) {
+		result[i].pass = !result[i].errors && !result[i].oos_events &&
+				 (result[i].bits >= bits_required);
+		if (!result[i].pass)
+			ret = -1;
+	}
+
+	return ret;
+}
+
+/***************************************************************************//**
+ * @brief ad9144_phy_prbs_ber_test
+ * Runs the PHY PRBS checkers of all lanes at once until enough bits were
+ * received for the requested BER and confidence level, or until the timeout
+ * expires. The 24-bit error counters are read every AD9144_BER_POLL_MS and
+ * accumulated; they are cleared whenever one of them saturates. result must
+ * hold num_lanes entries. Returns 0 if all lanes pass, -1 otherwise.
+ *******************************************************************************/
+int32_t ad9144_phy_prbs_ber_test(struct ad9144_dev *dev,
+				 const struct ad9144_ber_param *param,
+				 struct ad9144_ber_result *result)
+{
+	uint32_t last_count[8] = {0};
+	uint64_t bits_required;
+	uint32_t elapsed_ms;
+	uint32_t count;
+	uint8_t ctrl;
+	uint8_t saturated;
+	uint8_t lane;
+	uint8_t val;
+
+	bits_required = ber_bits_required(param->ber_exp, param->confidence);
+	if (!bits_required || !dev->lane_rate_kbps)
+		return -1;
+
+	ad9144_ber_reset(result, dev->num_lanes);
+
+	ctrl = PHY_PRBS_PAT_SEL(param->prbs_type);
+	ad9144_spi_write(dev, REG_PHY_PRBS_TEST_EN, (1 << dev->num_lanes) - 1);
+	ad9144_spi_write(dev, REG_PHY_PRBS_TEST_CTRL, ctrl | PHY_TEST_RESET);
+	ad9144_spi_write(dev, REG_PHY_PRBS_TEST_CTRL, ctrl);
+	ctrl |= PHY_TEST_START;
+	ad9144_spi_write(dev, REG_PHY_PRBS_TEST_CTRL, ctrl);
+
+	elapsed_ms = 0;
+	do {
+		mdelay(AD9144_BER_POLL_MS);
+		elapsed_ms += AD9144_BER_POLL_MS;
+
+		saturated = 0;
+		for (lane = 0; lane < dev->num_lanes; lane++) {
+			ad9144_spi_write(dev, REG_PHY_PRBS_TEST_CTRL,
+					 ctrl | PHY_SRC_ERR_CNT(lane));
+			ad9144_spi_read(dev, REG_PHY_PRBS_TEST_ERRCNT_HIBITS, &val);
+			count = val << 16;
+			ad9144_spi_read(dev, REG_PHY_PRBS_TEST_ERRCNT_MIDBITS, &val);
+			count |= val << 8;
+			ad9144_spi_read(dev, REG_PHY_PRBS_TEST_ERRCNT_LOBITS, &val);
+			count |= val;
+
+			result[lane].bits += (uint64_t)dev->lane_rate_kbps *
+					     AD9144_BER_POLL_MS;
+			result[lane].errors += count - last_count[lane];
+			last_count[lane] = count;
+			if (count == AD9144_PHY_PRBS_ERRCNT_MAX) {
+				result[lane].saturations++;
+				saturated = 1;
+			}
+		}
+
+		if (saturated) {
+			ad9144_spi_write(dev, REG_PHY_PRBS_TEST_CTRL,
+					 ctrl | PHY_TEST_RESET);
+			ad9144_spi_write(dev, REG_PHY_PRBS_TEST_CTRL, ctrl);
+			for (lane = 0; lane < dev->num_lanes; lane++)
+				last_count[lane] = 0;
+		}
+	} while (!ad9144_ber_done(result, dev->num_lanes, bits_required) &&
+		 (!param->timeout_ms || elapsed_ms < param->timeout_ms));
+
+	ad9144_spi_write(dev, REG_PHY_PRBS_TEST_CTRL, 0x00);
+	ad9144_spi_write(dev, REG_PHY_PRBS_TEST_EN, 0x00);
+
+	return ad9144_ber_finish(result, dev->num_lanes, bits_required);
+}
+
+/***************************************************************************//**
+ * @brief ad9144_datapath_prbs_ber_test
+ * Runs the datapath PRBS checkers of all converters at once. The 8-bit I and
+ * Q error counters of each dual are read and cleared every
+ * AD9144_BER_POLL_MS. result must hold num_converters entries, converter 2n
+ * is the I channel and 2n + 1 the Q channel of dual n.
+ * Returns 0 if all converters pass, -1 otherwise.
+ *******************************************************************************/
+int32_t ad9144_datapath_prbs_ber_test(struct ad9144_dev *dev,
+				      const struct ad9144_ber_param *param,
+				      struct ad9144_ber_result *result)
+{
+	uint64_t bits_required;
+	uint64_t poll_bits;
+	uint32_t elapsed_ms;
+	uint8_t status = 0;
+	uint8_t prbs;
+	uint8_t count;
+	uint8_t conv;
+
+	bits_required = ber_bits_required(param->ber_exp, param->confidence);
+	/* 8b/10b payload of all lanes, shared by the converters */
+	poll_bits = (uint64_t)dev->lane_rate_kbps * 8 * dev->num_lanes *
+		    AD9144_BER_POLL_MS;
+	do_div(&poll_bits, 10 * dev->num_converters);
+	if (!bits_required || !poll_bits)
+		return -1;
+
+	ad9144_ber_reset(result, dev->num_converters);
+
+	prbs = (param->prbs_type << 2) | PRBS_EN;
+	ad9144_spi_write(dev, REG_SPI_PAGEINDX, PAGEINDX(0x3));
+	ad9144_spi_write(dev, REG_PRBS, prbs | PRBS_RESET);
+	ad9144_spi_write(dev, REG_PRBS, prbs);
+
+	elapsed_ms = 0;
+	do {
+		mdelay(AD9144_BER_POLL_MS);
+		elapsed_ms += AD9144_BER_POLL_MS;
+
+		for (conv = 0; conv < dev->num_converters; conv++) {
+			if (!(conv & 1)) {
+				ad9144_spi_write(dev, REG_SPI_PAGEINDX,
+						 PAGEINDX(1 << (conv / 2)));
+				ad9144_spi_read(dev, REG_PRBS, &status);
+			}
+
+			if (!(status & ((conv & 1) ? PRBS_GOOD_Q : PRBS_GOOD_I))) {
+				result[conv].oos_events++;
+				continue;
+			}
+
+			ad9144_spi_read(dev, (conv & 1) ? REG_PRBS_ERROR_Q :
+					REG_PRBS_ERROR_I, &count);
+			result[conv].bits += poll_bits;
+			result[conv].errors += count;
+			if (count == AD9144_PRBS_ERRCNT_MAX)
+				result[conv].saturations++;
+		}
+
+		/* Clear the counters of both duals for the next interval. */
+		ad9144_spi_write(dev, REG_SPI_PAGEINDX, PAGEINDX(0x3));
+		ad9144_spi_write(dev, REG_PRBS, prbs | PRBS_RESET);
+		ad9144_spi_write(dev, REG_PRBS, prbs);
+	} while (!ad9144_ber_done(result, dev->num_converters, bits_required) &&
+		 (!param->timeout_ms || elapsed_ms < param->timeout_ms));
+
+	return ad9144_ber_finish(result, dev->num_converters, bits_required);
+}
+
 int32_t ad9144_dac_calibrate(struct ad9144_dev *dev)
 {
 	uint32_t dac_mask;
@@ -45,6 +45,7 @@
 #include <stdint.h>
 #include "delay.h"
 #include "spi.h"
+#include "util.h"
 
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
@@ -1148,6 +1149,10 @@
 #define PHY_SRC_ERR_CNT(x)			(((x) & 0x7) << 4) /* PHY error count source */
 #define PHY_PRBS_PAT_SEL(x)			(((x) & 0x3) << 2) /* PHY PRBS pattern select */
 
+#define AD9144_PHY_PRBS_ERRCNT_MAX		0xFFFFFF
+#define AD9144_PRBS_ERRCNT_MAX			0xFF
+#define AD9144_BER_POLL_MS			10
+
 /*
  *	REG_SHORT_TPL_TEST_0
  */
@@ -1355,12 +1360,6 @@
 #define AD9144_PRBS7				0x0
 #define AD9144_PRBS15				0x1
 
-/*
- *	GENERAL
- */
-#define ARRAY_SIZE(x)				(sizeof(x)/sizeof(x[0]))
-#define BIT(x)					(1UL << (x))
-
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -1370,6 +1369,31 @@ struct ad9144_dev {
 
 	uint8_t num_converters;
 	uint8_t num_lanes;
+	uint32_t lane_rate_kbps;
+};
+
+struct ad9144_ber_param {
+	/* PRBS polynomial, PHY: 0 PRBS7, 1 PRBS15, 2 PRBS31, datapath: 0 PRBS15, 1 PRBS7 */
+	uint8_t		prbs_type;
+	/* Target bit error rate is 10^-ber_exp */
+	uint32_t	ber_exp;
+	/* Confidence level in per mille */
+	uint32_t	confidence;
+	/* Upper limit of the test duration, 0 for no limit */
+	uint32_t	timeout_ms;
+};
+
+struct ad9144_ber_result {
+	/* Bits checked while the checker was in sync */
+	uint64_t	bits;
+	/* Accumulated error count, a lower bound if saturations is not 0 */
+	uint64_t	errors;
+	/* Poll intervals with the checker out of sync */
+	uint32_t	oos_events;
+	/* Poll intervals in which the hardware error counter saturated */
+	uint32_t	saturations;
+	/* Error free over the bits required by the target */
+	uint8_t		pass;
 };
 
 struct ad9144_init_param {
@@ -1424,6 +1448,14 @@ int32_t ad9144_short_pattern_test(struct ad9144_dev *dev,
 int32_t ad9144_datapath_prbs_test(struct ad9144_dev *dev,
 				  const struct ad9144_init_param *init_param);
 
+int32_t ad9144_phy_prbs_ber_test(struct ad9144_dev *dev,
+				 const struct ad9144_ber_param *param,
+				 struct ad9144_ber_result *result);
+
+int32_t ad9144_datapath_prbs_ber_test(struct ad9144_dev *dev,
+				      const struct ad9144_ber_param *param,
+				      struct ad9144_ber_result *result);
+
 int32_t ad9144_dac_calibrate(struct ad9144_dev *dev);
 
 #endif
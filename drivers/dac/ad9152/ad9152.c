@@ -43,6 +43,80 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include "ad9152.h"
+#include "spi_seq.h"
+#include "util.h"
+
+/*
+ * Static part of the device setup: transport layer, physical layer and the
+ * SERDES PLL calibration.
+ */
+static const struct spi_seq_entry ad9152_setup_seq[] = {
+	SPI_SEQ_WR(0x011, 0x00),	// dacs - power up everything
+	SPI_SEQ_WR(0x080, 0x00),	// clocks - power up everything
+	SPI_SEQ_WR(0x081, 0x00),	// sysref - power up/falling edge
+
+	// digital data path
+
+	SPI_SEQ_WR(0x112, 0x00),	// interpolation (bypass)
+	SPI_SEQ_WR(0x110, 0x00),	// 2's complement
+
+	// transport layer
+
+	SPI_SEQ_WR(0x200, 0x00),	// phy - power up
+	SPI_SEQ_WR(0x201, 0x00),	// phy - power up
+	SPI_SEQ_WR(0x230, 0x28),	// half-rate CDR
+	SPI_SEQ_WR(0x312, 0x20),	// half-rate CDR
+	SPI_SEQ_WR(0x300, 0x00),	// single link - link 0
+	SPI_SEQ_WR(0x450, 0x00),	// device id (0x400)
+	SPI_SEQ_WR(0x451, 0x00),	// bank id (0x401)
+	SPI_SEQ_WR(0x452, 0x04),	// lane-id (0x402)
+	SPI_SEQ_WR(0x453, 0x83),	// descrambling, 4 lanes
+	SPI_SEQ_WR(0x454, 0x00),	// octects per frame per lane (1)
+	SPI_SEQ_WR(0x455, 0x1f),	// mult-frame - framecount (32)
+	SPI_SEQ_WR(0x456, 0x01),	// no-of-converters (2)
+	SPI_SEQ_WR(0x457, 0x0f),	// no CS bits, 16bit dac
+	SPI_SEQ_WR(0x458, 0x2f),	// subclass 1, 16bits per sample
+	SPI_SEQ_WR(0x459,
+		   0x20),	// jesd204b, 1 samples per converter per device
+	SPI_SEQ_WR(0x45a, 0x80),	// HD mode, no CS bits
+	SPI_SEQ_WR(0x45d, 0x49),	// check-sum of 0x450 to 0x45c
+	SPI_SEQ_WR(0x478, 0x01),	// ilas mf count
+	SPI_SEQ_WR(0x46c, 0x0f),	// enable deskew for all lanes
+	SPI_SEQ_WR(0x476, 0x01),	// frame - bytecount (1)
+	SPI_SEQ_WR(0x47d, 0x0f),	// enable all lanes
+
+	// physical layer
+	SPI_SEQ_WR(0x2a6, 0x08),
+	SPI_SEQ_WR(0x248, 0xaa),
+	SPI_SEQ_WR(0x2aa, 0xb7),	// jesd termination
+	SPI_SEQ_WR(0x2ab, 0x87),	// jesd termination
+	SPI_SEQ_WR(0x2a7, 0x01),	// input termination calibration
+	SPI_SEQ_WR(0x314, 0x01),	// pclk == qbd master clock
+	SPI_SEQ_WR(0x230, 0x28),	// cdr mode - halfrate, no division
+	SPI_SEQ_WR(0x206, 0x00),	// cdr reset
+	SPI_SEQ_WR(0x206, 0x01),	// cdr reset
+	SPI_SEQ_WR(0x289, 0x04),	// data-rate == 10Gbps
+	SPI_SEQ_WR(0x280, 0x01),	// enable serdes pll
+	SPI_SEQ_WR(0x280, 0x05),	// enable serdes calibration
+	SPI_SEQ_DELAY_MS(20),
+};
+
+/* Data link layer setup, run once the SERDES PLL is up. */
+static const struct spi_seq_entry ad9152_link_seq[] = {
+	SPI_SEQ_WR(0x268, 0x62),	// equalizer
+
+	// data link layer
+
+	SPI_SEQ_WR(0x301, 0x01),	// subclass-1
+	SPI_SEQ_WR(0x304, 0x00),	// lmfc delay
+	SPI_SEQ_WR(0x306, 0x0a),	// receive buffer delay
+	SPI_SEQ_WR(0x03a, 0x01),	// sync-oneshot mode
+	SPI_SEQ_WR(0x03a, 0x81),	// sync-enable
+	SPI_SEQ_WR(0x03a, 0xc1),	// sysref-armed
+	SPI_SEQ_WR(0x300, 0x01),	// enable link
+
+	SPI_SEQ_WR(0x0e7, 0x30),	// turn off cal clock
+};
 
 /***************************************************************************//**
  * @brief ad9152_spi_read
@@ -89,6 +163,27 @@ int32_t ad9152_spi_write(struct ad9152_dev *dev,
 	return ret;
 }
 
+/***************************************************************************//**
+ * @brief ad9152_spi_write_seq
+ *
+ * The device is set up for ascending address streaming, so consecutive
+ * registers in the sequence are written in a single SPI transaction.
+ *******************************************************************************/
+static int32_t ad9152_spi_write_seq(struct ad9152_dev *dev,
+				    const struct spi_seq_entry *seq,
+				    uint32_t num)
+{
+	const struct spi_seq_config cfg = {
+		.spi = dev->spi_desc,
+		.read_flag = 0x8000,
+		.addr_mask = 0x7FFF,
+		.addr_ascending = true,
+		.max_stream = SPI_SEQ_MAX_STREAM,
+	};
+
+	return spi_seq_run(&cfg, seq, num);
+}
+
 /***************************************************************************//**
  * @brief ad9152_setup
  *******************************************************************************/
@@ -119,58 +214,15 @@ int32_t ad9152_setup(struct ad9152_dev **device,
 	mdelay(5);
 
 	ad9152_spi_write(dev, REG_SPI_INTFCONFA, SOFTRESET_M | SOFTRESET);	// reset
-	ad9152_spi_write(dev, REG_SPI_INTFCONFA, 0x00);	// reset
+	ad9152_spi_write(dev, REG_SPI_INTFCONFA,
+			 ADDRINC_M | ADDRINC);	// ascending streaming
 
 	mdelay(4);
 
-	ad9152_spi_write(dev, 0x011, 0x00);	// dacs - power up everything
-	ad9152_spi_write(dev, 0x080, 0x00);	// clocks - power up everything
-	ad9152_spi_write(dev, 0x081, 0x00);	// sysref - power up/falling edge
-
-	// digital data path
-
-	ad9152_spi_write(dev, 0x112, 0x00);	// interpolation (bypass)
-	ad9152_spi_write(dev, 0x110, 0x00);	// 2's complement
-
-	// transport layer
-
-	ad9152_spi_write(dev, 0x200, 0x00);	// phy - power up
-	ad9152_spi_write(dev, 0x201, 0x00);	// phy - power up
-	ad9152_spi_write(dev, 0x230, 0x28);	// half-rate CDR
-	ad9152_spi_write(dev, 0x312, 0x20);	// half-rate CDR
-	ad9152_spi_write(dev, 0x300, 0x00);	// single link - link 0
-	ad9152_spi_write(dev, 0x450, 0x00);	// device id (0x400)
-	ad9152_spi_write(dev, 0x451, 0x00);	// bank id (0x401)
-	ad9152_spi_write(dev, 0x452, 0x04);	// lane-id (0x402)
-	ad9152_spi_write(dev, 0x453, 0x83);	// descrambling, 4 lanes
-	ad9152_spi_write(dev, 0x454, 0x00);	// octects per frame per lane (1)
-	ad9152_spi_write(dev, 0x455, 0x1f);	// mult-frame - framecount (32)
-	ad9152_spi_write(dev, 0x456, 0x01);	// no-of-converters (2)
-	ad9152_spi_write(dev, 0x457, 0x0f);	// no CS bits, 16bit dac
-	ad9152_spi_write(dev, 0x458, 0x2f);	// subclass 1, 16bits per sample
-	ad9152_spi_write(dev, 0x459,
-			 0x20);	// jesd204b, 1 samples per converter per device
-	ad9152_spi_write(dev, 0x45a, 0x80);	// HD mode, no CS bits
-	ad9152_spi_write(dev, 0x45d, 0x49);	// check-sum of 0x450 to 0x45c
-	ad9152_spi_write(dev, 0x478, 0x01);	// ilas mf count
-	ad9152_spi_write(dev, 0x46c, 0x0f);	// enable deskew for all lanes
-	ad9152_spi_write(dev, 0x476, 0x01);	// frame - bytecount (1)
-	ad9152_spi_write(dev, 0x47d, 0x0f);	// enable all lanes
-
-	// physical layer
-	ad9152_spi_write(dev, 0x2a6, 0x08);
-	ad9152_spi_write(dev, 0x248, 0xaa);
-	ad9152_spi_write(dev, 0x2aa, 0xb7);	// jesd termination
-	ad9152_spi_write(dev, 0x2ab, 0x87);	// jesd termination
-	ad9152_spi_write(dev, 0x2a7, 0x01);	// input termination calibration
-	ad9152_spi_write(dev, 0x314, 0x01);	// pclk == qbd master clock
-	ad9152_spi_write(dev, 0x230, 0x28);	// cdr mode - halfrate, no division
-	ad9152_spi_write(dev, 0x206, 0x00);	// cdr reset
-	ad9152_spi_write(dev, 0x206, 0x01);	// cdr reset
-	ad9152_spi_write(dev, 0x289, 0x04);	// data-rate == 10Gbps
-	ad9152_spi_write(dev, 0x280, 0x01);	// enable serdes pll
-	ad9152_spi_write(dev, 0x280, 0x05);	// enable serdes calibration
-	mdelay(20);
+	ret = ad9152_spi_write_seq(dev, ad9152_setup_seq,
+				   ARRAY_SIZE(ad9152_setup_seq));
+	if (ret < 0)
+		return ret;
 
 	ad9152_spi_read(dev, 0x281, &pll_stat);
 	if (pll_stat == 0) {
@@ -178,20 +230,9 @@ int32_t ad9152_setup(struct ad9152_dev **device,
 		ret = -1;
 	}
 
-	ad9152_spi_write(dev, 0x268, 0x62);	// equalizer
-
-
-	// data link layer
-
-	ad9152_spi_write(dev, 0x301, 0x01);	// subclass-1
-	ad9152_spi_write(dev, 0x304, 0x00);	// lmfc delay
-	ad9152_spi_write(dev, 0x306, 0x0a);	// receive buffer delay
-	ad9152_spi_write(dev, 0x03a, 0x01);	// sync-oneshot mode
-	ad9152_spi_write(dev, 0x03a, 0x81);	// sync-enable
-	ad9152_spi_write(dev, 0x03a, 0xc1);	// sysref-armed
-	ad9152_spi_write(dev, 0x300, 0x01);	// enable link
-
-	ad9152_spi_write(dev, 0x0e7, 0x30);	// turn off cal clock
+	if (ad9152_spi_write_seq(dev, ad9152_link_seq,
+				 ARRAY_SIZE(ad9152_link_seq)) < 0)
+		return -1;
 
 	*device = dev;
 
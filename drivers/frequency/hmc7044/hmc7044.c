@@ -44,6 +44,7 @@
 #include "error.h"
 #include "util.h"
 #include "hmc7044.h"
+#include "spi_seq.h"
 
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
@@ -213,8 +214,6 @@
 #define HMC7044_DYN_DRIVER_EN		BIT(5)
 #define HMC7044_FORCE_MUTE_EN		BIT(7)
 
-#define HMC7044_NUM_CHAN	14
-
 #define HMC7044_LOW_VCO_MIN	2150000
 #define HMC7044_LOW_VCO_MAX	2880000
 #define HMC7044_HIGH_VCO_MIN	2650000
@@ -235,6 +234,42 @@
 #define HMC7044_OUT_DIV_MIN	1
 #define HMC7044_OUT_DIV_MAX	4094
 
+#define HMC7044_SYSREF_TIMER_DIV_MAX	4095
+#define HMC7044_SYSREF_TIMER_FREQ_MAX	4000000
+
+/* PLL2, SYSREF timer, two divider bytes per channel and the restart */
+#define HMC7044_PLAN_MAX_WRITES	(6 + 2 + 2 * HMC7044_NUM_CHAN + 4)
+
+/*
+ * Soft reset, disable all channels and load the configuration updates
+ * (provided by Analog Devices).
+ */
+static const struct spi_seq_entry hmc7044_reset_seq[] = {
+	SPI_SEQ_WR(HMC7044_REG_SOFT_RESET, HMC7044_SOFT_RESET),
+	SPI_SEQ_DELAY_MS(10),
+	SPI_SEQ_WR(HMC7044_REG_SOFT_RESET, 0),
+	SPI_SEQ_DELAY_MS(10),
+	SPI_SEQ_WR(HMC7044_REG_CH_OUT_CRTL_0(0), 0),
+	SPI_SEQ_WR(HMC7044_REG_CH_OUT_CRTL_0(1), 0),
+	SPI_SEQ_WR(HMC7044_REG_CH_OUT_CRTL_0(2), 0),
+	SPI_SEQ_WR(HMC7044_REG_CH_OUT_CRTL_0(3), 0),
+	SPI_SEQ_WR(HMC7044_REG_CH_OUT_CRTL_0(4), 0),
+	SPI_SEQ_WR(HMC7044_REG_CH_OUT_CRTL_0(5), 0),
+	SPI_SEQ_WR(HMC7044_REG_CH_OUT_CRTL_0(6), 0),
+	SPI_SEQ_WR(HMC7044_REG_CH_OUT_CRTL_0(7), 0),
+	SPI_SEQ_WR(HMC7044_REG_CH_OUT_CRTL_0(8), 0),
+	SPI_SEQ_WR(HMC7044_REG_CH_OUT_CRTL_0(9), 0),
+	SPI_SEQ_WR(HMC7044_REG_CH_OUT_CRTL_0(10), 0),
+	SPI_SEQ_WR(HMC7044_REG_CH_OUT_CRTL_0(11), 0),
+	SPI_SEQ_WR(HMC7044_REG_CH_OUT_CRTL_0(12), 0),
+	SPI_SEQ_WR(HMC7044_REG_CH_OUT_CRTL_0(13), 0),
+	SPI_SEQ_WR(HMC7044_REG_CLK_OUT_DRV_LOW_PW, 0x4d),
+	SPI_SEQ_WR(HMC7044_REG_CLK_OUT_DRV_HIGH_PW, 0xdf),
+	SPI_SEQ_WR(HMC7044_REG_PLL1_DELAY, 0x06),
+	SPI_SEQ_WR(HMC7044_REG_PLL1_HOLDOVER, 0x06),
+	SPI_SEQ_WR(HMC7044_REG_VTUNE_PRESET, 0x04),
+};
+
 /******************************************************************************/
 /************************** Functions Implementation **************************/
 /******************************************************************************/
@@ -289,6 +324,31 @@ int32_t hmc7044_read(struct hmc7044_dev *dev, uint16_t reg, uint8_t *val)
 	return SUCCESS;
 }
 
+/**
+ * Run a register sequence.
+ *
+ * The device takes one data byte per instruction, so the sequence is not
+ * merged into streaming transactions.
+ * @param dev - The device structure.
+ * @param seq - The sequence.
+ * @param num - Number of steps in the sequence.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+static int32_t hmc7044_write_seq(struct hmc7044_dev *dev,
+				 const struct spi_seq_entry *seq,
+				 uint32_t num)
+{
+	const struct spi_seq_config cfg = {
+		.spi = dev->spi_desc,
+		.read_flag = HMC7044_READ,
+		.addr_mask = HMC7044_ADDR(0xFFFF),
+		.addr_ascending = false,
+		.max_stream = 1,
+	};
+
+	return spi_seq_run(&cfg, seq, num);
+}
+
 /**
  * Calculate the output channel divider.
  * @param rate - The desired rate.
@@ -371,8 +431,324 @@ uint32_t hmc7044_clk_set_rate(struct hmc7044_dev *dev, uint32_t chan,
 	if(ret < 0)
 		return ret;
 
-	return hmc7044_write(dev, HMC7044_REG_CH_OUT_CRTL_2(chan),
-			     HMC7044_DIV_MSB(div));
+	ret = hmc7044_write(dev, HMC7044_REG_CH_OUT_CRTL_2(chan),
+			    HMC7044_DIV_MSB(div));
+	if(ret < 0)
+		return ret;
+
+	dev->plan.out_div[chan] = div;
+
+	return SUCCESS;
+}
+
+/**
+ * Fill a register write step of a sequence.
+ * @param e - The sequence step.
+ * @param reg - The register address.
+ * @param val - The register data.
+ */
+static void hmc7044_seq_write(struct spi_seq_entry *e, uint16_t reg,
+			      uint8_t val)
+{
+	e->op = SPI_SEQ_OP_WRITE;
+	e->reg = reg;
+	e->val = val;
+	e->mask = 0xFF;
+}
+
+/**
+ * Fill a delay step of a sequence.
+ * @param e - The sequence step.
+ * @param ms - The delay in milliseconds.
+ */
+static void hmc7044_seq_delay(struct spi_seq_entry *e, uint16_t ms)
+{
+	e->op = SPI_SEQ_OP_DELAY;
+	e->reg = ms;
+	e->val = 0;
+	e->mask = 0;
+}
+
+/**
+ * Check if an output divider is supported.
+ * @param div - The output divider.
+ * @return true if the divider can be programmed, false otherwise.
+ */
+static bool hmc7044_out_div_valid(uint32_t div)
+{
+	if (div < HMC7044_OUT_DIV_MIN || div > HMC7044_OUT_DIV_MAX)
+		return false;
+
+	/* Supported odd divide ratios are 1, 3, and 5 */
+	return !(div % 2) || div == 1 || div == 3 || div == 5;
+}
+
+/**
+ * Least common multiple, saturated above the maximum VCO frequency.
+ * @param a - First operand.
+ * @param b - Second operand.
+ * @return The least common multiple of a and b.
+ */
+static uint64_t hmc7044_lcm(uint64_t a, uint64_t b)
+{
+	uint64_t x = a, y = b, t;
+
+	while (y) {
+		t = x % y;
+		x = y;
+		y = t;
+	}
+
+	a = a / x * b;
+
+	return min_t(uint64_t, a, HMC7044_HIGH_VCO_MAX * 1000ULL + 1);
+}
+
+/**
+ * Compute the exact PLL2 dividers for a VCO frequency.
+ *
+ * fVCO / N2 = fVCXO * doubler / R2, the doubler is preferred since it doubles
+ * the phase detector frequency.
+ * @param plan - The plan, pll2_freq is the input.
+ * @param vcxo_freq - The VCXO frequency in Hz.
+ * @return SUCCESS if the frequency can be synthesized, FAILURE otherwise.
+ */
+static int32_t hmc7044_clk_plan_pll2(struct hmc7044_clk_plan *plan,
+				     uint32_t vcxo_freq)
+{
+	uint64_t fref, n2, r2, a, b, t;
+	uint32_t dbl;
+
+	for (dbl = 2; dbl >= 1; dbl--) {
+		fref = (uint64_t)vcxo_freq * dbl;
+		a = plan->pll2_freq;
+		b = fref;
+		while (b) {
+			t = a % b;
+			a = b;
+			b = t;
+		}
+		n2 = plan->pll2_freq / a;
+		r2 = fref / a;
+
+		while (n2 < HMC7044_N2_MIN && r2 <= HMC7044_R2_MAX / 2) {
+			n2 *= 2;
+			r2 *= 2;
+		}
+		if (n2 < HMC7044_N2_MIN || n2 > HMC7044_N2_MAX ||
+		    r2 > HMC7044_R2_MAX)
+			continue;
+
+		plan->n2 = n2;
+		plan->r2 = r2;
+		plan->doubler_en = (dbl == 2);
+		plan->high_vco_en = plan->pll2_freq >= 1000ULL *
+				    (HMC7044_LOW_VCO_MAX +
+				     HMC7044_HIGH_VCO_MIN) / 2;
+
+		return SUCCESS;
+	}
+
+	return FAILURE;
+}
+
+/**
+ * Evaluate a VCO frequency against a clock plan request.
+ * @param req - The request.
+ * @param pll2_freq - The candidate VCO frequency in Hz.
+ * @param plan - The resulting plan.
+ * @return SUCCESS if all requested frequencies can be generated exactly,
+ *         FAILURE otherwise.
+ */
+static int32_t hmc7044_clk_plan_try(const struct hmc7044_clk_plan_req *req,
+				    uint32_t pll2_freq,
+				    struct hmc7044_clk_plan *plan)
+{
+	uint64_t sysref_div = 1;
+	uint32_t i;
+
+	if (pll2_freq < HMC7044_LOW_VCO_MIN * 1000ULL ||
+	    pll2_freq > HMC7044_HIGH_VCO_MAX * 1000ULL)
+		return FAILURE;
+
+	plan->pll2_freq = pll2_freq;
+	if (hmc7044_clk_plan_pll2(plan, req->vcxo_freq))
+		return FAILURE;
+
+	for (i = 0; i < HMC7044_NUM_CHAN; i++) {
+		plan->out_div[i] = 0;
+		if (!req->out_freq[i])
+			continue;
+		if (pll2_freq % req->out_freq[i])
+			return FAILURE;
+		plan->out_div[i] = pll2_freq / req->out_freq[i];
+		if (!hmc7044_out_div_valid(plan->out_div[i]))
+			return FAILURE;
+		sysref_div = hmc7044_lcm(sysref_div, plan->out_div[i]);
+	}
+
+	/* The SYSREF period has to be a multiple of every output period */
+	if (req->sysref_freq) {
+		if (pll2_freq % req->sysref_freq ||
+		    (pll2_freq / req->sysref_freq) % sysref_div)
+			return FAILURE;
+		sysref_div = pll2_freq / req->sysref_freq;
+	} else {
+		while (pll2_freq / sysref_div > HMC7044_SYSREF_TIMER_FREQ_MAX)
+			sysref_div *= 2;
+	}
+	if (sysref_div > HMC7044_SYSREF_TIMER_DIV_MAX)
+		return FAILURE;
+	plan->sysref_timer_div = sysref_div;
+
+	return SUCCESS;
+}
+
+/**
+ * Compute a clock plan.
+ *
+ * The VCO candidates are the multiples of the least common multiple of the
+ * requested output frequencies. The hinted VCO frequency wins if it is valid,
+ * so a retune that does not need PLL2 to move only touches the dividers.
+ * Otherwise the candidate with the highest PLL2 phase detector frequency is
+ * selected. Only exact solutions are accepted.
+ * @param req - The request.
+ * @param plan - The resulting plan.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t hmc7044_clk_plan_solve(const struct hmc7044_clk_plan_req *req,
+			       struct hmc7044_clk_plan *plan)
+{
+	struct hmc7044_clk_plan cand;
+	uint64_t step = 1;
+	uint64_t freq;
+	bool found = false;
+	uint32_t i;
+
+	if (!req->vcxo_freq)
+		return FAILURE;
+
+	if (req->pll2_freq_hint &&
+	    !hmc7044_clk_plan_try(req, req->pll2_freq_hint, plan))
+		return SUCCESS;
+
+	for (i = 0; i < HMC7044_NUM_CHAN; i++)
+		if (req->out_freq[i])
+			step = hmc7044_lcm(step, req->out_freq[i]);
+	if (req->sysref_freq)
+		step = hmc7044_lcm(step, req->sysref_freq);
+	if (step == 1)
+		return FAILURE;
+
+	freq = DIV_ROUND_UP(HMC7044_LOW_VCO_MIN * 1000ULL, step) * step;
+	for (; freq <= HMC7044_HIGH_VCO_MAX * 1000ULL; freq += step) {
+		if (hmc7044_clk_plan_try(req, freq, &cand))
+			continue;
+		if (found && cand.r2 >= plan->r2)
+			continue;
+		*plan = cand;
+		found = true;
+	}
+
+	return found ? SUCCESS : FAILURE;
+}
+
+/**
+ * Apply a clock plan.
+ *
+ * Only the registers that differ from the currently applied plan are written,
+ * in a single sequence followed by one divider restart. Channels without a
+ * divider in the plan are left untouched.
+ * @param dev - The device structure.
+ * @param plan - The plan, as computed by hmc7044_clk_plan_solve().
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t hmc7044_clk_plan_apply(struct hmc7044_dev *dev,
+			       const struct hmc7044_clk_plan *plan)
+{
+	struct spi_seq_entry seq[HMC7044_PLAN_MAX_WRITES];
+	struct hmc7044_clk_plan *cur = &dev->plan;
+	uint8_t req_mode;
+	uint32_t n = 0;
+	uint32_t i;
+	int32_t ret;
+
+	if (plan->r2 != cur->r2 || plan->n2 != cur->n2 ||
+	    plan->doubler_en != cur->doubler_en ||
+	    plan->high_vco_en != cur->high_vco_en) {
+		hmc7044_seq_write(&seq[n++], HMC7044_REG_EN_CTRL_0,
+				  HMC7044_RF_RESEEDER_EN |
+				  HMC7044_VCO_SEL(plan->high_vco_en ?
+						  HMC7044_VCO_HIGH :
+						  HMC7044_VCO_LOW) |
+				  HMC7044_SYSREF_TIMER_EN | HMC7044_PLL2_EN |
+				  HMC7044_PLL1_EN);
+		hmc7044_seq_write(&seq[n++], HMC7044_REG_PLL2_R_LSB,
+				  HMC7044_R2_LSB(plan->r2));
+		hmc7044_seq_write(&seq[n++], HMC7044_REG_PLL2_R_MSB,
+				  HMC7044_R2_MSB(plan->r2));
+		hmc7044_seq_write(&seq[n++], HMC7044_REG_PLL2_N_LSB,
+				  HMC7044_N2_LSB(plan->n2));
+		hmc7044_seq_write(&seq[n++], HMC7044_REG_PLL2_N_MSB,
+				  HMC7044_N2_MSB(plan->n2));
+		hmc7044_seq_write(&seq[n++], HMC7044_REG_PLL2_FREQ_DOUBLER,
+				  plan->doubler_en ?
+				  0 : HMC7044_PLL2_FREQ_DOUBLER_DIS);
+	}
+
+	if (plan->sysref_timer_div != cur->sysref_timer_div) {
+		hmc7044_seq_write(&seq[n++], HMC7044_REG_SYSREF_TIMER_LSB,
+				  HMC7044_SYSREF_TIMER_LSB(plan->sysref_timer_div));
+		hmc7044_seq_write(&seq[n++], HMC7044_REG_SYSREF_TIMER_MSB,
+				  HMC7044_SYSREF_TIMER_MSB(plan->sysref_timer_div));
+	}
+
+	for (i = 0; i < HMC7044_NUM_CHAN; i++) {
+		if (!plan->out_div[i] || plan->out_div[i] == cur->out_div[i])
+			continue;
+		hmc7044_seq_write(&seq[n++], HMC7044_REG_CH_OUT_CRTL_1(i),
+				  HMC7044_DIV_LSB(plan->out_div[i]));
+		hmc7044_seq_write(&seq[n++], HMC7044_REG_CH_OUT_CRTL_2(i),
+				  HMC7044_DIV_MSB(plan->out_div[i]));
+	}
+
+	if (!n)
+		return SUCCESS;
+
+	/* Do a restart to resynchronize the dividers */
+	req_mode = (dev->high_performance_mode_clock_dist_en ?
+		    HMC7044_HIGH_PERF_DISTRIB_PATH : 0) |
+		   (dev->high_performance_mode_pll_vco_en ?
+		    HMC7044_HIGH_PERF_PLL_VCO : 0);
+	hmc7044_seq_write(&seq[n++], HMC7044_REG_REQ_MODE_0,
+			  HMC7044_RESTART_DIV_FSM);
+	hmc7044_seq_delay(&seq[n++], 1);
+	hmc7044_seq_write(&seq[n++], HMC7044_REG_REQ_MODE_0, req_mode);
+	hmc7044_seq_delay(&seq[n++], 1);
+
+	ret = hmc7044_write_seq(dev, seq, n);
+	if (ret < 0)
+		return ret;
+
+	for (i = 0; i < HMC7044_NUM_CHAN; i++)
+		if (plan->out_div[i])
+			cur->out_div[i] = plan->out_div[i];
+	cur->pll2_freq = plan->pll2_freq;
+	cur->r2 = plan->r2;
+	cur->n2 = plan->n2;
+	cur->doubler_en = plan->doubler_en;
+	cur->high_vco_en = plan->high_vco_en;
+	cur->sysref_timer_div = plan->sysref_timer_div;
+
+	dev->pll2_freq = plan->pll2_freq;
+	dev->sysref_timer_div = plan->sysref_timer_div;
+	for (i = 0; i < dev->num_channels; i++)
+		if (dev->channels[i].num < HMC7044_NUM_CHAN &&
+		    plan->out_div[dev->channels[i].num])
+			dev->channels[i].divider =
+				plan->out_div[dev->channels[i].num];
+
+	return SUCCESS;
 }
 
 /**
@@ -395,6 +771,7 @@ static int32_t hmc7044_setup(struct hmc7044_dev *dev)
 	uint32_t vco_limit;
 	uint32_t n2[2], r2[2];
 	uint32_t i, ref_en = 0;
+	int32_t ret;
 
 	vcxo_freq = dev->vcxo_freq / 1000;
 	pll2_freq = dev->pll2_freq / 1000;
@@ -478,21 +855,10 @@ static int32_t hmc7044_setup(struct hmc7044_dev *dev)
 		return -FAILURE;
 
 	/* Resets all registers to default values */
-	hmc7044_write(dev, HMC7044_REG_SOFT_RESET, HMC7044_SOFT_RESET);
-	mdelay(10);
-	hmc7044_write(dev, HMC7044_REG_SOFT_RESET, 0);
-	mdelay(10);
-
-	/* Disable all channels */
-	for (i = 0; i < HMC7044_NUM_CHAN; i++)
-		hmc7044_write(dev, HMC7044_REG_CH_OUT_CRTL_0(i), 0);
-
-	/* Load the configuration updates (provided by Analog Devices) */
-	hmc7044_write(dev, HMC7044_REG_CLK_OUT_DRV_LOW_PW, 0x4d);
-	hmc7044_write(dev, HMC7044_REG_CLK_OUT_DRV_HIGH_PW, 0xdf);
-	hmc7044_write(dev, HMC7044_REG_PLL1_DELAY, 0x06);
-	hmc7044_write(dev, HMC7044_REG_PLL1_HOLDOVER, 0x06);
-	hmc7044_write(dev, HMC7044_REG_VTUNE_PRESET, 0x04);
+	ret = hmc7044_write_seq(dev, hmc7044_reset_seq,
+				ARRAY_SIZE(hmc7044_reset_seq));
+	if (ret < 0)
+		return ret;
 
 	hmc7044_write(dev, HMC7044_REG_GLOB_MODE,
 		      HMC7044_SYNC_PIN_MODE(dev->sync_pin_mode) |
@@ -624,6 +990,21 @@ static int32_t hmc7044_setup(struct hmc7044_dev *dev)
 	}
 	mdelay(10);
 
+	/* Keep track of the programmed settings for hmc7044_clk_plan_apply() */
+	dev->plan.pll2_freq = dev->pll2_freq;
+	dev->plan.r2 = r2[0];
+	dev->plan.n2 = n2[0];
+	dev->plan.doubler_en = pll2_freq_doubler_en;
+	dev->plan.high_vco_en = high_vco_en;
+	dev->plan.sysref_timer_div = dev->sysref_timer_div;
+	for (i = 0; i < HMC7044_NUM_CHAN; i++)
+		dev->plan.out_div[i] = 0;
+	for (i = 0; i < dev->num_channels; i++) {
+		chan = &dev->channels[i];
+		if (chan->num < HMC7044_NUM_CHAN && !chan->disable)
+			dev->plan.out_div[chan->num] = chan->divider;
+	}
+
 	/* Do a restart to reset the system and initiate calibration */
 	hmc7044_write(dev, HMC7044_REG_REQ_MODE_0,
 		      HMC7044_RESTART_DIV_FSM);
@@ -47,6 +47,11 @@
 #include "delay.h"
 #include "spi.h"
 
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define HMC7044_NUM_CHAN	14
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -66,6 +71,42 @@ struct hmc7044_chan_spec {
 	unsigned int	out_mux_mode;
 };
 
+/**
+ * @struct hmc7044_clk_plan
+ * @brief PLL2, SYSREF timer and output divider settings of the device.
+ */
+struct hmc7044_clk_plan {
+	/** PLL2 VCO frequency in Hz */
+	uint32_t	pll2_freq;
+	/** PLL2 reference divider */
+	uint32_t	r2;
+	/** PLL2 feedback divider */
+	uint32_t	n2;
+	/** PLL2 reference doubler enable */
+	bool		doubler_en;
+	/** High VCO range select */
+	bool		high_vco_en;
+	/** SYSREF timer divider */
+	uint32_t	sysref_timer_div;
+	/** Output dividers by channel number, 0 if the channel is unused */
+	uint32_t	out_div[HMC7044_NUM_CHAN];
+};
+
+/**
+ * @struct hmc7044_clk_plan_req
+ * @brief Frequencies requested from the clock plan solver.
+ */
+struct hmc7044_clk_plan_req {
+	/** VCXO frequency in Hz */
+	uint32_t	vcxo_freq;
+	/** Output frequencies in Hz by channel number, 0 if unused */
+	uint32_t	out_freq[HMC7044_NUM_CHAN];
+	/** SYSREF frequency in Hz, 0 to pick the fastest valid one */
+	uint32_t	sysref_freq;
+	/** Preferred VCO frequency in Hz, kept if it satisfies the request */
+	uint32_t	pll2_freq_hint;
+};
+
 struct hmc7044_dev {
 	spi_desc	*spi_desc;
 	uint32_t	clkin_freq[4];
@@ -87,6 +128,7 @@ struct hmc7044_dev {
 	uint32_t	gpo_ctrl[4];
 	uint32_t	num_channels;
 	struct hmc7044_chan_spec	*channels;
+	struct hmc7044_clk_plan	plan;
 };
 
 struct hmc7044_init_param {
@@ -127,5 +169,11 @@ uint32_t hmc7044_clk_round_rate(struct hmc7044_dev *dev, uint32_t rate,
 				uint32_t parent_rate);
 uint32_t hmc7044_clk_set_rate(struct hmc7044_dev *dev, uint32_t chan,
 			      uint32_t rate);
+/* Compute the PLL2, SYSREF timer and divider settings for a request. */
+int32_t hmc7044_clk_plan_solve(const struct hmc7044_clk_plan_req *req,
+			       struct hmc7044_clk_plan *plan);
+/* Program the registers that differ from the current plan. */
+int32_t hmc7044_clk_plan_apply(struct hmc7044_dev *dev,
+			       const struct hmc7044_clk_plan *plan);
 
 #endif // HMC7044_H_
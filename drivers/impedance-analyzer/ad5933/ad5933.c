@@ -41,7 +41,9 @@
 /***************************** Include Files *********************************/
 /*****************************************************************************/
 #include <stdlib.h>
+#include <errno.h>
 #include "ad5933.h"
+#include "error.h"
 #include <math.h>
 
 /******************************************************************************/
@@ -165,6 +167,41 @@ uint32_t ad5933_get_register_value(struct ad5933_dev *dev,
 	return register_value;
 }
 
+/***************************************************************************//**
+ * @brief Reads consecutive registers using a single block read transaction.
+ *
+ * @param dev              - The device structure.
+ * @param register_address - Address of the first register.
+ * @param data             - Buffer for the register values.
+ * @param bytes_number     - Number of bytes.
+ *
+ * @return SUCCESS in case of success, negative error code otherwise.
+*******************************************************************************/
+static int32_t ad5933_block_read(struct ad5933_dev *dev,
+				 uint8_t register_address,
+				 uint8_t *data,
+				 uint8_t bytes_number)
+{
+	uint8_t write_data[2];
+	int32_t ret;
+
+	/* Set the register pointer. */
+	write_data[0] = AD5933_ADDR_POINTER;
+	write_data[1] = register_address;
+	ret = i2c_write(dev->i2c_desc, write_data, 2, 1);
+	if (ret != SUCCESS)
+		return ret;
+
+	/* Block read command followed by a repeated start. */
+	write_data[0] = AD5933_BLOCK_READ;
+	write_data[1] = bytes_number;
+	ret = i2c_write(dev->i2c_desc, write_data, 2, 0);
+	if (ret != SUCCESS)
+		return ret;
+
+	return i2c_read(dev->i2c_desc, data, bytes_number, 1);
+}
+
 /***************************************************************************//**
  * @brief Resets the device.
  *
@@ -457,3 +494,212 @@ double ad5933_calculate_impedance(struct ad5933_dev *dev,
 
 	return impedance;
 }
+
+/***************************************************************************//**
+ * @brief Configures the device and starts an asynchronous sweep.
+ *
+ * The function only issues the sweep commands and returns; the points are
+ * collected by ad5933_sweep_process().
+ *
+ * @param dev   - The device structure.
+ * @param sweep - Sweep settings and result buffer.
+ *
+ * @return SUCCESS in case of success, negative error code otherwise.
+*******************************************************************************/
+int32_t ad5933_sweep_start(struct ad5933_dev *dev,
+			   struct ad5933_sweep *sweep)
+{
+	if (!sweep->points || sweep->inc_num > AD5933_MAX_INC_NUM)
+		return -EINVAL;
+
+	sweep->count = 0;
+
+	ad5933_config_sweep(dev,
+			    sweep->start_freq,
+			    sweep->inc_freq,
+			    sweep->inc_num);
+	ad5933_set_register_value(dev,
+				  AD5933_REG_CONTROL_HB,
+				  AD5933_CONTROL_FUNCTION(AD5933_FUNCTION_STANDBY) |
+				  AD5933_CONTROL_RANGE(dev->current_range) |
+				  AD5933_CONTROL_PGA_GAIN(dev->current_gain),
+				  1);
+	ad5933_reset(dev);
+	ad5933_set_register_value(dev,
+				  AD5933_REG_CONTROL_HB,
+				  AD5933_CONTROL_FUNCTION(AD5933_FUNCTION_INIT_START_FREQ)|
+				  AD5933_CONTROL_RANGE(dev->current_range) |
+				  AD5933_CONTROL_PGA_GAIN(dev->current_gain),
+				  1);
+	ad5933_set_register_value(dev,
+				  AD5933_REG_CONTROL_HB,
+				  AD5933_CONTROL_FUNCTION(AD5933_FUNCTION_START_SWEEP) |
+				  AD5933_CONTROL_RANGE(dev->current_range) |
+				  AD5933_CONTROL_PGA_GAIN(dev->current_gain),
+				  1);
+
+	return SUCCESS;
+}
+
+/***************************************************************************//**
+ * @brief Collects the next sweep point if available and advances the sweep.
+ *
+ * The status register is polled first, the real and imaginary data are then
+ * fetched with one block read. When a point is ready it is stored and the
+ * next frequency increment is issued.
+ * Intended to be called from a periodic task while the device settles and
+ * converts the next point.
+ *
+ * @param dev   - The device structure.
+ * @param sweep - Sweep started with ad5933_sweep_start().
+ *
+ * @return SUCCESS once the sweep has completed, -EAGAIN while points are
+ *         still pending, negative error code otherwise.
+*******************************************************************************/
+int32_t ad5933_sweep_process(struct ad5933_dev *dev,
+			     struct ad5933_sweep *sweep)
+{
+	uint8_t data[AD5933_SWEEP_BLOCK_LEN];
+	struct ad5933_sweep_point *point;
+	uint8_t status;
+	int32_t ret;
+
+	if (sweep->count > sweep->inc_num)
+		return SUCCESS;
+
+	status = ad5933_get_register_value(dev, AD5933_REG_STATUS, 1);
+	if (!(status & AD5933_STAT_DATA_VALID))
+		return -EAGAIN;
+
+	ret = ad5933_block_read(dev, AD5933_REG_REAL_DATA, data, sizeof(data));
+	if (ret != SUCCESS)
+		return ret;
+
+	point = &sweep->points[sweep->count];
+	point->freq = sweep->start_freq + sweep->count * sweep->inc_freq;
+	point->real = (int16_t)((data[0] << 8) | data[1]);
+	point->imag = (int16_t)((data[2] << 8) | data[3]);
+	sweep->count++;
+
+	if ((status & AD5933_STAT_SWEEP_DONE) || sweep->count > sweep->inc_num) {
+		ad5933_set_register_value(dev,
+					  AD5933_REG_CONTROL_HB,
+					  AD5933_CONTROL_FUNCTION(AD5933_FUNCTION_STANDBY) |
+					  AD5933_CONTROL_RANGE(dev->current_range) |
+					  AD5933_CONTROL_PGA_GAIN(dev->current_gain),
+					  1);
+		return SUCCESS;
+	}
+
+	ad5933_set_register_value(dev,
+				  AD5933_REG_CONTROL_HB,
+				  AD5933_CONTROL_FUNCTION(AD5933_FUNCTION_INC_FREQ) |
+				  AD5933_CONTROL_RANGE(dev->current_range) |
+				  AD5933_CONTROL_PGA_GAIN(dev->current_gain),
+				  1);
+
+	return -EAGAIN;
+}
+
+/***************************************************************************//**
+ * @brief Runs a whole sweep, polling the device until it completes.
+ *
+ * @param dev   - The device structure.
+ * @param sweep - Sweep settings and result buffer.
+ *
+ * @return SUCCESS in case of success, negative error code otherwise.
+*******************************************************************************/
+int32_t ad5933_sweep_run(struct ad5933_dev *dev,
+			 struct ad5933_sweep *sweep)
+{
+	int32_t ret;
+
+	ret = ad5933_sweep_start(dev, sweep);
+	if (ret != SUCCESS)
+		return ret;
+
+	do {
+		ret = ad5933_sweep_process(dev, sweep);
+	} while (ret == -EAGAIN);
+
+	return ret;
+}
+
+/***************************************************************************//**
+ * @brief Computes gain factor and system phase for each point of a sweep
+ *        performed on a known calibration impedance.
+ *
+ * @param points                - Calibration sweep points.
+ * @param nb_points             - Number of points.
+ * @param calibration_impedance - The calibration impedance value.
+ * @param gain_factor           - Output, one gain factor per point.
+ * @param system_phase          - Output, one system phase (rad) per point.
+ *                                May be NULL.
+ *
+ * @return None.
+*******************************************************************************/
+void ad5933_sweep_calibrate(const struct ad5933_sweep_point *points,
+			    uint16_t nb_points,
+			    float calibration_impedance,
+			    float *gain_factor,
+			    float *system_phase)
+{
+	float real;
+	float imag;
+	uint16_t i;
+
+	for (i = 0; i < nb_points; i++) {
+		real = points[i].real;
+		imag = points[i].imag;
+		gain_factor[i] = 1.0f / (sqrtf(real * real + imag * imag) *
+					 calibration_impedance);
+	}
+
+	if (!system_phase)
+		return;
+
+	for (i = 0; i < nb_points; i++)
+		system_phase[i] = atan2f(points[i].imag, points[i].real);
+}
+
+/***************************************************************************//**
+ * @brief Computes impedance magnitude and phase for each point of a sweep,
+ *        using the per point calibration of ad5933_sweep_calibrate().
+ *
+ * @param points       - Sweep points.
+ * @param nb_points    - Number of points.
+ * @param gain_factor  - Gain factor of each point.
+ * @param system_phase - System phase of each point. May be NULL.
+ * @param impedance    - Output, impedance magnitude of each point.
+ * @param phase        - Output, impedance phase (rad) of each point. May be
+ *                       NULL.
+ *
+ * @return None.
+*******************************************************************************/
+void ad5933_sweep_impedance(const struct ad5933_sweep_point *points,
+			    uint16_t nb_points,
+			    const float *gain_factor,
+			    const float *system_phase,
+			    float *impedance,
+			    float *phase)
+{
+	float real;
+	float imag;
+	uint16_t i;
+
+	for (i = 0; i < nb_points; i++) {
+		real = points[i].real;
+		imag = points[i].imag;
+		impedance[i] = 1.0f / (sqrtf(real * real + imag * imag) *
+				       gain_factor[i]);
+	}
+
+	if (!phase)
+		return;
+
+	for (i = 0; i < nb_points; i++) {
+		phase[i] = atan2f(points[i].imag, points[i].real);
+		if (system_phase)
+			phase[i] -= system_phase[i];
+	}
+}
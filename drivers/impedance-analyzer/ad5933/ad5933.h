@@ -108,6 +108,10 @@
 #define AD5933_INTERNAL_SYS_CLK     16000000ul      // 16MHz
 #define AD5933_MAX_INC_NUM          511             // Maximum increment number
 
+/* Real and imaginary data in a single block read */
+#define AD5933_SWEEP_BLOCK_LEN      (AD5933_REG_IMAG_DATA + 2 - \
+				     AD5933_REG_REAL_DATA)
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -122,6 +126,25 @@ struct ad5933_dev {
 	uint8_t current_range;
 };
 
+struct ad5933_sweep_point {
+	/* Excitation frequency in Hz */
+	uint32_t freq;
+	/* Raw DFT result */
+	int16_t real;
+	int16_t imag;
+};
+
+struct ad5933_sweep {
+	/* Sweep Settings */
+	uint32_t start_freq;
+	uint32_t inc_freq;
+	uint16_t inc_num;
+	/* Caller provided buffer of at least inc_num + 1 points */
+	struct ad5933_sweep_point *points;
+	/* Number of points acquired so far */
+	uint16_t count;
+};
+
 struct ad5933_init_param {
 	/* I2C */
 	i2c_init_param	i2c_init;
@@ -189,4 +212,32 @@ double ad5933_calculate_impedance(struct ad5933_dev *dev,
 				  double gain_factor,
 				  uint8_t freq_function);
 
+/*! Configures the device and starts an asynchronous sweep. */
+int32_t ad5933_sweep_start(struct ad5933_dev *dev,
+			   struct ad5933_sweep *sweep);
+
+/*! Collects the next sweep point if available and advances the sweep. */
+int32_t ad5933_sweep_process(struct ad5933_dev *dev,
+			     struct ad5933_sweep *sweep);
+
+/*! Runs a whole sweep, polling the device until it completes. */
+int32_t ad5933_sweep_run(struct ad5933_dev *dev,
+			 struct ad5933_sweep *sweep);
+
+/*! Computes gain factor and system phase for each point of a calibration
+ *  sweep. */
+void ad5933_sweep_calibrate(const struct ad5933_sweep_point *points,
+			    uint16_t nb_points,
+			    float calibration_impedance,
+			    float *gain_factor,
+			    float *system_phase);
+
+/*! Computes impedance magnitude and phase for each point of a sweep. */
+void ad5933_sweep_impedance(const struct ad5933_sweep_point *points,
+			    uint16_t nb_points,
+			    const float *gain_factor,
+			    const float *system_phase,
+			    float *impedance,
+			    float *phase);
+
 #endif /* __AD5933_H__ */
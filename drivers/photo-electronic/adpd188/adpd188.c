@@ -42,6 +42,7 @@
 /******************************************************************************/
 
 #include <stdlib.h>
+#include <string.h>
 #include "adpd188.h"
 #include "error.h"
 #include "delay.h"
@@ -284,6 +285,50 @@ int32_t adpd188_fifo_status_get(struct adpd188_dev *dev, uint8_t *bytes_no)
 	return SUCCESS;
 }
 
+/**
+ * @brief Read 16 bit words from the FIFO in a single transaction. The
+ *        FIFO_ACCESS register is read repeatedly, each access returning the
+ *        next word.
+ * @param dev - The ADPD188 descriptor.
+ * @param data - The read words.
+ * @param word_no - Number of words to read, up to ADPD188_FIFO_SIZE / 2.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t adpd188_fifo_read(struct adpd188_dev *dev, uint16_t *data,
+			  uint8_t word_no)
+{
+	int32_t ret;
+	uint8_t buff[1 + ADPD188_FIFO_SIZE];
+	uint8_t reg_addr = ADPD188_REG_FIFO_ACCESS;
+	uint8_t i;
+
+	if(!word_no)
+		return SUCCESS;
+	if(word_no > ADPD188_FIFO_SIZE / 2)
+		return FAILURE;
+
+	if(dev->phy_opt == ADPD188_SPI) {
+		memset(buff, 0, 1 + word_no * 2);
+		buff[0] = (reg_addr << 1) & 0xFE;
+		ret = spi_write_and_read(dev->phy_desc, buff, 1 + word_no * 2);
+	} else if(dev->phy_opt == ADPD188_I2C) {
+		ret = i2c_write(dev->phy_desc, &reg_addr, 1, 0);
+		if(ret != SUCCESS)
+			return FAILURE;
+		/* Same layout as in the SPI case, see adpd188_reg_read(). */
+		ret = i2c_read(dev->phy_desc, (buff + 1), word_no * 2, 1);
+	} else {
+		ret = FAILURE;
+	}
+	if(ret != SUCCESS)
+		return FAILURE;
+
+	for(i = 0; i < word_no; i++)
+		data[i] = (buff[1 + i * 2] << 8) | buff[2 + i * 2];
+
+	return SUCCESS;
+}
+
 /**
  * @brief Empty the FIFO.
  * @param dev - The ADPD188 descriptor.
@@ -595,7 +640,7 @@ int32_t adpd188_slot_setup(struct adpd188_dev *dev,
 		reg_data &= ~ADPD188_SLOT_EN_SLOTA_FIFO_MODE_MASK;
 		reg_data |= (config.sot_fifo_mode <<
 			     ADPD188_SLOT_EN_SLOTA_FIFO_MODE_POS) &
-			    ADPD188_SLOT_EN_SLOTA_FIFO_MODE_POS;
+			    ADPD188_SLOT_EN_SLOTA_FIFO_MODE_MASK;
 	} else if(config.slot_id == ADPD188_SLOTB) {
 		reg_data &= ~ADPD188_SLOT_EN_SLOTB_EN_MASK;
 		reg_data |= (config.slot_en << ADPD188_SLOT_EN_SLOTB_EN_POS) &
@@ -603,7 +648,7 @@ int32_t adpd188_slot_setup(struct adpd188_dev *dev,
 		reg_data &= ~ADPD188_SLOT_EN_SLOTB_FIFO_MODE_MASK;
 		reg_data |= (config.sot_fifo_mode <<
 			     ADPD188_SLOT_EN_SLOTB_FIFO_MODE_POS) &
-			    ADPD188_SLOT_EN_SLOTB_FIFO_MODE_POS;
+			    ADPD188_SLOT_EN_SLOTB_FIFO_MODE_MASK;
 	}
 
 	return adpd188_reg_write(dev, ADPD188_REG_SLOT_EN, reg_data);
@@ -874,3 +919,275 @@ int32_t adpd188_smoke_detect_setup(struct adpd188_dev *dev)
 
 	return adpd188_reg_write(dev, ADPD188_REG_MATH, reg_data);
 }
+
+/**
+ * @brief Get the number of FIFO words a time slot writes per sampling period.
+ * @param mode - The FIFO mode of the slot.
+ * @return The number of words, or 0xFF for a reserved mode.
+ */
+static uint8_t adpd188_slot_fifo_words(enum adpd188_slot_fifo_mode mode)
+{
+	switch(mode) {
+	case ADPD188_NO_FIFO:
+		return 0;
+	case ADPD188_16BIT_SUM:
+		return 1;
+	case ADPD188_32BIT_SUM:
+		return 2;
+	case ADPD188_16BIT_4CHAN:
+		return 4;
+	case ADPD188_32BIT_4CHAN:
+		return 8;
+	default:
+		return 0xFF;
+	}
+}
+
+/**
+ * @brief Get the number of FIFO words written per sampling period.
+ * @param stream - The FIFO stream.
+ * @return The number of words.
+ */
+static uint8_t adpd188_fifo_record_words(struct adpd188_fifo_stream *stream)
+{
+	return adpd188_slot_fifo_words(stream->slot_mode[ADPD188_SLOTA]) +
+	       adpd188_slot_fifo_words(stream->slot_mode[ADPD188_SLOTB]);
+}
+
+/**
+ * @brief Decode the FIFO words of one time slot. 32 bit values are written
+ *        to the FIFO low word first.
+ * @param mode - The FIFO mode of the slot.
+ * @param words - The FIFO words of the slot.
+ * @param sample - The decoded sample.
+ * @return None.
+ */
+static void adpd188_fifo_decode(enum adpd188_slot_fifo_mode mode,
+				const uint16_t *words,
+				struct adpd188_sample *sample)
+{
+	uint8_t i;
+
+	switch(mode) {
+	case ADPD188_16BIT_SUM:
+		sample->chan_no = 1;
+		sample->data[0] = words[0];
+		break;
+	case ADPD188_32BIT_SUM:
+		sample->chan_no = 1;
+		sample->data[0] = words[0] | ((uint32_t)words[1] << 16);
+		break;
+	case ADPD188_16BIT_4CHAN:
+		sample->chan_no = 4;
+		for(i = 0; i < 4; i++)
+			sample->data[i] = words[i];
+		break;
+	case ADPD188_32BIT_4CHAN:
+		sample->chan_no = 4;
+		for(i = 0; i < 4; i++)
+			sample->data[i] = words[2 * i] |
+					  ((uint32_t)words[2 * i + 1] << 16);
+		break;
+	default:
+		sample->chan_no = 0;
+		break;
+	}
+}
+
+/**
+ * @brief Start interrupt driven FIFO streaming. The slot FIFO modes are taken
+ *        from the device, the FIFO threshold is set to stream->periods
+ *        sampling periods and the FIFO interrupt is routed to the selected
+ *        GPIO, whose edge must call adpd188_fifo_stream_isr(), and the main
+ *        loop adpd188_fifo_stream_process(). Call it in program mode, then
+ *        switch to normal mode.
+ * @param dev - The ADPD188 descriptor.
+ * @param stream - The FIFO stream, with the ring, periods and gpio_id set.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t adpd188_fifo_stream_start(struct adpd188_dev *dev,
+				  struct adpd188_fifo_stream *stream)
+{
+	int32_t ret;
+	uint16_t reg_data;
+	uint8_t record_words;
+
+	if(!stream || !stream->ring || (stream->ring_size < 2) ||
+	    !stream->periods)
+		return FAILURE;
+
+	ret = adpd188_reg_read(dev, ADPD188_REG_SLOT_EN, &reg_data);
+	if(ret != SUCCESS)
+		return FAILURE;
+
+	stream->slot_mode[ADPD188_SLOTA] = ADPD188_NO_FIFO;
+	if(reg_data & ADPD188_SLOT_EN_SLOTA_EN_MASK)
+		stream->slot_mode[ADPD188_SLOTA] =
+			(reg_data & ADPD188_SLOT_EN_SLOTA_FIFO_MODE_MASK) >>
+			ADPD188_SLOT_EN_SLOTA_FIFO_MODE_POS;
+	stream->slot_mode[ADPD188_SLOTB] = ADPD188_NO_FIFO;
+	if(reg_data & ADPD188_SLOT_EN_SLOTB_EN_MASK)
+		stream->slot_mode[ADPD188_SLOTB] =
+			(reg_data & ADPD188_SLOT_EN_SLOTB_FIFO_MODE_MASK) >>
+			ADPD188_SLOT_EN_SLOTB_FIFO_MODE_POS;
+
+	if((adpd188_slot_fifo_words(stream->slot_mode[ADPD188_SLOTA]) == 0xFF) ||
+	    (adpd188_slot_fifo_words(stream->slot_mode[ADPD188_SLOTB]) == 0xFF))
+		return FAILURE;
+
+	record_words = adpd188_fifo_record_words(stream);
+	if(!record_words ||
+	    (stream->periods * record_words > ADPD188_FIFO_SIZE / 2))
+		return FAILURE;
+
+	stream->head = 0;
+	stream->tail = 0;
+	stream->dropped = 0;
+	stream->overruns = 0;
+
+	ret = adpd188_fifo_thresh_set(dev, stream->periods * record_words - 1);
+	if(ret != SUCCESS)
+		return FAILURE;
+	ret = adpd188_gpio_alt_setup(dev, stream->gpio_id, ADPD188_INT_FUNC);
+	if(ret != SUCCESS)
+		return FAILURE;
+	ret = adpd188_fifo_clear(dev);
+	if(ret != SUCCESS)
+		return FAILURE;
+
+	dev->irq_pending = 0;
+	dev->stream = stream;
+
+	return adpd188_interrupt_en(dev, ADPD188_FIFO_INT);
+}
+
+/**
+ * @brief Drain the complete sampling periods present in the FIFO and decode
+ *        them into the stream ring, once adpd188_fifo_stream_isr() latched
+ *        an interrupt. Costs a status read and a single burst read, whatever
+ *        the number of words.
+ * @param dev - The ADPD188 descriptor.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t adpd188_fifo_stream_process(struct adpd188_dev *dev)
+{
+	struct adpd188_fifo_stream *stream = dev->stream;
+	struct adpd188_sample *sample;
+	uint16_t words[ADPD188_FIFO_SIZE / 2];
+	uint8_t bytes_no, record_words, word_no, i, slot;
+	uint16_t next;
+	int32_t ret;
+
+	if(!stream)
+		return FAILURE;
+
+	if(!dev->irq_pending)
+		return SUCCESS;
+	dev->irq_pending = 0;
+
+	ret = adpd188_fifo_status_get(dev, &bytes_no);
+	if(ret != SUCCESS)
+		return FAILURE;
+	if(bytes_no >= ADPD188_FIFO_SIZE)
+		stream->overruns++;
+
+	record_words = adpd188_fifo_record_words(stream);
+	word_no = (bytes_no / 2) / record_words * record_words;
+	if(!word_no)
+		return SUCCESS;
+
+	ret = adpd188_fifo_read(dev, words, word_no);
+	if(ret != SUCCESS)
+		return FAILURE;
+
+	i = 0;
+	while(i < word_no) {
+		for(slot = ADPD188_SLOTA; slot <= ADPD188_SLOTB; slot++) {
+			if(stream->slot_mode[slot] == ADPD188_NO_FIFO)
+				continue;
+
+			next = (stream->head + 1) % stream->ring_size;
+			if(next == stream->tail) {
+				stream->dropped++;
+			} else {
+				sample = &stream->ring[stream->head];
+				sample->slot = slot;
+				adpd188_fifo_decode(stream->slot_mode[slot],
+						    &words[i], sample);
+				stream->head = next;
+			}
+			i += adpd188_slot_fifo_words(stream->slot_mode[slot]);
+		}
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief FIFO threshold interrupt handler, to be registered with
+ *        irq_register_callback() for the GPIO selected in the stream. It
+ *        only latches the event, the FIFO is read by
+ *        adpd188_fifo_stream_process() so the bus is used from one context.
+ * @param ctx - The ADPD188 descriptor.
+ * @param event - Unused.
+ * @param extra - Unused.
+ * @return None.
+ */
+void adpd188_fifo_stream_isr(void *ctx, uint32_t event, void *extra)
+{
+	((struct adpd188_dev *)ctx)->irq_pending = 1;
+}
+
+/**
+ * @brief Take decoded samples out of the stream ring, oldest first.
+ * @param dev - The ADPD188 descriptor.
+ * @param samples - Array receiving the samples.
+ * @param max_samples - Size of the array.
+ * @param count - Number of samples taken.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t adpd188_fifo_stream_read(struct adpd188_dev *dev,
+				 struct adpd188_sample *samples,
+				 uint16_t max_samples, uint16_t *count)
+{
+	struct adpd188_fifo_stream *stream = dev->stream;
+	uint16_t tail, head;
+
+	*count = 0;
+	if(!stream)
+		return FAILURE;
+
+	tail = stream->tail;
+	head = stream->head;
+	while((tail != head) && (*count < max_samples)) {
+		samples[(*count)++] = stream->ring[tail];
+		tail = (tail + 1) % stream->ring_size;
+	}
+	stream->tail = tail;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Stop FIFO streaming and mask the FIFO interrupt.
+ * @param dev - The ADPD188 descriptor.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t adpd188_fifo_stream_stop(struct adpd188_dev *dev)
+{
+	int32_t ret;
+	uint16_t reg_data;
+
+	if(!dev->stream)
+		return FAILURE;
+
+	dev->stream = NULL;
+	dev->irq_pending = 0;
+
+	ret = adpd188_reg_read(dev, ADPD188_REG_INT_MASK, &reg_data);
+	if(ret != SUCCESS)
+		return FAILURE;
+	reg_data |= ADPD188_INT_MASK_FIFO_INT_MASK_MASK;
+
+	return adpd188_reg_write(dev, ADPD188_REG_INT_MASK, reg_data);
+}
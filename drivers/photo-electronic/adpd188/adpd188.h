@@ -178,6 +178,9 @@
 #define ADPD188_FIFO_THRESH_FIFO_THRESH_POS	8
 #define ADPD188_FIFO_THRESH_MAX_THRESHOLD	63
 
+/* FIFO depth, in bytes */
+#define ADPD188_FIFO_SIZE			128
+
 /* ADPD188_REG_DEVID */
 #define ADPD188_DEVID_REV_NUM_MASK	0xFF00
 #define ADPD188_DEVID_DEV_ID_MASK	0x00FF
@@ -636,6 +639,46 @@ struct adpd188_slot_config {
 	enum adpd188_slot_fifo_mode sot_fifo_mode;
 };
 
+/**
+ * @struct adpd188_sample
+ * @brief One time slot sample decoded from the FIFO.
+ */
+struct adpd188_sample {
+	/** Time slot that produced the sample. */
+	enum adpd188_slots slot;
+	/** Number of valid entries in data: 1 for the sum modes, 4 otherwise. */
+	uint8_t chan_no;
+	/** Channel data, or the sum of the four channels in data[0]. */
+	uint32_t data[4];
+};
+
+/**
+ * @struct adpd188_fifo_stream
+ * @brief FIFO streaming state. The user sets the ring, the number of sampling
+ *        periods per interrupt and the GPIO, the rest is managed by the
+ *        driver.
+ */
+struct adpd188_fifo_stream {
+	/** Ring of decoded samples, holding ring_size - 1 samples. */
+	struct adpd188_sample *ring;
+	/** Number of entries of the ring. */
+	uint16_t ring_size;
+	/** Sampling periods gathered in the FIFO before an interrupt. */
+	uint8_t periods;
+	/** ADPD188 GPIO (0 or 1) wired to the host interrupt line. */
+	uint8_t gpio_id;
+	/** Ring write index. */
+	volatile uint16_t head;
+	/** Ring read index. */
+	volatile uint16_t tail;
+	/** Samples lost because the ring was full. */
+	uint32_t dropped;
+	/** Times the FIFO was found full, samples may have been lost. */
+	uint32_t overruns;
+	/** FIFO mode of each slot, ADPD188_NO_FIFO for a disabled slot. */
+	enum adpd188_slot_fifo_mode slot_mode[2];
+};
+
 /**
  * @struct adpd188_dev
  * @brief Driver descriptor structure.
@@ -649,6 +692,10 @@ struct adpd188_dev {
 	struct gpio_desc *gpio0;
 	/** GPIO 1 descriptor. */
 	struct gpio_desc *gpio1;
+	/** Active FIFO stream, NULL when not streaming. */
+	struct adpd188_fifo_stream *stream;
+	/** FIFO interrupt latched by adpd188_fifo_stream_isr(). */
+	volatile uint8_t irq_pending;
 };
 
 /**
@@ -694,6 +741,10 @@ int32_t adpd188_mode_set(struct adpd188_dev *dev, enum adpd188_mode new_mode);
 /* Get the number of bytes currently present in FIFO. */
 int32_t adpd188_fifo_status_get(struct adpd188_dev *dev, uint8_t *bytes_no);
 
+/* Read 16 bit words from the FIFO in a single transaction. */
+int32_t adpd188_fifo_read(struct adpd188_dev *dev, uint16_t *data,
+			  uint8_t word_no);
+
 /* Empty the FIFO. */
 int32_t adpd188_fifo_clear(struct adpd188_dev *dev);
 
@@ -736,6 +787,24 @@ int32_t adpd188_adc_fsample_set(struct adpd188_dev *dev, float freq_hz);
 /* Get sample frequency of the ADC. */
 int32_t adpd188_adc_fsample_get(struct adpd188_dev *dev, float *freq_hz);
 
+/* Start interrupt driven FIFO streaming. */
+int32_t adpd188_fifo_stream_start(struct adpd188_dev *dev,
+				  struct adpd188_fifo_stream *stream);
+
+/* Drain the complete sampling periods present in the FIFO. */
+int32_t adpd188_fifo_stream_process(struct adpd188_dev *dev);
+
+/* FIFO threshold interrupt handler. */
+void adpd188_fifo_stream_isr(void *ctx, uint32_t event, void *extra);
+
+/* Take decoded samples out of the stream ring. */
+int32_t adpd188_fifo_stream_read(struct adpd188_dev *dev,
+				 struct adpd188_sample *samples,
+				 uint16_t max_samples, uint16_t *count);
+
+/* Stop FIFO streaming. */
+int32_t adpd188_fifo_stream_stop(struct adpd188_dev *dev);
+
 /* Do initial configuration of the device to use as a smoke detector. */
 int32_t adpd188_smoke_detect_setup(struct adpd188_dev *dev);
 
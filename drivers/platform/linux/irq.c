@@ -0,0 +1,514 @@
+/***************************************************************************//**
+ *   @file   linux/irq.c
+ *   @brief  Implementation of Linux IRQ Generic Driver.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+#include "error.h"
+#include "irq.h"
+#include "irq_extra.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+#define LINUX_IRQ_MAX_EVENTS	16
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Find a registered interrupt source.
+ * @param ldesc - The Linux IRQ descriptor.
+ * @param irq_id - Interrupt identifier.
+ * @return The source, NULL if not registered.
+ */
+static struct linux_irq_source *linux_irq_find(struct linux_irq_desc *ldesc,
+		uint32_t irq_id)
+{
+	struct linux_irq_source *src;
+
+	for (src = ldesc->sources; src; src = src->next)
+		if (src->irq_id == irq_id)
+			return src;
+
+	return NULL;
+}
+
+/**
+ * @brief Check that a source is still registered.
+ * @param ldesc - The Linux IRQ descriptor.
+ * @param source - The source.
+ * @return true if the source is registered, false otherwise.
+ */
+static bool linux_irq_is_registered(struct linux_irq_desc *ldesc,
+				    struct linux_irq_source *source)
+{
+	struct linux_irq_source *src;
+
+	for (src = ldesc->sources; src; src = src->next)
+		if (src == source)
+			return true;
+
+	return false;
+}
+
+/**
+ * @brief Acknowledge an interrupt source and call its callback.
+ * @param src - The source.
+ * @return None.
+ */
+static void linux_irq_handle(struct linux_irq_source *src)
+{
+	struct gpioevent_data gpio_event;
+	uint32_t uio_count;
+	uint64_t count;
+	uint32_t unmask = 1;
+	void *extra;
+	ssize_t ret;
+
+	switch (src->type) {
+	case IRQ_LINUX_UIO:
+		ret = read(src->fd, &uio_count, sizeof(uio_count));
+		extra = &uio_count;
+		break;
+	case IRQ_LINUX_GPIO:
+		ret = read(src->fd, &gpio_event, sizeof(gpio_event));
+		extra = &gpio_event;
+		break;
+	default:
+		ret = read(src->fd, &count, sizeof(count));
+		extra = &count;
+		break;
+	}
+	if (ret <= 0)
+		return;
+
+	if (src->callback)
+		src->callback(src->ctx, src->irq_id, extra);
+
+	/* UIO interrupts stay masked until re-enabled by a write */
+	if (src->type == IRQ_LINUX_UIO && src->enabled)
+		ret = write(src->fd, &unmask, sizeof(unmask));
+}
+
+/**
+ * @brief Interrupt dispatch thread.
+ * @param arg - The Linux IRQ descriptor.
+ * @return NULL.
+ */
+static void *linux_irq_thread(void *arg)
+{
+	struct linux_irq_desc *ldesc = arg;
+	struct epoll_event events[LINUX_IRQ_MAX_EVENTS];
+	struct linux_irq_source *src;
+	int n;
+	int i;
+
+	while (1) {
+		n = epoll_wait(ldesc->epoll_fd, events, LINUX_IRQ_MAX_EVENTS,
+			       -1);
+		if (n < 0 && errno != EINTR)
+			break;
+
+		pthread_mutex_lock(&ldesc->lock);
+		while (!ldesc->enabled && !ldesc->stop)
+			pthread_cond_wait(&ldesc->cond, &ldesc->lock);
+		if (ldesc->stop) {
+			pthread_mutex_unlock(&ldesc->lock);
+			break;
+		}
+
+		for (i = 0; i < n; i++) {
+			src = events[i].data.ptr;
+			/* A previous callback may have unregistered it */
+			if (src && linux_irq_is_registered(ldesc, src) &&
+			    src->enabled)
+				linux_irq_handle(src);
+		}
+		pthread_mutex_unlock(&ldesc->lock);
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Initialize the IRQ interrupts.
+ *
+ * Interrupt sources are file descriptors polled by a dispatch thread, which
+ * calls the registered callbacks. Callbacks run on that thread, one at a
+ * time, and may call the other irq_* functions.
+ *
+ * @param desc - The IRQ controller descriptor.
+ * @param param - The structure that contains the IRQ parameters.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t irq_ctrl_init(struct irq_ctrl_desc **desc,
+		      const struct irq_init_param *param)
+{
+	struct irq_ctrl_desc *descriptor;
+	struct linux_irq_desc *ldesc;
+	pthread_mutexattr_t attr;
+	struct epoll_event ev;
+
+	descriptor = (struct irq_ctrl_desc *)calloc(1, sizeof *descriptor);
+	if (!descriptor)
+		return FAILURE;
+	ldesc = (struct linux_irq_desc *)calloc(1, sizeof *ldesc);
+	if (!ldesc)
+		goto error_desc;
+
+	descriptor->irq_ctrl_id = param->irq_ctrl_id;
+	descriptor->extra = ldesc;
+
+	ldesc->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (ldesc->epoll_fd < 0)
+		goto error_ldesc;
+
+	ldesc->stop_fd = eventfd(0, EFD_CLOEXEC);
+	if (ldesc->stop_fd < 0)
+		goto error_epoll;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.ptr = NULL;
+	if (epoll_ctl(ldesc->epoll_fd, EPOLL_CTL_ADD, ldesc->stop_fd, &ev) < 0)
+		goto error_stop;
+
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&ldesc->lock, &attr);
+	pthread_mutexattr_destroy(&attr);
+	pthread_cond_init(&ldesc->cond, NULL);
+
+	if (pthread_create(&ldesc->thread, NULL, linux_irq_thread, ldesc))
+		goto error_thread;
+
+	*desc = descriptor;
+
+	return SUCCESS;
+
+error_thread:
+	pthread_cond_destroy(&ldesc->cond);
+	pthread_mutex_destroy(&ldesc->lock);
+error_stop:
+	close(ldesc->stop_fd);
+error_epoll:
+	close(ldesc->epoll_fd);
+error_ldesc:
+	free(ldesc);
+error_desc:
+	free(descriptor);
+
+	return FAILURE;
+}
+
+/**
+ * @brief Enable global interrupts.
+ * @param desc - The IRQ controller descriptor.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t irq_global_enable(struct irq_ctrl_desc *desc)
+{
+	struct linux_irq_desc *ldesc = desc->extra;
+
+	pthread_mutex_lock(&ldesc->lock);
+	ldesc->enabled = true;
+	pthread_cond_broadcast(&ldesc->cond);
+	pthread_mutex_unlock(&ldesc->lock);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Disable global interrupts.
+ *
+ * Pending events are kept and dispatched once interrupts are enabled again.
+ *
+ * @param desc - The IRQ controller descriptor.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t irq_global_disable(struct irq_ctrl_desc *desc)
+{
+	struct linux_irq_desc *ldesc = desc->extra;
+
+	pthread_mutex_lock(&ldesc->lock);
+	ldesc->enabled = false;
+	pthread_mutex_unlock(&ldesc->lock);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Enable specific interrupt.
+ * @param desc - The IRQ controller descriptor.
+ * @param irq_id - Interrupt identifier.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t irq_enable(struct irq_ctrl_desc *desc, uint32_t irq_id)
+{
+	struct linux_irq_desc *ldesc = desc->extra;
+	struct linux_irq_source *src;
+	struct epoll_event ev;
+	uint32_t unmask = 1;
+	int32_t ret = SUCCESS;
+
+	pthread_mutex_lock(&ldesc->lock);
+	src = linux_irq_find(ldesc, irq_id);
+	if (!src) {
+		ret = FAILURE;
+		goto out;
+	}
+	if (src->enabled)
+		goto out;
+
+	if (src->type == IRQ_LINUX_UIO &&
+	    write(src->fd, &unmask, sizeof(unmask)) < 0) {
+		ret = FAILURE;
+		goto out;
+	}
+
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.ptr = src;
+	if (epoll_ctl(ldesc->epoll_fd, EPOLL_CTL_ADD, src->fd, &ev) < 0) {
+		ret = FAILURE;
+		goto out;
+	}
+	src->enabled = true;
+out:
+	pthread_mutex_unlock(&ldesc->lock);
+
+	return ret;
+}
+
+/**
+ * @brief Disable specific interrupt.
+ * @param desc - The IRQ controller descriptor.
+ * @param irq_id - Interrupt identifier.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t irq_disable(struct irq_ctrl_desc *desc, uint32_t irq_id)
+{
+	struct linux_irq_desc *ldesc = desc->extra;
+	struct linux_irq_source *src;
+	int32_t ret = SUCCESS;
+
+	pthread_mutex_lock(&ldesc->lock);
+	src = linux_irq_find(ldesc, irq_id);
+	if (!src) {
+		ret = FAILURE;
+	} else if (src->enabled) {
+		epoll_ctl(ldesc->epoll_fd, EPOLL_CTL_DEL, src->fd, NULL);
+		src->enabled = false;
+	}
+	pthread_mutex_unlock(&ldesc->lock);
+
+	return ret;
+}
+
+/**
+ * @brief Open the file descriptor of an interrupt source.
+ * @param src - The source.
+ * @param config - The source description.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+static int32_t linux_irq_open(struct linux_irq_source *src,
+			      const struct linux_irq_config *config)
+{
+	struct gpioevent_request req;
+	int chip_fd;
+	int ret;
+
+	switch (config->type) {
+	case IRQ_LINUX_UIO:
+		src->fd = open(config->path, O_RDWR | O_CLOEXEC);
+		src->own_fd = true;
+		break;
+	case IRQ_LINUX_GPIO:
+		chip_fd = open(config->path, O_RDWR | O_CLOEXEC);
+		if (chip_fd < 0)
+			return FAILURE;
+
+		memset(&req, 0, sizeof(req));
+		req.lineoffset = config->line;
+		req.handleflags = GPIOHANDLE_REQUEST_INPUT;
+		req.eventflags = config->event_flags;
+		strncpy(req.consumer_label, "no-os-irq",
+			sizeof(req.consumer_label) - 1);
+		ret = ioctl(chip_fd, GPIO_GET_LINEEVENT_IOCTL, &req);
+		close(chip_fd);
+
+		src->fd = ret < 0 ? -1 : req.fd;
+		src->own_fd = true;
+		break;
+	case IRQ_LINUX_EVENTFD:
+	case IRQ_LINUX_TIMERFD:
+		src->fd = config->fd;
+		src->own_fd = false;
+		break;
+	default:
+		return FAILURE;
+	}
+
+	return src->fd < 0 ? FAILURE : SUCCESS;
+}
+
+/**
+ * @brief Register a callback to handle the irq events.
+ *
+ * The interrupt source is described by a struct linux_irq_config passed as
+ * callback_desc->config. The source stays disabled until irq_enable().
+ *
+ * @param desc - The IRQ controller descriptor.
+ * @param irq_id - Interrupt identifier, chosen by the caller.
+ * @param callback_desc - Callback descriptor
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t irq_register_callback(struct irq_ctrl_desc *desc, uint32_t irq_id,
+			      struct callback_desc *callback_desc)
+{
+	struct linux_irq_desc *ldesc = desc->extra;
+	struct linux_irq_config *config = callback_desc->config;
+	struct linux_irq_source *src;
+	int32_t ret = FAILURE;
+
+	if (!config)
+		return FAILURE;
+
+	pthread_mutex_lock(&ldesc->lock);
+	if (linux_irq_find(ldesc, irq_id))
+		goto out;
+
+	src = (struct linux_irq_source *)calloc(1, sizeof(*src));
+	if (!src)
+		goto out;
+
+	src->irq_id = irq_id;
+	src->type = config->type;
+	src->callback = callback_desc->callback;
+	src->ctx = callback_desc->ctx;
+	if (linux_irq_open(src, config) != SUCCESS) {
+		free(src);
+		goto out;
+	}
+
+	src->next = ldesc->sources;
+	ldesc->sources = src;
+	ret = SUCCESS;
+out:
+	pthread_mutex_unlock(&ldesc->lock);
+
+	return ret;
+}
+
+/**
+ * @brief Unregisters a generic IRQ handling function.
+ * @param desc - The IRQ controller descriptor.
+ * @param irq_id - Interrupt identifier.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t irq_unregister(struct irq_ctrl_desc *desc, uint32_t irq_id)
+{
+	struct linux_irq_desc *ldesc = desc->extra;
+	struct linux_irq_source **p;
+	struct linux_irq_source *src;
+	int32_t ret = FAILURE;
+
+	pthread_mutex_lock(&ldesc->lock);
+	for (p = &ldesc->sources; *p; p = &(*p)->next) {
+		src = *p;
+		if (src->irq_id != irq_id)
+			continue;
+
+		if (src->enabled)
+			epoll_ctl(ldesc->epoll_fd, EPOLL_CTL_DEL, src->fd, NULL);
+		if (src->own_fd)
+			close(src->fd);
+		*p = src->next;
+		free(src);
+		ret = SUCCESS;
+		break;
+	}
+	pthread_mutex_unlock(&ldesc->lock);
+
+	return ret;
+}
+
+/**
+ * @brief Free the resources allocated by irq_ctrl_init().
+ * @param desc - The IRQ control descriptor.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t irq_ctrl_remove(struct irq_ctrl_desc *desc)
+{
+	struct linux_irq_desc *ldesc = desc->extra;
+	uint64_t one = 1;
+
+	pthread_mutex_lock(&ldesc->lock);
+	ldesc->stop = true;
+	pthread_cond_broadcast(&ldesc->cond);
+	pthread_mutex_unlock(&ldesc->lock);
+
+	if (write(ldesc->stop_fd, &one, sizeof(one)) > 0)
+		pthread_join(ldesc->thread, NULL);
+
+	while (ldesc->sources)
+		irq_unregister(desc, ldesc->sources->irq_id);
+
+	pthread_cond_destroy(&ldesc->cond);
+	pthread_mutex_destroy(&ldesc->lock);
+	close(ldesc->stop_fd);
+	close(ldesc->epoll_fd);
+	free(ldesc);
+	free(desc);
+
+	return SUCCESS;
+}
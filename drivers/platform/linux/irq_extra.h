@@ -0,0 +1,137 @@
+/***************************************************************************//**
+ *   @file   linux/irq_extra.h
+ *   @brief  Header file of Linux IRQ driver.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef IRQ_EXTRA_H_
+#define IRQ_EXTRA_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @enum linux_irq_type
+ * @brief Kinds of file descriptors that can act as interrupt sources
+ */
+enum linux_irq_type {
+	/** UIO device; reads return the interrupt count, writes unmask it */
+	IRQ_LINUX_UIO,
+	/** eventfd, e.g. a software or test interrupt source */
+	IRQ_LINUX_EVENTFD,
+	/** timerfd, e.g. the one of a Linux timer_desc */
+	IRQ_LINUX_TIMERFD,
+	/** GPIO character device line event */
+	IRQ_LINUX_GPIO
+};
+
+/**
+ * @struct linux_irq_config
+ * @brief Interrupt source description, passed as callback_desc.config
+ */
+struct linux_irq_config {
+	/** Kind of interrupt source */
+	enum linux_irq_type	type;
+	/**
+	 * File descriptor of an IRQ_LINUX_EVENTFD or IRQ_LINUX_TIMERFD source,
+	 * ignored otherwise. Owned by the caller.
+	 */
+	int			fd;
+	/** UIO device (/dev/uioN) or GPIO chip (/dev/gpiochipN) to open */
+	const char		*path;
+	/** GPIO line offset within the chip */
+	uint32_t		line;
+	/** GPIOEVENT_REQUEST_* edge flags of a GPIO line */
+	uint32_t		event_flags;
+};
+
+/**
+ * @struct linux_irq_source
+ * @brief Registered interrupt source
+ */
+struct linux_irq_source {
+	/** Interrupt identifier */
+	uint32_t		irq_id;
+	/** Kind of interrupt source */
+	enum linux_irq_type	type;
+	/** File descriptor polled for the interrupt */
+	int			fd;
+	/** True if fd was opened by the driver */
+	bool			own_fd;
+	/** True while the source is part of the epoll set */
+	bool			enabled;
+	/** Callback */
+	void			(*callback)(void *ctx, uint32_t event,
+					    void *extra);
+	/** Callback context */
+	void			*ctx;
+	/** Next registered source */
+	struct linux_irq_source	*next;
+};
+
+/**
+ * @struct linux_irq_desc
+ * @brief Linux platform specific IRQ descriptor
+ */
+struct linux_irq_desc {
+	/** epoll instance waiting on all enabled sources */
+	int			epoll_fd;
+	/** eventfd used to stop the dispatch thread */
+	int			stop_fd;
+	/** Dispatch thread */
+	pthread_t		thread;
+	/** Protects the source list and the global enable state */
+	pthread_mutex_t		lock;
+	/** Signalled when interrupts are globally enabled */
+	pthread_cond_t		cond;
+	/** Global interrupt enable */
+	bool			enabled;
+	/** Set when the dispatch thread must exit */
+	bool			stop;
+	/** Registered sources */
+	struct linux_irq_source	*sources;
+};
+
+#endif
@@ -44,9 +44,11 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
 #include "platform_drivers.h"
+#include <linux/gpio.h>
 #include <linux/i2c-dev.h>
 #include <linux/spi/spidev.h>
 
@@ -268,123 +270,152 @@ int32_t spi_write_and_read(spi_desc *desc,
 }
 
 /**
- * @brief Obtain the GPIO decriptor.
+ * @brief Request a set of lines of a GPIO chip.
+ * @param chip_fd - File descriptor of the GPIO chip.
+ * @param offsets - Line offsets.
+ * @param nb_lines - Number of lines.
+ * @param direction - GPIO_OUT or GPIO_IN.
+ * @param values - Initial values of output lines, may be NULL.
+ * @return The line handle file descriptor, negative value otherwise.
+ */
+static int gpio_request_lines(int chip_fd,
+			      const uint8_t *offsets,
+			      uint8_t nb_lines,
+			      uint8_t direction,
+			      const uint8_t *values)
+{
+	struct gpiohandle_request req;
+	uint8_t i;
+	int ret;
+
+	memset(&req, 0, sizeof(req));
+	for (i = 0; i < nb_lines; i++) {
+		req.lineoffsets[i] = offsets[i];
+		if (values)
+			req.default_values[i] = values[i] ? 1 : 0;
+	}
+	req.lines = nb_lines;
+	req.flags = (direction == GPIO_OUT) ? GPIOHANDLE_REQUEST_OUTPUT :
+		    GPIOHANDLE_REQUEST_INPUT;
+	strncpy(req.consumer_label, "no-os", sizeof(req.consumer_label) - 1);
+
+	ret = ioctl(chip_fd, GPIO_GET_LINEHANDLE_IOCTL, &req);
+	if (ret < 0)
+		return ret;
+
+	return req.fd;
+}
+
+/**
+ * @brief Obtain the GPIO decriptor of a line of a given GPIO chip.
  * @param desc - The GPIO descriptor.
- * @param gpio_number - The number of the GPIO.
+ * @param pathname - The GPIO chip character device, e.g. /dev/gpiochip0.
+ * @param gpio_number - The line offset within the chip.
  * @return SUCCESS in case of success, FAILURE otherwise.
  */
-int32_t gpio_get(gpio_desc **desc,
-		 uint8_t gpio_number)
+int32_t gpio_get_chip(gpio_desc **desc,
+		      const char *pathname,
+		      uint8_t gpio_number)
 {
 	gpio_desc *descriptor;
-	char buf[100];
-	int fd;
-	int len;
-	int ret;
 
 	descriptor = (gpio_desc *)malloc(sizeof(*descriptor));
 	if (!descriptor)
 		return FAILURE;
 
-	descriptor->number = gpio_number;
-
-	fd = open("/sys/class/gpio/export", O_WRONLY);
-	if (fd < 0) {
+	descriptor->chip_fd = open(pathname, O_RDWR | O_CLOEXEC);
+	if (descriptor->chip_fd < 0) {
 		printf("%s: Can't open device\n\r", __func__);
 		free(descriptor);
 		return FAILURE;
 	}
 
-	len = sprintf(buf, "%d", gpio_number);
-	ret = write(fd, buf, len);
-	if (ret < 0) {
-		printf("%s: Can't write to file\n\r", __func__);
-		close(fd);
-		free(descriptor);
-		return FAILURE;
-	}
-
-	ret = close(fd);
-	if (ret < 0) {
-		printf("%s: Can't close device\n\r", __func__);
-		free(descriptor);
-		return FAILURE;
-	}
+	descriptor->number = gpio_number;
+	descriptor->fd = -1;
+	descriptor->direction = GPIO_IN;
 
 	*desc = descriptor;
 
 	return SUCCESS;
 }
 
+/**
+ * @brief Obtain the GPIO decriptor.
+ * @param desc - The GPIO descriptor.
+ * @param gpio_number - The line offset within GPIO_DEFAULT_CHIP.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t gpio_get(gpio_desc **desc,
+		 uint8_t gpio_number)
+{
+	return gpio_get_chip(desc, GPIO_DEFAULT_CHIP, gpio_number);
+}
+
 /**
  * @brief Free the resources allocated by gpio_get().
- * @param desc - The SPI descriptor.
+ * @param desc - The GPIO descriptor.
  * @return SUCCESS in case of success, FAILURE otherwise.
  */
 int32_t gpio_remove(gpio_desc *desc)
 {
-	char buf[100];
-	int fd;
-	int len;
-	int ret;
+	int32_t ret = SUCCESS;
 
-	fd = open("/sys/class/gpio/unexport", O_WRONLY);
-	if (fd < 0) {
-		printf("%s: Can't open device\n\r", __func__);
-		return FAILURE;
-	}
-
-	len = sprintf(buf, "%d", desc->number);
-	ret = write(fd, buf, len);
-	if (ret < 0) {
-		printf("%s: Can't write to file\n\r", __func__);
-		return FAILURE;
-	}
-
-	ret = close(fd);
-	if (ret < 0) {
+	if (desc->fd >= 0 && close(desc->fd) < 0)
+		ret = FAILURE;
+	if (close(desc->chip_fd) < 0)
+		ret = FAILURE;
+	if (ret != SUCCESS)
 		printf("%s: Can't close device\n\r", __func__);
-		return FAILURE;
-	}
 
 	free(desc);
 
-	return SUCCESS;
+	return ret;
 }
 
 /**
- * @brief Enable the input direction of the specified GPIO.
+ * @brief Request the line with a new direction, releasing the old handle.
  * @param desc - The GPIO descriptor.
+ * @param direction - GPIO_OUT or GPIO_IN.
+ * @param value - Initial value if the line is an output.
  * @return SUCCESS in case of success, FAILURE otherwise.
  */
-int32_t gpio_direction_input(gpio_desc *desc)
+static int32_t gpio_request(gpio_desc *desc,
+			    uint8_t direction,
+			    uint8_t value)
 {
-	char buf[100];
 	int fd;
-	int ret;
 
-	sprintf(buf, "/sys/class/gpio/gpio%d/direction", desc->number);
-	fd = open(buf, O_WRONLY);
-	if (fd < 0) {
-		printf("%s: Can't open device\n\r", __func__);
-		return FAILURE;
+	if (desc->fd >= 0) {
+		close(desc->fd);
+		desc->fd = -1;
 	}
 
-	ret = write(fd, "in", 3);
-	if (ret < 0) {
-		printf("%s: Can't write to file\n\r", __func__);
+	fd = gpio_request_lines(desc->chip_fd, &desc->number, 1, direction,
+				&value);
+	if (fd < 0) {
+		printf("%s: Can't request line\n\r", __func__);
 		return FAILURE;
 	}
 
-	ret = close(fd);
-	if (ret < 0) {
-		printf("%s: Can't close device\n\r", __func__);
-		return FAILURE;
-	}
+	desc->fd = fd;
+	desc->direction = direction;
 
 	return SUCCESS;
 }
 
+/**
+ * @brief Enable the input direction of the specified GPIO.
+ * @param desc - The GPIO descriptor.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t gpio_direction_input(gpio_desc *desc)
+{
+	if (desc->fd >= 0 && desc->direction == GPIO_IN)
+		return SUCCESS;
+
+	return gpio_request(desc, GPIO_IN, 0);
+}
+
 /**
  * @brief Enable the output direction of the specified GPIO.
  * @param desc - The GPIO descriptor.
@@ -396,36 +427,10 @@ int32_t gpio_direction_input(gpio_desc *desc)
 int32_t gpio_direction_output(gpio_desc *desc,
 			      uint8_t value)
 {
-	char buf[100];
-	int fd;
-	int ret;
-
-	sprintf(buf, "/sys/class/gpio/gpio%d/direction", desc->number);
-	fd = open(buf, O_WRONLY);
-	if (fd < 0) {
-		printf("%s: Can't open device\n\r", __func__);
-		return FAILURE;
-	}
-
-	ret = write(fd, "out", 4);
-	if (ret < 0) {
-		printf("%s: Can't write to file\n\r", __func__);
-		return FAILURE;
-	}
+	if (desc->fd >= 0 && desc->direction == GPIO_OUT)
+		return gpio_set_value(desc, value);
 
-	ret = close(fd);
-	if (ret < 0) {
-		printf("%s: Can't close device\n\r", __func__);
-		return FAILURE;
-	}
-
-	ret = gpio_set_value(desc, value);
-	if (ret != SUCCESS) {
-		printf("%s: Can't set value\n\r", __func__);
-		return FAILURE;
-	}
-
-	return SUCCESS;
+	return gpio_request(desc, GPIO_OUT, value);
 }
 
 /**
@@ -439,35 +444,27 @@ int32_t gpio_direction_output(gpio_desc *desc,
 int32_t gpio_get_direction(gpio_desc *desc,
 			   uint8_t *direction)
 {
-	char buf[100];
-	char data;
-	int fd;
+	struct gpioline_info info;
 	int ret;
 
-	sprintf(buf, "/sys/class/gpio/gpio%d/direction", desc->number);
-	fd = open(buf, O_RDONLY);
-	if (fd < 0) {
-		printf("%s: Can't open file\n\r", __func__);
-		return FAILURE;
+	if (desc->fd >= 0) {
+		*direction = desc->direction;
+		return SUCCESS;
 	}
 
-	ret = read(fd, &data, 1);
+	memset(&info, 0, sizeof(info));
+	info.line_offset = desc->number;
+	ret = ioctl(desc->chip_fd, GPIO_GET_LINEINFO_IOCTL, &info);
 	if (ret < 0) {
-		printf("%s: Can't read from file\n\r", __func__);
+		printf("%s: Can't read line info\n\r", __func__);
 		return FAILURE;
 	}
 
-	if(data == 'o')
+	if (info.flags & GPIOLINE_FLAG_IS_OUT)
 		*direction = GPIO_OUT;
 	else
 		*direction = GPIO_IN;
 
-	ret = close(fd);
-	if (ret < 0) {
-		printf("%s: Can't close device\n\r", __func__);
-		return FAILURE;
-	}
-
 	return SUCCESS;
 }
 
@@ -482,29 +479,16 @@ int32_t gpio_get_direction(gpio_desc *desc,
 int32_t gpio_set_value(gpio_desc *desc,
 		       uint8_t value)
 {
-	char buf[100];
-	int fd;
+	struct gpiohandle_data data;
 	int ret;
 
-	sprintf(buf, "/sys/class/gpio/gpio%d/value", desc->number);
-	fd = open(buf, O_WRONLY);
-	if (fd < 0) {
-		printf("%s: Can't open device\n\r", __func__);
-		return FAILURE;
-	}
-
-	if (value)
-		ret = write(fd, "1", 2);
-	else
-		ret = write(fd, "0", 2);
-	if (ret < 0) {
-		printf("%s: Can't write to file\n\r", __func__);
-		return FAILURE;
-	}
+	if (desc->fd < 0)
+		return gpio_request(desc, GPIO_OUT, value);
 
-	ret = close(fd);
+	data.values[0] = value ? 1 : 0;
+	ret = ioctl(desc->fd, GPIOHANDLE_SET_LINE_VALUES_IOCTL, &data);
 	if (ret < 0) {
-		printf("%s: Can't close device\n\r", __func__);
+		printf("%s: Can't set value\n\r", __func__);
 		return FAILURE;
 	}
 
@@ -522,30 +506,85 @@ int32_t gpio_set_value(gpio_desc *desc,
 int32_t gpio_get_value(gpio_desc *desc,
 		       uint8_t *value)
 {
-	char buf[100];
-	char data;
-	int fd;
+	struct gpiohandle_data data;
 	int ret;
 
-	sprintf(buf, "/sys/class/gpio/gpio%d/value", desc->number);
-	fd = open(buf, O_RDONLY);
-	if (fd < 0) {
-		printf("%s: Can't open file\n\r", __func__);
+	if (desc->fd < 0 && gpio_request(desc, GPIO_IN, 0) != SUCCESS)
 		return FAILURE;
-	}
 
-	ret = read(fd, &data, 1);
+	ret = ioctl(desc->fd, GPIOHANDLE_GET_LINE_VALUES_IOCTL, &data);
 	if (ret < 0) {
-		printf("%s: Can't read from file\n\r", __func__);
+		printf("%s: Can't get value\n\r", __func__);
 		return FAILURE;
 	}
 
-	if(data == '0')
-		*value = GPIO_LOW;
-	else
-		*value = GPIO_HIGH;
+	*value = data.values[0] ? GPIO_HIGH : GPIO_LOW;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Request several lines of a GPIO chip as one handle.
+ * @param desc - The GPIO bulk descriptor.
+ * @param pathname - The GPIO chip character device, e.g. /dev/gpiochip0.
+ * @param offsets - The line offsets within the chip.
+ * @param nb_lines - Number of lines, at most GPIO_BULK_MAX_LINES.
+ * @param direction - Direction of all lines, GPIO_OUT or GPIO_IN.
+ * @param values - Initial values of output lines, may be NULL.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t gpio_bulk_get(gpio_bulk_desc **desc,
+		      const char *pathname,
+		      const uint8_t *offsets,
+		      uint8_t nb_lines,
+		      uint8_t direction,
+		      const uint8_t *values)
+{
+	gpio_bulk_desc *descriptor;
+	int chip_fd;
+
+	if (!nb_lines || nb_lines > GPIO_BULK_MAX_LINES)
+		return FAILURE;
+
+	descriptor = (gpio_bulk_desc *)malloc(sizeof(*descriptor));
+	if (!descriptor)
+		return FAILURE;
+
+	chip_fd = open(pathname, O_RDWR | O_CLOEXEC);
+	if (chip_fd < 0) {
+		printf("%s: Can't open device\n\r", __func__);
+		free(descriptor);
+		return FAILURE;
+	}
 
-	ret = close(fd);
+	descriptor->fd = gpio_request_lines(chip_fd, offsets, nb_lines,
+					    direction, values);
+	close(chip_fd);
+	if (descriptor->fd < 0) {
+		printf("%s: Can't request lines\n\r", __func__);
+		free(descriptor);
+		return FAILURE;
+	}
+
+	descriptor->nb_lines = nb_lines;
+	descriptor->direction = direction;
+
+	*desc = descriptor;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Free the resources allocated by gpio_bulk_get().
+ * @param desc - The GPIO bulk descriptor.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t gpio_bulk_remove(gpio_bulk_desc *desc)
+{
+	int ret;
+
+	ret = close(desc->fd);
+	free(desc);
 	if (ret < 0) {
 		printf("%s: Can't close device\n\r", __func__);
 		return FAILURE;
@@ -554,6 +593,60 @@ int32_t gpio_get_value(gpio_desc *desc,
 	return SUCCESS;
 }
 
+/**
+ * @brief Set the values of all lines of a bulk descriptor at once.
+ * @param desc - The GPIO bulk descriptor.
+ * @param values - One value per line, in request order.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t gpio_bulk_set_values(gpio_bulk_desc *desc,
+			     const uint8_t *values)
+{
+	struct gpiohandle_data data;
+	uint8_t i;
+	int ret;
+
+	if (desc->direction != GPIO_OUT)
+		return FAILURE;
+
+	memset(&data, 0, sizeof(data));
+	for (i = 0; i < desc->nb_lines; i++)
+		data.values[i] = values[i] ? 1 : 0;
+
+	ret = ioctl(desc->fd, GPIOHANDLE_SET_LINE_VALUES_IOCTL, &data);
+	if (ret < 0) {
+		printf("%s: Can't set values\n\r", __func__);
+		return FAILURE;
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Get the values of all lines of a bulk descriptor at once.
+ * @param desc - The GPIO bulk descriptor.
+ * @param values - One value per line, in request order.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t gpio_bulk_get_values(gpio_bulk_desc *desc,
+			     uint8_t *values)
+{
+	struct gpiohandle_data data;
+	uint8_t i;
+	int ret;
+
+	ret = ioctl(desc->fd, GPIOHANDLE_GET_LINE_VALUES_IOCTL, &data);
+	if (ret < 0) {
+		printf("%s: Can't get values\n\r", __func__);
+		return FAILURE;
+	}
+
+	for (i = 0; i < desc->nb_lines; i++)
+		values[i] = data.values[i] ? GPIO_HIGH : GPIO_LOW;
+
+	return SUCCESS;
+}
+
 /**
  * @brief Generate microseconds delay.
  * @param usecs - Delay in microseconds.
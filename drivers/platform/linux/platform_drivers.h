@@ -56,6 +56,9 @@
 #define GPIO_HIGH	0x01
 #define GPIO_LOW	0x00
 
+#define GPIO_DEFAULT_CHIP	"/dev/gpiochip0"
+#define GPIO_BULK_MAX_LINES	64
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -117,8 +120,17 @@ typedef struct {
 	gpio_type	type;
 	uint32_t	id;
 	uint8_t		number;
+	int		chip_fd;
+	int		fd;
+	uint8_t		direction;
 } gpio_desc;
 
+typedef struct {
+	int		fd;
+	uint8_t		nb_lines;
+	uint8_t		direction;
+} gpio_bulk_desc;
+
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
@@ -154,6 +166,11 @@ int32_t spi_write_and_read(spi_desc *desc,
 			   uint8_t *data,
 			   uint8_t bytes_number);
 
+/* Obtain the GPIO decriptor of a line of a given GPIO chip. */
+int32_t gpio_get_chip(gpio_desc **desc,
+		      const char *pathname,
+		      uint8_t gpio_number);
+
 /* Obtain the GPIO decriptor. */
 int32_t gpio_get(gpio_desc **desc,
 		 uint8_t gpio_number);
@@ -180,6 +197,25 @@ int32_t gpio_set_value(gpio_desc *desc,
 int32_t gpio_get_value(gpio_desc *desc,
 		       uint8_t *value);
 
+/* Request several lines of a GPIO chip as one handle. */
+int32_t gpio_bulk_get(gpio_bulk_desc **desc,
+		      const char *pathname,
+		      const uint8_t *offsets,
+		      uint8_t nb_lines,
+		      uint8_t direction,
+		      const uint8_t *values);
+
+/* Free the resources allocated by gpio_bulk_get(). */
+int32_t gpio_bulk_remove(gpio_bulk_desc *desc);
+
+/* Set the values of all lines of a bulk descriptor at once. */
+int32_t gpio_bulk_set_values(gpio_bulk_desc *desc,
+			     const uint8_t *values);
+
+/* Get the values of all lines of a bulk descriptor at once. */
+int32_t gpio_bulk_get_values(gpio_bulk_desc *desc,
+			     uint8_t *values);
+
 /* Generate microseconds delay. */
 void udelay(uint32_t usecs);
 
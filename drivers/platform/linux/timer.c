@@ -0,0 +1,309 @@
+/***************************************************************************//**
+ *   @file   linux/timer.c
+ *   @brief  Implementation of Linux timer driver.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+#include "error.h"
+#include "timer.h"
+#include "timer_extra.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+#define NSEC_PER_SEC	1000000000ull
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Read CLOCK_MONOTONIC.
+ * @return The current time, in nanoseconds.
+ */
+static uint64_t linux_timer_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+/**
+ * @brief Convert timer counts to nanoseconds.
+ * @param desc - The timer descriptor.
+ * @param counts - Number of counts.
+ * @return The duration, in nanoseconds.
+ */
+static uint64_t linux_timer_counts_to_ns(struct timer_desc *desc,
+		uint64_t counts)
+{
+	return counts * NSEC_PER_SEC / desc->freq_hz;
+}
+
+/**
+ * @brief Arm or disarm the timerfd.
+ * @param desc - The timer descriptor.
+ * @param arm - Arm the timer to expire every load_value counts if true.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+static int32_t linux_timer_arm(struct timer_desc *desc, bool arm)
+{
+	struct linux_timer_desc *ldesc = desc->extra;
+	struct itimerspec its;
+	uint64_t period_ns;
+
+	memset(&its, 0, sizeof(its));
+	if (arm && desc->load_value) {
+		period_ns = linux_timer_counts_to_ns(desc, desc->load_value);
+		if (!period_ns)
+			period_ns = 1;
+		its.it_interval.tv_sec = period_ns / NSEC_PER_SEC;
+		its.it_interval.tv_nsec = period_ns % NSEC_PER_SEC;
+		its.it_value = its.it_interval;
+	}
+
+	if (timerfd_settime(ldesc->fd, 0, &its, NULL) < 0)
+		return FAILURE;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Initialize hardware timer and the handler structure associated with
+ *        it.
+ *
+ * The counter is derived from CLOCK_MONOTONIC and counts at freq_hz, which
+ * defaults to 1 GHz (a nanosecond counter) when set to 0.
+ *
+ * @param desc - Pointer to the timer descriptor.
+ * @param param - Initialization parameters.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t timer_init(struct timer_desc **desc,
+		   struct timer_init_param *param)
+{
+	struct timer_desc *dev;
+	struct linux_timer_desc *ldesc;
+
+	if (!desc || !param)
+		return FAILURE;
+
+	dev = (struct timer_desc *)calloc(1, sizeof(*dev));
+	if (!dev)
+		return FAILURE;
+	ldesc = (struct linux_timer_desc *)calloc(1, sizeof(*ldesc));
+	if (!ldesc)
+		goto error_dev;
+
+	ldesc->fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+	if (ldesc->fd < 0)
+		goto error_ldesc;
+
+	dev->id = param->id;
+	dev->freq_hz = param->freq_hz ? param->freq_hz : NSEC_PER_SEC;
+	dev->load_value = param->load_value;
+	dev->extra = ldesc;
+
+	*desc = dev;
+
+	return SUCCESS;
+
+error_ldesc:
+	free(ldesc);
+error_dev:
+	free(dev);
+
+	return FAILURE;
+}
+
+/**
+ * @brief Free the memory allocated by timer_init().
+ * @param desc - Pointer to the timer descriptor.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t timer_remove(struct timer_desc *desc)
+{
+	struct linux_timer_desc *ldesc;
+
+	if (!desc)
+		return FAILURE;
+
+	ldesc = desc->extra;
+	close(ldesc->fd);
+	free(ldesc);
+	free(desc);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Start a timer.
+ * @param desc - Pointer to the timer descriptor.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t timer_start(struct timer_desc *desc)
+{
+	struct linux_timer_desc *ldesc = desc->extra;
+
+	if (ldesc->running)
+		return SUCCESS;
+
+	ldesc->start_ns = linux_timer_now_ns();
+	ldesc->running = true;
+
+	return linux_timer_arm(desc, true);
+}
+
+/**
+ * @brief Stop a timer from counting.
+ * @param desc - Pointer to the timer descriptor.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t timer_stop(struct timer_desc *desc)
+{
+	struct linux_timer_desc *ldesc = desc->extra;
+
+	if (!ldesc->running)
+		return SUCCESS;
+
+	ldesc->elapsed_ns += linux_timer_now_ns() - ldesc->start_ns;
+	ldesc->running = false;
+
+	return linux_timer_arm(desc, false);
+}
+
+/**
+ * @brief Get the time counted by the timer, in nanoseconds.
+ * @param desc - Pointer to the timer descriptor.
+ * @param ns - Elapsed time.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t linux_timer_ns_get(struct timer_desc *desc, uint64_t *ns)
+{
+	struct linux_timer_desc *ldesc = desc->extra;
+
+	*ns = ldesc->elapsed_ns;
+	if (ldesc->running)
+		*ns += linux_timer_now_ns() - ldesc->start_ns;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Get the value of the counter register for the timer.
+ * @param desc - Pointer to the timer descriptor.
+ * @param counter - Counter value, wraps around at 32 bits.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t timer_counter_get(struct timer_desc *desc, uint32_t *counter)
+{
+	uint64_t ns;
+
+	linux_timer_ns_get(desc, &ns);
+	if (desc->freq_hz == NSEC_PER_SEC)
+		*counter = (uint32_t)ns;
+	else
+		*counter = (uint32_t)(ns / NSEC_PER_SEC * desc->freq_hz +
+				      ns % NSEC_PER_SEC * desc->freq_hz /
+				      NSEC_PER_SEC);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Set the timer counter register value.
+ * @param desc - Pointer to the timer descriptor.
+ * @param new_val - New counter value.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t timer_counter_set(struct timer_desc *desc, uint32_t new_val)
+{
+	struct linux_timer_desc *ldesc = desc->extra;
+
+	ldesc->elapsed_ns = linux_timer_counts_to_ns(desc, new_val);
+	if (ldesc->running)
+		ldesc->start_ns = linux_timer_now_ns();
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Get the timer clock frequency.
+ * @param desc - Pointer to the timer descriptor.
+ * @param freq_hz - The counter frequency, in Hz.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t timer_count_clk_get(struct timer_desc *desc, uint32_t *freq_hz)
+{
+	*freq_hz = desc->freq_hz;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Set the timer clock frequency.
+ *
+ * The time counted so far is kept; the counter value is rescaled.
+ *
+ * @param desc - Pointer to the timer descriptor.
+ * @param freq_hz - The new counter frequency, in Hz.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t timer_count_clk_set(struct timer_desc *desc, uint32_t freq_hz)
+{
+	struct linux_timer_desc *ldesc = desc->extra;
+
+	if (!freq_hz)
+		return FAILURE;
+
+	desc->freq_hz = freq_hz;
+	if (ldesc->running)
+		return linux_timer_arm(desc, true);
+
+	return SUCCESS;
+}
@@ -0,0 +1,101 @@
+/***************************************************************************//**
+ *   @file   axi_io.c
+ *   @brief  Implementation of AXI IO Sim Platform Driver.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include "error.h"
+#include "axi_io.h"
+#include "sim_extra.h"
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief AXI IO Sim read function.
+ * @param base - Base address.
+ * @param offset - Address offset.
+ * @param data - Location where read data will be stored.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t axi_io_read(uint32_t base, uint32_t offset, uint32_t *data)
+{
+	struct sim_model *model;
+	uint32_t reg;
+	int32_t ret;
+
+	model = sim_axi_find(base + offset, &reg);
+	if (!model || !model->ops->reg_read)
+		return FAILURE;
+
+	ret = model->ops->reg_read(model, reg, data);
+
+	sim_account(model, SIM_BUS_AXI_READ, reg, *data, 4,
+		    model->timing.access_ns ? model->timing.access_ns :
+		    SIM_DEFAULT_AXI_NS);
+
+	return ret;
+}
+
+/**
+ * @brief AXI IO Sim write function.
+ * @param base - Base address.
+ * @param offset - Address offset.
+ * @param data - Data to be written.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t axi_io_write(uint32_t base, uint32_t offset, uint32_t data)
+{
+	struct sim_model *model;
+	uint32_t reg;
+	int32_t ret;
+
+	model = sim_axi_find(base + offset, &reg);
+	if (!model || !model->ops->reg_write)
+		return FAILURE;
+
+	ret = model->ops->reg_write(model, reg, data);
+
+	sim_account(model, SIM_BUS_AXI_WRITE, reg, data, 4,
+		    model->timing.access_ns ? model->timing.access_ns :
+		    SIM_DEFAULT_AXI_NS);
+
+	return ret;
+}
@@ -0,0 +1,164 @@
+/***************************************************************************//**
+ *   @file   i2c.c
+ *   @brief  Implementation of I2C Sim Platform Driver.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdlib.h>
+#include "error.h"
+#include "i2c.h"
+#include "sim_extra.h"
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Initialize the I2C communication peripheral.
+ * @param desc - The I2C descriptor.
+ * @param param - The structure that contains the I2C parameters.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t i2c_init(struct i2c_desc **desc,
+		 const struct i2c_init_param *param)
+{
+	struct i2c_desc *descriptor;
+
+	descriptor = (struct i2c_desc *)calloc(1, sizeof(*descriptor));
+	if (!descriptor)
+		return FAILURE;
+
+	descriptor->max_speed_hz = param->max_speed_hz;
+	descriptor->slave_address = param->slave_address;
+	descriptor->extra = param->extra;
+
+	*desc = descriptor;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Free the resources allocated by i2c_init().
+ * @param desc - The I2C descriptor.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t i2c_remove(struct i2c_desc *desc)
+{
+	free(desc);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Duration of an I2C transaction: the address byte and the data bytes,
+ *        9 bus clock cycles each.
+ * @param desc - The I2C descriptor.
+ * @param model - The target model.
+ * @param bytes_number - Number of data bytes.
+ * @return The duration in ns.
+ */
+static uint32_t i2c_duration(struct i2c_desc *desc, struct sim_model *model,
+			     uint8_t bytes_number)
+{
+	uint32_t hz;
+
+	hz = model->timing.bus_hz;
+	if (!hz)
+		hz = desc->max_speed_hz ? desc->max_speed_hz :
+		     SIM_DEFAULT_I2C_HZ;
+
+	return model->timing.access_ns +
+	       (9000000000ULL * (bytes_number + 1) + hz - 1) / hz;
+}
+
+/**
+ * @brief Write data to a slave device.
+ * @param desc - The I2C descriptor.
+ * @param data - Buffer that stores the transmission data.
+ * @param bytes_number - Number of bytes to write.
+ * @param stop_bit - Stop condition control.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t i2c_write(struct i2c_desc *desc,
+		  uint8_t *data,
+		  uint8_t bytes_number,
+		  uint8_t stop_bit)
+{
+	struct sim_model *model;
+	int32_t ret;
+
+	model = sim_i2c_find(desc->slave_address);
+	if (!model || !model->ops->i2c_write)
+		return FAILURE;
+
+	ret = model->ops->i2c_write(model, data, bytes_number, stop_bit);
+
+	sim_account(model, SIM_BUS_I2C_WRITE, desc->slave_address, 0,
+		    bytes_number, i2c_duration(desc, model, bytes_number));
+
+	return ret;
+}
+
+/**
+ * @brief Read data from a slave device.
+ * @param desc - The I2C descriptor.
+ * @param data - Buffer that will store the received data.
+ * @param bytes_number - Number of bytes to read.
+ * @param stop_bit - Stop condition control.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t i2c_read(struct i2c_desc *desc,
+		 uint8_t *data,
+		 uint8_t bytes_number,
+		 uint8_t stop_bit)
+{
+	struct sim_model *model;
+	int32_t ret;
+
+	model = sim_i2c_find(desc->slave_address);
+	if (!model || !model->ops->i2c_read)
+		return FAILURE;
+
+	ret = model->ops->i2c_read(model, data, bytes_number, stop_bit);
+
+	sim_account(model, SIM_BUS_I2C_READ, desc->slave_address, 0,
+		    bytes_number, i2c_duration(desc, model, bytes_number));
+
+	return ret;
+}
@@ -0,0 +1,341 @@
+/***************************************************************************//**
+ *   @file   sim.c
+ *   @brief  Simulation platform: device models, simulated time and statistics.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <inttypes.h>
+#include <stdio.h>
+#include <stddef.h>
+#include "error.h"
+#include "sim_extra.h"
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+/**
+ * @struct sim_axi_window
+ * @brief AXI address window routed to a model.
+ */
+struct sim_axi_window {
+	uint32_t		base;
+	uint32_t		size;
+	struct sim_model	*model;
+};
+
+/******************************************************************************/
+/************************ Variables Definitions *******************************/
+/******************************************************************************/
+static struct sim_model *sim_spi[SIM_MAX_SPI_DEVICES];
+static uint8_t sim_spi_cs[SIM_MAX_SPI_DEVICES];
+static struct sim_model *sim_i2c[SIM_MAX_I2C_DEVICES];
+static uint8_t sim_i2c_addr[SIM_MAX_I2C_DEVICES];
+static struct sim_axi_window sim_axi[SIM_MAX_AXI_DEVICES];
+
+/* Every attached model, once */
+static struct sim_model *sim_models[SIM_MAX_SPI_DEVICES +
+				    SIM_MAX_I2C_DEVICES +
+				    SIM_MAX_AXI_DEVICES];
+static uint32_t sim_nb_models;
+
+static uint64_t sim_now_ns;
+static sim_trace_cb sim_trace;
+static void *sim_trace_ctx;
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Add a model to the list of attached models.
+ * @param model - The model.
+ */
+static void sim_model_add(struct sim_model *model)
+{
+	uint32_t i;
+
+	for (i = 0; i < sim_nb_models; i++)
+		if (sim_models[i] == model)
+			return;
+
+	sim_models[sim_nb_models++] = model;
+}
+
+/**
+ * @brief Route a SPI chip select to a model.
+ * @param chip_select - The chip select.
+ * @param model - The model.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sim_spi_attach(uint8_t chip_select, struct sim_model *model)
+{
+	uint32_t i;
+
+	for (i = 0; i < SIM_MAX_SPI_DEVICES; i++) {
+		if (sim_spi[i])
+			continue;
+		sim_spi[i] = model;
+		sim_spi_cs[i] = chip_select;
+		sim_model_add(model);
+
+		return SUCCESS;
+	}
+
+	return FAILURE;
+}
+
+/**
+ * @brief Route an I2C slave address to a model.
+ * @param slave_address - The 7-bit slave address.
+ * @param model - The model.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sim_i2c_attach(uint8_t slave_address, struct sim_model *model)
+{
+	uint32_t i;
+
+	for (i = 0; i < SIM_MAX_I2C_DEVICES; i++) {
+		if (sim_i2c[i])
+			continue;
+		sim_i2c[i] = model;
+		sim_i2c_addr[i] = slave_address;
+		sim_model_add(model);
+
+		return SUCCESS;
+	}
+
+	return FAILURE;
+}
+
+/**
+ * @brief Route an AXI address window to a model.
+ * @param base - The base address, as passed to axi_io_read()/axi_io_write().
+ * @param size - The size of the window in bytes.
+ * @param model - The model.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sim_axi_attach(uint32_t base, uint32_t size, struct sim_model *model)
+{
+	uint32_t i;
+
+	for (i = 0; i < SIM_MAX_AXI_DEVICES; i++) {
+		if (sim_axi[i].model)
+			continue;
+		sim_axi[i].base = base;
+		sim_axi[i].size = size;
+		sim_axi[i].model = model;
+		sim_model_add(model);
+
+		return SUCCESS;
+	}
+
+	return FAILURE;
+}
+
+/**
+ * @brief Detach all the models and reset the simulated time.
+ */
+void sim_reset(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < SIM_MAX_SPI_DEVICES; i++)
+		sim_spi[i] = NULL;
+	for (i = 0; i < SIM_MAX_I2C_DEVICES; i++)
+		sim_i2c[i] = NULL;
+	for (i = 0; i < SIM_MAX_AXI_DEVICES; i++)
+		sim_axi[i].model = NULL;
+	sim_nb_models = 0;
+	sim_now_ns = 0;
+	sim_trace = NULL;
+}
+
+/**
+ * @brief Find the model behind a SPI chip select.
+ * @param chip_select - The chip select.
+ * @return The model, NULL if none is attached.
+ */
+struct sim_model *sim_spi_find(uint8_t chip_select)
+{
+	uint32_t i;
+
+	for (i = 0; i < SIM_MAX_SPI_DEVICES; i++)
+		if (sim_spi[i] && sim_spi_cs[i] == chip_select)
+			return sim_spi[i];
+
+	return NULL;
+}
+
+/**
+ * @brief Find the model behind an I2C slave address.
+ * @param slave_address - The slave address.
+ * @return The model, NULL if none is attached.
+ */
+struct sim_model *sim_i2c_find(uint8_t slave_address)
+{
+	uint32_t i;
+
+	for (i = 0; i < SIM_MAX_I2C_DEVICES; i++)
+		if (sim_i2c[i] && sim_i2c_addr[i] == slave_address)
+			return sim_i2c[i];
+
+	return NULL;
+}
+
+/**
+ * @brief Find the model behind an AXI address.
+ * @param address - The absolute address.
+ * @param offset - The offset of the address inside the model window.
+ * @return The model, NULL if none is attached.
+ */
+struct sim_model *sim_axi_find(uint32_t address, uint32_t *offset)
+{
+	uint32_t i;
+
+	for (i = 0; i < SIM_MAX_AXI_DEVICES; i++) {
+		if (!sim_axi[i].model || address < sim_axi[i].base ||
+		    address - sim_axi[i].base >= sim_axi[i].size)
+			continue;
+		*offset = address - sim_axi[i].base;
+
+		return sim_axi[i].model;
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Simulated time.
+ * @return The simulated time, in ns.
+ */
+uint64_t sim_time_ns(void)
+{
+	return sim_now_ns;
+}
+
+/**
+ * @brief Move the simulated time forward and let the models catch up.
+ * @param ns - The time step, in ns.
+ */
+void sim_advance(uint64_t ns)
+{
+	uint32_t i;
+
+	sim_now_ns += ns;
+
+	for (i = 0; i < sim_nb_models; i++)
+		if (sim_models[i]->ops->advance)
+			sim_models[i]->ops->advance(sim_models[i], sim_now_ns);
+}
+
+/**
+ * @brief Install a callback called after every transaction.
+ * @param cb - The callback, NULL to disable tracing.
+ * @param ctx - Callback context.
+ */
+void sim_trace_set(sim_trace_cb cb, void *ctx)
+{
+	sim_trace = cb;
+	sim_trace_ctx = ctx;
+}
+
+/**
+ * @brief Account a transaction and advance the simulated time by its
+ *        duration.
+ * @param model - The target model.
+ * @param bus - The bus.
+ * @param addr - Register offset for AXI, chip select or slave address
+ *               otherwise.
+ * @param data - Data word for AXI, 0 otherwise.
+ * @param bytes - Number of bytes.
+ * @param duration_ns - Duration of the transaction.
+ */
+void sim_account(struct sim_model *model, enum sim_bus bus, uint32_t addr,
+		 uint32_t data, uint32_t bytes, uint32_t duration_ns)
+{
+	struct sim_trace trace;
+
+	model->stats.transactions++;
+	model->stats.bytes += bytes;
+	model->stats.busy_ns += duration_ns;
+
+	if (sim_trace) {
+		trace.model = model;
+		trace.bus = bus;
+		trace.addr = addr;
+		trace.data = data;
+		trace.bytes = bytes;
+		trace.start_ns = sim_now_ns;
+		trace.duration_ns = duration_ns;
+		sim_trace(&trace, sim_trace_ctx);
+	}
+
+	sim_advance(duration_ns);
+}
+
+/**
+ * @brief Clear the counters of all the attached models.
+ */
+void sim_stats_clear(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < sim_nb_models; i++) {
+		sim_models[i]->stats.transactions = 0;
+		sim_models[i]->stats.bytes = 0;
+		sim_models[i]->stats.busy_ns = 0;
+	}
+}
+
+/**
+ * @brief Print the counters of all the attached models.
+ */
+void sim_stats_print(void)
+{
+	struct sim_stats *stats;
+	uint32_t i;
+
+	printf("sim: %"PRIu64" ns elapsed\n", sim_now_ns);
+	for (i = 0; i < sim_nb_models; i++) {
+		stats = &sim_models[i]->stats;
+		printf("sim: %-16s %10"PRIu64" transactions %10"PRIu64
+		       " bytes %12"PRIu64" ns\n", sim_models[i]->name,
+		       stats->transactions, stats->bytes, stats->busy_ns);
+	}
+}
@@ -0,0 +1,284 @@
+/***************************************************************************//**
+ *   @file   sim_ad9144.c
+ *   @brief  AD9144 SPI register map model for the simulation platform.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "error.h"
+#include "ad9144.h"
+#include "sim_models.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define SIM_AD9144_NUM_REGS	0x500
+#define SIM_AD9144_READ		0x80
+#define SIM_AD9144_PRODIDH	0x91
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+/**
+ * @struct sim_ad9144
+ * @brief AD9144 model state.
+ */
+struct sim_ad9144 {
+	struct sim_model	model;
+	uint8_t			regs[SIM_AD9144_NUM_REGS];
+	uint64_t		pll_lock_ns;
+	uint64_t		cal_ns;
+	/** DAC PLL enabled, locked from dac_lock_ns on */
+	bool			dac_pll_on;
+	uint64_t		dac_lock_ns;
+	/** SERDES PLL enabled, locked from serdes_lock_ns on */
+	bool			serdes_pll_on;
+	uint64_t		serdes_lock_ns;
+	/** Calibration started, done from cal_done_ns on */
+	bool			cal_started;
+	uint64_t		cal_done_ns;
+};
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Load the power-on register values.
+ * @param dev - The model.
+ */
+static void sim_ad9144_defaults(struct sim_ad9144 *dev)
+{
+	memset(dev->regs, 0, sizeof(dev->regs));
+	dev->regs[REG_SPI_PRODIDL] = AD9144_CHIP_ID;
+	dev->regs[REG_SPI_PRODIDH] = SIM_AD9144_PRODIDH;
+	dev->dac_pll_on = false;
+	dev->serdes_pll_on = false;
+	dev->cal_started = false;
+}
+
+/**
+ * @brief Register read, with the status bits computed from simulated time.
+ * @param dev - The model.
+ * @param reg - The register address.
+ * @return The register value.
+ */
+static uint8_t sim_ad9144_read(struct sim_ad9144 *dev, uint16_t reg)
+{
+	uint64_t now = sim_time_ns();
+
+	switch (reg) {
+	case REG_DACPLLSTATUS:
+		if (dev->dac_pll_on && now >= dev->dac_lock_ns)
+			return CP_CAL_VALID | RFPLL_LOCK;
+		return 0;
+	case REG_PLL_STATUS:
+		if (dev->serdes_pll_on && now >= dev->serdes_lock_ns)
+			return SPI_CP_CAL_VALID_RB | SPI_PLL_LOCK_RB;
+		return 0;
+	case REG_CAL_CTRL:
+		if (!dev->cal_started)
+			return dev->regs[reg];
+		return dev->regs[reg] |
+		       (now >= dev->cal_done_ns ? CAL_FIN : CAL_ACTIVE);
+	case REG_CODEGRPSYNCFLG:
+	case REG_FRAMESYNCFLG:
+	case REG_GOODCHKSUMFLG:
+	case REG_INITLANESYNCFLG:
+		/* The enabled lanes are always in sync */
+		return dev->regs[REG_LANEENABLE];
+	default:
+		return dev->regs[reg];
+	}
+}
+
+/**
+ * @brief Register write, starting the PLL and calibration timers.
+ * @param dev - The model.
+ * @param reg - The register address.
+ * @param val - The register value.
+ */
+static void sim_ad9144_write(struct sim_ad9144 *dev, uint16_t reg,
+			     uint8_t val)
+{
+	uint64_t now = sim_time_ns();
+
+	switch (reg) {
+	case REG_SPI_INTFCONFA:
+		if (val & (SOFTRESET_M | SOFTRESET)) {
+			sim_ad9144_defaults(dev);
+			return;
+		}
+		break;
+	case REG_SPI_PRODIDL:
+	case REG_SPI_PRODIDH:
+	case REG_DACPLLSTATUS:
+	case REG_PLL_STATUS:
+	case REG_CODEGRPSYNCFLG:
+	case REG_FRAMESYNCFLG:
+	case REG_GOODCHKSUMFLG:
+	case REG_INITLANESYNCFLG:
+		return;
+	case REG_DACPLLCNTRL:
+		if ((val & ENABLE_SYNTH) &&
+		    (!dev->dac_pll_on || (val & SYNTH_RECAL)))
+			dev->dac_lock_ns = now + dev->pll_lock_ns;
+		dev->dac_pll_on = val & ENABLE_SYNTH;
+		break;
+	case REG_SYNTH_ENABLE_CNTRL:
+		if ((val & SPI_ENABLE_SYNTH) &&
+		    (!dev->serdes_pll_on || (val & SPI_RECAL_SYNTH)))
+			dev->serdes_lock_ns = now + dev->pll_lock_ns;
+		dev->serdes_pll_on = val & SPI_ENABLE_SYNTH;
+		break;
+	case REG_CAL_CTRL:
+		if ((val & CAL_START) && !(dev->regs[reg] & CAL_START)) {
+			dev->cal_started = true;
+			dev->cal_done_ns = now + dev->cal_ns;
+		} else if (!(val & CAL_EN)) {
+			dev->cal_started = false;
+		}
+		val &= ~(CAL_FIN | CAL_ACTIVE);
+		break;
+	default:
+		break;
+	}
+
+	dev->regs[reg] = val;
+}
+
+/**
+ * @brief SPI transfer: 16-bit instruction followed by one or more data bytes,
+ *        the address moving in the direction selected through ADDRINC.
+ * @param model - The model.
+ * @param data - The transfer buffer, updated in place.
+ * @param bytes - Number of bytes.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+static int32_t sim_ad9144_spi_xfer(struct sim_model *model, uint8_t *data,
+				   uint16_t bytes)
+{
+	struct sim_ad9144 *dev = model->priv;
+	bool read = data[0] & SIM_AD9144_READ;
+	uint16_t reg;
+	uint16_t i;
+
+	if (bytes < 3)
+		return FAILURE;
+
+	reg = ((data[0] & ~SIM_AD9144_READ) << 8) | data[1];
+	for (i = 2; i < bytes; i++) {
+		if (reg < SIM_AD9144_NUM_REGS) {
+			if (read)
+				data[i] = sim_ad9144_read(dev, reg);
+			else
+				sim_ad9144_write(dev, reg, data[i]);
+		} else if (read) {
+			data[i] = 0;
+		}
+		if (dev->regs[REG_SPI_INTFCONFA] & ADDRINC)
+			reg++;
+		else
+			reg--;
+	}
+
+	return SUCCESS;
+}
+
+static const struct sim_model_ops sim_ad9144_ops = {
+	.spi_xfer = sim_ad9144_spi_xfer,
+};
+
+/**
+ * @brief Register value, as last written by the driver or set by the model.
+ * @param model - The model.
+ * @param reg - The register address.
+ * @return The register value.
+ */
+uint8_t sim_ad9144_reg(struct sim_model *model, uint16_t reg)
+{
+	struct sim_ad9144 *dev = model->priv;
+
+	if (reg >= SIM_AD9144_NUM_REGS)
+		return 0;
+
+	return sim_ad9144_read(dev, reg);
+}
+
+/**
+ * @brief Create an AD9144 model.
+ * @param model - The model.
+ * @param init - The model parameters.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sim_ad9144_init(struct sim_model **model,
+			const struct sim_ad9144_init *init)
+{
+	struct sim_ad9144 *dev;
+
+	dev = (struct sim_ad9144 *)calloc(1, sizeof(*dev));
+	if (!dev)
+		return FAILURE;
+
+	dev->model.name = init->name;
+	dev->model.ops = &sim_ad9144_ops;
+	dev->model.priv = dev;
+	dev->model.timing.bus_hz = init->spi_hz;
+	dev->pll_lock_ns = (uint64_t)init->pll_lock_us * 1000;
+	dev->cal_ns = (uint64_t)init->cal_us * 1000;
+	sim_ad9144_defaults(dev);
+
+	*model = &dev->model;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Free the resources allocated by sim_ad9144_init().
+ * @param model - The model.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sim_ad9144_remove(struct sim_model *model)
+{
+	free(model->priv);
+
+	return SUCCESS;
+}
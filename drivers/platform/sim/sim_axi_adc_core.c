@@ -0,0 +1,239 @@
+/***************************************************************************//**
+ *   @file   sim_axi_adc_core.c
+ *   @brief  axi_adc_core model for the simulation platform.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdlib.h>
+#include "error.h"
+#include "axi_adc_core.h"
+#include "sim_models.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define SIM_AXI_ADC_NUM_REGS	0x400
+#define SIM_AXI_ADC_MAX_CHAN	16
+#define SIM_AXI_ADC_VERSION	0x000a0162
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+/**
+ * @struct sim_axi_adc
+ * @brief axi_adc_core model state.
+ */
+struct sim_axi_adc {
+	struct sim_model	model;
+	uint32_t		regs[SIM_AXI_ADC_NUM_REGS];
+	uint32_t		clock_hz;
+	uint32_t		num_channels;
+	uint32_t		pn_err_mask;
+	/** Next sample of the ramp produced by sim_axi_adc_source() */
+	uint16_t		sample;
+};
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Register read.
+ * @param model - The model.
+ * @param offset - The register offset.
+ * @param data - The register value.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+static int32_t sim_axi_adc_reg_read(struct sim_model *model,
+				    uint32_t offset, uint32_t *data)
+{
+	struct sim_axi_adc *adc = model->priv;
+	uint32_t *regs = adc->regs;
+	uint32_t ch;
+
+	if ((offset >> 2) >= SIM_AXI_ADC_NUM_REGS) {
+		*data = 0;
+		return SUCCESS;
+	}
+
+	for (ch = 0; ch < adc->num_channels; ch++) {
+		if (!(adc->pn_err_mask & BIT(ch)))
+			continue;
+		regs[AXI_ADC_REG_CHAN_STATUS(ch) >> 2] |= AXI_ADC_PN_ERR |
+				AXI_ADC_PN_OOS;
+		regs[AXI_ADC_REG_STATUS >> 2] |= AXI_ADC_MUX_PN_ERR |
+						 AXI_ADC_MUX_PN_OOS;
+	}
+
+	switch (offset) {
+	case 0:
+		*data = SIM_AXI_ADC_VERSION;
+		break;
+	case AXI_ADC_REG_STATUS:
+		*data = regs[offset >> 2];
+		if ((regs[AXI_ADC_REG_RSTN >> 2] &
+		     (AXI_ADC_MMCM_RSTN | AXI_ADC_RSTN)) ==
+		    (AXI_ADC_MMCM_RSTN | AXI_ADC_RSTN))
+			*data |= AXI_ADC_STATUS;
+		break;
+	case AXI_ADC_REG_CLK_FREQ:
+		/* clock_hz = freq * ratio * 390625 / 256 */
+		*data = ((uint64_t)adc->clock_hz << 8) / 390625;
+		break;
+	case AXI_ADC_REG_CLK_RATIO:
+		*data = 1;
+		break;
+	default:
+		*data = regs[offset >> 2];
+		break;
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Register write.
+ * @param model - The model.
+ * @param offset - The register offset.
+ * @param data - The register value.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+static int32_t sim_axi_adc_reg_write(struct sim_model *model,
+				     uint32_t offset, uint32_t data)
+{
+	struct sim_axi_adc *adc = model->priv;
+	uint32_t ch;
+
+	if ((offset >> 2) >= SIM_AXI_ADC_NUM_REGS)
+		return SUCCESS;
+
+	/* Status flags are sticky and cleared by writing 1 */
+	if (offset == AXI_ADC_REG_STATUS) {
+		adc->regs[offset >> 2] &= ~data;
+		return SUCCESS;
+	}
+	for (ch = 0; ch < adc->num_channels; ch++) {
+		if (offset == AXI_ADC_REG_CHAN_STATUS(ch)) {
+			adc->regs[offset >> 2] &= ~data;
+			return SUCCESS;
+		}
+	}
+
+	adc->regs[offset >> 2] = data;
+
+	return SUCCESS;
+}
+
+static const struct sim_model_ops sim_axi_adc_ops = {
+	.reg_read = sim_axi_adc_reg_read,
+	.reg_write = sim_axi_adc_reg_write,
+};
+
+/**
+ * @brief DMA source producing one 16-bit ramp per enabled channel, with the
+ *        channels interleaved.
+ * @param ctx - The axi_adc_core model.
+ * @param buf - The destination buffer.
+ * @param bytes - Number of bytes to produce.
+ */
+void sim_axi_adc_source(void *ctx, uint8_t *buf, uint32_t bytes)
+{
+	struct sim_model *model = ctx;
+	struct sim_axi_adc *adc = model->priv;
+	uint16_t *data = (uint16_t *)buf;
+	uint32_t enabled[SIM_AXI_ADC_MAX_CHAN];
+	uint32_t nb_enabled = 0;
+	uint32_t ch, i;
+
+	for (ch = 0; ch < adc->num_channels; ch++)
+		if (adc->regs[AXI_ADC_REG_CHAN_CNTRL(ch) >> 2] & AXI_ADC_ENABLE)
+			enabled[nb_enabled++] = ch;
+	if (!nb_enabled)
+		return;
+
+	for (i = 0; i < bytes / 2; i++) {
+		ch = enabled[i % nb_enabled];
+		data[i] = adc->sample + (ch << 12);
+		if (i % nb_enabled == nb_enabled - 1)
+			adc->sample++;
+	}
+}
+
+/**
+ * @brief Create an axi_adc_core model.
+ * @param model - The model.
+ * @param init - The model parameters.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sim_axi_adc_init(struct sim_model **model,
+			 const struct sim_axi_adc_init *init)
+{
+	struct sim_axi_adc *adc;
+
+	if (init->num_channels > SIM_AXI_ADC_MAX_CHAN)
+		return FAILURE;
+
+	adc = (struct sim_axi_adc *)calloc(1, sizeof(*adc));
+	if (!adc)
+		return FAILURE;
+
+	adc->model.name = init->name;
+	adc->model.ops = &sim_axi_adc_ops;
+	adc->model.priv = adc;
+	adc->model.timing.access_ns = init->access_ns;
+	adc->clock_hz = init->clock_hz;
+	adc->num_channels = init->num_channels;
+	adc->pn_err_mask = init->pn_err_mask;
+
+	*model = &adc->model;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Free the resources allocated by sim_axi_adc_init().
+ * @param model - The model.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sim_axi_adc_remove(struct sim_model *model)
+{
+	free(model->priv);
+
+	return SUCCESS;
+}
@@ -0,0 +1,326 @@
+/***************************************************************************//**
+ *   @file   sim_axi_dmac.c
+ *   @brief  axi_dmac model for the simulation platform.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdbool.h>
+#include <stdlib.h>
+#include "error.h"
+#include "axi_dmac.h"
+#include "sim_models.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define SIM_AXI_DMAC_NUM_REGS	((AXI_DMAC_REG_TRANSFER_DONE >> 2) + 1)
+#define SIM_AXI_DMAC_NUM_IDS	4
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+/**
+ * @struct sim_axi_dmac_xfer
+ * @brief A transfer accepted by the model.
+ */
+struct sim_axi_dmac_xfer {
+	uint32_t	id;
+	uint32_t	length;
+	uint32_t	dest;
+	/** The destination address was written for this transfer */
+	bool		to_mem;
+	bool		cyclic;
+};
+
+/**
+ * @struct sim_axi_dmac
+ * @brief axi_dmac model state.
+ */
+struct sim_axi_dmac {
+	struct sim_model	model;
+	uint32_t		regs[SIM_AXI_DMAC_NUM_REGS];
+	uint32_t		bytes_per_us;
+	uint8_t			*mem;
+	uint32_t		mem_base;
+	uint32_t		mem_size;
+	sim_dma_source		source;
+	void			*source_ctx;
+	/** The destination address was written since the last submit */
+	bool			dest_set;
+	/** Accepted transfers, the first one is in flight */
+	struct sim_axi_dmac_xfer	queue[SIM_AXI_DMAC_NUM_IDS];
+	uint32_t		queued;
+	uint64_t		duration_ns;
+	uint64_t		done_ns;
+};
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Write the data of a finished transfer to the memory window.
+ * @param dmac - The model.
+ * @param xfer - The transfer.
+ */
+static void sim_axi_dmac_fill(struct sim_axi_dmac *dmac,
+			      struct sim_axi_dmac_xfer *xfer)
+{
+	uint32_t offset, len, i;
+	uint16_t *ramp;
+
+	if (!xfer->to_mem || !dmac->mem || xfer->dest < dmac->mem_base ||
+	    xfer->dest - dmac->mem_base >= dmac->mem_size)
+		return;
+
+	offset = xfer->dest - dmac->mem_base;
+	len = xfer->length;
+	if (len > dmac->mem_size - offset)
+		len = dmac->mem_size - offset;
+
+	if (dmac->source) {
+		dmac->source(dmac->source_ctx, dmac->mem + offset, len);
+	} else {
+		ramp = (uint16_t *)(dmac->mem + offset);
+		for (i = 0; i < len / 2; i++)
+			ramp[i] = i;
+	}
+}
+
+/**
+ * @brief Start the transfer at the head of the queue.
+ * @param dmac - The model.
+ * @param now_ns - The simulated start time.
+ */
+static void sim_axi_dmac_start(struct sim_axi_dmac *dmac, uint64_t now_ns)
+{
+	uint32_t bw;
+
+	bw = dmac->bytes_per_us ? dmac->bytes_per_us : 1;
+	dmac->duration_ns = ((uint64_t)dmac->queue[0].length * 1000 + bw - 1) /
+			    bw;
+	dmac->done_ns = now_ns + dmac->duration_ns;
+	dmac->regs[AXI_DMAC_REG_IRQ_PENDING >> 2] |= AXI_DMAC_IRQ_SOT;
+}
+
+/**
+ * @brief Accept a transfer submitted through START_TRANSFER. While all the
+ * transfer IDs are in use the submission stays pending, as on hardware.
+ * @param dmac - The model.
+ * @param now_ns - The simulated time.
+ */
+static void sim_axi_dmac_submit(struct sim_axi_dmac *dmac, uint64_t now_ns)
+{
+	uint32_t *regs = dmac->regs;
+	struct sim_axi_dmac_xfer *xfer;
+
+	if (!regs[AXI_DMAC_REG_START_TRANSFER >> 2] ||
+	    dmac->queued == SIM_AXI_DMAC_NUM_IDS)
+		return;
+
+	xfer = &dmac->queue[dmac->queued];
+	xfer->id = regs[AXI_DMAC_REG_TRANSFER_ID >> 2];
+	xfer->length = (regs[AXI_DMAC_REG_X_LENGTH >> 2] + 1) *
+		       (regs[AXI_DMAC_REG_Y_LENGTH >> 2] + 1);
+	xfer->dest = regs[AXI_DMAC_REG_DEST_ADDRESS >> 2];
+	xfer->to_mem = dmac->dest_set;
+	xfer->cyclic = regs[AXI_DMAC_REG_FLAGS >> 2] & DMA_CYCLIC;
+	dmac->dest_set = false;
+
+	regs[AXI_DMAC_REG_START_TRANSFER >> 2] = 0;
+	regs[AXI_DMAC_REG_TRANSFER_DONE >> 2] &= ~BIT(xfer->id);
+	regs[AXI_DMAC_REG_TRANSFER_ID >> 2] = (xfer->id + 1) %
+					      SIM_AXI_DMAC_NUM_IDS;
+
+	if (!dmac->queued++)
+		sim_axi_dmac_start(dmac, now_ns);
+}
+
+/**
+ * @brief Complete the transfers whose time has come and start the next ones.
+ * @param model - The model.
+ * @param now_ns - The simulated time.
+ */
+static void sim_axi_dmac_advance(struct sim_model *model, uint64_t now_ns)
+{
+	struct sim_axi_dmac *dmac = model->priv;
+	uint32_t *regs = dmac->regs;
+	uint64_t done_ns;
+	uint32_t i;
+
+	while (dmac->queued && now_ns >= dmac->done_ns) {
+		sim_axi_dmac_fill(dmac, &dmac->queue[0]);
+		regs[AXI_DMAC_REG_IRQ_PENDING >> 2] |= AXI_DMAC_IRQ_EOT;
+		regs[AXI_DMAC_REG_TRANSFER_DONE >> 2] |= BIT(dmac->queue[0].id);
+
+		/* Cyclic transfers restart right away */
+		if (dmac->queue[0].cyclic) {
+			regs[AXI_DMAC_REG_IRQ_PENDING >> 2] |= AXI_DMAC_IRQ_SOT;
+			dmac->done_ns += dmac->duration_ns;
+			continue;
+		}
+
+		done_ns = dmac->done_ns;
+		dmac->queued--;
+		for (i = 0; i < dmac->queued; i++)
+			dmac->queue[i] = dmac->queue[i + 1];
+		if (dmac->queued)
+			sim_axi_dmac_start(dmac, done_ns);
+		sim_axi_dmac_submit(dmac, done_ns);
+	}
+}
+
+/**
+ * @brief Register read.
+ * @param model - The model.
+ * @param offset - The register offset.
+ * @param data - The register value.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+static int32_t sim_axi_dmac_reg_read(struct sim_model *model,
+				     uint32_t offset, uint32_t *data)
+{
+	struct sim_axi_dmac *dmac = model->priv;
+
+	if ((offset >> 2) >= SIM_AXI_DMAC_NUM_REGS) {
+		*data = 0;
+		return SUCCESS;
+	}
+
+	*data = dmac->regs[offset >> 2];
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Register write.
+ * @param model - The model.
+ * @param offset - The register offset.
+ * @param data - The register value.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+static int32_t sim_axi_dmac_reg_write(struct sim_model *model,
+				      uint32_t offset, uint32_t data)
+{
+	struct sim_axi_dmac *dmac = model->priv;
+	uint32_t *regs = dmac->regs;
+
+	if ((offset >> 2) >= SIM_AXI_DMAC_NUM_REGS)
+		return SUCCESS;
+
+	switch (offset) {
+	case AXI_DMAC_REG_IRQ_PENDING:
+		regs[offset >> 2] &= ~data;
+		break;
+	case AXI_DMAC_REG_CTRL:
+		regs[offset >> 2] = data;
+		if (!(data & AXI_DMAC_CTRL_ENABLE)) {
+			dmac->queued = 0;
+			regs[AXI_DMAC_REG_START_TRANSFER >> 2] = 0;
+		}
+		break;
+	case AXI_DMAC_REG_START_TRANSFER:
+		if ((data & 1) &&
+		    (regs[AXI_DMAC_REG_CTRL >> 2] & AXI_DMAC_CTRL_ENABLE)) {
+			regs[offset >> 2] = 1;
+			sim_axi_dmac_submit(dmac, sim_time_ns());
+		}
+		break;
+	case AXI_DMAC_REG_TRANSFER_ID:
+	case AXI_DMAC_REG_TRANSFER_DONE:
+		break;
+	case AXI_DMAC_REG_DEST_ADDRESS:
+		dmac->dest_set = true;
+	/* fall through */
+	default:
+		regs[offset >> 2] = data;
+		break;
+	}
+
+	return SUCCESS;
+}
+
+static const struct sim_model_ops sim_axi_dmac_ops = {
+	.reg_read = sim_axi_dmac_reg_read,
+	.reg_write = sim_axi_dmac_reg_write,
+	.advance = sim_axi_dmac_advance,
+};
+
+/**
+ * @brief Create an axi_dmac model.
+ * @param model - The model.
+ * @param init - The model parameters.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sim_axi_dmac_init(struct sim_model **model,
+			  const struct sim_axi_dmac_init *init)
+{
+	struct sim_axi_dmac *dmac;
+
+	dmac = (struct sim_axi_dmac *)calloc(1, sizeof(*dmac));
+	if (!dmac)
+		return FAILURE;
+
+	dmac->model.name = init->name;
+	dmac->model.ops = &sim_axi_dmac_ops;
+	dmac->model.priv = dmac;
+	dmac->model.timing.access_ns = init->access_ns;
+	dmac->bytes_per_us = init->bytes_per_us;
+	dmac->mem = init->mem;
+	dmac->mem_base = init->mem_base;
+	dmac->mem_size = init->mem_size;
+	dmac->source = init->source;
+	dmac->source_ctx = init->source_ctx;
+
+	*model = &dmac->model;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Free the resources allocated by sim_axi_dmac_init().
+ * @param model - The model.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sim_axi_dmac_remove(struct sim_model *model)
+{
+	free(model->priv);
+
+	return SUCCESS;
+}
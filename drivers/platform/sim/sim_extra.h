@@ -0,0 +1,201 @@
+/***************************************************************************//**
+ *   @file   sim_extra.h
+ *   @brief  Simulation platform: device models, simulated time and statistics.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+#ifndef SIM_EXTRA_H_
+#define SIM_EXTRA_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdint.h>
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define SIM_MAX_SPI_DEVICES	8
+#define SIM_MAX_I2C_DEVICES	8
+#define SIM_MAX_AXI_DEVICES	16
+#define SIM_MAX_GPIOS		128
+
+/* Bus timing used when neither the model nor the descriptor sets one. */
+#define SIM_DEFAULT_SPI_HZ	10000000
+#define SIM_DEFAULT_I2C_HZ	400000
+#define SIM_DEFAULT_AXI_NS	100
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+/**
+ * @enum sim_bus
+ * @brief Bus a transaction went through.
+ */
+enum sim_bus {
+	SIM_BUS_SPI,
+	SIM_BUS_I2C_WRITE,
+	SIM_BUS_I2C_READ,
+	SIM_BUS_AXI_READ,
+	SIM_BUS_AXI_WRITE,
+};
+
+struct sim_model;
+
+/**
+ * @struct sim_model_ops
+ * @brief Callbacks implementing a device model. Unused ones can be NULL.
+ */
+struct sim_model_ops {
+	/** Full duplex SPI transfer, data is updated in place */
+	int32_t (*spi_xfer)(struct sim_model *model, uint8_t *data,
+			    uint16_t bytes);
+	/** I2C write */
+	int32_t (*i2c_write)(struct sim_model *model, const uint8_t *data,
+			     uint8_t bytes, uint8_t stop);
+	/** I2C read */
+	int32_t (*i2c_read)(struct sim_model *model, uint8_t *data,
+			    uint8_t bytes, uint8_t stop);
+	/** Memory mapped register read, offset relative to the base */
+	int32_t (*reg_read)(struct sim_model *model, uint32_t offset,
+			    uint32_t *data);
+	/** Memory mapped register write, offset relative to the base */
+	int32_t (*reg_write)(struct sim_model *model, uint32_t offset,
+			     uint32_t data);
+	/** Simulated time moved forward, now_ns is the new time */
+	void (*advance)(struct sim_model *model, uint64_t now_ns);
+};
+
+/**
+ * @struct sim_timing
+ * @brief Timing annotation of a model.
+ */
+struct sim_timing {
+	/** Fixed cost of every transaction, in ns */
+	uint32_t	access_ns;
+	/** Serial bus clock, 0 to use the descriptor or the default */
+	uint32_t	bus_hz;
+};
+
+/**
+ * @struct sim_stats
+ * @brief Traffic counters of a model.
+ */
+struct sim_stats {
+	/** Number of transactions */
+	uint64_t	transactions;
+	/** Number of bytes transferred */
+	uint64_t	bytes;
+	/** Simulated time spent in transactions, in ns */
+	uint64_t	busy_ns;
+};
+
+/**
+ * @struct sim_model
+ * @brief Device model instance, attached to a bus by the application.
+ */
+struct sim_model {
+	/** Name used in reports */
+	const char			*name;
+	/** Model callbacks */
+	const struct sim_model_ops	*ops;
+	/** Model state */
+	void				*priv;
+	/** Timing annotation */
+	struct sim_timing		timing;
+	/** Traffic counters */
+	struct sim_stats		stats;
+};
+
+/**
+ * @struct sim_trace
+ * @brief One transaction, as passed to the trace callback.
+ */
+struct sim_trace {
+	/** Target model */
+	struct sim_model	*model;
+	/** Bus */
+	enum sim_bus		bus;
+	/** Register offset for AXI, chip select or slave address otherwise */
+	uint32_t		addr;
+	/** Data word for AXI, 0 otherwise */
+	uint32_t		data;
+	/** Number of bytes */
+	uint32_t		bytes;
+	/** Simulated start time, in ns */
+	uint64_t		start_ns;
+	/** Duration, in ns */
+	uint32_t		duration_ns;
+};
+
+typedef void (*sim_trace_cb)(const struct sim_trace *trace, void *ctx);
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+/* Route a SPI chip select to a model. */
+int32_t sim_spi_attach(uint8_t chip_select, struct sim_model *model);
+/* Route an I2C slave address to a model. */
+int32_t sim_i2c_attach(uint8_t slave_address, struct sim_model *model);
+/* Route an AXI address window to a model. */
+int32_t sim_axi_attach(uint32_t base, uint32_t size, struct sim_model *model);
+/* Detach all the models and reset the simulated time. */
+void sim_reset(void);
+
+/* Simulated time, in ns. */
+uint64_t sim_time_ns(void);
+/* Move the simulated time forward. */
+void sim_advance(uint64_t ns);
+
+/* Install a callback called after every transaction. */
+void sim_trace_set(sim_trace_cb cb, void *ctx);
+/* Clear the counters of all the attached models. */
+void sim_stats_clear(void);
+/* Print the counters of all the attached models. */
+void sim_stats_print(void);
+
+/* Drive the level seen by the driver on a GPIO. */
+void sim_gpio_set_input(uint8_t number, uint8_t value);
+/* Level last written by the driver to a GPIO. */
+uint8_t sim_gpio_get_output(uint8_t number);
+
+/* Model lookup and accounting, used by the bus drivers. */
+struct sim_model *sim_spi_find(uint8_t chip_select);
+struct sim_model *sim_i2c_find(uint8_t slave_address);
+struct sim_model *sim_axi_find(uint32_t address, uint32_t *offset);
+void sim_account(struct sim_model *model, enum sim_bus bus, uint32_t addr,
+		 uint32_t data, uint32_t bytes, uint32_t duration_ns);
+
+#endif // SIM_EXTRA_H_
@@ -0,0 +1,176 @@
+/***************************************************************************//**
+ *   @file   sim_models.h
+ *   @brief  Register level device models for the simulation platform.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+#ifndef SIM_MODELS_H_
+#define SIM_MODELS_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+#include "sim_extra.h"
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+/* Produce the data a DMA transfer writes to memory. */
+typedef void (*sim_dma_source)(void *ctx, uint8_t *buf, uint32_t bytes);
+
+/**
+ * @struct sim_axi_dmac_init
+ * @brief Parameters of the axi_dmac model.
+ */
+struct sim_axi_dmac_init {
+	/** Name used in reports */
+	const char	*name;
+	/** Register access time in ns, 0 for the default */
+	uint32_t	access_ns;
+	/** Transfer throughput in bytes per us */
+	uint32_t	bytes_per_us;
+	/** Host buffer standing for the DMA memory, can be NULL */
+	uint8_t		*mem;
+	/** Bus address of mem */
+	uint32_t	mem_base;
+	/** Size of mem in bytes */
+	uint32_t	mem_size;
+	/** Data source of device to memory transfers, NULL for a ramp */
+	sim_dma_source	source;
+	/** Source context */
+	void		*source_ctx;
+};
+
+/**
+ * @struct sim_axi_adc_init
+ * @brief Parameters of the axi_adc_core model.
+ */
+struct sim_axi_adc_init {
+	/** Name used in reports */
+	const char	*name;
+	/** Register access time in ns, 0 for the default */
+	uint32_t	access_ns;
+	/** Interface clock reported through CLK_FREQ, in Hz */
+	uint32_t	clock_hz;
+	/** Number of channels */
+	uint32_t	num_channels;
+	/** Channels whose PN monitor reports errors */
+	uint32_t	pn_err_mask;
+};
+
+/**
+ * @struct sim_ad9144_init
+ * @brief Parameters of the AD9144 model.
+ */
+struct sim_ad9144_init {
+	/** Name used in reports */
+	const char	*name;
+	/** SPI clock, 0 to use the descriptor speed */
+	uint32_t	spi_hz;
+	/** Time the DAC and SERDES PLLs take to lock, in us */
+	uint32_t	pll_lock_us;
+	/** Time a DAC calibration takes, in us */
+	uint32_t	cal_us;
+};
+
+/**
+ * @struct sim_sd_init
+ * @brief Parameters of the SD card model.
+ */
+struct sim_sd_init {
+	/** Name used in reports */
+	const char	*name;
+	/** SPI clock, 0 to use the descriptor speed */
+	uint32_t	spi_hz;
+	/** Image file holding the card content */
+	const char	*path;
+	/** Card size in bytes, 0 for the size of the image file */
+	uint64_t	size;
+	/** Report CMD23 (SET_BLOCK_COUNT) support in the SCR */
+	bool		cmd23;
+};
+
+/**
+ * @struct sim_sd_stats
+ * @brief Protocol counters of the SD card model.
+ */
+struct sim_sd_stats {
+	/** Commands received, CMD55 prefixes included */
+	uint32_t	commands;
+	/** Blocks sent to the host */
+	uint32_t	blocks_read;
+	/** Blocks written to the image */
+	uint32_t	blocks_written;
+	/** CMD18 commands */
+	uint32_t	multi_reads;
+	/** CMD25 commands */
+	uint32_t	multi_writes;
+	/** Blocks announced through ACMD23 */
+	uint32_t	pre_erased;
+	/** Blocks erased by CMD38 */
+	uint32_t	blocks_erased;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+/* axi_dmac model. */
+int32_t sim_axi_dmac_init(struct sim_model **model,
+			  const struct sim_axi_dmac_init *init);
+int32_t sim_axi_dmac_remove(struct sim_model *model);
+
+/* axi_adc_core model. */
+int32_t sim_axi_adc_init(struct sim_model **model,
+			 const struct sim_axi_adc_init *init);
+int32_t sim_axi_adc_remove(struct sim_model *model);
+/* DMA source producing one 16-bit ramp per enabled channel. */
+void sim_axi_adc_source(void *ctx, uint8_t *buf, uint32_t bytes);
+
+/* AD9144 SPI register map model. */
+int32_t sim_ad9144_init(struct sim_model **model,
+			const struct sim_ad9144_init *init);
+int32_t sim_ad9144_remove(struct sim_model *model);
+/* Register value, as last written by the driver or set by the model. */
+uint8_t sim_ad9144_reg(struct sim_model *model, uint16_t reg);
+
+/* SD card model, SPI mode, backed by an image file. */
+int32_t sim_sd_init(struct sim_model **model, const struct sim_sd_init *init);
+int32_t sim_sd_remove(struct sim_model *model);
+/* Protocol counters. */
+const struct sim_sd_stats *sim_sd_stats(struct sim_model *model);
+
+#endif // SIM_MODELS_H_
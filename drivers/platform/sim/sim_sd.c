@@ -0,0 +1,616 @@
+/***************************************************************************//**
+ *   @file   sim_sd.c
+ *   @brief  File backed SD card model (SPI mode) for the simulation platform.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "error.h"
+#include "sim_models.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define SIM_SD_BLOCK_LEN	512
+#define SIM_SD_CMD_LEN		6
+#define SIM_SD_CRC_LEN		2
+/* Capacity unit of a version 2.0 CSD */
+#define SIM_SD_CSIZE_UNIT	(512 * 1024)
+/* Busy bytes sent after a block is written */
+#define SIM_SD_BUSY_BYTES	4
+#define SIM_SD_OUT_LEN		(2 * SIM_SD_BLOCK_LEN)
+
+#define SIM_SD_R1_IDLE		0x01
+#define SIM_SD_R1_ILLEGAL	0x04
+#define SIM_SD_R1_PARAM		0x40
+
+#define SIM_SD_TOKEN_1		0xFE
+#define SIM_SD_TOKEN_N		0xFC
+#define SIM_SD_TOKEN_STOP	0xFD
+#define SIM_SD_DATA_ACCEPTED	0x05
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+/**
+ * @enum sim_sd_state
+ * @brief What the model expects from the host.
+ */
+enum sim_sd_state {
+	/** A command */
+	SIM_SD_IDLE,
+	/** A command, while sending blocks of a CMD18 */
+	SIM_SD_READING,
+	/** A start block or stop transmission token */
+	SIM_SD_WRITE_TOKEN,
+	/** Block data and CRC */
+	SIM_SD_WRITE_DATA,
+};
+
+/**
+ * @struct sim_sd
+ * @brief SD card model state.
+ */
+struct sim_sd {
+	struct sim_model	model;
+	FILE			*file;
+	/** Number of blocks of the card */
+	uint32_t		blocks;
+	bool			cmd23;
+	enum sim_sd_state	state;
+	/** Card not initialized by ACMD41 yet */
+	bool			idle;
+	uint32_t		acmd41_count;
+	/** The previous command was CMD55 */
+	bool			app_cmd;
+	uint8_t			cmd[SIM_SD_CMD_LEN];
+	uint32_t		cmd_len;
+	/** Bytes sent to the host, from out[out_pos] to out[out_len - 1] */
+	uint8_t			out[SIM_SD_OUT_LEN];
+	uint32_t		out_pos;
+	uint32_t		out_len;
+	/** Next block of a multiple block transfer */
+	uint32_t		block;
+	/** Blocks left in the transfer, 0 if ended by the host */
+	uint32_t		block_count;
+	/** Block count set by CMD23 for the next transfer */
+	uint32_t		next_count;
+	/** The write in progress is a CMD25 */
+	bool			multi;
+	/** Range set by CMD32 and CMD33 */
+	uint32_t		erase_start;
+	uint32_t		erase_end;
+	uint8_t			data[SIM_SD_BLOCK_LEN + SIM_SD_CRC_LEN];
+	uint32_t		data_len;
+	struct sim_sd_stats	stats;
+};
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Queue bytes to be sent to the host.
+ * @param dev - The model.
+ * @param buf - The bytes, NULL to queue 0xFF.
+ * @param len - Number of bytes.
+ */
+static void sim_sd_push(struct sim_sd *dev, const uint8_t *buf, uint32_t len)
+{
+	if (dev->out_pos == dev->out_len) {
+		dev->out_pos = 0;
+		dev->out_len = 0;
+	} else if (dev->out_len + len > SIM_SD_OUT_LEN) {
+		memmove(dev->out, dev->out + dev->out_pos,
+			dev->out_len - dev->out_pos);
+		dev->out_len -= dev->out_pos;
+		dev->out_pos = 0;
+	}
+	if (dev->out_len + len > SIM_SD_OUT_LEN)
+		len = SIM_SD_OUT_LEN - dev->out_len;
+
+	if (buf)
+		memcpy(dev->out + dev->out_len, buf, len);
+	else
+		memset(dev->out + dev->out_len, 0xFF, len);
+	dev->out_len += len;
+}
+
+/**
+ * @brief Queue the answer to a command: one fill byte and the response.
+ * @param dev - The model.
+ * @param resp - The response.
+ * @param len - Response length.
+ */
+static void sim_sd_respond(struct sim_sd *dev, const uint8_t *resp,
+			   uint32_t len)
+{
+	sim_sd_push(dev, NULL, 1);
+	sim_sd_push(dev, resp, len);
+}
+
+/**
+ * @brief Queue a R1 response.
+ * @param dev - The model.
+ * @param flags - Error flags.
+ */
+static void sim_sd_r1(struct sim_sd *dev, uint8_t flags)
+{
+	uint8_t r1 = flags | (dev->idle ? SIM_SD_R1_IDLE : 0);
+
+	sim_sd_respond(dev, &r1, 1);
+}
+
+/**
+ * @brief Queue a data block: fill byte, start token, data and CRC.
+ * @param dev - The model.
+ * @param data - The data.
+ * @param len - Data length.
+ */
+static void sim_sd_push_block(struct sim_sd *dev, const uint8_t *data,
+			      uint32_t len)
+{
+	uint8_t token = SIM_SD_TOKEN_1;
+
+	sim_sd_push(dev, NULL, 1);
+	sim_sd_push(dev, &token, 1);
+	sim_sd_push(dev, data, len);
+	sim_sd_push(dev, NULL, SIM_SD_CRC_LEN);
+}
+
+/**
+ * @brief Queue a block of the backing file.
+ * @param dev - The model.
+ * @param block - The block number.
+ */
+static void sim_sd_read_block(struct sim_sd *dev, uint32_t block)
+{
+	uint8_t buf[SIM_SD_BLOCK_LEN];
+
+	memset(buf, 0, sizeof(buf));
+	fseek(dev->file, (long)block * SIM_SD_BLOCK_LEN, SEEK_SET);
+	if (fread(buf, 1, sizeof(buf), dev->file) != sizeof(buf))
+		memset(buf, 0, sizeof(buf));
+	sim_sd_push_block(dev, buf, sizeof(buf));
+	dev->stats.blocks_read++;
+}
+
+/**
+ * @brief Store the received block in the backing file.
+ * @param dev - The model.
+ */
+static void sim_sd_write_block(struct sim_sd *dev)
+{
+	uint8_t resp[1 + SIM_SD_BUSY_BYTES];
+
+	fseek(dev->file, (long)dev->block * SIM_SD_BLOCK_LEN, SEEK_SET);
+	fwrite(dev->data, 1, SIM_SD_BLOCK_LEN, dev->file);
+	fflush(dev->file);
+	dev->stats.blocks_written++;
+	dev->block++;
+
+	/* Data response token, then busy */
+	memset(resp, 0, sizeof(resp));
+	resp[0] = SIM_SD_DATA_ACCEPTED;
+	sim_sd_push(dev, resp, sizeof(resp));
+}
+
+/**
+ * @brief Erase the range set by CMD32 and CMD33, the blocks read as zeros.
+ * @param dev - The model.
+ */
+static void sim_sd_erase(struct sim_sd *dev)
+{
+	uint8_t zero[SIM_SD_BLOCK_LEN];
+	uint8_t busy[SIM_SD_BUSY_BYTES];
+	uint32_t i;
+
+	memset(zero, 0, sizeof(zero));
+	for (i = dev->erase_start; i <= dev->erase_end; i++) {
+		fseek(dev->file, (long)i * SIM_SD_BLOCK_LEN, SEEK_SET);
+		fwrite(zero, 1, sizeof(zero), dev->file);
+		dev->stats.blocks_erased++;
+	}
+	fflush(dev->file);
+
+	memset(busy, 0, sizeof(busy));
+	sim_sd_push(dev, busy, sizeof(busy));
+}
+
+/**
+ * @brief Check the block range of a data command.
+ * @param dev - The model.
+ * @param block - First block.
+ * @param count - Number of blocks, 0 if not known.
+ * @return true if the range is in the card.
+ */
+static bool sim_sd_in_range(struct sim_sd *dev, uint32_t block,
+			    uint32_t count)
+{
+	if (block >= dev->blocks)
+		return false;
+
+	return count <= dev->blocks - block;
+}
+
+/**
+ * @brief Execute an application command (preceded by CMD55).
+ * @param dev - The model.
+ * @param index - Command index.
+ * @param arg - Command argument.
+ */
+static void sim_sd_app_command(struct sim_sd *dev, uint8_t index, uint32_t arg)
+{
+	/* SD 3.0, 1 and 4 bit bus, CMD23 in CMD_SUPPORT */
+	uint8_t scr[8] = { 0x02, 0x35, 0x80, 0x00, 0, 0, 0, 0 };
+
+	switch (index) {
+	case 41:
+		if (++dev->acmd41_count > 1)
+			dev->idle = false;
+		sim_sd_r1(dev, 0);
+		break;
+	case 51:
+		if (dev->cmd23)
+			scr[3] |= 0x02;
+		sim_sd_r1(dev, 0);
+		sim_sd_push_block(dev, scr, sizeof(scr));
+		break;
+	case 23:
+		/* Pre-erase count, only a hint */
+		dev->stats.pre_erased += arg & 0x7FFFFF;
+		sim_sd_r1(dev, 0);
+		break;
+	default:
+		sim_sd_r1(dev, SIM_SD_R1_ILLEGAL);
+		break;
+	}
+}
+
+/**
+ * @brief Execute a command.
+ * @param dev - The model.
+ */
+static void sim_sd_command(struct sim_sd *dev)
+{
+	uint8_t index = dev->cmd[0] & 0x3F;
+	uint32_t arg = ((uint32_t)dev->cmd[1] << 24) | (dev->cmd[2] << 16) |
+		       (dev->cmd[3] << 8) | dev->cmd[4];
+	uint32_t c_size = dev->blocks / (SIM_SD_CSIZE_UNIT / SIM_SD_BLOCK_LEN) - 1;
+	uint8_t csd[16] = { 0x40, 0x0E, 0x00, 0x32, 0x5B, 0x59, 0x00, 0, 0, 0,
+			    0x7F, 0x80, 0x0A, 0x40, 0x00, 0x01
+			  };
+	uint8_t resp[5];
+	uint32_t count;
+
+	dev->stats.commands++;
+
+	/* A command ends a multiple block read */
+	if (dev->state == SIM_SD_READING) {
+		dev->out_pos = dev->out_len;
+		dev->state = SIM_SD_IDLE;
+	}
+
+	if (dev->app_cmd) {
+		dev->app_cmd = false;
+		sim_sd_app_command(dev, index, arg);
+		return;
+	}
+
+	count = dev->next_count;
+	dev->next_count = 0;
+
+	switch (index) {
+	case 0:
+		dev->idle = true;
+		dev->acmd41_count = 0;
+		sim_sd_r1(dev, 0);
+		break;
+	case 8:
+		resp[0] = dev->idle ? SIM_SD_R1_IDLE : 0;
+		resp[1] = 0;
+		resp[2] = 0;
+		resp[3] = (arg >> 8) & 0x0F;
+		resp[4] = arg & 0xFF;
+		sim_sd_respond(dev, resp, 5);
+		break;
+	case 55:
+		dev->app_cmd = true;
+		sim_sd_r1(dev, 0);
+		break;
+	case 58:
+		/* Powered up, high capacity, 3.2V - 3.4V */
+		resp[0] = dev->idle ? SIM_SD_R1_IDLE : 0;
+		resp[1] = 0xC0;
+		resp[2] = 0x30;
+		resp[3] = 0;
+		resp[4] = 0;
+		sim_sd_respond(dev, resp, 5);
+		break;
+	case 9:
+		csd[7] = (c_size >> 16) & 0x3F;
+		csd[8] = (c_size >> 8) & 0xFF;
+		csd[9] = c_size & 0xFF;
+		sim_sd_r1(dev, 0);
+		sim_sd_push_block(dev, csd, sizeof(csd));
+		break;
+	case 12:
+		sim_sd_r1(dev, 0);
+		break;
+	case 23:
+		if (!dev->cmd23) {
+			sim_sd_r1(dev, SIM_SD_R1_ILLEGAL);
+			break;
+		}
+		dev->next_count = arg;
+		sim_sd_r1(dev, 0);
+		break;
+	case 17:
+	case 18:
+		if (!sim_sd_in_range(dev, arg, count)) {
+			sim_sd_r1(dev, SIM_SD_R1_PARAM);
+			break;
+		}
+		sim_sd_r1(dev, 0);
+		sim_sd_read_block(dev, arg);
+		if (index == 17)
+			break;
+		dev->stats.multi_reads++;
+		dev->block = arg + 1;
+		dev->block_count = count ? count - 1 : 0;
+		/* Without a block count, the host ends the read with CMD12 */
+		if (!count || dev->block_count)
+			dev->state = SIM_SD_READING;
+		break;
+	case 24:
+	case 25:
+		if (!sim_sd_in_range(dev, arg, count)) {
+			sim_sd_r1(dev, SIM_SD_R1_PARAM);
+			break;
+		}
+		sim_sd_r1(dev, 0);
+		dev->multi = index == 25;
+		if (dev->multi)
+			dev->stats.multi_writes++;
+		dev->block = arg;
+		dev->block_count = count;
+		dev->state = SIM_SD_WRITE_TOKEN;
+		break;
+	case 32:
+	case 33:
+		if (!sim_sd_in_range(dev, arg, 1)) {
+			sim_sd_r1(dev, SIM_SD_R1_PARAM);
+			break;
+		}
+		if (index == 32)
+			dev->erase_start = arg;
+		else
+			dev->erase_end = arg;
+		sim_sd_r1(dev, 0);
+		break;
+	case 38:
+		if (dev->erase_end < dev->erase_start) {
+			sim_sd_r1(dev, SIM_SD_R1_PARAM);
+			break;
+		}
+		sim_sd_r1(dev, 0);
+		sim_sd_erase(dev);
+		break;
+	default:
+		sim_sd_r1(dev, SIM_SD_R1_ILLEGAL);
+		break;
+	}
+}
+
+/**
+ * @brief Handle one byte received from the host.
+ * @param dev - The model.
+ * @param in - The byte.
+ */
+static void sim_sd_receive(struct sim_sd *dev, uint8_t in)
+{
+	switch (dev->state) {
+	case SIM_SD_WRITE_TOKEN:
+		if (in == SIM_SD_TOKEN_STOP && dev->multi) {
+			sim_sd_push(dev, NULL, 1);
+			dev->state = SIM_SD_IDLE;
+		} else if (in == (dev->multi ? SIM_SD_TOKEN_N : SIM_SD_TOKEN_1)) {
+			dev->data_len = 0;
+			dev->state = SIM_SD_WRITE_DATA;
+		}
+		break;
+	case SIM_SD_WRITE_DATA:
+		dev->data[dev->data_len++] = in;
+		if (dev->data_len < sizeof(dev->data))
+			break;
+		if (dev->block >= dev->blocks) {
+			/* Write error */
+			in = 0x0D;
+			sim_sd_push(dev, &in, 1);
+			dev->state = SIM_SD_IDLE;
+			break;
+		}
+		sim_sd_write_block(dev);
+		dev->state = SIM_SD_WRITE_TOKEN;
+		if (!dev->multi || (dev->block_count && !--dev->block_count))
+			dev->state = SIM_SD_IDLE;
+		break;
+	default:
+		/* A command starts with the 01 bits */
+		if (!dev->cmd_len && (in & 0xC0) != 0x40)
+			break;
+		dev->cmd[dev->cmd_len++] = in;
+		if (dev->cmd_len < SIM_SD_CMD_LEN)
+			break;
+		dev->cmd_len = 0;
+		sim_sd_command(dev);
+		break;
+	}
+}
+
+/**
+ * @brief SPI transfer, processed byte by byte as a card would.
+ * @param model - The model.
+ * @param data - The transfer buffer, updated in place.
+ * @param bytes - Number of bytes.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+static int32_t sim_sd_spi_xfer(struct sim_model *model, uint8_t *data,
+			       uint16_t bytes)
+{
+	struct sim_sd *dev = model->priv;
+	uint8_t in;
+	uint16_t i;
+
+	for (i = 0; i < bytes; i++) {
+		in = data[i];
+		data[i] = 0xFF;
+		if (dev->out_pos < dev->out_len)
+			data[i] = dev->out[dev->out_pos++];
+
+		sim_sd_receive(dev, in);
+
+		/* Keep the blocks of a multiple block read coming */
+		if (dev->state == SIM_SD_READING &&
+		    dev->out_pos == dev->out_len) {
+			if (dev->block >= dev->blocks) {
+				dev->state = SIM_SD_IDLE;
+				continue;
+			}
+			sim_sd_read_block(dev, dev->block++);
+			if (dev->block_count && !--dev->block_count)
+				dev->state = SIM_SD_IDLE;
+		}
+	}
+
+	return SUCCESS;
+}
+
+static const struct sim_model_ops sim_sd_ops = {
+	.spi_xfer = sim_sd_spi_xfer,
+};
+
+/**
+ * @brief Protocol counters of the model.
+ * @param model - The model.
+ * @return The counters.
+ */
+const struct sim_sd_stats *sim_sd_stats(struct sim_model *model)
+{
+	struct sim_sd *dev = model->priv;
+
+	return &dev->stats;
+}
+
+/**
+ * @brief Create a SD card model backed by a file.
+ * @param model - The model.
+ * @param init - The model parameters.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sim_sd_init(struct sim_model **model, const struct sim_sd_init *init)
+{
+	struct sim_sd *dev;
+	uint64_t size;
+	long len;
+
+	if (!init->path)
+		return FAILURE;
+
+	dev = (struct sim_sd *)calloc(1, sizeof(*dev));
+	if (!dev)
+		return FAILURE;
+
+	dev->file = fopen(init->path, "r+b");
+	if (!dev->file && init->size)
+		dev->file = fopen(init->path, "w+b");
+	if (!dev->file)
+		goto error;
+
+	size = init->size;
+	if (!size) {
+		fseek(dev->file, 0, SEEK_END);
+		len = ftell(dev->file);
+		if (len < 0)
+			goto error_file;
+		size = len;
+	}
+	/* The CSD describes the capacity in units of 512 KiB */
+	size -= size % SIM_SD_CSIZE_UNIT;
+	if (!size)
+		goto error_file;
+	dev->blocks = size / SIM_SD_BLOCK_LEN;
+
+	dev->model.name = init->name;
+	dev->model.ops = &sim_sd_ops;
+	dev->model.priv = dev;
+	dev->model.timing.bus_hz = init->spi_hz;
+	dev->cmd23 = init->cmd23;
+	dev->idle = true;
+
+	*model = &dev->model;
+
+	return SUCCESS;
+
+error_file:
+	fclose(dev->file);
+error:
+	free(dev);
+
+	return FAILURE;
+}
+
+/**
+ * @brief Free the resources allocated by sim_sd_init().
+ * @param model - The model.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sim_sd_remove(struct sim_model *model)
+{
+	struct sim_sd *dev = model->priv;
+
+	fclose(dev->file);
+	free(dev);
+
+	return SUCCESS;
+}
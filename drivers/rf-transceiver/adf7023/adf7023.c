@@ -41,8 +41,10 @@
 /***************************** Include Files **********************************/
 /******************************************************************************/
 #include <stdlib.h>
+#include <string.h>
 #include "adf7023_config.h"
 #include "adf7023.h"
+#include "util.h"
 
 /******************************************************************************/
 /*************************** Macros Definitions *******************************/
@@ -100,7 +102,7 @@ int32_t adf7023_init(struct adf7023_dev **device,
 	uint8_t status = 0;
 	int32_t ret = 0;
 
-	dev = (struct adf7023_dev *)malloc(sizeof(*dev));
+	dev = (struct adf7023_dev *)calloc(1, sizeof(*dev));
 	if (!dev)
 		return -1;
 
@@ -167,10 +169,12 @@ int32_t adf7023_remove(struct adf7023_dev *dev)
 void adf7023_get_status(struct adf7023_dev *dev,
 			uint8_t* status)
 {
+	uint8_t data[2] = {SPI_NOP, SPI_NOP};
+
 	ADF7023_CS_ASSERT;
-	adf7023_write_read_byte(dev, SPI_NOP, 0);
-	adf7023_write_read_byte(dev, SPI_NOP, status);
+	spi_write_and_read(dev->spi_desc, data, 2);
 	ADF7023_CS_DEASSERT;
+	*status = data[1];
 }
 
 /***************************************************************************//**
@@ -190,41 +194,124 @@ void adf7023_set_command(struct adf7023_dev *dev,
 }
 
 /***************************************************************************//**
- * @brief Sets a FW state and waits until the device enters in that state.
+ * @brief Returns the command that moves the firmware to a FW state.
  *
- * @param dev      - The device structure.
  * @param fw_state - FW state.
  *
- * @return None.
+ * @return The command.
 *******************************************************************************/
-void adf7023_set_fw_state(struct adf7023_dev *dev,
-			  uint8_t fw_state)
+static uint8_t adf7023_fw_state_command(uint8_t fw_state)
 {
-	uint8_t status = 0;
-
 	switch(fw_state) {
 	case FW_STATE_PHY_OFF:
-		adf7023_set_command(dev, CMD_PHY_OFF);
-		break;
+		return CMD_PHY_OFF;
 	case FW_STATE_PHY_ON:
-		adf7023_set_command(dev, CMD_PHY_ON);
-		break;
+		return CMD_PHY_ON;
 	case FW_STATE_PHY_RX:
-		adf7023_set_command(dev, CMD_PHY_RX);
-		break;
+		return CMD_PHY_RX;
 	case FW_STATE_PHY_TX:
-		adf7023_set_command(dev, CMD_PHY_TX);
-		break;
+		return CMD_PHY_TX;
 	default:
-		adf7023_set_command(dev, CMD_PHY_SLEEP);
+		return CMD_PHY_SLEEP;
 	}
-	while((status & STATUS_FW_STATE) != fw_state) {
-		adf7023_get_status(dev, &status);
+}
+
+/***************************************************************************//**
+ * @brief Issues the first command of a sequence of FW state changes. The
+ *        following ones are issued by adf7023_fw_state_poll() as the firmware
+ *        reaches each state.
+ *
+ * @param dev  - The device structure.
+ * @param path - FW states to go through.
+ * @param len  - Number of FW states.
+ *
+ * @return None.
+*******************************************************************************/
+static void adf7023_fw_state_path(struct adf7023_dev *dev,
+				  const uint8_t *path,
+				  uint8_t len)
+{
+	uint8_t i;
+
+	for (i = 0; i < len; i++)
+		dev->fw_path[i] = path[i];
+	dev->fw_path_len = len;
+	dev->fw_path_pos = 0;
+
+	adf7023_set_command(dev, adf7023_fw_state_command(path[0]));
+}
+
+/***************************************************************************//**
+ * @brief Issues a FW state change without waiting for the device to enter
+ *        that state. Completion is checked with adf7023_fw_state_poll().
+ *
+ * @param dev      - The device structure.
+ * @param fw_state - FW state.
+ *
+ * @return None.
+*******************************************************************************/
+void adf7023_fw_state_request(struct adf7023_dev *dev,
+			      uint8_t fw_state)
+{
+	adf7023_fw_state_path(dev, &fw_state, 1);
+}
+
+/***************************************************************************//**
+ * @brief Checks the progress of the FW state change issued last, with a
+ *        single status read. Does not read the status once the change is
+ *        done.
+ *
+ * @param dev  - The device structure.
+ * @param done - Set to 1 when the device is in the requested FW state.
+ *
+ * @return None.
+*******************************************************************************/
+void adf7023_fw_state_poll(struct adf7023_dev *dev,
+			   uint8_t *done)
+{
+	uint8_t status = 0;
+
+	*done = 0;
+	if (dev->fw_path_pos == dev->fw_path_len) {
+		*done = 1;
+		return;
+	}
+
+	adf7023_get_status(dev, &status);
+	if ((status & STATUS_FW_STATE) != dev->fw_path[dev->fw_path_pos])
+		return;
+
+	dev->fw_path_pos++;
+	if (dev->fw_path_pos == dev->fw_path_len) {
+		*done = 1;
+		return;
 	}
+
+	adf7023_set_command(dev,
+			    adf7023_fw_state_command(dev->fw_path[dev->fw_path_pos]));
 }
 
 /***************************************************************************//**
- * @brief Reads data from the RAM.
+ * @brief Sets a FW state and waits until the device enters in that state.
+ *
+ * @param dev      - The device structure.
+ * @param fw_state - FW state.
+ *
+ * @return None.
+*******************************************************************************/
+void adf7023_set_fw_state(struct adf7023_dev *dev,
+			  uint8_t fw_state)
+{
+	uint8_t done = 0;
+
+	adf7023_fw_state_request(dev, fw_state);
+	while(!done)
+		adf7023_fw_state_poll(dev, &done);
+}
+
+/***************************************************************************//**
+ * @brief Reads data from the RAM. The data is moved in transfers of up to
+ *        ADF7023_BURST_SIZE bytes within a single chip select assertion.
  *
  * @param dev     - The device structure.
  * @param address - Start address.
@@ -238,18 +325,29 @@ void adf7023_get_ram(struct adf7023_dev *dev,
 		     uint32_t length,
 		     uint8_t* data)
 {
+	uint32_t hdr = 3;
+	uint32_t chunk;
+
+	dev->spi_buf[0] = SPI_MEM_RD | ((address & 0x700) >> 8);
+	dev->spi_buf[1] = address & 0xFF;
+	dev->spi_buf[2] = SPI_NOP;
+
 	ADF7023_CS_ASSERT;
-	adf7023_write_read_byte(dev, SPI_MEM_RD | ((address & 0x700) >> 8), 0);
-	adf7023_write_read_byte(dev, address & 0xFF, 0);
-	adf7023_write_read_byte(dev, SPI_NOP, 0);
-	while(length--) {
-		adf7023_write_read_byte(dev, SPI_NOP, data++);
+	while(length) {
+		chunk = min(length, (uint32_t)ADF7023_BURST_SIZE);
+		memset(&dev->spi_buf[hdr], SPI_NOP, chunk);
+		spi_write_and_read(dev->spi_desc, dev->spi_buf, hdr + chunk);
+		memcpy(data, &dev->spi_buf[hdr], chunk);
+		data += chunk;
+		length -= chunk;
+		hdr = 0;
 	}
 	ADF7023_CS_DEASSERT;
 }
 
 /***************************************************************************//**
- * @brief Writes data to RAM.
+ * @brief Writes data to RAM. The data is moved in transfers of up to
+ *        ADF7023_BURST_SIZE bytes within a single chip select assertion.
  *
  * @param dev     - The device structure.
  * @param address - Start address.
@@ -263,15 +361,49 @@ void adf7023_set_ram(struct adf7023_dev *dev,
 		     uint32_t length,
 		     uint8_t* data)
 {
+	uint32_t hdr = 2;
+	uint32_t chunk;
+
+	dev->spi_buf[0] = SPI_MEM_WR | ((address & 0x700) >> 8);
+	dev->spi_buf[1] = address & 0xFF;
+
 	ADF7023_CS_ASSERT;
-	adf7023_write_read_byte(dev, SPI_MEM_WR | ((address & 0x700) >> 8), 0);
-	adf7023_write_read_byte(dev, address & 0xFF, 0);
-	while(length--) {
-		adf7023_write_read_byte(dev, *(data++), 0);
+	while(length) {
+		chunk = min(length, (uint32_t)ADF7023_BURST_SIZE);
+		memcpy(&dev->spi_buf[hdr], data, chunk);
+		spi_write_and_read(dev->spi_desc, dev->spi_buf, hdr + chunk);
+		data += chunk;
+		length -= chunk;
+		hdr = 0;
 	}
 	ADF7023_CS_DEASSERT;
 }
 
+/***************************************************************************//**
+ * @brief Writes the length and address bytes followed by the payload to the
+ *        TX packet RAM, in a single SPI transfer.
+ *
+ * @param dev    - The device structure.
+ * @param packet - Payload.
+ * @param length - Payload length.
+ *
+ * @return None.
+*******************************************************************************/
+static void adf7023_write_tx_packet(struct adf7023_dev *dev,
+				    uint8_t* packet,
+				    uint8_t length)
+{
+	dev->spi_buf[0] = SPI_MEM_WR;
+	dev->spi_buf[1] = ADF7023_TX_BASE_ADR;
+	dev->spi_buf[2] = 2 + length;
+	dev->spi_buf[3] = dev->adf7023_bbram_current.address_match_offset;
+	memcpy(&dev->spi_buf[4], packet, length);
+
+	ADF7023_CS_ASSERT;
+	spi_write_and_read(dev->spi_desc, dev->spi_buf, 4 + length);
+	ADF7023_CS_DEASSERT;
+}
+
 /***************************************************************************//**
  * @brief Receives one packet.
  *
@@ -297,8 +429,8 @@ void adf7023_receive_packet(struct adf7023_dev *dev,
 	adf7023_set_ram(dev, MCR_REG_INTERRUPT_SOURCE_0,
 			0x1,
 			&interrupt_reg);
-	adf7023_get_ram(dev, 0x10, 1, length);
-	adf7023_get_ram(dev, 0x12, *length - 2, packet);
+	adf7023_get_ram(dev, ADF7023_RX_BASE_ADR, 1, length);
+	adf7023_get_ram(dev, ADF7023_RX_BASE_ADR + 2, *length - 2, packet);
 }
 
 /***************************************************************************//**
@@ -315,12 +447,8 @@ void adf7023_transmit_packet(struct adf7023_dev *dev,
 			     uint8_t length)
 {
 	uint8_t interrupt_reg = 0;
-	uint8_t header [ 2 ]    = {0, 0};
 
-	header[0] = 2 + length;
-	header[1] = dev->adf7023_bbram_current.address_match_offset;
-	adf7023_set_ram(dev, 0x10, 2, header);
-	adf7023_set_ram(dev, 0x12, length, packet);
+	adf7023_write_tx_packet(dev, packet, length);
 	adf7023_set_fw_state(dev, FW_STATE_PHY_ON);
 	adf7023_set_fw_state(dev, FW_STATE_PHY_TX);
 	while(!(interrupt_reg & BBRAM_INTERRUPT_MASK_0_INTERRUPT_TX_EOF)) {
@@ -330,6 +458,301 @@ void adf7023_transmit_packet(struct adf7023_dev *dev,
 	}
 }
 
+/***************************************************************************//**
+ * @brief Starts interrupt driven packet reception and transmission. The
+ *        preamble, sync word, CRC and TX end of frame sources are routed to
+ *        IRQ_GP3, whose rising edge must call adf7023_packet_isr(). The device
+ *        is then kept listening in PHY_RX, leaving it only to send the
+ *        packets queued with adf7023_packet_send().
+ *
+ * @param dev      - The device structure.
+ * @param rx_queue - Reception queue, with the ring set.
+ * @param tx_queue - Transmission queue, with the ring set.
+ *
+ * @return 0 in case of success, -1 otherwise.
+*******************************************************************************/
+int32_t adf7023_packet_start(struct adf7023_dev *dev,
+			     struct adf7023_packet_queue *rx_queue,
+			     struct adf7023_packet_queue *tx_queue)
+{
+	uint8_t clear = 0xFF;
+
+	if (!rx_queue || !rx_queue->ring || rx_queue->size < 2 ||
+	    !tx_queue || !tx_queue->ring || tx_queue->size < 2)
+		return -1;
+
+	rx_queue->head = 0;
+	rx_queue->tail = 0;
+	rx_queue->dropped = 0;
+	tx_queue->head = 0;
+	tx_queue->tail = 0;
+	tx_queue->dropped = 0;
+
+	dev->adf7023_bbram_current.interrupt_mask0 |=
+		ADF7023_PACKET_STATUS_MASK |
+		BBRAM_INTERRUPT_MASK_0_INTERRUPT_TX_EOF;
+	adf7023_set_ram(dev, 0x100, 64, (uint8_t*)&dev->adf7023_bbram_current);
+	adf7023_set_fw_state(dev, FW_STATE_PHY_OFF);
+	adf7023_set_command(dev, CMD_CONFIG_DEV);
+	adf7023_set_fw_state(dev, FW_STATE_PHY_ON);
+	adf7023_set_ram(dev, MCR_REG_INTERRUPT_SOURCE_0, 1, &clear);
+
+	dev->rx_status = 0;
+	dev->irq_pending = 0;
+	dev->trx_state = ADF7023_TRX_IDLE;
+	dev->tx_queue = tx_queue;
+	dev->rx_queue = rx_queue;
+
+	return 0;
+}
+
+/***************************************************************************//**
+ * @brief Bounds the time a reception in progress may hold off transmission.
+ *        Without a time source, a packet dropped by the firmware for a bad
+ *        CRC keeps the queued packets waiting until the next preamble.
+ *
+ * @param dev         - The device structure.
+ * @param get_time_us - Time source in us, NULL to disable the timeout.
+ * @param timeout_us  - Longest time from the preamble to the end of a packet.
+ *
+ * @return None.
+*******************************************************************************/
+void adf7023_packet_set_rx_timeout(struct adf7023_dev *dev,
+				   uint32_t (*get_time_us)(void),
+				   uint32_t timeout_us)
+{
+	dev->rx_status = 0;
+	dev->rx_timeout_us = timeout_us;
+	dev->get_time_us = get_time_us;
+}
+
+/***************************************************************************//**
+ * @brief IRQ_GP3 handler, to be registered with irq_register_callback(). It
+ *        only latches the event, the SPI work is left to
+ *        adf7023_packet_process() so the bus is used from one context.
+ *
+ * @param ctx   - The device structure.
+ * @param event - Unused.
+ * @param extra - Unused.
+ *
+ * @return None.
+*******************************************************************************/
+void adf7023_packet_isr(void *ctx, uint32_t event, void *extra)
+{
+	((struct adf7023_dev *)ctx)->irq_pending = 1;
+}
+
+/***************************************************************************//**
+ * @brief Copies a received packet from the RX packet RAM to the reception
+ *        queue.
+ *
+ * @param dev - The device structure.
+ *
+ * @return None.
+*******************************************************************************/
+static void adf7023_packet_read(struct adf7023_dev *dev)
+{
+	struct adf7023_packet_queue *queue = dev->rx_queue;
+	struct adf7023_packet *packet;
+	uint8_t next;
+	uint8_t length = 0;
+
+	next = (queue->head + 1) % queue->size;
+	if (next == queue->tail) {
+		queue->dropped++;
+		return;
+	}
+
+	adf7023_get_ram(dev, ADF7023_RX_BASE_ADR, 1, &length);
+	if ((length < 2) || (length - 2 > ADF7023_MAX_PAYLOAD))
+		return;
+
+	packet = &queue->ring[queue->head];
+	packet->length = length - 2;
+	packet->status = dev->rx_status;
+	adf7023_get_ram(dev, ADF7023_RX_BASE_ADR + 2, packet->length,
+			packet->data);
+	queue->head = next;
+}
+
+/***************************************************************************//**
+ * @brief Services the interrupt sources latched by adf7023_packet_isr() and
+ *        advances the packet state machine. Does not wait on the device:
+ *        when the firmware is still changing state, the call returns after a
+ *        single status read. Must be called from the main loop.
+ *
+ * @param dev - The device structure.
+ *
+ * @return 0 in case of success, -1 otherwise.
+*******************************************************************************/
+int32_t adf7023_packet_process(struct adf7023_dev *dev)
+{
+	static const uint8_t to_rx[2] = {FW_STATE_PHY_ON, FW_STATE_PHY_RX};
+	static const uint8_t to_tx[2] = {FW_STATE_PHY_ON, FW_STATE_PHY_TX};
+	struct adf7023_packet_queue *tx_queue = dev->tx_queue;
+	struct adf7023_packet *packet;
+	uint8_t irq = 0;
+	uint8_t done;
+
+	if (!dev->rx_queue)
+		return -1;
+
+	if (dev->irq_pending) {
+		dev->irq_pending = 0;
+		adf7023_get_ram(dev, MCR_REG_INTERRUPT_SOURCE_0, 1, &irq);
+		adf7023_set_ram(dev, MCR_REG_INTERRUPT_SOURCE_0, 1, &irq);
+
+		/*
+		 * The firmware is back in PHY_ON once a packet is received or
+		 * sent, possibly before the PHY_RX/PHY_TX state was polled.
+		 */
+		if (dev->trx_state == ADF7023_TRX_RX) {
+			/*
+			 * A packet failing the CRC or the address match is
+			 * dropped by the firmware without an interrupt, a new
+			 * preamble is the first sign of it.
+			 */
+			if (irq & BBRAM_INTERRUPT_MASK_0_INTERRUPT_PREMABLE_DETECT)
+				dev->rx_status = 0;
+			if (!dev->rx_status && dev->get_time_us)
+				dev->rx_start_us = dev->get_time_us();
+			dev->rx_status |= irq & ADF7023_PACKET_STATUS_MASK;
+			if (irq & BBRAM_INTERRUPT_MASK_0_INTERRUPT_CRC_CORRECT) {
+				adf7023_packet_read(dev);
+				dev->rx_status = 0;
+				dev->trx_state = ADF7023_TRX_IDLE;
+				dev->fw_path_pos = dev->fw_path_len;
+			}
+		} else if ((dev->trx_state == ADF7023_TRX_TX) &&
+			   (irq & BBRAM_INTERRUPT_MASK_0_INTERRUPT_TX_EOF)) {
+			tx_queue->tail = (tx_queue->tail + 1) % tx_queue->size;
+			dev->trx_state = ADF7023_TRX_IDLE;
+			dev->fw_path_pos = dev->fw_path_len;
+		}
+	}
+
+	/* Give up on a reception that did not complete in time */
+	if (dev->rx_status && dev->get_time_us &&
+	    (dev->get_time_us() - dev->rx_start_us > dev->rx_timeout_us))
+		dev->rx_status = 0;
+
+	adf7023_fw_state_poll(dev, &done);
+	if (!done)
+		return 0;
+
+	switch (dev->trx_state) {
+	case ADF7023_TRX_IDLE:
+		dev->rx_status = 0;
+		if (tx_queue->tail != tx_queue->head) {
+			packet = &tx_queue->ring[tx_queue->tail];
+			adf7023_write_tx_packet(dev, packet->data, packet->length);
+			adf7023_fw_state_path(dev, to_tx, 2);
+			dev->trx_state = ADF7023_TRX_TX;
+		} else {
+			adf7023_fw_state_path(dev, to_rx, 2);
+			dev->trx_state = ADF7023_TRX_RX;
+		}
+		break;
+	case ADF7023_TRX_RX:
+		/* Leave reception for a queued packet, unless one is coming in */
+		if ((tx_queue->tail != tx_queue->head) && !dev->rx_status) {
+			adf7023_fw_state_request(dev, FW_STATE_PHY_ON);
+			dev->trx_state = ADF7023_TRX_IDLE;
+		}
+		break;
+	default:
+		break;
+	}
+
+	return 0;
+}
+
+/***************************************************************************//**
+ * @brief Queues one packet for transmission.
+ *
+ * @param dev    - The device structure.
+ * @param data   - Payload.
+ * @param length - Payload length, up to ADF7023_MAX_PAYLOAD bytes.
+ *
+ * @return 0 in case of success, -1 if the queue is full or the packet does
+ *         not fit.
+*******************************************************************************/
+int32_t adf7023_packet_send(struct adf7023_dev *dev,
+			    uint8_t *data,
+			    uint8_t length)
+{
+	struct adf7023_packet_queue *queue = dev->tx_queue;
+	struct adf7023_packet *packet;
+	uint8_t next;
+
+	if (!queue || length > ADF7023_MAX_PAYLOAD)
+		return -1;
+
+	next = (queue->head + 1) % queue->size;
+	if (next == queue->tail) {
+		queue->dropped++;
+		return -1;
+	}
+
+	packet = &queue->ring[queue->head];
+	memcpy(packet->data, data, length);
+	packet->length = length;
+	packet->status = 0;
+	queue->head = next;
+
+	return 0;
+}
+
+/***************************************************************************//**
+ * @brief Takes one received packet out of the reception queue.
+ *
+ * @param dev      - The device structure.
+ * @param packet   - Received packet, with its metadata.
+ * @param received - Set to 1 when a packet was taken, 0 if the queue is empty.
+ *
+ * @return 0 in case of success, -1 otherwise.
+*******************************************************************************/
+int32_t adf7023_packet_recv(struct adf7023_dev *dev,
+			    struct adf7023_packet *packet,
+			    uint8_t *received)
+{
+	struct adf7023_packet_queue *queue = dev->rx_queue;
+
+	*received = 0;
+	if (!queue)
+		return -1;
+
+	if (queue->tail == queue->head)
+		return 0;
+
+	*packet = queue->ring[queue->tail];
+	queue->tail = (queue->tail + 1) % queue->size;
+	*received = 1;
+
+	return 0;
+}
+
+/***************************************************************************//**
+ * @brief Stops packet mode and leaves the device in PHY_ON. Packets still
+ *        queued for transmission are discarded.
+ *
+ * @param dev - The device structure.
+ *
+ * @return 0 in case of success, -1 otherwise.
+*******************************************************************************/
+int32_t adf7023_packet_stop(struct adf7023_dev *dev)
+{
+	if (!dev->rx_queue)
+		return -1;
+
+	dev->rx_queue = NULL;
+	dev->tx_queue = NULL;
+	dev->trx_state = ADF7023_TRX_IDLE;
+	adf7023_set_fw_state(dev, FW_STATE_PHY_ON);
+
+	return 0;
+}
+
 /***************************************************************************//**
  * @brief Sets the channel frequency.
  *
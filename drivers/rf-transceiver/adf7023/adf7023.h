@@ -369,10 +369,50 @@ struct adf7023_bbram {
 #define ADF7023_TX_BASE_ADR 0x10
 #define ADF7023_RX_BASE_ADR 0x10
 
+/* Packet RAM, holding the length and address bytes followed by the payload */
+#define ADF7023_PACKET_RAM_SIZE 0x100
+#define ADF7023_MAX_PAYLOAD     (ADF7023_PACKET_RAM_SIZE - \
+				 ADF7023_RX_BASE_ADR - 2)
+
+/* Largest RAM access moved in a single SPI transfer */
+#define ADF7023_BURST_SIZE      ADF7023_PACKET_RAM_SIZE
+
+/* Interrupt sources reported in the packet metadata */
+#define ADF7023_PACKET_STATUS_MASK \
+	(BBRAM_INTERRUPT_MASK_0_INTERRUPT_PREMABLE_DETECT | \
+	 BBRAM_INTERRUPT_MASK_0_INTERRUPT_SYNC_DETECT | \
+	 BBRAM_INTERRUPT_MASK_0_INTERRUPT_ADDRESS_MATCH | \
+	 BBRAM_INTERRUPT_MASK_0_INTERRUPT_CRC_CORRECT)
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
 
+enum adf7023_trx_state {
+	ADF7023_TRX_IDLE,
+	ADF7023_TRX_RX,
+	ADF7023_TRX_TX,
+};
+
+struct adf7023_packet {
+	/* Payload, without the length and address bytes */
+	uint8_t	data[ADF7023_MAX_PAYLOAD];
+	/* Payload length */
+	uint8_t	length;
+	/* ADF7023_PACKET_STATUS_MASK sources seen while receiving the packet */
+	uint8_t	status;
+};
+
+struct adf7023_packet_queue {
+	/* Ring provided by the user, holding size - 1 packets */
+	struct adf7023_packet	*ring;
+	uint8_t			size;
+	volatile uint8_t	head;
+	volatile uint8_t	tail;
+	/* Received packets lost because the ring was full */
+	uint32_t		dropped;
+};
+
 struct adf7023_dev {
 	/* SPI */
 	spi_desc		*spi_desc;
@@ -381,6 +421,22 @@ struct adf7023_dev {
 	struct gpio_desc	*gpio_miso;
 	/* Device Settings */
 	struct adf7023_bbram	adf7023_bbram_current;
+	/* FW state transition in progress */
+	uint8_t			fw_path[2];
+	uint8_t			fw_path_len;
+	uint8_t			fw_path_pos;
+	/* Packet mode */
+	struct adf7023_packet_queue	*rx_queue;
+	struct adf7023_packet_queue	*tx_queue;
+	enum adf7023_trx_state	trx_state;
+	uint8_t			rx_status;
+	volatile uint8_t	irq_pending;
+	/* Optional time source in us, bounding a reception in progress */
+	uint32_t		(*get_time_us)(void);
+	uint32_t		rx_timeout_us;
+	uint32_t		rx_start_us;
+	/* Burst transfer buffer: command, address and NOP bytes, then data */
+	uint8_t			spi_buf[3 + ADF7023_BURST_SIZE];
 };
 
 struct adf7023_init_param {
@@ -414,6 +470,14 @@ void adf7023_set_command(struct adf7023_dev *dev,
 void adf7023_set_fw_state(struct adf7023_dev *dev,
 			  uint8_t fw_state);
 
+/* Issues a FW state change without waiting for it. */
+void adf7023_fw_state_request(struct adf7023_dev *dev,
+			      uint8_t fw_state);
+
+/* Checks the progress of the FW state change issued last. */
+void adf7023_fw_state_poll(struct adf7023_dev *dev,
+			   uint8_t *done);
+
 /* Reads data from the RAM. */
 void adf7023_get_ram(struct adf7023_dev *dev,
 		     uint32_t address,
@@ -436,6 +500,35 @@ void adf7023_transmit_packet(struct adf7023_dev *dev,
 			     uint8_t* packet,
 			     uint8_t length);
 
+/* Starts interrupt driven packet reception and transmission. */
+int32_t adf7023_packet_start(struct adf7023_dev *dev,
+			     struct adf7023_packet_queue *rx_queue,
+			     struct adf7023_packet_queue *tx_queue);
+
+/* Bounds the time a reception in progress may hold off transmission. */
+void adf7023_packet_set_rx_timeout(struct adf7023_dev *dev,
+				   uint32_t (*get_time_us)(void),
+				   uint32_t timeout_us);
+
+/* IRQ_GP3 handler. */
+void adf7023_packet_isr(void *ctx, uint32_t event, void *extra);
+
+/* Services the interrupt sources and advances the packet state machine. */
+int32_t adf7023_packet_process(struct adf7023_dev *dev);
+
+/* Queues one packet for transmission. */
+int32_t adf7023_packet_send(struct adf7023_dev *dev,
+			    uint8_t *data,
+			    uint8_t length);
+
+/* Takes one received packet out of the reception queue. */
+int32_t adf7023_packet_recv(struct adf7023_dev *dev,
+			    struct adf7023_packet *packet,
+			    uint8_t *received);
+
+/* Stops packet mode and leaves the device in PHY_ON. */
+int32_t adf7023_packet_stop(struct adf7023_dev *dev);
+
 /* Sets the channel frequency. */
 void adf7023_set_channel_frequency(struct adf7023_dev *dev,
 				   uint32_t ch_freq);
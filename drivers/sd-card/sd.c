@@ -59,6 +59,7 @@
 
 #define CMD0_RETRY_NUMBER		(5u)
 #define WAIT_RESP_TIMEOUT		(1000u) //1000ms
+#define WAIT_ERASE_TIMEOUT		(30000u) //30s
 
 #define R1_READY_STATE			(0x00u)
 #define R1_IDLE_STATE			(0x01u)
@@ -69,6 +70,7 @@
 #define R3_LEN				(5u)
 #define R7_LEN				(5u)
 #define CSD_LEN				(18u)
+#define SCR_LEN				(10u)
 #define CRC_LEN				(2u)
 #define CMD_LEN				(8u)
 
@@ -78,7 +80,15 @@
 
 #define DATA_BLOCK_BITS			(9u)
 #define MASK_ADDR_IN_BLOCK		(DATA_BLOCK_LEN - 1u)
-#define MASK_BLOCK_NUMBER		(~(uint64_t)MASK_ADDR_IN_BLOCK)
+/* Limit of the block count of CMD23 and ACMD23 */
+#define MAX_BLOCKS_PER_CMD		(0xFFFFu)
+
+/* SECTOR_SIZE field of the CSD register, erase sector size minus one */
+#define CSD_SECTOR_SIZE(csd)		((((csd)[10] & 0x3Fu) << 1) | ((csd)[11] >> 7))
+
+/* CMD_SUPPORT bit of the SCR register telling CMD23 is supported */
+#define SCR_CMD23_BYTE			(3u)
+#define SCR_CMD23_MASK			(0x02u)
 
 #define START_1_BLOCK_TOKEN		(0xFEu)
 #define START_N_BLOCK_TOKEN		(0xFCu)
@@ -105,6 +115,7 @@ static int32_t wait_for_response(struct sd_desc *sd_desc, uint8_t *data_out)
 	ret = FAILURE;
 	not_timeout = WAIT_RESP_TIMEOUT;
 	do {
+		*data_out = 0xFF;
 		if (SUCCESS != spi_write_and_read(sd_desc->spi_desc,
 						  data_out, 1))
 			break;
@@ -121,16 +132,17 @@ static int32_t wait_for_response(struct sd_desc *sd_desc, uint8_t *data_out)
 /**
  * Read SD card bytes until one is different from 0x00
  * @param sd_desc - Instance of the SD card
+ * @param timeout - Timeout in ms
  * @return SUCCESS in case of success, FAILURE otherwise.
  */
-static int32_t wait_until_not_busy(struct sd_desc *sd_desc)
+static int32_t wait_until_not_busy(struct sd_desc *sd_desc, uint32_t timeout)
 {
 	uint32_t	not_timeout;
 	int32_t		ret;
 	uint8_t		data;
 
 	ret = FAILURE;
-	not_timeout = WAIT_RESP_TIMEOUT;
+	not_timeout = timeout;
 	do {
 		data = 0xFF;
 		if (SUCCESS != spi_write_and_read(sd_desc->spi_desc, &data, 1))
@@ -145,19 +157,6 @@ static int32_t wait_until_not_busy(struct sd_desc *sd_desc)
 	return ret;
 }
 
-/**
- * Calculate the number of blocks to be read/written from the address
- * and the length
- * @param address - Address in memory
- * @param len - Length of data
- * @return Number of blocks
- */
-static inline uint32_t get_nb_of_blocks(uint64_t address, uint64_t len)
-{
-	return ((address + len - 1) >> DATA_BLOCK_BITS) -
-	       (address >> DATA_BLOCK_BITS) + 1;
-}
-
 /**
  * Build command with cmd_desc, send it to the SD card and write the
  * response in the response field of cmd_desc
@@ -175,7 +174,7 @@ static int32_t send_command(struct sd_desc *sd_desc, struct cmd_desc *cmd_desc)
 		cmd_desc_local.response_len = R1_LEN;
 		if (SUCCESS != send_command(sd_desc, &cmd_desc_local))
 			return FAILURE;
-		if (cmd_desc_local.response[0] != R1_IDLE_STATE) {
+		if (cmd_desc_local.response[0] & ~R1_IDLE_STATE) {
 			DEBUG_MSG("Not the expected response for CMD55\n");
 			return FAILURE;
 		}
@@ -211,31 +210,68 @@ static int32_t send_command(struct sd_desc *sd_desc, struct cmd_desc *cmd_desc)
 }
 
 /**
- * Send one block of data to the SD card
+ * Send a data command and check that the card accepted it
  * @param sd_desc	- Instance of the SD card
- * @param data		- Data to be written
- * @param nb_of_blocks	- Number of blocks written in the executing command
+ * @param cmd		- Command code
+ * @param arg		- Argument for the command
  * @return SUCCESS in case of success, FAILURE otherwise.
  */
-static int32_t write_block(struct sd_desc *sd_desc, uint8_t *data,
-			   uint32_t nb_of_blocks)
+static int32_t send_data_command(struct sd_desc *sd_desc, uint8_t cmd,
+				 uint32_t arg)
 {
-	/* Send start block token */
-	sd_desc->buff[0] = START_N_BLOCK_TOKEN;
-	if (nb_of_blocks == 1)
-		sd_desc->buff[0] = START_1_BLOCK_TOKEN;
-	if (SUCCESS != spi_write_and_read(sd_desc->spi_desc, sd_desc->buff, 1))
-		return FAILURE;
+	struct cmd_desc	cmd_desc;
 
-	/* Send data with CRC */
-	if (SUCCESS != spi_write_and_read(sd_desc->spi_desc, data, DATA_BLOCK_LEN))
+	cmd_desc.cmd = cmd;
+	cmd_desc.arg = arg;
+	cmd_desc.response_len = R1_LEN;
+	if (SUCCESS != send_command(sd_desc, &cmd_desc))
 		return FAILURE;
-	*((uint16_t *)sd_desc->buff) = 0xFFFF;
-	if (SUCCESS != spi_write_and_read(sd_desc->spi_desc, sd_desc->buff, CRC_LEN))
+	if (cmd_desc.response[0] != R1_READY_STATE) {
+		DEBUG_MSG("Data command not accepted\n");
 		return FAILURE;
+	}
 
-	/* Read response and check if write was ok */
+	return SUCCESS;
+}
+
+/**
+ * Transfer a data block with the block transfer of the instance
+ * @param sd_desc	- Instance of the SD card
+ * @param data		- Data to be sent, updated with the received bytes
+ * @param bytes		- Number of bytes
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+static inline int32_t xfer_block(struct sd_desc *sd_desc, uint8_t *data,
+				 uint16_t bytes)
+{
+	if (sd_desc->block_xfer)
+		return sd_desc->block_xfer(sd_desc->spi_desc, data, bytes);
+
+	return spi_write_and_read(sd_desc->spi_desc, data, bytes);
+}
+
+/**
+ * Send one block of data to the SD card. The start token, the data and the
+ * CRC go out in a single transfer.
+ * @param sd_desc	- Instance of the SD card
+ * @param data		- Data to be written
+ * @param token		- Start block token
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+static int32_t write_block(struct sd_desc *sd_desc, const uint8_t *data,
+			   uint8_t token)
+{
 	uint8_t		response;
+
+	sd_desc->block_buff[0] = token;
+	memcpy(sd_desc->block_buff + 1, data, DATA_BLOCK_LEN);
+	sd_desc->block_buff[DATA_BLOCK_LEN + 1] = 0xFF;
+	sd_desc->block_buff[DATA_BLOCK_LEN + 2] = 0xFF;
+	if (SUCCESS != xfer_block(sd_desc, sd_desc->block_buff,
+				  DATA_BLOCK_LEN + 1 + CRC_LEN))
+		return FAILURE;
+
+	/* Read response and check if write was ok */
 	if (SUCCESS != wait_for_response(sd_desc, &response))
 		return FAILURE;
 	switch (response & MASK_RESPONSE_TOKEN) {
@@ -251,14 +287,15 @@ static int32_t write_block(struct sd_desc *sd_desc, uint8_t *data,
 		DEBUG_MSG("Other problem\n");
 		return FAILURE;
 	}
-	if (SUCCESS != wait_until_not_busy(sd_desc))
+	if (SUCCESS != wait_until_not_busy(sd_desc, WAIT_RESP_TIMEOUT))
 		return FAILURE;
 
 	return SUCCESS;
 }
 
 /**
- * Read one block of data to the SD card
+ * Read one block of data to the SD card. The data and the CRC are read in a
+ * single transfer.
  * @param sd_desc	- Instance of the SD card
  * @param data		- Buffer were data will be read
  * @return SUCCESS in case of success, FAILURE otherwise.
@@ -295,118 +332,207 @@ static int32_t read_block(struct sd_desc *sd_desc, uint8_t *data)
 		return FAILURE;
 	}
 
-	/* Read data block */
-	memset(data, 0xff, DATA_BLOCK_LEN);
-	if (SUCCESS != spi_write_and_read(sd_desc->spi_desc, data, DATA_BLOCK_LEN))
+	/* Read data block and crc */
+	memset(sd_desc->block_buff, 0xFF, DATA_BLOCK_LEN + CRC_LEN);
+	if (SUCCESS != xfer_block(sd_desc, sd_desc->block_buff,
+				  DATA_BLOCK_LEN + CRC_LEN))
 		return FAILURE;
+	memcpy(data, sd_desc->block_buff, DATA_BLOCK_LEN);
+
+	return SUCCESS;
+}
+
+/**
+ * Read consecutive blocks with a single command. When the card supports it,
+ * the number of blocks is set with CMD23 so no stop command is needed.
+ * @param sd_desc	- Instance of the SD card
+ * @param data		- Buffer were data will be read
+ * @param block		- First block
+ * @param nb_of_blocks	- Number of blocks, at most MAX_BLOCKS_PER_CMD
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+static int32_t read_blocks(struct sd_desc *sd_desc, uint8_t *data,
+			   uint32_t block, uint32_t nb_of_blocks)
+{
+	bool		stop;
+	uint32_t	i;
+
+	if (nb_of_blocks == 1) {
+		if (SUCCESS != send_data_command(sd_desc, CMD(17), block))
+			return FAILURE;
+
+		return read_block(sd_desc, data);
+	}
 
-	/* Read crc*/
-	*((uint16_t *)sd_desc->buff) = 0xFFFF;
-	if (SUCCESS != spi_write_and_read(sd_desc->spi_desc, sd_desc->buff, CRC_LEN))
+	stop = !sd_desc->set_block_count;
+	if (!stop && SUCCESS != send_data_command(sd_desc, CMD(23),
+			nb_of_blocks))
+		return FAILURE;
+	if (SUCCESS != send_data_command(sd_desc, CMD(18), block))
 		return FAILURE;
 
+	for (i = 0; i < nb_of_blocks; i++)
+		if (SUCCESS != read_block(sd_desc, data + i * DATA_BLOCK_LEN))
+			return FAILURE;
+
+	/* Send stop transmission command */
+	if (stop) {
+		if (SUCCESS != send_data_command(sd_desc, CMD(12), STUFF_ARG))
+			return FAILURE;
+		if (SUCCESS != wait_until_not_busy(sd_desc, WAIT_RESP_TIMEOUT))
+			return FAILURE;
+	}
+
 	return SUCCESS;
 }
 
 /**
- * Prepare and write data block by block
+ * Write consecutive blocks with a single command. The blocks are pre-erased
+ * with ACMD23 and, when the card supports it, announced with CMD23.
  * @param sd_desc	- Instance of the SD card
  * @param data		- Data to be written
- * @param addr		- Address in memory where data will be written
- * @param len		- Length of data to be written
- * @param nb_of_blocks	- Number of block to be written
- * @param first_block	- First block where data will be written with unmodified
- * 						  data
- * @param last_block	- Last block where data will be written with unmodified
- * 						  data
+ * @param block		- First block
+ * @param nb_of_blocks	- Number of blocks, at most MAX_BLOCKS_PER_CMD
  * @return SUCCESS in case of success, FAILURE otherwise.
  */
-static int32_t write_multiple_blocks(struct sd_desc *sd_desc,
-				     uint8_t *data, uint64_t addr, uint64_t len,
-				     uint8_t *first_block, uint8_t *last_block)
+static int32_t write_blocks(struct sd_desc *sd_desc, const uint8_t *data,
+			    uint32_t block, uint32_t nb_of_blocks)
 {
-	uint16_t	buff_first_idx;
-	uint16_t	buff_copy_len;
 	uint32_t	i;
-	uint64_t	data_idx;
-	uint32_t	nb_of_blocks = get_nb_of_blocks(addr, len);
 
-	data_idx = 0;
-	i = 0;
-	while (i < nb_of_blocks) {
-		buff_first_idx = 0x0000u;
-		if (i == 0)
-			buff_first_idx = addr & MASK_ADDR_IN_BLOCK;
-		buff_copy_len = DATA_BLOCK_LEN - buff_first_idx;
-		if (i == nb_of_blocks - 1)
-			buff_copy_len = ((addr + len - 1) & MASK_ADDR_IN_BLOCK) - buff_first_idx + 1;
-		if (buff_first_idx == 0x0000u && buff_copy_len == DATA_BLOCK_LEN) {
-			/* Write every block beside the first and last if the write is not the entire block */
-			if (SUCCESS != write_block(sd_desc, data + data_idx, nb_of_blocks))
-				return FAILURE;
-		} else {			/* If we are not writing a full block */
-			if (i == 0) {		/* If is the first block */
-				memcpy(first_block + buff_first_idx, data + data_idx, buff_copy_len);
-				if (SUCCESS != write_block(sd_desc, first_block, nb_of_blocks))
-					return FAILURE;
-			} else {		/* Is the last block */
-				memcpy(last_block, data + data_idx, buff_copy_len);
-				if (SUCCESS != write_block(sd_desc, last_block, nb_of_blocks))
-					return FAILURE;
-			}
-		}
-		data_idx += buff_copy_len;
-		i++;
+	if (nb_of_blocks == 1) {
+		if (SUCCESS != send_data_command(sd_desc, CMD(24), block))
+			return FAILURE;
+
+		return write_block(sd_desc, data, START_1_BLOCK_TOKEN);
 	}
 
+	if (SUCCESS != send_data_command(sd_desc, ACMD(23), nb_of_blocks))
+		return FAILURE;
+	if (sd_desc->set_block_count &&
+	    SUCCESS != send_data_command(sd_desc, CMD(23), nb_of_blocks))
+		return FAILURE;
+	if (SUCCESS != send_data_command(sd_desc, CMD(25), block))
+		return FAILURE;
+
+	for (i = 0; i < nb_of_blocks; i++)
+		if (SUCCESS != write_block(sd_desc, data + i * DATA_BLOCK_LEN,
+					   START_N_BLOCK_TOKEN))
+			return FAILURE;
+
+	/*
+	 * Send stop transmission token. A card that got the number of blocks
+	 * through CMD23 already ended the transfer and ignores it.
+	 */
+	sd_desc->buff[0] = STOP_TRANSMISSION_TOKEN;
+	sd_desc->buff[1] = 0xFF;
+	if (SUCCESS != spi_write_and_read(sd_desc->spi_desc, sd_desc->buff, 2))
+		return FAILURE;
+
+	return wait_until_not_busy(sd_desc, WAIT_RESP_TIMEOUT);
+}
+
+/**
+ * Write a cached block to the card if it was modified
+ * @param sd_desc	- Instance of the SD card
+ * @param entry		- Cached block
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+static int32_t cache_write_back(struct sd_desc *sd_desc,
+				struct sd_cache_block *entry)
+{
+	if (!entry->valid || !entry->dirty)
+		return SUCCESS;
+
+	if (SUCCESS != write_blocks(sd_desc, entry->data, entry->block, 1))
+		return FAILURE;
+	entry->dirty = false;
+
 	return SUCCESS;
 }
 
 /**
- * Prepare and read data block by block
+ * Get the cached copy of a block. On a miss, the least recently used entry
+ * is written back if needed and reused.
  * @param sd_desc	- Instance of the SD card
- * @param data		- Data to be read
- * @param addr		- Address in memory from where data will be read
- * @param len		- Length of data to be read
- * @param nb_of_blocks	- Number of block to be read
+ * @param block		- Block number
+ * @param load		- true to read the block from the card on a miss,
+ * 			  false if the caller overwrites the whole block
+ * @param entry		- The cached block is stored here
  * @return SUCCESS in case of success, FAILURE otherwise.
  */
-static int32_t read_multiple_blocks(struct sd_desc *sd_desc,
-				    uint8_t *data, uint64_t addr, uint64_t len)
+static int32_t cache_get(struct sd_desc *sd_desc, uint32_t block, bool load,
+			 struct sd_cache_block **entry)
 {
-	uint8_t		buff[DATA_BLOCK_LEN] __attribute__ ((aligned));
-	uint32_t	i;
-	uint64_t	data_idx;
+	struct sd_cache_block	*victim;
+	struct sd_cache_block	*e;
+	uint32_t		i;
 
-	data_idx = 0;
-	i = 0;
-	while (i < get_nb_of_blocks(addr, len)) {
-		uint16_t		buff_first_idx;
-		uint16_t		buff_copy_len;
-
-		buff_first_idx = 0x0000u;
-		if (i == 0)
-			buff_first_idx = addr & MASK_ADDR_IN_BLOCK;
-		buff_copy_len = DATA_BLOCK_LEN - buff_first_idx;
-		if (i == get_nb_of_blocks(addr, len) - 1)
-			buff_copy_len = ((addr + len - 1) & MASK_ADDR_IN_BLOCK) - buff_first_idx + 1;
-		if (buff_first_idx == 0x0000u && buff_copy_len == DATA_BLOCK_LEN) {
-			if (SUCCESS != read_block(sd_desc, data + data_idx))
-				return FAILURE;
-		} else {
-			if (SUCCESS != read_block(sd_desc, buff))
-				return FAILURE;
-			memcpy(data + data_idx, buff + buff_first_idx, buff_copy_len);
+	victim = &sd_desc->cache[0];
+	for (i = 0; i < sd_desc->cache_len; i++) {
+		e = &sd_desc->cache[i];
+		if (e->valid && e->block == block) {
+			e->stamp = ++sd_desc->cache_stamp;
+			*entry = e;
+			return SUCCESS;
 		}
-		data_idx += buff_copy_len;
-		i++;
+		if (!victim->valid)
+			continue;
+		if (!e->valid || e->stamp < victim->stamp)
+			victim = e;
 	}
 
+	if (SUCCESS != cache_write_back(sd_desc, victim))
+		return FAILURE;
+
+	victim->valid = false;
+	if (load && SUCCESS != read_blocks(sd_desc, victim->data, block, 1))
+		return FAILURE;
+	victim->block = block;
+	victim->valid = true;
+	victim->dirty = false;
+	victim->stamp = ++sd_desc->cache_stamp;
+	*entry = victim;
+
 	return SUCCESS;
 }
 
+/**
+ * Keep the cache coherent with a transfer that bypassed it
+ * @param sd_desc	- Instance of the SD card
+ * @param data		- Data of the transfer
+ * @param block		- First block of the transfer
+ * @param nb_of_blocks	- Number of blocks of the transfer
+ * @param written	- true if data was written to the card, false if it was
+ * 			  read from the card
+ */
+static void cache_sync(struct sd_desc *sd_desc, uint8_t *data, uint32_t block,
+		       uint32_t nb_of_blocks, bool written)
+{
+	struct sd_cache_block	*e;
+	uint8_t			*blk_data;
+	uint32_t		i;
+
+	for (i = 0; i < sd_desc->cache_len; i++) {
+		e = &sd_desc->cache[i];
+		if (!e->valid || e->block < block ||
+		    e->block - block >= nb_of_blocks)
+			continue;
+		blk_data = data + (e->block - block) * DATA_BLOCK_LEN;
+		if (written) {
+			memcpy(e->data, blk_data, DATA_BLOCK_LEN);
+			e->dirty = false;
+		} else if (e->dirty) {
+			/* The cached copy is newer than the card */
+			memcpy(blk_data, e->data, DATA_BLOCK_LEN);
+		}
+	}
+}
+
 /**
  * Read data of size len from the specified address and store it in data.
+ * Runs of whole blocks are streamed with one multiple block command, single
+ * and partial blocks go through the block cache.
  * This operation returns only when the read is complete
  * @param sd_desc	- Instance of the SD card
  * @param data		- Where data will be read
@@ -417,7 +543,11 @@ static int32_t read_multiple_blocks(struct sd_desc *sd_desc,
 int32_t sd_read(struct sd_desc *sd_desc,
 		uint8_t *data, uint64_t address, uint64_t len)
 {
-	struct cmd_desc	cmd_desc;
+	struct sd_cache_block	*entry;
+	uint32_t		block;
+	uint32_t		offset;
+	uint64_t		count;
+	uint64_t		chunk;
 
 	/* Initial checks */
 	if (data == NULL || address > sd_desc->memory_size ||
@@ -425,39 +555,39 @@ int32_t sd_read(struct sd_desc *sd_desc,
 	    address + len > sd_desc->memory_size)
 		return FAILURE;
 
-	/* Send read command */
-	cmd_desc.cmd = (get_nb_of_blocks(address, len) == 1) ? CMD(17): CMD(18);
-	cmd_desc.arg = address >> DATA_BLOCK_BITS;;
-	cmd_desc.response_len = R1_LEN;
-	if (SUCCESS != send_command(sd_desc, &cmd_desc))
-		return FAILURE;
-	if (cmd_desc.response[0] != R1_READY_STATE) {
-		DEBUG_MSG("Failed to write Data command\n");
-		return FAILURE;
-	}
-
-	/* Read blocks */
-	if (SUCCESS != read_multiple_blocks(sd_desc, data, address, len))
-		return FAILURE;
-
-	/* Send stop transmission command */
-	if (get_nb_of_blocks(address, len) != 1) {
-		cmd_desc.cmd = CMD(12);
-		cmd_desc.arg = STUFF_ARG;
-		cmd_desc.response_len = R1_LEN;
-		if (SUCCESS != send_command(sd_desc, &cmd_desc))
-			return FAILURE;
-		if(cmd_desc.response[0] != R1_READY_STATE) {
-			DEBUG_MSG("Failed to send stop transmission command\n");
-			return FAILURE;
+	block = address >> DATA_BLOCK_BITS;
+	offset = address & MASK_ADDR_IN_BLOCK;
+	while (len) {
+		count = offset ? 0 : len >> DATA_BLOCK_BITS;
+		if (count > 1) {
+			if (count > MAX_BLOCKS_PER_CMD)
+				count = MAX_BLOCKS_PER_CMD;
+			if (SUCCESS != read_blocks(sd_desc, data, block, count))
+				return FAILURE;
+			cache_sync(sd_desc, data, block, count, false);
+			chunk = count * DATA_BLOCK_LEN;
+		} else {
+			chunk = DATA_BLOCK_LEN - offset;
+			if (chunk > len)
+				chunk = len;
+			if (SUCCESS != cache_get(sd_desc, block, true, &entry))
+				return FAILURE;
+			memcpy(data, entry->data + offset, chunk);
 		}
+		data += chunk;
+		len -= chunk;
+		block += (offset + chunk) >> DATA_BLOCK_BITS;
+		offset = 0;
 	}
 
 	return SUCCESS;
 }
 
 /**
- * Write data of size len to the specified address
+ * Write data of size len to the specified address.
+ * Runs of whole blocks are streamed with one multiple block command, single
+ * and partial blocks go through the block cache. With a write-back cache,
+ * these are written to the card on eviction or by sd_flush().
  * This operation returns only when the write is complete
  * @param sd_desc	- Instance of the SD card
  * @param data		- Data to write
@@ -468,55 +598,110 @@ int32_t sd_read(struct sd_desc *sd_desc,
 int32_t sd_write(struct sd_desc *sd_desc, uint8_t *data, uint64_t address,
 		 uint64_t len)
 {
-	struct cmd_desc	cmd_desc;
-	uint8_t		first_block[DATA_BLOCK_LEN] __attribute__ ((aligned));
-	uint8_t		last_block[DATA_BLOCK_LEN] __attribute__ ((aligned));
+	struct sd_cache_block	*entry;
+	uint32_t		block;
+	uint32_t		offset;
+	uint64_t		count;
+	uint64_t		chunk;
 
 	/* Initial checks */
 	if (data == NULL || address > sd_desc->memory_size ||
 	    len > sd_desc->memory_size || address + len > sd_desc->memory_size)
 		return FAILURE;
 
-	/* Read first and last block in memory if needed to be updated with user data and then written back                                                                        */
-	/* If not writing from the beginning of a block or */
-	if ((address & MASK_ADDR_IN_BLOCK) != 0 ||
-	    /* If writing from the beginning but not the full block */
-	    ((address & MASK_ADDR_IN_BLOCK) == 0 && len < DATA_BLOCK_LEN))
-		sd_read(sd_desc, first_block, address & MASK_BLOCK_NUMBER, DATA_BLOCK_LEN);
-	/* If the last block is different from the first and */
-	if (((address + len - 1) & MASK_BLOCK_NUMBER) != (address & MASK_BLOCK_NUMBER)
-	    /* If reading less than the full block */
-	    && ((address + len - 1) & MASK_ADDR_IN_BLOCK) != MASK_ADDR_IN_BLOCK)
-		sd_read(sd_desc, last_block, (address + len - 1) & MASK_BLOCK_NUMBER,
-			DATA_BLOCK_LEN);
-
-	/* Send write command to SD */
-	cmd_desc.cmd = (get_nb_of_blocks(address, len) == 1) ? CMD(24): CMD(25);
-	cmd_desc.arg = address >> DATA_BLOCK_BITS; //Address of first block
-	cmd_desc.response_len = R1_LEN;
-	if (SUCCESS != send_command(sd_desc, &cmd_desc))
-		return FAILURE;
-	if (cmd_desc.response[0] != R1_READY_STATE) {
-		DEBUG_MSG("Failed to write Data command\n");
-		return FAILURE;
+	block = address >> DATA_BLOCK_BITS;
+	offset = address & MASK_ADDR_IN_BLOCK;
+	while (len) {
+		count = offset ? 0 : len >> DATA_BLOCK_BITS;
+		if (count > 1) {
+			if (count > MAX_BLOCKS_PER_CMD)
+				count = MAX_BLOCKS_PER_CMD;
+			if (SUCCESS != write_blocks(sd_desc, data, block, count))
+				return FAILURE;
+			cache_sync(sd_desc, data, block, count, true);
+			chunk = count * DATA_BLOCK_LEN;
+		} else {
+			chunk = DATA_BLOCK_LEN - offset;
+			if (chunk > len)
+				chunk = len;
+			/* Only a partial block needs the old content */
+			if (SUCCESS != cache_get(sd_desc, block,
+						 chunk != DATA_BLOCK_LEN, &entry))
+				return FAILURE;
+			memcpy(entry->data + offset, data, chunk);
+			entry->dirty = true;
+			if (!sd_desc->write_back &&
+			    SUCCESS != cache_write_back(sd_desc, entry))
+				return FAILURE;
+		}
+		data += chunk;
+		len -= chunk;
+		block += (offset + chunk) >> DATA_BLOCK_BITS;
+		offset = 0;
 	}
 
-	/* Write blocks */
-	if (SUCCESS != write_multiple_blocks(sd_desc, data, address, len,
-					     first_block, last_block))
+	return SUCCESS;
+}
+
+/**
+ * Erase the blocks of the specified range. Cached copies of these blocks
+ * are dropped, even if they were modified.
+ * This operation returns only when the erase is complete
+ * @param sd_desc	- Instance of the SD card
+ * @param address	- Address of the first block, multiple of DATA_BLOCK_LEN
+ * @param len		- Length in bytes, multiple of DATA_BLOCK_LEN
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sd_erase(struct sd_desc *sd_desc, uint64_t address, uint64_t len)
+{
+	struct sd_cache_block	*e;
+	uint32_t		first;
+	uint32_t		last;
+	uint32_t		i;
+
+	/* Initial checks */
+	if (!len || (address & MASK_ADDR_IN_BLOCK) ||
+	    (len & MASK_ADDR_IN_BLOCK) || address > sd_desc->memory_size ||
+	    len > sd_desc->memory_size || address + len > sd_desc->memory_size)
 		return FAILURE;
 
-	/* Send stop transmission token */
-	if (get_nb_of_blocks(address, len) != 1) {
-		sd_desc->buff[0] = STOP_TRANSMISSION_TOKEN;
-		sd_desc->buff[1] = 0xFF;
-		if (SUCCESS != spi_write_and_read(sd_desc->spi_desc, sd_desc->buff, 2))
-			return FAILURE;
-		if (SUCCESS != wait_until_not_busy(sd_desc))
-			return FAILURE;
+	first = address >> DATA_BLOCK_BITS;
+	last = (address + len - 1) >> DATA_BLOCK_BITS;
+	for (i = 0; i < sd_desc->cache_len; i++) {
+		e = &sd_desc->cache[i];
+		if (e->valid && e->block >= first && e->block <= last)
+			e->valid = false;
 	}
 
-	return SUCCESS;
+	if (SUCCESS != send_data_command(sd_desc, CMD(32), first))
+		return FAILURE;
+	if (SUCCESS != send_data_command(sd_desc, CMD(33), last))
+		return FAILURE;
+	if (SUCCESS != send_data_command(sd_desc, CMD(38), STUFF_ARG))
+		return FAILURE;
+
+	return wait_until_not_busy(sd_desc, WAIT_ERASE_TIMEOUT);
+}
+
+/**
+ * Write to the card all the blocks modified in the write-back cache
+ * @param sd_desc	- Instance of the SD card
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sd_flush(struct sd_desc *sd_desc)
+{
+	uint32_t	i;
+	int32_t		ret;
+
+	if (!sd_desc)
+		return FAILURE;
+
+	ret = SUCCESS;
+	for (i = 0; i < sd_desc->cache_len; i++)
+		if (SUCCESS != cache_write_back(sd_desc, &sd_desc->cache[i]))
+			ret = FAILURE;
+
+	return ret;
 }
 
 /**
@@ -539,6 +724,7 @@ int32_t sd_init(struct sd_desc **sd_desc, const struct sd_init_param *param)
 	if (!local_desc)
 		return FAILURE;
 	local_desc->spi_desc = param->spi_desc;
+	local_desc->block_xfer = param->block_xfer;
 
 	/* Synchronize SD card frequency: Send 10 dummy bytes*/
 	memset(local_desc->buff, 0xFF, 10);
@@ -622,6 +808,34 @@ int32_t sd_init(struct sd_desc **sd_desc, const struct sd_init_param *param)
 			  local_desc->buff[9];
 	local_desc->memory_size = ((uint64_t)c_size + 1) *
 				  ((uint64_t)DATA_BLOCK_LEN << 10u);
+	local_desc->erase_blocks = CSD_SECTOR_SIZE(local_desc->buff) + 1;
+
+	/* Read SCR register to check if CMD23 is supported */
+	cmd_desc.cmd = ACMD(51);
+	cmd_desc.arg = STUFF_ARG;
+	cmd_desc.response_len = R1_LEN;
+	if (SUCCESS != send_command(local_desc, &cmd_desc))
+		goto failure;
+	if (SUCCESS != wait_for_response(local_desc, cmd_desc.response))
+		goto failure;
+	if (cmd_desc.response[0] != START_1_BLOCK_TOKEN) {
+		DEBUG_MSG("Failed to read SCR register\n");
+		goto failure;
+	}
+	memset(local_desc->buff, 0xFF, SCR_LEN);
+	if (SUCCESS != spi_write_and_read(local_desc->spi_desc,
+					  local_desc->buff, SCR_LEN))
+		goto failure;
+	local_desc->set_block_count = !!(local_desc->buff[SCR_CMD23_BYTE] &
+					 SCR_CMD23_MASK);
+
+	/* Without write-back, one block is still needed for partial writes */
+	local_desc->write_back = param->cache_blocks != 0;
+	local_desc->cache_len = param->cache_blocks ? param->cache_blocks : 1;
+	local_desc->cache = calloc(local_desc->cache_len,
+				   sizeof(*local_desc->cache));
+	if (!local_desc->cache)
+		goto failure;
 
 	*sd_desc = local_desc;
 
@@ -632,15 +846,21 @@ failure:
 }
 
 /**
- * Remove the initialize instance of SD card.
+ * Remove the initialize instance of SD card. The blocks modified in the
+ * write-back cache are written to the card first.
  * @param desc	- Instance of the SD card
  * @return SUCCESS in case of success, FAILURE otherwise.
  */
 int32_t sd_remove(struct sd_desc *desc)
 {
+	int32_t	ret;
+
 	if (desc == NULL)
 		return FAILURE;
 
+	ret = sd_flush(desc);
+	free(desc->cache);
 	free(desc);
-	return SUCCESS;
+
+	return ret;
 }
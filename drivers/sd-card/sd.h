@@ -46,6 +46,10 @@
 *   	- High capacity or extended capacity (SDHX or SDXC)
 *   	- Supply voltage of 3.3V
 *
+* Runs of whole blocks are moved with multiple block commands. Single and
+* partial blocks go through a small block cache which, when enabled with
+* cache_blocks, keeps written blocks until sd_flush() or sd_remove().
+*
 *******************************************************************************/
 
 #ifndef __SD_H__
@@ -78,6 +82,13 @@
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
 
+/**
+ * Full duplex transfer used for the data blocks, with the same behavior as
+ * spi_write_and_read(). Lets the platform move the blocks with DMA.
+ */
+typedef int32_t (*sd_block_xfer)(struct spi_desc *desc, uint8_t *data,
+				 uint16_t bytes);
+
 /**
  * @struct sd_init_param
  * @brief Configuration structure sent in the function sd_init
@@ -85,6 +96,27 @@
 struct sd_init_param {
 	/** Descriptor of an initialized SPI channel */
 	struct spi_desc *spi_desc;
+	/** Transfer used for the data blocks, NULL for spi_write_and_read() */
+	sd_block_xfer	block_xfer;
+	/** Number of blocks kept in the write-back cache, 0 to write through */
+	uint32_t	cache_blocks;
+};
+
+/**
+ * @struct sd_cache_block
+ * @brief Cached copy of one data block
+ */
+struct sd_cache_block {
+	/** Data block */
+	uint8_t		data[DATA_BLOCK_LEN] __attribute__ ((aligned));
+	/** Block number on the card */
+	uint32_t	block;
+	/** Last use, for the replacement of the least recently used block */
+	uint32_t	stamp;
+	/** true if data holds the content of block */
+	bool		valid;
+	/** true if data was not written to the card yet */
+	bool		dirty;
 };
 
 /**
@@ -98,8 +130,24 @@ struct sd_desc {
 	uint64_t	memory_size;
 	/** 1 if SD card is HC or XC, 0 otherwise */
 	uint8_t		high_capacity;
+	/** Erase sector size, in data blocks */
+	uint32_t	erase_blocks;
+	/** 1 if the card supports CMD23 (SET_BLOCK_COUNT), 0 otherwise */
+	uint8_t		set_block_count;
 	/** Buffer used for the driver implementation */
 	uint8_t		buff[18];
+	/** Transfer used for the data blocks */
+	sd_block_xfer	block_xfer;
+	/** Token, data block and CRC, sent or received in one transfer */
+	uint8_t		block_buff[DATA_BLOCK_LEN + 3] __attribute__ ((aligned));
+	/** Block cache */
+	struct sd_cache_block	*cache;
+	/** Number of blocks in cache */
+	uint32_t	cache_len;
+	/** Incremented on every cache access */
+	uint32_t	cache_stamp;
+	/** true if written blocks are kept in cache until sd_flush() */
+	bool		write_back;
 };
 
 /**
@@ -132,6 +180,8 @@ int32_t sd_write(struct sd_desc *desc,
 		 uint8_t *data,
 		 uint64_t address,
 		 uint64_t len);
+int32_t sd_erase(struct sd_desc *desc, uint64_t address, uint64_t len);
+int32_t sd_flush(struct sd_desc *desc);
 
 #endif /* __SD_H__ */
 
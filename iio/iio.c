@@ -47,9 +47,31 @@
 #include "ctype.h"
 #include "tinyiiod.h"
 #include "util.h"
+#include "xml.h"
 #include "error.h"
 #include "errno.h"
 
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* Sizes of the batch frame, entry and reply entry headers */
+#define IIO_BATCH_HDR		6
+#define IIO_BATCH_ENTRY_HDR	8
+#define IIO_BATCH_REPLY_HDR	6
+/* Largest batch reply */
+#define IIO_BATCH_REPLY_SIZE	4096
+/* Largest attribute value written by a batch, including the NUL */
+#define IIO_BATCH_VALUE_SIZE	256
+
+/* Batch IDs: interface index, channel index + 1 (0 for the device) and
+ * attribute index + 1 (0 for none) */
+#define IIO_BATCH_ID(dev, ch, attr)	(((uint32_t)(dev) << 24) | \
+					 ((uint32_t)(ch) << 12) | (attr))
+#define IIO_BATCH_ID_DEV(id)		((id) >> 24)
+#define IIO_BATCH_ID_CH(id)		(((id) >> 12) & 0xFFF)
+#define IIO_BATCH_ID_ATTR(id)		((id) & 0xFFF)
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -85,6 +107,12 @@ struct element_info {
  */
 static struct iio_interfaces *iio_interfaces = NULL;
 
+/**
+ * Reply of the last batch frame, read back through IIO_BATCH_ATTR.
+ */
+static char *iio_batch_reply = NULL;
+static size_t iio_batch_reply_len = 0;
+
 /******************************************************************************/
 /************************ Functions Definitions *******************************/
 /******************************************************************************/
@@ -191,9 +219,10 @@ static struct iio_interface *iio_get_interface(const char *device_name,
 static ssize_t iio_read_all_attr(void *device, char *buf, size_t len,
 				 const struct iio_ch_info *channel, struct iio_attribute **attributes)
 {
-	int16_t i = 0, j = 0;
-	char local_buf[256];
+	int16_t i = 0;
+	size_t j = 0;
 	ssize_t attr_length;
+	size_t padded;
 	uint32_t *pattr_length;
 
 	if (!attributes)
@@ -203,15 +232,19 @@ static ssize_t iio_read_all_attr(void *device, char *buf, size_t len,
 		return FAILURE;
 
 	while (attributes[i]) {
-		attr_length = attributes[i]->show(device, local_buf, len, channel);
+		if (j + 4 > len)
+			return -ENOMEM;
 		pattr_length = (uint32_t *)(buf + j);
-		*pattr_length = bswap_constant_32(attr_length);
 		j += 4;
+		/* Each value is rendered in place, right after its length */
+		attr_length = attributes[i]->show(device, buf + j, len - j, channel);
+		*pattr_length = bswap_constant_32(attr_length);
 		if (attr_length >= 0) {
-			sprintf(buf + j, "%s", local_buf);
-			if (attr_length & 0x3) /* multiple of 4 */
-				attr_length = ((attr_length >> 2) + 1) << 2;
-			j += attr_length;
+			padded = (attr_length + 3) & ~3; /* multiple of 4 */
+			if (j + padded > len)
+				return -ENOMEM;
+			memset(buf + j + attr_length, 0, padded - attr_length);
+			j += padded;
 		}
 		i++;
 	}
@@ -231,8 +264,9 @@ static ssize_t iio_read_all_attr(void *device, char *buf, size_t len,
 static ssize_t iio_write_all_attr(void *device, char *buf, size_t len,
 				  const struct iio_ch_info *channel, struct iio_attribute **attributes)
 {
-	int16_t i = 0, j = 0;
-	int16_t attr_length;
+	int16_t i = 0;
+	size_t j = 0;
+	uint32_t attr_length;
 
 	if (!attributes)
 		return FAILURE;
@@ -241,8 +275,12 @@ static ssize_t iio_write_all_attr(void *device, char *buf, size_t len,
 		return FAILURE;
 
 	while (attributes[i]) {
-		attr_length = bswap_constant_32((uint32_t)(buf + j));
+		if (j + 4 > len)
+			return -EINVAL;
+		attr_length = bswap_constant_32(*(uint32_t *)(buf + j));
 		j += 4;
+		if (attr_length > len - j)
+			return -EINVAL;
 		attributes[i]->store(device, (buf + j), attr_length, channel);
 		j += attr_length;
 		if (j & 0x3)
@@ -367,6 +405,317 @@ static bool iio_supported_dev(const char *device)
 	return (NULL != iio_get_interface(device, iio_interfaces));
 }
 
+/**
+ * @brief Read a little endian 16-bit value.
+ * @param p - Where the value is stored.
+ * @return The value.
+ */
+static inline uint16_t iio_get_le16(const char *p)
+{
+	return (uint8_t)p[0] | ((uint8_t)p[1] << 8);
+}
+
+/**
+ * @brief Read a little endian 32-bit value.
+ * @param p - Where the value is stored.
+ * @return The value.
+ */
+static inline uint32_t iio_get_le32(const char *p)
+{
+	return iio_get_le16(p) | ((uint32_t)iio_get_le16(p + 2) << 16);
+}
+
+/**
+ * @brief Write a little endian 16-bit value.
+ * @param p - Where the value is stored.
+ * @param val - The value.
+ */
+static inline void iio_put_le16(char *p, uint16_t val)
+{
+	p[0] = val;
+	p[1] = val >> 8;
+}
+
+/**
+ * @brief Write a little endian 32-bit value.
+ * @param p - Where the value is stored.
+ * @param val - The value.
+ */
+static inline void iio_put_le32(char *p, uint32_t val)
+{
+	iio_put_le16(p, val);
+	iio_put_le16(p + 2, val >> 16);
+}
+
+/**
+ * @brief Resolve the names of an element into a batch ID.
+ * @param data - "device\0channel\0attribute\0", channel and attribute can be
+ * 		empty.
+ * @param len - Length of data.
+ * @param ch_out - If "true" is output channel, if "false" is input channel.
+ * @param id - The ID.
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+static int32_t iio_batch_resolve(const char *data, uint16_t len, bool ch_out,
+				 uint32_t *id)
+{
+	const char *channel, *attr;
+	struct iio_device *iio;
+	struct iio_attribute **attributes;
+	int16_t ch = 0, at = 0;
+	uint8_t i;
+
+	if (!len || data[len - 1] != '\0')
+		return -EINVAL;
+	channel = data + strlen(data) + 1;
+	if (channel >= data + len)
+		return -EINVAL;
+	attr = channel + strlen(channel) + 1;
+	if (attr >= data + len)
+		return -EINVAL;
+
+	for (i = 0; i < iio_interfaces->num_interfaces; i++)
+		if (!strcmp(data, iio_interfaces->interfaces[i]->name))
+			break;
+	if (i == iio_interfaces->num_interfaces)
+		return -ENODEV;
+
+	iio = iio_interfaces->interfaces[i]->iio;
+	attributes = iio->attributes;
+	if (*channel) {
+		if (!iio->channels)
+			return -ENOENT;
+		ch = iio_get_channel_id(channel, iio->channels, ch_out);
+		if (ch < 0)
+			return ch;
+		attributes = iio->channels[ch]->attributes;
+		ch++;
+	}
+	if (*attr) {
+		if (!attributes)
+			return -ENOENT;
+		at = iio_get_attribute_id(attr, attributes);
+		if (at < 0)
+			return at;
+		at++;
+	}
+	*id = IIO_BATCH_ID(i, ch, at);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Find the attribute of a batch ID.
+ * @param id - The ID.
+ * @param iface - Interface of the attribute.
+ * @param attr - The attribute.
+ * @param channel - Channel properties, untouched for device attributes.
+ * @return SUCCESS if the attribute is found, negative value otherwise.
+ */
+static int32_t iio_batch_get_attr(uint32_t id, struct iio_interface **iface,
+				  struct iio_attribute **attr,
+				  struct iio_ch_info **channel)
+{
+	struct iio_attribute **attributes;
+	struct iio_channel **channels;
+	uint16_t ch = IIO_BATCH_ID_CH(id);
+	uint16_t at = IIO_BATCH_ID_ATTR(id);
+	uint16_t i;
+
+	if (IIO_BATCH_ID_DEV(id) >= iio_interfaces->num_interfaces || !at)
+		return -ENOENT;
+	*iface = iio_interfaces->interfaces[IIO_BATCH_ID_DEV(id)];
+
+	attributes = (*iface)->iio->attributes;
+	if (ch) {
+		channels = (*iface)->iio->channels;
+		for (i = 0; i < ch; i++)
+			if (!channels || !channels[i])
+				return -ENOENT;
+		attributes = channels[ch - 1]->attributes;
+		(*channel)->ch_num = iio_get_channel_number(channels[ch - 1]->name);
+		(*channel)->ch_out = channels[ch - 1]->ch_out;
+	} else {
+		*channel = NULL;
+	}
+
+	for (i = 0; i < at; i++)
+		if (!attributes || !attributes[i])
+			return -ENOENT;
+	*attr = attributes[at - 1];
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Execute a batch entry.
+ * @param entry - The entry.
+ * @param reply - Where the reply data is stored.
+ * @param size - Size of reply.
+ * @param reply_len - Length of the reply data.
+ * @return Status of the entry: length of the value or SUCCESS, negative value
+ * 		in case of error.
+ */
+static ssize_t iio_batch_entry(const char *entry, char *reply, size_t size,
+			       uint16_t *reply_len)
+{
+	uint8_t op = entry[0];
+	uint16_t len = iio_get_le16(entry + 2);
+	uint32_t id = iio_get_le32(entry + 4);
+	const char *data = entry + IIO_BATCH_ENTRY_HDR;
+	char value[IIO_BATCH_VALUE_SIZE];
+	struct iio_interface *iface;
+	struct iio_attribute *attr;
+	struct iio_ch_info ch_info;
+	struct iio_ch_info *channel = &ch_info;
+	uint32_t val;
+	ssize_t ret;
+
+	*reply_len = 0;
+
+	switch (op) {
+	case IIO_BATCH_RESOLVE:
+		if (size < 4)
+			return -ENOMEM;
+		ret = iio_batch_resolve(data, len, entry[1] & IIO_BATCH_CH_OUT, &val);
+		if (ret < 0)
+			return ret;
+		iio_put_le32(reply, val);
+		*reply_len = 4;
+
+		return SUCCESS;
+	case IIO_BATCH_READ_ATTR:
+		ret = iio_batch_get_attr(id, &iface, &attr, &channel);
+		if (ret < 0)
+			return ret;
+		if (!attr->show)
+			return -ENOENT;
+		ret = attr->show(iface->dev_instance, reply, size, channel);
+		if (ret > 0)
+			*reply_len = min_t(size_t, ret, size);
+
+		return ret;
+	case IIO_BATCH_WRITE_ATTR:
+		/* Attribute handlers expect a NUL terminated value */
+		if (len >= sizeof(value))
+			return -EINVAL;
+		ret = iio_batch_get_attr(id, &iface, &attr, &channel);
+		if (ret < 0)
+			return ret;
+		if (!attr->store)
+			return -ENOENT;
+		memcpy(value, data, len);
+		value[len] = '\0';
+
+		return attr->store(iface->dev_instance, value, len, channel);
+	case IIO_BATCH_READ_REG:
+	case IIO_BATCH_WRITE_REG:
+		if (IIO_BATCH_ID_DEV(id) >= iio_interfaces->num_interfaces ||
+		    len < (op == IIO_BATCH_READ_REG ? 4 : 8))
+			return -EINVAL;
+		iface = iio_interfaces->interfaces[IIO_BATCH_ID_DEV(id)];
+		if (op == IIO_BATCH_WRITE_REG)
+			return iface->write_reg ?
+			       iface->write_reg(iface->dev_instance,
+						iio_get_le32(data),
+						iio_get_le32(data + 4)) : -ENOENT;
+		if (!iface->read_reg)
+			return -ENOENT;
+		if (size < 4)
+			return -ENOMEM;
+		ret = iface->read_reg(iface->dev_instance, iio_get_le32(data), &val);
+		if (ret < 0)
+			return ret;
+		iio_put_le32(reply, val);
+		*reply_len = 4;
+
+		return SUCCESS;
+	default:
+		return -EINVAL;
+	}
+}
+
+/**
+ * @brief Execute a batch frame and keep its reply for iio_batch_read().
+ * The whole frame is checked before any entry is executed. If the reply
+ * buffer fills up the remaining entries are not executed, the reply holds
+ * the number of executed entries.
+ * @param buf - The request frame.
+ * @param len - Length of buf.
+ * @return Length of the request in case of success or negative value
+ * 		otherwise.
+ */
+static ssize_t iio_batch_run(const char *buf, size_t len)
+{
+	size_t pos, out;
+	uint16_t count, i, reply_len;
+	ssize_t status;
+
+	if (len < IIO_BATCH_HDR || iio_get_le16(buf) != IIO_BATCH_MAGIC ||
+	    buf[2] != IIO_BATCH_VERSION)
+		return -EINVAL;
+	count = iio_get_le16(buf + 4);
+
+	for (i = 0, pos = IIO_BATCH_HDR; i < count; i++) {
+		if (pos + IIO_BATCH_ENTRY_HDR > len)
+			return -EINVAL;
+		pos += IIO_BATCH_ENTRY_HDR + iio_get_le16(buf + pos + 2);
+	}
+	if (pos > len)
+		return -EINVAL;
+
+	if (!iio_batch_reply) {
+		iio_batch_reply = (char *)malloc(IIO_BATCH_REPLY_SIZE);
+		if (!iio_batch_reply)
+			return -ENOMEM;
+	}
+
+	pos = IIO_BATCH_HDR;
+	out = IIO_BATCH_HDR;
+	for (i = 0; i < count; i++) {
+		if (out + IIO_BATCH_REPLY_HDR > IIO_BATCH_REPLY_SIZE)
+			break;
+		status = iio_batch_entry(buf + pos,
+					 iio_batch_reply + out + IIO_BATCH_REPLY_HDR,
+					 IIO_BATCH_REPLY_SIZE - out - IIO_BATCH_REPLY_HDR,
+					 &reply_len);
+		iio_put_le32(iio_batch_reply + out, status);
+		iio_put_le16(iio_batch_reply + out + 4, reply_len);
+		out += IIO_BATCH_REPLY_HDR + reply_len;
+		pos += IIO_BATCH_ENTRY_HDR + iio_get_le16(buf + pos + 2);
+	}
+
+	iio_put_le16(iio_batch_reply, IIO_BATCH_MAGIC);
+	iio_batch_reply[2] = IIO_BATCH_VERSION;
+	iio_batch_reply[3] = 0;
+	iio_put_le16(iio_batch_reply + 4, i);
+	iio_batch_reply_len = out;
+
+	return len;
+}
+
+/**
+ * @brief Read the reply of the last batch frame. A reply can be read once.
+ * @param buf - Where the reply is stored.
+ * @param len - Size of buf.
+ * @return Length of the reply or negative value in case of error.
+ */
+static ssize_t iio_batch_read(char *buf, size_t len)
+{
+	ssize_t ret;
+
+	if (!iio_batch_reply_len)
+		return -ENOENT;
+	if (len < iio_batch_reply_len)
+		return -ENOMEM;
+
+	memcpy(buf, iio_batch_reply, iio_batch_reply_len);
+	ret = iio_batch_reply_len;
+	iio_batch_reply_len = 0;
+
+	return ret;
+}
+
 /**
  * @brief Read global attribute of a device.
  * @param device - String containing device name.
@@ -385,6 +734,9 @@ static ssize_t iio_read_attr(const char *device, const char *attr, char *buf,
 	if (!iio_supported_dev(device))
 		return FAILURE;
 
+	if (debug && !strcmp(attr, IIO_BATCH_ATTR))
+		return iio_batch_read(buf, len);
+
 	el_info.device_name = device;
 	el_info.channel_name = "";	/* there is no channel here */
 	el_info.attribute_name = attr;
@@ -415,6 +767,9 @@ static ssize_t iio_write_attr(const char *device, const char *attr,
 	if (!iio_supported_dev(device))
 		return -ENODEV;
 
+	if (debug && !strcmp(attr, IIO_BATCH_ATTR))
+		return iio_batch_run(buf, len);
+
 	el_info.device_name = device;
 	el_info.channel_name = "";	/* there is no channel here */
 	el_info.attribute_name = attr;
@@ -631,18 +986,16 @@ static ssize_t iio_write_dev(const char *device, const char *buf,
 }
 
 /**
- * @brief Get a merged xml containing all devices.
- * @param outxml - Generated xml.
+ * @brief Write the context description.
+ * @param writer - XML writer.
+ * @param dev_xml - Descriptions of the devices.
  * @return SUCCESS in case of success or negative value otherwise.
  */
-static ssize_t iio_get_xml(char **outxml)
+static ssize_t iio_write_context_xml(struct xml_writer *writer, char **dev_xml)
 {
-	char *xml, *tmp_xml, *tmp_xml2;
-	uint32_t length;
 	uint16_t i;
-	ssize_t ret;
 
-	char header[] = "<?xml version=\"1.0\" encoding=\"utf-8\"?>"
+	static const char header[] = "<?xml version=\"1.0\" encoding=\"utf-8\"?>"
 			"<!DOCTYPE context ["
 			"<!ELEMENT context (device | context-attribute)*>"
 			"<!ELEMENT context-attribute EMPTY>"
@@ -663,46 +1016,67 @@ static ssize_t iio_get_xml(char **outxml)
 			"]>"
 			"<context name=\"xml\" description=\"no-OS analog 1.1.0-g0000000 #1 Tue Nov 26 09:52:32 IST 2019 armv7l\" >"
 			"<context-attribute name=\"no-OS\" value=\"1.1.0-g0000000\" />";
-	char header_end[] = "</context>";
+	static const char header_end[] = "</context>";
+
+	xml_write_raw(writer, header);
+	for (i = 0; i < iio_interfaces->num_interfaces; i++)
+		xml_write_raw(writer, dev_xml[i]);
+
+	return xml_write_raw(writer, header_end);
+}
+
+/**
+ * @brief Get a merged xml containing all devices. The length is computed
+ * first so the context is rendered in a single allocation.
+ * @param outxml - Generated xml.
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+static ssize_t iio_get_xml(char **outxml)
+{
+	struct xml_writer writer;
+	char **dev_xml;
+	char *xml = NULL;
+	uint16_t i;
+	ssize_t ret;
 
 	if (!outxml)
 		return FAILURE;
 
-	xml = (char *)calloc(1, strlen(header) + 1);
-	if (!xml)
+	dev_xml = (char **)calloc(iio_interfaces->num_interfaces,
+				  sizeof(*dev_xml));
+	if (!dev_xml)
 		return FAILURE;
 
-	strcpy(xml, header);
 	for (i = 0; i < iio_interfaces->num_interfaces; i++) {
-		ret = iio_interfaces->interfaces[i]->get_xml(&tmp_xml,
+		ret = iio_interfaces->interfaces[i]->get_xml(&dev_xml[i],
 				iio_interfaces->interfaces[i]->iio);
 		if (ret < 0)
 			goto error;
-
-		length = strlen(xml);
-		tmp_xml2 = (char *)realloc(xml, strlen(xml) + strlen(tmp_xml) + 1);
-		if (!tmp_xml2)
-			goto error;
-
-		xml = tmp_xml2;
-		strcpy((xml + length), tmp_xml);
 	}
 
-	length = strlen(xml);
-	tmp_xml = (char *)realloc(xml, strlen(xml) + strlen(header_end) + 1);
-	if (!tmp_xml)
+	xml_writer_init(&writer, NULL, 0, NULL, NULL);
+	iio_write_context_xml(&writer, dev_xml);
+
+	ret = FAILURE;
+	xml = (char *)malloc(writer.len + 1);
+	if (!xml)
 		goto error;
 
-	xml = tmp_xml;
-	strcpy((xml + length), header_end);
+	xml_writer_init(&writer, xml, writer.len + 1, NULL, NULL);
+	iio_write_context_xml(&writer, dev_xml);
+	ret = xml_writer_flush(&writer);
+	if (ret < 0)
+		goto error;
 
 	*outxml = xml;
-
-	return SUCCESS;
+	xml = NULL;
 error:
+	for (i = 0; i < iio_interfaces->num_interfaces; i++)
+		free(dev_xml[i]);
+	free(dev_xml);
 	free(xml);
 
-	return FAILURE;
+	return ret;
 }
 
 /**
@@ -837,6 +1211,9 @@ ssize_t iio_remove(struct tinyiiod *iiod)
 		free(iio_interfaces->interfaces[i]);
 
 	free(iio_interfaces);
+	free(iio_batch_reply);
+	iio_batch_reply = NULL;
+	iio_batch_reply_len = 0;
 	tinyiiod_destroy(iiod);
 
 	return SUCCESS;
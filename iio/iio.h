@@ -47,10 +47,53 @@
 #include "tinyiiod.h"
 #include "iio_types.h"
 
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/*
+ * Batch frames are written to, and their replies read from, the debug
+ * attribute IIO_BATCH_ATTR of any registered device. All fields are little
+ * endian.
+ *
+ * Request: u16 magic, u8 version, u8 reserved, u16 number of entries, then
+ * for each entry: u8 op, u8 flags, u16 data length, u32 id, data.
+ * Reply: u16 magic, u8 version, u8 reserved, u16 number of entries, then
+ * for each entry: i32 status (length or negative error), u16 data length,
+ * data.
+ *
+ * IDs are returned by IIO_BATCH_RESOLVE and are valid until an interface is
+ * registered or unregistered.
+ */
+#define IIO_BATCH_ATTR		"iio_batch"
+#define IIO_BATCH_MAGIC		0x4249
+#define IIO_BATCH_VERSION	1
+/* Resolve flag, the channel is an output channel */
+#define IIO_BATCH_CH_OUT	0x01
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
 
+/**
+ * @enum iio_batch_op
+ * @brief Operations of a batch entry.
+ */
+enum iio_batch_op {
+	/** Data is "device\0channel\0attribute\0", replies with the u32 id.
+	 *  Channel and attribute can be empty, a device id is used for
+	 *  register accesses. */
+	IIO_BATCH_RESOLVE,
+	/** Replies with the attribute value */
+	IIO_BATCH_READ_ATTR,
+	/** Data is the attribute value */
+	IIO_BATCH_WRITE_ATTR,
+	/** Data is the u32 register address, replies with the u32 value */
+	IIO_BATCH_READ_REG,
+	/** Data is the u32 register address and the u32 value */
+	IIO_BATCH_WRITE_REG,
+};
+
 /**
  * @struct iio_interface
  * @brief Links a physical device instance "void *dev_instance"
@@ -79,6 +122,10 @@ struct iio_interface {
 	/** Write data to RAM. It should be called before "transfer_mem_to_dev" */
 	ssize_t (*write_data)(void *dev_instance, char *pbuf, size_t offset,
 			      size_t bytes_count, uint32_t ch_mask);
+	/** Read a device register, optional */
+	int32_t (*read_reg)(void *dev_instance, uint32_t reg, uint32_t *val);
+	/** Write a device register, optional */
+	int32_t (*write_reg)(void *dev_instance, uint32_t reg, uint32_t val);
 };
 
 /******************************************************************************/
@@ -47,6 +47,7 @@
 #include <errno.h>
 #include "error.h"
 #include "iio_ad9361.h"
+#include "iio_format.h"
 #include "ad9361_api.h"
 #include "util.h"
 
@@ -86,6 +87,18 @@ static const char * const ad9361_rf_tx_port[] =
 static const char * const ad9361_agc_modes[] =
 {"manual", "fast_attack", "slow_attack", "hybrid"};
 
+/**
+ * Receive path clocks.
+ */
+static const char * const rx_path_clks[] =
+{"BBPLL:", "ADC:", "R2:", "R1:", "RF:", "RXSAMP:"};
+
+/**
+ * Transmit path clocks.
+ */
+static const char * const tx_path_clks[] =
+{"BBPLL:", "DAC:", "T2:", "T1:", "TF:", "TXSAMP:"};
+
 /**
  * State machine modes.
  */
@@ -417,6 +430,70 @@ static const char * const  ad9361_phy_xml =
 /************************ Functions Definitions *******************************/
 /******************************************************************************/
 
+/**
+ * @brief Parse an unsigned 32-bit attribute value.
+ * @param buf - Value written to the attribute.
+ * @param val - The value.
+ * @return SUCCESS in case of success, -EINVAL otherwise.
+ */
+static int32_t parse_uint32(const char *buf, uint32_t *val)
+{
+	uint64_t v;
+
+	if (iio_parse_uint(buf, &v) < 0 || v > UINT32_MAX)
+		return -EINVAL;
+	*val = v;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Parse an enable attribute value, any non zero value enables.
+ * @param buf - Value written to the attribute.
+ * @param en_dis - 1 to enable, 0 to disable.
+ * @return SUCCESS in case of success, -EINVAL otherwise.
+ */
+static int32_t parse_en_dis(const char *buf, uint8_t *en_dis)
+{
+	uint64_t v;
+
+	if (iio_parse_uint(buf, &v) < 0)
+		return -EINVAL;
+	*en_dis = !!v;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Format the clock rates of a data path as "NAME:rate NAME:rate ...".
+ * @param buf - Where value is stored.
+ * @param len - Maximum length of value to be stored in buf.
+ * @param names - Clock names, one for each rate.
+ * @param clk - Clock rates.
+ * @return Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t fmt_path_rates(char *buf, size_t len, const char * const *names,
+			      const unsigned long *clk)
+{
+	size_t length = 0;
+	ssize_t ret;
+	uint8_t i;
+
+	for (i = 0; i < 6; i++) {
+		ret = iio_fmt_str(buf + length, len - length, names[i]);
+		if (ret < 0)
+			return ret;
+		length += ret;
+		ret = iio_fmt_uint(buf + length, len - length, clk[i],
+				   i < 5 ? " " : NULL);
+		if (ret < 0)
+			return ret;
+		length += ret;
+	}
+
+	return length;
+}
+
 /**
  * @brief get_rf_port_select().
  * @param device- Physical instance of a iio_axi_adc device.
@@ -434,10 +511,10 @@ static ssize_t get_rf_port_select(void *device, char *buf, size_t len,
 
 	if (channel->ch_out) {
 		ret = ad9361_get_tx_rf_port_output(ad9361_phy, &mode);
-		return ret < 0 ? ret : sprintf(buf, "%s", ad9361_rf_tx_port[mode]);
+		return ret < 0 ? ret : iio_fmt_str(buf, len, ad9361_rf_tx_port[mode]);
 	} else {
 		ret = ad9361_get_rx_rf_port_input(ad9361_phy, &mode);
-		return ret < 0 ? ret : sprintf(buf, "%s", ad9361_rf_rx_port[mode]);
+		return ret < 0 ? ret : iio_fmt_str(buf, len, ad9361_rf_rx_port[mode]);
 	}
 }
 
@@ -454,26 +531,16 @@ static ssize_t get_hardwaregain(void *device, char *buf, size_t len,
 {
 	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
 	struct rf_rx_gain rx_gain = {0};
-	int32_t i = 0, ret, val1, val2;
+	int32_t ret;
 
 	if (channel->ch_out) {
 		ret = ad9361_get_tx_atten(ad9361_phy, channel->ch_num + 1);
 		if (ret < 0)
 			return -EINVAL;
-		val1 = -1 * (ret / 1000);
-		val2 = (ret % 1000) * 1000;
-		if (!val1)
-			val2 *= -1;
-		if (val2 < 0 && val1 >= 0) {
-			ret = (ssize_t) snprintf(buf, len, "-");
-			if (ret < 0)
-				return ret;
-			i++;
-		}
-		ret = i + (ssize_t) snprintf(&buf[i], len, "%"PRIi32".%.6"PRIi32" dB", val1,
-					     labs(val2));
 
-		return ret;
+		/* The attenuation is in mdB, the gain is its negative */
+		return iio_fmt_fixed(buf, len, -(int64_t)ret * 1000, IIO_FMT_MICRO,
+				     " dB");
 	} else {
 		ret = ad9361_get_rx_gain(ad9361_phy,
 					 ad9361_1rx1tx_channel_map(ad9361_phy,
@@ -481,8 +548,7 @@ static ssize_t get_hardwaregain(void *device, char *buf, size_t len,
 		if (ret < 0)
 			return ret;
 
-		return (ssize_t) snprintf(buf, len, "%"PRIi16".000000 dB",
-					  (int)rx_gain.gain_db);
+		return iio_fmt_int_plus_micro(buf, len, rx_gain.gain_db, 0, " dB");
 	}
 }
 
@@ -505,13 +571,20 @@ static ssize_t get_rssi(void *device, char *buf, size_t len,
 		ret = ad9361_get_tx_rssi(ad9361_phy, channel->ch_num, &rssi_db_x_1000);
 		if (ret < 0)
 			return -EINVAL;
-		return ret < 0 ? ret : sprintf(buf, "%"PRIu32".%02"PRIu32" dB",
-					       rssi_db_x_1000 / 1000, rssi_db_x_1000 % 1000);
+		return iio_fmt_fixed(buf, len, rssi_db_x_1000, IIO_FMT_MILLI, " dB");
 	} else {
 		struct rf_rssi rssi = {0};
+		uint8_t decimals = 0;
+		int32_t mul;
+
 		ret = ad9361_get_rx_rssi (ad9361_phy, channel->ch_num, &rssi);
-		return ret < 0 ? ret : sprintf(buf, "%"PRIu32".%02"PRIu32" dB",
-					       rssi.symbol / rssi.multiplier, rssi.symbol % rssi.multiplier);
+		if (ret < 0)
+			return ret;
+		/* The multiplier is a power of 10, one decimal per digit */
+		for (mul = rssi.multiplier; mul > 1; mul /= 10)
+			decimals++;
+
+		return iio_fmt_fixed(buf, len, rssi.symbol, decimals, " dB");
 	}
 }
 
@@ -528,6 +601,7 @@ static ssize_t get_hardwaregain_available(void *device, char *buf, size_t len,
 {
 	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
 
+	/* Kept comma separated, the format this attribute always had */
 	if (channel->ch_out)
 		return (ssize_t) snprintf(buf, len, "[%"PRIi16", %"PRIi16", %"PRIi16"]", 0, 250,
 					  89750);
@@ -571,8 +645,7 @@ static ssize_t get_sampling_frequency_available(void *device, char *buf,
 			int_dec = ad9361_phy->rx_fir_dec;
 	}
 
-	return (ssize_t) snprintf(buf, len, "[%"PRIu32" %"PRIi16" %"PRIu32"]",
-				  MIN_ADC_CLK / (12 * int_dec), 1, max);
+	return iio_fmt_range(buf, len, MIN_ADC_CLK / (12 * int_dec), 1, max);
 }
 
 /**
@@ -586,27 +659,12 @@ static ssize_t get_sampling_frequency_available(void *device, char *buf,
 static ssize_t get_rf_port_select_available(void *device, char *buf, size_t len,
 		const struct iio_ch_info *channel)
 {
-	ssize_t bytes_no, ret;
-	uint16_t i;
-
-	if (channel->ch_out) {
-		return (ssize_t) sprintf(buf, "%s %s",
-					 ad9361_rf_tx_port[0],
-					 ad9361_rf_tx_port[1]);
-	} else {
-		bytes_no = 0;
-		for (i = 0; i < sizeof(ad9361_rf_rx_port) / sizeof(ad9361_rf_rx_port[0]);
-		     i++) {
-			if (i > 0)
-				bytes_no += sprintf(buf + bytes_no, " ");
-			ret = sprintf(buf + bytes_no, "%s", ad9361_rf_rx_port[i]);
-			if (ret < 0)
-				return ret;
-			bytes_no += ret;
-
-		}
-		return bytes_no;
-	}
+	if (channel->ch_out)
+		return iio_fmt_list(buf, len, ad9361_rf_tx_port,
+				    ARRAY_SIZE(ad9361_rf_tx_port));
+	else
+		return iio_fmt_list(buf, len, ad9361_rf_rx_port,
+				    ARRAY_SIZE(ad9361_rf_rx_port));
 }
 
 /**
@@ -631,7 +689,7 @@ static ssize_t get_filter_fir_en(void *device, char *buf, size_t len,
 	if (ret < 0)
 		return ret;
 
-	return (ssize_t) snprintf(buf, len, "%"PRIi16"", en_dis);
+	return iio_fmt_uint(buf, len, en_dis, NULL);
 }
 
 /**
@@ -652,7 +710,7 @@ static ssize_t get_sampling_frequency(void *device, char *buf, size_t len,
 	if (ret < 0)
 		return ret;
 
-	return (ssize_t) snprintf(buf, len, "%"PRIi32"", sampling_freq_hz);
+	return iio_fmt_uint(buf, len, sampling_freq_hz, NULL);
 }
 
 /**
@@ -667,9 +725,9 @@ static ssize_t get_rf_bandwidth_available(void *device, char *buf, size_t len,
 		const struct iio_ch_info *channel)
 {
 	if (channel->ch_out)
-		return snprintf(buf, len, "[200000 1 40000000]");
+		return iio_fmt_range(buf, len, 200000, 1, 40000000);
 	else
-		return snprintf(buf, len, "[200000 1 56000000]");
+		return iio_fmt_range(buf, len, 200000, 1, 56000000);
 }
 
 /**
@@ -685,9 +743,9 @@ static ssize_t get_rf_bandwidth(void *device, char *buf, size_t len,
 {
 	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
 	if (channel->ch_out)
-		return snprintf(buf, len, "%"PRIu32"", ad9361_phy->current_tx_bw_Hz);
+		return iio_fmt_uint(buf, len, ad9361_phy->current_tx_bw_Hz, NULL);
 	else
-		return snprintf(buf, len, "%"PRIu32"", ad9361_phy->current_rx_bw_Hz);
+		return iio_fmt_uint(buf, len, ad9361_phy->current_rx_bw_Hz, NULL);
 }
 
 /**
@@ -702,8 +760,8 @@ static ssize_t get_gain_control_mode(void *device, char *buf, size_t len,
 				     const struct iio_ch_info *channel)
 {
 	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
-	return (ssize_t) snprintf(buf, len, "%s",
-				  ad9361_agc_modes[ad9361_phy->agc_mode[channel->ch_num]]);
+	return iio_fmt_str(buf, len,
+			   ad9361_agc_modes[ad9361_phy->agc_mode[channel->ch_num]]);
 }
 
 /**
@@ -720,7 +778,7 @@ static ssize_t get_rf_dc_offset_tracking_en(void *device, char *buf, size_t len,
 	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
 
 	if (!channel->ch_out)
-		return (ssize_t) snprintf(buf, len, "%"PRIi16"", ad9361_phy->rfdc_track_en) + 1;
+		return iio_fmt_uint(buf, len, ad9361_phy->rfdc_track_en, NULL) + 1;
 
 	return -ENOENT;
 }
@@ -739,7 +797,7 @@ static ssize_t get_quadrature_tracking_en(void *device, char *buf, size_t len,
 	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
 
 	if (!channel->ch_out)
-		return (ssize_t) snprintf(buf, len, "%"PRIi16"", ad9361_phy->quad_track_en) + 1;
+		return iio_fmt_uint(buf, len, ad9361_phy->quad_track_en, NULL) + 1;
 
 	return -ENOENT;
 }
@@ -756,11 +814,8 @@ static ssize_t get_gain_control_mode_available(void *device, char *buf,
 		size_t len,
 		const struct iio_ch_info *channel)
 {
-	return (ssize_t) snprintf(buf, len, "%s %s %s %s",
-				  ad9361_agc_modes[0],
-				  ad9361_agc_modes[1],
-				  ad9361_agc_modes[2],
-				  ad9361_agc_modes[3]);
+	return iio_fmt_list(buf, len, ad9361_agc_modes,
+			    ARRAY_SIZE(ad9361_agc_modes));
 }
 
 /**
@@ -777,7 +832,7 @@ static ssize_t get_bb_dc_offset_tracking_en(void *device, char *buf, size_t len,
 	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
 
 	if (!channel->ch_out)
-		return (ssize_t) snprintf(buf, len, "%"PRIi16"", ad9361_phy->bbdc_track_en) + 1;
+		return iio_fmt_uint(buf, len, ad9361_phy->bbdc_track_en, NULL) + 1;
 
 	return -ENOENT;
 }
@@ -793,9 +848,8 @@ static ssize_t get_bb_dc_offset_tracking_en(void *device, char *buf, size_t len,
 static ssize_t get_frequency_available(void *device, char *buf, size_t len,
 				       const struct iio_ch_info *channel)
 {
-	return snprintf(buf, len, "[%"PRIu64" 1 %"PRIu64"]",
-			AD9363A_MIN_CARRIER_FREQ_HZ,
-			AD9363A_MAX_CARRIER_FREQ_HZ);
+	return iio_fmt_range(buf, len, AD9363A_MIN_CARRIER_FREQ_HZ, 1,
+			     AD9363A_MAX_CARRIER_FREQ_HZ);
 }
 
 /**
@@ -812,18 +866,25 @@ static ssize_t get_fastlock_save(void *device, char *buf, size_t len,
 	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
 	uint8_t faslock_vals[16];
 	size_t length;
-	int32_t ret = 0;
+	ssize_t ret = 0;
 	int32_t i;
 
 	ret = ad9361_fastlock_save(ad9361_phy, channel->ch_num == 1,
 				   ad9361_phy->fastlock.save_profile, faslock_vals);
 	if (ret < 0)
 		return ret;
-	length = snprintf(buf, len, "%"PRIu8" ", ad9361_phy->fastlock.save_profile);
+	ret = iio_fmt_uint(buf, len, ad9361_phy->fastlock.save_profile, " ");
+	if (ret < 0)
+		return ret;
+	length = ret;
 
-	for (i = 0; i < RX_FAST_LOCK_CONFIG_WORD_NUM; i++)
-		length += sprintf(buf + length, "%"PRIu8"%c", faslock_vals[i],
-				  i == 15 ? '\n' : ',');
+	for (i = 0; i < RX_FAST_LOCK_CONFIG_WORD_NUM; i++) {
+		ret = iio_fmt_uint(buf + length, len - length, faslock_vals[i],
+				   i == 15 ? "\n" : ",");
+		if (ret < 0)
+			return ret;
+		length += ret;
+	}
 
 	return length;
 }
@@ -845,7 +906,7 @@ static ssize_t get_powerdown(void *device, char *buf, size_t len,
 	val = !!(ad9361_phy->cached_synth_pd[channel->ch_num ? 0 : 1] &
 		 RX_LO_POWER_DOWN);
 
-	return snprintf(buf, len, "%"PRIu64"", val);
+	return iio_fmt_uint(buf, len, val, NULL);
 }
 
 /**
@@ -899,7 +960,7 @@ static ssize_t get_frequency(void *device, char *buf, size_t len,
 	val = ad9361_from_clk(clk_get_rate(ad9361_phy,
 					   ad9361_phy->ref_clk_scale[channel->ch_num ?
 									   TX_RFPLL : RX_RFPLL]));
-	return snprintf(buf, len, "%"PRIu64"", (val));
+	return iio_fmt_uint(buf, len, val, NULL);
 }
 
 /**
@@ -916,11 +977,9 @@ static ssize_t get_external(void *device, char *buf, size_t len,
 	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
 
 	if (channel->ch_num == 0)
-		return (ssize_t) snprintf(buf, len, "%"PRIi16"",
-					  ad9361_phy->pdata->use_ext_rx_lo);
+		return iio_fmt_uint(buf, len, ad9361_phy->pdata->use_ext_rx_lo, NULL);
 	else
-		return (ssize_t) snprintf(buf, len, "%"PRIi16"",
-					  ad9361_phy->pdata->use_ext_tx_lo);
+		return iio_fmt_uint(buf, len, ad9361_phy->pdata->use_ext_tx_lo, NULL);
 }
 
 /**
@@ -936,8 +995,8 @@ static ssize_t get_fastlock_recall(void *device, char *buf, size_t len,
 {
 	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
 
-	return snprintf(buf, len, "%"PRIi16"",
-			ad9361_phy->fastlock.current_profile[channel->ch_num]);
+	return iio_fmt_uint(buf, len,
+			    ad9361_phy->fastlock.current_profile[channel->ch_num], NULL);
 }
 
 /**
@@ -957,7 +1016,7 @@ static ssize_t get_temp0_input(void *device, char *buf, size_t len,
 	if (ret < 0)
 		return ret;
 
-	return (ssize_t) snprintf(buf, len, "%"PRIi32"", temp);
+	return iio_fmt_int(buf, len, temp, NULL);
 }
 
 /**
@@ -982,7 +1041,7 @@ static ssize_t get_voltage_filter_fir_en(void *device, char *buf, size_t len,
 	if (ret < 0)
 		return ret;
 
-	return (ssize_t) snprintf(buf, len, "%"PRIi16"", en_dis_rx && en_dis_tx);
+	return iio_fmt_uint(buf, len, en_dis_rx && en_dis_tx, NULL);
 }
 
 /**
@@ -1015,16 +1074,19 @@ static ssize_t set_hardwaregain(void *device, char *buf, size_t len,
 {
 	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
 	ssize_t ret = 0;
-	float gain = strtof(buf, NULL);
-	int32_t val1 = (int32_t)gain;
-	int32_t val2 = (int32_t)(gain * 1000) % 1000;
+	int64_t gain;
+
+	/* Gain in mdB */
+	ret = iio_parse_fixed(buf, IIO_FMT_MILLI, &gain);
+	if (ret < 0 || gain < INT32_MIN || gain > INT32_MAX)
+		return -EINVAL;
 
 	if (channel->ch_out) {
 		int32_t ch;
-		if (val1 > 0 || (val1 == 0 && val2 > 0)) {
+		if (gain > 0) {
 			return -EINVAL;
 		}
-		uint32_t code = ((abs(val1) * 1000) + (abs(val2)));
+		uint32_t code = -gain;
 		ch = ad9361_1rx1tx_channel_map(ad9361_phy, true, channel->ch_num);
 		ret = ad9361_set_tx_atten(ad9361_phy, code, ch == 0, ch == 1,
 					  !ad9361_phy->pdata->update_tx_gain_via_alert);
@@ -1033,7 +1095,7 @@ static ssize_t set_hardwaregain(void *device, char *buf, size_t len,
 		}
 	} else {
 		struct rf_rx_gain rx_gain = {0};
-		rx_gain.gain_db = val1;
+		rx_gain.gain_db = gain / 1000;
 		ret = ad9361_set_rx_gain(ad9361_phy,
 					 ad9361_1rx1tx_channel_map(ad9361_phy, false, channel->ch_num + 1), &rx_gain);
 		if (ret < 0) {
@@ -1168,7 +1230,12 @@ static ssize_t set_rf_bandwidth(void *device, char *buf, size_t len,
 {
 	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
 	ssize_t ret = -ENOENT;
-	uint32_t rf_bandwidth = srt_to_uint32(buf);
+	uint32_t rf_bandwidth;
+	int32_t err;
+
+	err = parse_uint32(buf, &rf_bandwidth);
+	if (err < 0)
+		return err;
 
 	rf_bandwidth = ad9361_validate_rf_bw(ad9361_phy, rf_bandwidth);
 	if (channel->ch_out) {
@@ -1198,11 +1265,12 @@ static ssize_t set_rf_dc_offset_tracking_en(void *device, char *buf, size_t len,
 		const struct iio_ch_info *channel)
 {
 	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
-	int8_t en_dis = str_to_int32(buf);
+	uint8_t en_dis;
 	int32_t ret;
 
-	if (en_dis < 0)
-		return en_dis;
+	ret = parse_en_dis(buf, &en_dis);
+	if (ret < 0)
+		return ret;
 
 	ad9361_phy->rfdc_track_en = en_dis ? 1 : 0;
 	if (!channel->ch_out) {
@@ -1245,11 +1313,12 @@ static ssize_t set_quadrature_tracking_en(void *device, char *buf, size_t len,
 		const struct iio_ch_info *channel)
 {
 	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
-	int8_t en_dis = str_to_int32(buf);
+	uint8_t en_dis;
 	int32_t ret;
 
-	if (en_dis < 0)
-		return en_dis;
+	ret = parse_en_dis(buf, &en_dis);
+	if (ret < 0)
+		return ret;
 
 	ad9361_phy->quad_track_en = en_dis ? 1 : 0;
 	if (!channel->ch_out) {
@@ -1274,9 +1343,13 @@ static ssize_t set_sampling_frequency(void *device, char *buf, size_t len,
 				      const struct iio_ch_info *channel)
 {
 	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
-	uint32_t sampling_freq_hz = srt_to_uint32(buf);
-	ssize_t ret = ad9361_set_rx_sampling_freq (ad9361_phy, sampling_freq_hz);
+	uint32_t sampling_freq_hz;
+	ssize_t ret;
 
+	ret = parse_uint32(buf, &sampling_freq_hz);
+	if (ret < 0)
+		return ret;
+	ret = ad9361_set_rx_sampling_freq (ad9361_phy, sampling_freq_hz);
 	if (ret < 0)
 		return ret;
 
@@ -1333,11 +1406,12 @@ static ssize_t set_filter_fir_en(void *device, char *buf, size_t len,
 				 const struct iio_ch_info *channel)
 {
 	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
-	int8_t en_dis = str_to_int32(buf);
+	uint8_t en_dis;
 	ssize_t ret;
 
-	if (en_dis < 0)
-		return en_dis;
+	ret = parse_en_dis(buf, &en_dis);
+	if (ret < 0)
+		return ret;
 	en_dis = en_dis ? 1 : 0;
 	if (channel->ch_out)
 		ret = ad9361_set_tx_fir_en_dis (ad9361_phy, en_dis);
@@ -1379,11 +1453,12 @@ static ssize_t set_bb_dc_offset_tracking_en(void *device, char *buf, size_t len,
 		const struct iio_ch_info *channel)
 {
 	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
-	int8_t en_dis = str_to_int32(buf);
+	uint8_t en_dis;
 	int32_t ret;
 
-	if (en_dis < 0)
-		return en_dis;
+	ret = parse_en_dis(buf, &en_dis);
+	if (ret < 0)
+		return ret;
 
 	ad9361_phy->bbdc_track_en = en_dis ? 1 : 0;
 	if (!channel->ch_out) {
@@ -1425,7 +1500,12 @@ static ssize_t set_fastlock_save(void *device, char *buf, size_t len,
 				 const struct iio_ch_info *channel)
 {
 	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
-	uint32_t readin = srt_to_uint32(buf);
+	uint32_t readin;
+	int32_t err;
+
+	err = parse_uint32(buf, &readin);
+	if (err < 0)
+		return err;
 
 	ad9361_phy->fastlock.save_profile = readin;
 
@@ -1445,7 +1525,12 @@ static ssize_t set_powerdown(void *device, char *buf, size_t len,
 {
 	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
 	ssize_t ret = -ENOENT;
-	bool res = str_to_int32(buf) ? 1 : 0;
+	uint8_t res;
+	int32_t err;
+
+	err = parse_en_dis(buf, &res);
+	if (err < 0)
+		return err;
 
 	if (channel->ch_num == 0)
 		ret = ad9361_synth_lo_powerdown(ad9361_phy, res ? LO_OFF : LO_ON, LO_DONTCARE);
@@ -1472,21 +1557,22 @@ static ssize_t set_fastlock_load(void *device, char *buf, size_t len,
 	ssize_t ret = 0;
 	char *line, *ptr = buf;
 	uint8_t faslock_vals[16];
-	uint32_t profile = 0, val, val2, i = 0;
+	uint64_t val, val2;
+	uint32_t profile = 0, i = 0;
 
+	/* "profile val0,val1,...,val15" */
 	while ((line = strsep(&ptr, ","))) {
-		if (line >= buf + len)
+		if (line >= buf + len || i == 16)
 			break;
 
-		ret = sscanf(line, "%"PRIu32" %"PRIu32"", &val, &val2);
-		if (ret == 1) {
-			faslock_vals[i++] = val;
+		ret = iio_parse_uint(line, &val);
+		if (ret < 0)
 			continue;
-		} else if (ret == 2) {
+		if (iio_parse_uint(line + ret, &val2) >= 0) {
 			profile = val;
-			faslock_vals[i++] = val2;
-			continue;
+			val = val2;
 		}
+		faslock_vals[i++] = val;
 	}
 	if (i == 16)
 		ret = ad9361_fastlock_load(ad9361_phy, channel->ch_num == 1,
@@ -1511,9 +1597,13 @@ static ssize_t set_fastlock_store(void *device, char *buf, size_t len,
 				  const struct iio_ch_info *channel)
 {
 	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
-	uint32_t profile = srt_to_uint32(buf);
+	uint32_t profile;
 	int32_t ret;
 
+	ret = parse_uint32(buf, &profile);
+	if (ret < 0)
+		return ret;
+
 	ret = ad9361_fastlock_store(ad9361_phy, channel->ch_num == 1, profile);
 	if (ret < 0)
 		return ret;
@@ -1533,9 +1623,12 @@ static ssize_t set_frequency(void *device, char *buf, size_t len,
 			     const struct iio_ch_info *channel)
 {
 	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
-	uint64_t lo_freq_hz = srt_to_uint32(buf);
+	uint64_t lo_freq_hz;
 	ssize_t ret = 0;
 
+	if (iio_parse_uint(buf, &lo_freq_hz) < 0)
+		return -EINVAL;
+
 	switch (channel->ch_num) {
 	case 0:
 		ret = clk_set_rate(ad9361_phy, ad9361_phy->ref_clk_scale[RX_RFPLL],
@@ -1566,9 +1659,13 @@ static ssize_t set_external(void *device, char *buf, size_t len,
 			    const struct iio_ch_info *channel)
 {
 	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
-	bool select = str_to_int32(buf) ? 1 : 0;
+	uint8_t select;
 	ssize_t ret = 0;
 
+	ret = parse_en_dis(buf, &select);
+	if (ret < 0)
+		return ret;
+
 	if (channel->ch_num == 0)
 		ret = ad9361_set_rx_lo_int_ext(ad9361_phy, select);
 	else
@@ -1592,7 +1689,11 @@ static ssize_t set_fastlock_recall(void *device, char *buf, size_t len,
 {
 	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
 	ssize_t ret = 0;
-	uint32_t profile = srt_to_uint32(buf);
+	uint32_t profile;
+
+	ret = parse_uint32(buf, &profile);
+	if (ret < 0)
+		return ret;
 
 	ret = ad9361_fastlock_recall(ad9361_phy, channel->ch_num == 1, profile);
 	if (ret < 0)
@@ -1613,9 +1714,13 @@ static ssize_t set_voltage_filter_fir_en(void *device, char *buf, size_t len,
 		const struct iio_ch_info *channel)
 {
 	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
-	int8_t en_dis = str_to_int32(buf) ? 1 : 0;
+	uint8_t en_dis;
 	ssize_t ret;
 
+	ret = parse_en_dis(buf, &en_dis);
+	if (ret < 0)
+		return ret;
+
 	ret = ad9361_set_tx_fir_en_dis (ad9361_phy, en_dis);
 	if (ret < 0)
 		return ret;
@@ -1642,7 +1747,7 @@ static ssize_t get_dcxo_tune_coarse(void *device, char *buf, size_t len,
 	if (ad9361_phy->pdata->use_extclk)
 		return -ENOENT;
 	else
-		return snprintf(buf, len, "%"PRIi32"", ad9361_phy->pdata->dcxo_coarse);
+		return iio_fmt_uint(buf, len, ad9361_phy->pdata->dcxo_coarse, NULL);
 }
 
 /**
@@ -1663,9 +1768,7 @@ static ssize_t get_rx_path_rates(void *device, char *buf, size_t len,
 	if (ret < 0)
 		return ret;
 
-	return snprintf(buf, len,
-			"BBPLL:%"PRIu32" ADC:%"PRIu32" R2:%"PRIu32" R1:%"PRIu32" RF:%"PRIu32" RXSAMP:%"PRIu32"",
-			clk[0], clk[1], clk[2], clk[3], clk[4], clk[5]);
+	return fmt_path_rates(buf, len, rx_path_clks, clk);
 }
 
 /**
@@ -1686,7 +1789,7 @@ static ssize_t get_trx_rate_governor(void *device, char *buf, size_t len,
 	if (ret < 0)
 		return ret;
 
-	return snprintf(buf, len, "%s", rate_governor ? "nominal" : "highest_osr");
+	return iio_fmt_str(buf, len, rate_governor ? "nominal" : "highest_osr");
 }
 
 /**
@@ -1700,9 +1803,8 @@ static ssize_t get_trx_rate_governor(void *device, char *buf, size_t len,
 static ssize_t get_calib_mode_available(void *device, char *buf, size_t len,
 					const struct iio_ch_info *channel)
 {
-	return (ssize_t) snprintf(buf, len, "%s %s %s %s %s", ad9361_calib_mode[0],
-				  ad9361_calib_mode[1], ad9361_calib_mode[2],
-				  ad9361_calib_mode[3], ad9361_calib_mode[4]);
+	return iio_fmt_list(buf, len, ad9361_calib_mode,
+			    ARRAY_SIZE(ad9361_calib_mode));
 }
 
 /**
@@ -1716,7 +1818,7 @@ static ssize_t get_calib_mode_available(void *device, char *buf, size_t len,
 static ssize_t get_xo_correction_available(void *device, char *buf, size_t len,
 		const struct iio_ch_info *channel)
 {
-	return (ssize_t) snprintf(buf, len, "%"PRIi16"", 0); /* dummy */
+	return iio_fmt_uint(buf, len, 0, NULL); /* dummy */
 }
 
 /**
@@ -1730,7 +1832,7 @@ static ssize_t get_xo_correction_available(void *device, char *buf, size_t len,
 static ssize_t get_gain_table_config(void *device, char *buf, size_t len,
 				     const struct iio_ch_info *channel)
 {
-	return (ssize_t) snprintf(buf, len, "%"PRIi16"", 0); /* dummy */
+	return iio_fmt_uint(buf, len, 0, NULL); /* dummy */
 }
 
 /**
@@ -1749,7 +1851,7 @@ static ssize_t get_dcxo_tune_fine(void *device, char *buf, size_t len,
 	if (ad9361_phy->pdata->use_extclk)
 		return -ENOENT;
 	else
-		return snprintf(buf, len, "%"PRIu32"", ad9361_phy->pdata->dcxo_fine);
+		return iio_fmt_uint(buf, len, ad9361_phy->pdata->dcxo_fine, NULL);
 }
 
 /**
@@ -1765,8 +1867,8 @@ static ssize_t get_dcxo_tune_fine_available(void *device, char *buf, size_t len,
 {
 	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
 
-	return snprintf(buf, len, "%s",
-			ad9361_phy->pdata->use_extclk ? "[0 0 0]" : "[0 1 8191]");
+	return iio_fmt_str(buf, len,
+			   ad9361_phy->pdata->use_extclk ? "[0 0 0]" : "[0 1 8191]");
 }
 
 /**
@@ -1782,9 +1884,9 @@ static ssize_t get_ensm_mode_available(void *device, char *buf, size_t len,
 {
 	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
 
-	return (ssize_t) snprintf(buf, len, "%s", ad9361_phy->pdata->fdd ?
-				  "sleep wait alert fdd pinctrl pinctrl_fdd_indep" :
-				  "sleep wait alert rx tx pinctrl");
+	return iio_fmt_str(buf, len, ad9361_phy->pdata->fdd ?
+			   "sleep wait alert fdd pinctrl pinctrl_fdd_indep" :
+			   "sleep wait alert rx tx pinctrl");
 }
 
 /**
@@ -1798,7 +1900,7 @@ static ssize_t get_ensm_mode_available(void *device, char *buf, size_t len,
 static ssize_t get_multichip_sync(void *device, char *buf, size_t len,
 				  const struct iio_ch_info *channel)
 {
-	return (ssize_t) snprintf(buf, len, "%"PRIi16"", 0);  /* dummy */
+	return iio_fmt_uint(buf, len, 0, NULL);  /* dummy */
 }
 
 /**
@@ -1812,7 +1914,7 @@ static ssize_t get_multichip_sync(void *device, char *buf, size_t len,
 static ssize_t get_rssi_gain_step_error(void *device, char *buf, size_t len,
 					const struct iio_ch_info *channel)
 {
-	return (ssize_t) snprintf(buf, len, "%"PRIi16"", 0);  /* dummy */
+	return iio_fmt_uint(buf, len, 0, NULL);  /* dummy */
 }
 
 /**
@@ -1829,8 +1931,8 @@ static ssize_t get_dcxo_tune_coarse_available(void *device, char *buf,
 {
 	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
 
-	return (ssize_t) snprintf(buf, len, "%s",
-				  ad9361_phy->pdata->use_extclk ? "[0 0 0]" : "[0 1 63]");
+	return iio_fmt_str(buf, len,
+			   ad9361_phy->pdata->use_extclk ? "[0 0 0]" : "[0 1 63]");
 }
 
 /**
@@ -1851,9 +1953,7 @@ static ssize_t get_tx_path_rates(void *device, char *buf, size_t len,
 	if (ret < 0)
 		return ret;
 
-	return snprintf(buf, len,
-			"BBPLL:%"PRIu32" DAC:%"PRIu32" T2:%"PRIu32" T1:%"PRIu32" TF:%"PRIu32" TXSAMP:%"PRIu32"",
-			clk[0], clk[1], clk[2], clk[3], clk[4], clk[5]);
+	return fmt_path_rates(buf, len, tx_path_clks, clk);
 }
 
 /**
@@ -1868,7 +1968,7 @@ static ssize_t get_trx_rate_governor_available(void *device, char *buf,
 		size_t len,
 		const struct iio_ch_info *channel)
 {
-	return snprintf(buf, len, "%s", "nominal highest_osr");
+	return iio_fmt_str(buf, len, "nominal highest_osr");
 }
 
 /**
@@ -1882,7 +1982,7 @@ static ssize_t get_trx_rate_governor_available(void *device, char *buf,
 static ssize_t get_xo_correction(void *device, char *buf, size_t len,
 				 const struct iio_ch_info *channel)
 {
-	return (ssize_t) snprintf(buf, len, "%"PRIi16"", 0); /* dummy */
+	return iio_fmt_uint(buf, len, 0, NULL); /* dummy */
 }
 
 /**
@@ -1905,7 +2005,7 @@ static ssize_t get_ensm_mode(void *device, char *buf, size_t len,
 	    ad9361_ensm_states[ret] == NULL)
 		return -EIO;
 
-	return snprintf(buf, len, "%s", ad9361_ensm_states[ret]);
+	return iio_fmt_str(buf, len, ad9361_ensm_states[ret]);
 }
 
 /**
@@ -1944,7 +2044,7 @@ static ssize_t get_calib_mode(void *device, char *buf, size_t len,
 	if (ret < 0)
 		return ret;
 
-	return (ssize_t) snprintf(buf, len, "%s", en_dis ? "auto" : "manual");
+	return iio_fmt_str(buf, len, en_dis ? "auto" : "manual");
 }
 
 /**
@@ -1983,9 +2083,13 @@ static ssize_t set_dcxo_tune_coarse(void *device, char *buf, size_t len,
 				    const struct iio_ch_info *channel)
 {
 	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
-	uint32_t dcxo_coarse = srt_to_uint32(buf);
+	uint32_t dcxo_coarse;
 	int32_t ret;
 
+	ret = parse_uint32(buf, &dcxo_coarse);
+	if (ret < 0)
+		return ret;
+
 	dcxo_coarse = clamp_t(uint32_t, dcxo_coarse, 0, 63U);
 	ad9361_phy->pdata->dcxo_coarse = dcxo_coarse;
 
@@ -2009,9 +2113,13 @@ static ssize_t set_dcxo_tune_fine(void *device, char *buf, size_t len,
 				  const struct iio_ch_info *channel)
 {
 	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
-	uint32_t dcxo_fine = srt_to_uint32(buf);
+	uint32_t dcxo_fine;
 	int32_t ret;
 
+	ret = parse_uint32(buf, &dcxo_fine);
+	if (ret < 0)
+		return ret;
+
 	dcxo_fine = clamp_t(uint32_t, dcxo_fine, 0, 8191U);
 	ad9361_phy->pdata->dcxo_fine = dcxo_fine;
 
@@ -2036,6 +2144,7 @@ static ssize_t set_calib_mode(void *device, char *buf, size_t len,
 {
 	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
 	int32_t arg = -1;
+	int64_t quad_arg;
 	ssize_t ret = 0;
 	uint32_t val = 0;
 	val = 0;
@@ -2045,9 +2154,9 @@ static ssize_t set_calib_mode(void *device, char *buf, size_t len,
 	} else if (!strcmp(buf, "manual")) {
 		ad9361_set_tx_auto_cal_en_dis (ad9361_phy, 0);
 	} else if (!strncmp(buf, "tx_quad", 7)) {
-		ret = sscanf(buf, "tx_quad %"PRIi32, &arg);
-		if (ret != 1)
-			arg = -1;
+		if (iio_parse_int(buf + 7, &quad_arg) > 0 &&
+		    quad_arg >= INT32_MIN && quad_arg <= INT32_MAX)
+			arg = quad_arg;
 		val = TX_QUAD_CAL;
 	} else if (!strcmp(buf, "rf_dc_offs")) {
 		val = RFDC_CAL;
@@ -2129,9 +2238,13 @@ static ssize_t set_multichip_sync(void *device, char *buf, size_t len,
 				  const struct iio_ch_info *channel)
 {
 	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
-	uint32_t readin = srt_to_uint32(buf);
+	uint32_t readin;
 	int32_t ret;
 
+	ret = parse_uint32(buf, &readin);
+	if (ret < 0)
+		return ret;
+
 	ret = ad9361_mcs(ad9361_phy, readin);
 	if (ret < 0)
 		return ret;
@@ -2596,6 +2709,40 @@ static ssize_t iio_ad9361_get_xml(char **xml, struct iio_device *iio_dev)
 	return SUCCESS;
 }
 
+/**
+ * @brief Read a device register.
+ * @param device - Physical instance of a ad9361 device.
+ * @param reg - Register address.
+ * @param val - Register value.
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+static int32_t iio_ad9361_read_reg(void *device, uint32_t reg, uint32_t *val)
+{
+	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
+	int32_t ret;
+
+	ret = ad9361_spi_read(ad9361_phy->spi, reg);
+	if (ret < 0)
+		return ret;
+	*val = ret;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Write a device register.
+ * @param device - Physical instance of a ad9361 device.
+ * @param reg - Register address.
+ * @param val - Register value.
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+static int32_t iio_ad9361_write_reg(void *device, uint32_t reg, uint32_t val)
+{
+	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
+
+	return ad9361_spi_write(ad9361_phy->spi, reg, val);
+}
+
 /**
  * @brief Create structure describing a device, channels and attributes.
  * @param device_name - Device name.
@@ -2656,6 +2803,8 @@ int32_t iio_ad9361_init(struct iio_ad9361_desc **desc,
 		.transfer_mem_to_dev = NULL,
 		.read_data = NULL,
 		.write_data = NULL,
+		.read_reg = iio_ad9361_read_reg,
+		.write_reg = iio_ad9361_write_reg,
 	};
 
 	status = iio_register(iio_interface);
@@ -0,0 +1,573 @@
+/***************************************************************************//**
+ *   @file   iio_ad9361_sweep.c
+ *   @brief  Implementation of iio_ad9361_sweep.
+ *   This exposes the AD9361 sweep engine as an iio device: the device
+ *   attributes configure the sweep and a buffer read runs a full sweep and
+ *   returns the stitched power trace, in milli-dBFS.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "error.h"
+#include "iio_ad9361_sweep.h"
+#include "util.h"
+#include "xml.h"
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * Device name.
+ */
+static const char dev_name[] = "ad9361-sweep";
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief get_start_frequency().
+ * @param device - Physical instance of a sweep device.
+ * @param buf - Where value is stored.
+ * @param len - Maximum length of value to be stored in buf.
+ * @param channel - Channel properties.
+ * @return Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_start_frequency(void *device, char *buf, size_t len,
+				   const struct iio_ch_info *channel)
+{
+	struct ad9361_sweep_desc *sweep = (struct ad9361_sweep_desc *)device;
+
+	return snprintf(buf, len, "%"PRIu64"", sweep->start_freq_hz);
+}
+
+/**
+ * @brief set_start_frequency().
+ * @param device - Physical instance of a sweep device.
+ * @param buf - Value to be written to attribute.
+ * @param len - Length of the data in "buf".
+ * @param channel - Channel properties.
+ * @return Number of bytes written to device, or negative value on failure.
+ */
+static ssize_t set_start_frequency(void *device, char *buf, size_t len,
+				   const struct iio_ch_info *channel)
+{
+	struct ad9361_sweep_desc *sweep = (struct ad9361_sweep_desc *)device;
+	uint64_t start_freq_hz = strtoull(buf, NULL, 10);
+	int32_t ret;
+
+	ret = ad9361_sweep_set_span(sweep, start_freq_hz, sweep->span_hz);
+	if (ret < 0)
+		return ret;
+
+	return len;
+}
+
+/**
+ * @brief get_span().
+ * @param device - Physical instance of a sweep device.
+ * @param buf - Where value is stored.
+ * @param len - Maximum length of value to be stored in buf.
+ * @param channel - Channel properties.
+ * @return Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_span(void *device, char *buf, size_t len,
+			const struct iio_ch_info *channel)
+{
+	struct ad9361_sweep_desc *sweep = (struct ad9361_sweep_desc *)device;
+
+	return snprintf(buf, len, "%"PRIu64"", sweep->span_hz);
+}
+
+/**
+ * @brief set_span().
+ * @param device - Physical instance of a sweep device.
+ * @param buf - Value to be written to attribute.
+ * @param len - Length of the data in "buf".
+ * @param channel - Channel properties.
+ * @return Number of bytes written to device, or negative value on failure.
+ */
+static ssize_t set_span(void *device, char *buf, size_t len,
+			const struct iio_ch_info *channel)
+{
+	struct ad9361_sweep_desc *sweep = (struct ad9361_sweep_desc *)device;
+	uint64_t span_hz = strtoull(buf, NULL, 10);
+	int32_t ret;
+
+	ret = ad9361_sweep_set_span(sweep, sweep->start_freq_hz, span_hz);
+	if (ret < 0)
+		return ret;
+
+	return len;
+}
+
+/**
+ * @brief get_rbw().
+ * @param device - Physical instance of a sweep device.
+ * @param buf - Where value is stored.
+ * @param len - Maximum length of value to be stored in buf.
+ * @param channel - Channel properties.
+ * @return Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_rbw(void *device, char *buf, size_t len,
+		       const struct iio_ch_info *channel)
+{
+	struct ad9361_sweep_desc *sweep = (struct ad9361_sweep_desc *)device;
+
+	return snprintf(buf, len, "%"PRIu32"", sweep->rbw_hz);
+}
+
+/**
+ * @brief set_rbw().
+ * @param device - Physical instance of a sweep device.
+ * @param buf - Value to be written to attribute.
+ * @param len - Length of the data in "buf".
+ * @param channel - Channel properties.
+ * @return Number of bytes written to device, or negative value on failure.
+ */
+static ssize_t set_rbw(void *device, char *buf, size_t len,
+		       const struct iio_ch_info *channel)
+{
+	struct ad9361_sweep_desc *sweep = (struct ad9361_sweep_desc *)device;
+	int32_t ret;
+
+	ret = ad9361_sweep_set_rbw(sweep, srt_to_uint32(buf));
+	if (ret < 0)
+		return ret;
+
+	return len;
+}
+
+/**
+ * @brief get_dwell().
+ * @param device - Physical instance of a sweep device.
+ * @param buf - Where value is stored.
+ * @param len - Maximum length of value to be stored in buf.
+ * @param channel - Channel properties.
+ * @return Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_dwell(void *device, char *buf, size_t len,
+			 const struct iio_ch_info *channel)
+{
+	struct ad9361_sweep_desc *sweep = (struct ad9361_sweep_desc *)device;
+
+	return snprintf(buf, len, "%"PRIu32"", sweep->dwell_us);
+}
+
+/**
+ * @brief set_dwell().
+ * @param device - Physical instance of a sweep device.
+ * @param buf - Value to be written to attribute.
+ * @param len - Length of the data in "buf".
+ * @param channel - Channel properties.
+ * @return Number of bytes written to device, or negative value on failure.
+ */
+static ssize_t set_dwell(void *device, char *buf, size_t len,
+			 const struct iio_ch_info *channel)
+{
+	struct ad9361_sweep_desc *sweep = (struct ad9361_sweep_desc *)device;
+	int32_t ret;
+
+	ret = ad9361_sweep_set_dwell(sweep, srt_to_uint32(buf));
+	if (ret < 0)
+		return ret;
+
+	return len;
+}
+
+/**
+ * @brief get_num_points().
+ * @param device - Physical instance of a sweep device.
+ * @param buf - Where value is stored.
+ * @param len - Maximum length of value to be stored in buf.
+ * @param channel - Channel properties.
+ * @return Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_num_points(void *device, char *buf, size_t len,
+			      const struct iio_ch_info *channel)
+{
+	struct ad9361_sweep_desc *sweep = (struct ad9361_sweep_desc *)device;
+	int32_t ret;
+
+	ret = ad9361_sweep_plan(sweep);
+	if (ret < 0)
+		return ret;
+
+	return snprintf(buf, len, "%"PRIu32"", sweep->num_points);
+}
+
+/**
+ * @brief get_bin_width().
+ * @param device - Physical instance of a sweep device.
+ * @param buf - Where value is stored.
+ * @param len - Maximum length of value to be stored in buf.
+ * @param channel - Channel properties.
+ * @return Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_bin_width(void *device, char *buf, size_t len,
+			     const struct iio_ch_info *channel)
+{
+	struct ad9361_sweep_desc *sweep = (struct ad9361_sweep_desc *)device;
+	uint32_t rem;
+	uint32_t val;
+	int32_t ret;
+
+	ret = ad9361_sweep_plan(sweep);
+	if (ret < 0)
+		return ret;
+
+	val = div_u64_rem(sweep->sampling_freq_hz, sweep->fft_size, &rem);
+	rem = div_u64((uint64_t)rem * 1000000, sweep->fft_size);
+
+	return snprintf(buf, len, "%"PRIu32".%06"PRIu32"", val, rem);
+}
+
+static struct iio_attribute iio_attr_start_frequency = {
+	.name = "start_frequency",
+	.show = get_start_frequency,
+	.store = set_start_frequency,
+};
+
+static struct iio_attribute iio_attr_span = {
+	.name = "span",
+	.show = get_span,
+	.store = set_span,
+};
+
+static struct iio_attribute iio_attr_rbw = {
+	.name = "rbw",
+	.show = get_rbw,
+	.store = set_rbw,
+};
+
+static struct iio_attribute iio_attr_dwell = {
+	.name = "dwell",
+	.show = get_dwell,
+	.store = set_dwell,
+};
+
+static struct iio_attribute iio_attr_num_points = {
+	.name = "num_points",
+	.show = get_num_points,
+	.store = NULL,
+};
+
+static struct iio_attribute iio_attr_bin_width = {
+	.name = "bin_width",
+	.show = get_bin_width,
+	.store = NULL,
+};
+
+static struct iio_attribute *global_attributes[] = {
+	&iio_attr_start_frequency,
+	&iio_attr_span,
+	&iio_attr_rbw,
+	&iio_attr_dwell,
+	&iio_attr_num_points,
+	&iio_attr_bin_width,
+	NULL,
+};
+
+static struct iio_attribute *voltage_attributes[] = {
+	NULL,
+};
+
+static struct iio_channel iio_channel_voltage0_in = {
+	.name = "voltage0",
+	.attributes = voltage_attributes,
+	.ch_out = false,
+};
+
+static struct iio_channel *iio_ad9361_sweep_channels[] = {
+	&iio_channel_voltage0_in,
+	NULL,
+};
+
+/**
+ * @brief Get xml corresponding to an "ad9361-sweep" device.
+ * @param xml - Xml containing description of a device.
+ * @param iio_dev - Structure describing a device, channels and attributes.
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+static ssize_t iio_ad9361_sweep_get_xml(char **xml, struct iio_device *iio_dev)
+{
+	struct xml_document *document = NULL;
+	struct xml_node *attribute = NULL;
+	struct xml_attribute *att = NULL;
+	struct xml_node *channel = NULL;
+	struct xml_node *device = NULL;
+	ssize_t ret;
+	uint16_t i;
+
+	if (!xml || !iio_dev)
+		return FAILURE;
+
+	ret = xml_create_node(&device, "device");
+	if (ret < 0)
+		goto error;
+	ret = xml_create_attribute(&att, "id", iio_dev->name);
+	if (ret < 0)
+		goto error;
+	ret = xml_add_attribute(device, att);
+	if (ret < 0)
+		goto error;
+	ret = xml_create_attribute(&att, "name", iio_dev->name);
+	if (ret < 0)
+		goto error;
+	ret = xml_add_attribute(device, att);
+	if (ret < 0)
+		goto error;
+
+	ret = xml_create_node(&channel, "channel");
+	if (ret < 0)
+		goto error;
+	ret = xml_create_attribute(&att, "id", iio_channel_voltage0_in.name);
+	if (ret < 0)
+		goto error;
+	ret = xml_add_attribute(channel, att);
+	if (ret < 0)
+		goto error;
+	ret = xml_create_attribute(&att, "type", "input");
+	if (ret < 0)
+		goto error;
+	ret = xml_add_attribute(channel, att);
+	if (ret < 0)
+		goto error;
+	ret = xml_create_node(&attribute, "scan-element");
+	if (ret < 0)
+		goto error;
+	ret = xml_create_attribute(&att, "index", "0");
+	if (ret < 0)
+		goto error;
+	ret = xml_add_attribute(attribute, att);
+	if (ret < 0)
+		goto error;
+	ret = xml_create_attribute(&att, "format", "le:S32/32>>0");
+	if (ret < 0)
+		goto error;
+	ret = xml_add_attribute(attribute, att);
+	if (ret < 0)
+		goto error;
+	ret = xml_add_node(channel, attribute);
+	if (ret < 0)
+		goto error;
+	ret = xml_add_node(device, channel);
+	if (ret < 0)
+		goto error;
+
+	for (i = 0; iio_dev->attributes[i] != NULL; i++) {
+		ret = xml_create_node(&attribute, "attribute");
+		if (ret < 0)
+			goto error;
+		ret = xml_create_attribute(&att, "name",
+					   iio_dev->attributes[i]->name);
+		if (ret < 0)
+			goto error;
+		ret = xml_add_attribute(attribute, att);
+		if (ret < 0)
+			goto error;
+		ret = xml_add_node(device, attribute);
+		if (ret < 0)
+			goto error;
+	}
+
+	ret = xml_create_document(&document, device);
+	if (ret < 0) {
+		if (document)
+			xml_delete_document(document);
+		goto error;
+	}
+	*xml = document->buff;
+	free(document);
+
+error:
+	if (device)
+		xml_delete_node(device);
+
+	return ret;
+}
+
+/**
+ * @brief Run a full sweep, the trace is then read with
+ * "iio_ad9361_sweep_read_dev".
+ * @param iio_inst - Physical instance of a sweep device.
+ * @param bytes_count - Number of bytes to transfer.
+ * @param ch_mask - Opened channels mask.
+ * @return bytes_count or negative value in case of error.
+ */
+static ssize_t iio_ad9361_sweep_transfer_dev_to_mem(void *iio_inst,
+		size_t bytes_count,
+		uint32_t ch_mask)
+{
+	ssize_t ret;
+
+	if (!iio_inst)
+		return FAILURE;
+
+	ret = ad9361_sweep_run((struct ad9361_sweep_desc *)iio_inst);
+	if (ret < 0)
+		return ret;
+
+	return bytes_count;
+}
+
+/**
+ * @brief Read chunk of the last trace to pbuf. Bytes past the end of the
+ * trace are zero filled.
+ * @param iio_inst - Physical instance of a sweep device.
+ * @param pbuf - Buffer where value is stored.
+ * @param offset - Offset to the remaining data after reading n chunks.
+ * @param bytes_count - Number of bytes to read.
+ * @param ch_mask - Opened channels mask.
+ * @return bytes_count or negative value in case of error.
+ */
+static ssize_t iio_ad9361_sweep_read_dev(void *iio_inst, char *pbuf,
+		size_t offset, size_t bytes_count,
+		uint32_t ch_mask)
+{
+	struct ad9361_sweep_desc *sweep;
+	size_t trace_bytes, count = 0;
+
+	if (!iio_inst || !pbuf)
+		return FAILURE;
+
+	sweep = (struct ad9361_sweep_desc *)iio_inst;
+	if (!sweep->plan_valid)
+		return FAILURE;
+
+	trace_bytes = sweep->num_points * sizeof(*sweep->trace);
+	if (offset < trace_bytes) {
+		count = min(bytes_count, trace_bytes - offset);
+		memcpy(pbuf, (char *)sweep->trace + offset, count);
+	}
+	memset(pbuf + count, 0, bytes_count - count);
+
+	return bytes_count;
+}
+
+/**
+ * @brief Init for reading the sweep engine trace and parameterization of
+ * the sweep.
+ * @param desc - Descriptor.
+ * @param init - Configuration structure.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t iio_ad9361_sweep_init(struct iio_ad9361_sweep_desc **desc,
+			      struct iio_ad9361_sweep_init_param *init)
+{
+	struct iio_interface *iio_interface;
+	struct iio_device *iio_device;
+	int32_t status;
+
+	if (!init || !init->sweep)
+		return FAILURE;
+
+	iio_device = calloc(1, sizeof(struct iio_device));
+	if (!iio_device)
+		return -ENOMEM;
+
+	iio_device->name = dev_name;
+	iio_device->num_ch = 1;
+	iio_device->channels = iio_ad9361_sweep_channels;
+	iio_device->attributes = global_attributes;
+
+	iio_interface = (struct iio_interface *)calloc(1, sizeof(struct iio_interface));
+	if (!iio_interface)
+		goto error_free_device;
+
+	*iio_interface = (struct iio_interface) {
+		.name = dev_name,
+		.dev_instance = init->sweep,
+		.iio = iio_device,
+		.get_xml = iio_ad9361_sweep_get_xml,
+		.transfer_dev_to_mem = iio_ad9361_sweep_transfer_dev_to_mem,
+		.transfer_mem_to_dev = NULL,
+		.read_data = iio_ad9361_sweep_read_dev,
+		.write_data = NULL,
+	};
+
+	status = iio_register(iio_interface);
+	if (status < 0)
+		goto error_free_iio_interface;
+
+	*desc = calloc(1, sizeof(struct iio_ad9361_sweep_desc));
+	if (!(*desc))
+		goto error_unregister;
+
+	(*desc)->iio_interface = iio_interface;
+
+	return SUCCESS;
+
+error_unregister:
+	iio_unregister(iio_interface);
+error_free_iio_interface:
+	free(iio_interface);
+error_free_device:
+	free(iio_device);
+
+	return FAILURE;
+}
+
+/**
+ * @brief Release resources.
+ * @param desc - Descriptor.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t iio_ad9361_sweep_remove(struct iio_ad9361_sweep_desc *desc)
+{
+	int32_t status;
+
+	if (!desc)
+		return FAILURE;
+
+	status = iio_unregister(desc->iio_interface);
+	if (status < 0)
+		return FAILURE;
+
+	free(desc->iio_interface->iio);
+	free(desc->iio_interface);
+	free(desc);
+
+	return SUCCESS;
+}
@@ -432,7 +432,7 @@ static ssize_t iio_axi_adc_get_xml(char** xml, struct iio_device *iio_dev)
 		ret = xml_add_attribute(attribute, att);
 		if (ret < 0)
 			goto error;
-		ret = xml_create_attribute(&att, "format", "le:S16/16&gt;&gt;0");
+		ret = xml_create_attribute(&att, "format", "le:S16/16>>0");
 		if (ret < 0)
 			goto error;
 		ret = xml_add_attribute(attribute, att);
@@ -476,6 +476,7 @@ static ssize_t iio_axi_adc_get_xml(char** xml, struct iio_device *iio_dev)
 		goto error;
 	}
 	*xml = document->buff;
+	free(document);
 
 error:
 	if (device)
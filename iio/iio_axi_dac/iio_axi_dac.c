@@ -648,7 +648,7 @@ static ssize_t iio_axi_dac_channel_xml(struct xml_node *device, uint8_t ch_no,
 			ret = xml_add_attribute(attribute, att);
 			if (ret < 0)
 				return ret;
-			ret = xml_create_attribute(&att, "format", "le:S16/16&gt;&gt;0");
+			ret = xml_create_attribute(&att, "format", "le:S16/16>>0");
 			if (ret < 0)
 				return ret;
 			ret = xml_add_attribute(attribute, att);
@@ -745,6 +745,7 @@ static ssize_t iio_axi_dac_get_xml(char** xml, struct iio_device *iio_dev)
 		goto error;
 	}
 	*xml = document->buff;
+	free(document);
 
 error:
 	if (device)
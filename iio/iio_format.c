@@ -0,0 +1,483 @@
+/***************************************************************************//**
+ *   @file   iio_format.c
+ *   @brief  Integer and fixed point formatting and parsing of IIO attribute values.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <errno.h>
+#include <string.h>
+#include "iio_format.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* Digits of the largest uint64_t value. */
+#define IIO_FMT_MAX_DIGITS	20
+/* Largest supported number of decimals. */
+#define IIO_FMT_MAX_DECIMALS	18
+
+/******************************************************************************/
+/************************ Variable Declarations *******************************/
+/******************************************************************************/
+
+static const uint64_t iio_fmt_pow10[IIO_FMT_MAX_DECIMALS + 1] = {
+	1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull,
+	10000000ull, 100000000ull, 1000000000ull, 10000000000ull,
+	100000000000ull, 1000000000000ull, 10000000000000ull,
+	100000000000000ull, 1000000000000000ull, 10000000000000000ull,
+	100000000000000000ull, 1000000000000000000ull
+};
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Append bytes to a string being formatted.
+ * @param buf - Output buffer.
+ * @param len - Size of buf.
+ * @param pos - Length of the string, updated.
+ * @param data - Bytes to append.
+ * @param n - Number of bytes.
+ * @return 0 in case of success, -ENOMEM if there is no room for data and
+ *         the terminating NUL.
+ */
+static int32_t iio_fmt_put(char *buf, size_t len, size_t *pos,
+			   const char *data, size_t n)
+{
+	if (*pos + n >= len)
+		return -ENOMEM;
+
+	memcpy(buf + *pos, data, n);
+	*pos += n;
+	buf[*pos] = '\0';
+
+	return 0;
+}
+
+/**
+ * @brief Append the decimal digits of a value.
+ * @param buf - Output buffer.
+ * @param len - Size of buf.
+ * @param pos - Length of the string, updated.
+ * @param val - The value.
+ * @param width - Minimum number of digits, zero padded.
+ * @return 0 in case of success, -ENOMEM if buf is too small.
+ */
+static int32_t iio_fmt_put_digits(char *buf, size_t len, size_t *pos,
+				  uint64_t val, uint8_t width)
+{
+	char digits[IIO_FMT_MAX_DIGITS];
+	char *p = digits + sizeof(digits);
+	uint32_t val32;
+
+	/* 64-bit divisions are slow on 32-bit CPUs, finish in 32 bits */
+	while (val > UINT32_MAX) {
+		*--p = '0' + val % 10;
+		val /= 10;
+	}
+	val32 = val;
+	do {
+		*--p = '0' + val32 % 10;
+		val32 /= 10;
+	} while (val32);
+	while (digits + sizeof(digits) - p < width)
+		*--p = '0';
+
+	return iio_fmt_put(buf, len, pos, p, digits + sizeof(digits) - p);
+}
+
+/**
+ * @brief Append an optional string.
+ * @param buf - Output buffer.
+ * @param len - Size of buf.
+ * @param pos - Length of the string, updated.
+ * @param str - The string, can be NULL.
+ * @return 0 in case of success, -ENOMEM if buf is too small.
+ */
+static int32_t iio_fmt_put_str(char *buf, size_t len, size_t *pos,
+			       const char *str)
+{
+	if (!str)
+		return 0;
+
+	return iio_fmt_put(buf, len, pos, str, strlen(str));
+}
+
+/**
+ * @brief Append a signed fixed point value.
+ * @param buf - Output buffer.
+ * @param len - Size of buf.
+ * @param pos - Length of the string, updated.
+ * @param neg - true if the value is negative.
+ * @param mag - Magnitude of the value, scaled by 10^decimals.
+ * @param decimals - Number of decimals.
+ * @return 0 in case of success, negative value otherwise.
+ */
+static int32_t iio_fmt_put_fixed(char *buf, size_t len, size_t *pos, bool neg,
+				 uint64_t mag, uint8_t decimals)
+{
+	uint64_t scale;
+	int32_t ret;
+
+	if (decimals > IIO_FMT_MAX_DECIMALS)
+		return -EINVAL;
+	scale = iio_fmt_pow10[decimals];
+
+	if (neg) {
+		ret = iio_fmt_put(buf, len, pos, "-", 1);
+		if (ret < 0)
+			return ret;
+	}
+	ret = iio_fmt_put_digits(buf, len, pos, mag / scale, 1);
+	if (ret < 0 || !decimals)
+		return ret;
+	ret = iio_fmt_put(buf, len, pos, ".", 1);
+	if (ret < 0)
+		return ret;
+
+	return iio_fmt_put_digits(buf, len, pos, mag % scale, decimals);
+}
+
+/**
+ * @brief Copy a string.
+ * @param buf - Output buffer.
+ * @param len - Size of buf.
+ * @param str - The string.
+ * @return Length of the string, or negative value on failure.
+ */
+ssize_t iio_fmt_str(char *buf, size_t len, const char *str)
+{
+	size_t pos = 0;
+	int32_t ret;
+
+	ret = iio_fmt_put_str(buf, len, &pos, str);
+
+	return ret < 0 ? ret : (ssize_t)pos;
+}
+
+/**
+ * @brief Format an unsigned integer.
+ * @param buf - Output buffer.
+ * @param len - Size of buf.
+ * @param val - The value.
+ * @param suffix - Appended to the value, can be NULL.
+ * @return Length of the string, or negative value on failure.
+ */
+ssize_t iio_fmt_uint(char *buf, size_t len, uint64_t val, const char *suffix)
+{
+	size_t pos = 0;
+	int32_t ret;
+
+	ret = iio_fmt_put_digits(buf, len, &pos, val, 1);
+	if (!ret)
+		ret = iio_fmt_put_str(buf, len, &pos, suffix);
+
+	return ret < 0 ? ret : (ssize_t)pos;
+}
+
+/**
+ * @brief Format a signed integer.
+ * @param buf - Output buffer.
+ * @param len - Size of buf.
+ * @param val - The value.
+ * @param suffix - Appended to the value, can be NULL.
+ * @return Length of the string, or negative value on failure.
+ */
+ssize_t iio_fmt_int(char *buf, size_t len, int64_t val, const char *suffix)
+{
+	return iio_fmt_fixed(buf, len, val, 0, suffix);
+}
+
+/**
+ * @brief Format a fixed point value: 12345 with 3 decimals is "12.345".
+ * @param buf - Output buffer.
+ * @param len - Size of buf.
+ * @param val - The value, scaled by 10^decimals.
+ * @param decimals - Number of decimals.
+ * @param suffix - Appended to the value, can be NULL.
+ * @return Length of the string, or negative value on failure.
+ */
+ssize_t iio_fmt_fixed(char *buf, size_t len, int64_t val, uint8_t decimals,
+		      const char *suffix)
+{
+	size_t pos = 0;
+	int32_t ret;
+
+	ret = iio_fmt_put_fixed(buf, len, &pos, val < 0,
+				val < 0 ? -(uint64_t)val : (uint64_t)val,
+				decimals);
+	if (!ret)
+		ret = iio_fmt_put_str(buf, len, &pos, suffix);
+
+	return ret < 0 ? ret : (ssize_t)pos;
+}
+
+/**
+ * @brief Format an IIO_VAL_INT_PLUS_MICRO value. As in Linux, val1 carries
+ *        the sign only when val0 is 0.
+ * @param buf - Output buffer.
+ * @param len - Size of buf.
+ * @param val0 - Integer part.
+ * @param val1 - Fractional part, in micro units.
+ * @param suffix - Appended to the value, can be NULL.
+ * @return Length of the string, or negative value on failure.
+ */
+ssize_t iio_fmt_int_plus_micro(char *buf, size_t len, int32_t val0,
+			       int32_t val1, const char *suffix)
+{
+	uint64_t mag;
+	size_t pos = 0;
+	int32_t ret;
+
+	mag = (uint64_t)(val0 < 0 ? -(int64_t)val0 : val0) *
+	      iio_fmt_pow10[IIO_FMT_MICRO] +
+	      (uint32_t)(val1 < 0 ? -(int64_t)val1 : val1);
+	ret = iio_fmt_put_fixed(buf, len, &pos, val0 < 0 || val1 < 0, mag,
+				IIO_FMT_MICRO);
+	if (!ret)
+		ret = iio_fmt_put_str(buf, len, &pos, suffix);
+
+	return ret < 0 ? ret : (ssize_t)pos;
+}
+
+/**
+ * @brief Format a range of values as "[min step max]".
+ * @param buf - Output buffer.
+ * @param len - Size of buf.
+ * @param min - Minimum value.
+ * @param step - Step.
+ * @param max - Maximum value.
+ * @return Length of the string, or negative value on failure.
+ */
+ssize_t iio_fmt_range(char *buf, size_t len, int64_t min, int64_t step,
+		      int64_t max)
+{
+	const int64_t vals[3] = {min, step, max};
+	size_t pos = 0;
+	int32_t ret;
+	uint8_t i;
+
+	ret = iio_fmt_put(buf, len, &pos, "[", 1);
+	for (i = 0; i < 3 && !ret; i++) {
+		ret = iio_fmt_put_fixed(buf, len, &pos, vals[i] < 0,
+					vals[i] < 0 ? -(uint64_t)vals[i] :
+					(uint64_t)vals[i], 0);
+		if (!ret)
+			ret = iio_fmt_put(buf, len, &pos, i < 2 ? " " : "]", 1);
+	}
+
+	return ret < 0 ? ret : (ssize_t)pos;
+}
+
+/**
+ * @brief Format a list of strings separated by spaces.
+ * @param buf - Output buffer.
+ * @param len - Size of buf.
+ * @param list - The strings.
+ * @param num - Number of strings.
+ * @return Length of the string, or negative value on failure.
+ */
+ssize_t iio_fmt_list(char *buf, size_t len, const char * const *list,
+		     uint32_t num)
+{
+	size_t pos = 0;
+	int32_t ret = 0;
+	uint32_t i;
+
+	if (len)
+		buf[0] = '\0';
+	for (i = 0; i < num && !ret; i++) {
+		if (i)
+			ret = iio_fmt_put(buf, len, &pos, " ", 1);
+		if (!ret)
+			ret = iio_fmt_put_str(buf, len, &pos, list[i]);
+	}
+
+	return ret < 0 ? ret : (ssize_t)pos;
+}
+
+/**
+ * @brief Skip the blanks in front of a number.
+ * @param buf - The string.
+ * @return First character that is not a blank.
+ */
+static const char *iio_parse_skip(const char *buf)
+{
+	while (*buf == ' ' || *buf == '\t')
+		buf++;
+
+	return buf;
+}
+
+/**
+ * @brief Parse the decimal digits of a value.
+ * @param p - First digit, updated past the last digit.
+ * @param val - The value.
+ * @return Number of digits, or -EINVAL if the value overflows.
+ */
+static int32_t iio_parse_digits(const char **p, uint64_t *val)
+{
+	const char *s = *p;
+	uint64_t v = 0;
+	uint8_t d;
+
+	while (*s >= '0' && *s <= '9') {
+		d = *s - '0';
+		if (v > (UINT64_MAX - d) / 10)
+			return -EINVAL;
+		v = v * 10 + d;
+		s++;
+	}
+	*val = v;
+	d = s - *p;
+	*p = s;
+
+	return d;
+}
+
+/**
+ * @brief Parse an unsigned integer.
+ * @param buf - The string.
+ * @param val - The value.
+ * @return Number of characters used, or negative value on failure.
+ */
+ssize_t iio_parse_uint(const char *buf, uint64_t *val)
+{
+	const char *p = iio_parse_skip(buf);
+
+	if (*p == '+')
+		p++;
+	if (iio_parse_digits(&p, val) <= 0)
+		return -EINVAL;
+
+	return p - buf;
+}
+
+/**
+ * @brief Parse a signed integer.
+ * @param buf - The string.
+ * @param val - The value.
+ * @return Number of characters used, or negative value on failure.
+ */
+ssize_t iio_parse_int(const char *buf, int64_t *val)
+{
+	return iio_parse_fixed(buf, 0, val);
+}
+
+/**
+ * @brief Parse a fixed point value: "-1.5" with 3 decimals is -1500.
+ * @param buf - The string.
+ * @param decimals - Number of decimals kept.
+ * @param val - The value, scaled by 10^decimals.
+ * @return Number of characters used, or negative value on failure.
+ */
+ssize_t iio_parse_fixed(const char *buf, uint8_t decimals, int64_t *val)
+{
+	const char *p = iio_parse_skip(buf);
+	uint64_t ip = 0;
+	uint64_t fp = 0;
+	uint64_t mag;
+	int32_t n;
+	int32_t nf = 0;
+	bool neg = false;
+
+	if (decimals > IIO_FMT_MAX_DECIMALS)
+		return -EINVAL;
+
+	if (*p == '-' || *p == '+')
+		neg = *p++ == '-';
+	n = iio_parse_digits(&p, &ip);
+	if (n < 0)
+		return n;
+	if (*p == '.') {
+		p++;
+		while (*p >= '0' && *p <= '9') {
+			if (nf < decimals)
+				fp = fp * 10 + (*p - '0');
+			nf++;
+			p++;
+		}
+	}
+	if (!n && !nf)
+		return -EINVAL;
+	if (nf < decimals)
+		fp *= iio_fmt_pow10[decimals - nf];
+
+	if (ip > (UINT64_MAX - fp) / iio_fmt_pow10[decimals])
+		return -EINVAL;
+	mag = ip * iio_fmt_pow10[decimals] + fp;
+	if (mag > (uint64_t)INT64_MAX + neg)
+		return -EINVAL;
+	*val = neg ? (int64_t)(0 - mag) : (int64_t)mag;
+
+	return p - buf;
+}
+
+/**
+ * @brief Parse an IIO_VAL_INT_PLUS_MICRO value. As in Linux, val1 carries
+ *        the sign only when val0 is 0.
+ * @param buf - The string.
+ * @param val0 - Integer part.
+ * @param val1 - Fractional part, in micro units.
+ * @return Number of characters used, or negative value on failure.
+ */
+ssize_t iio_parse_int_plus_micro(const char *buf, int32_t *val0,
+				 int32_t *val1)
+{
+	int64_t val;
+	int64_t ip;
+	ssize_t ret;
+
+	ret = iio_parse_fixed(buf, IIO_FMT_MICRO, &val);
+	if (ret < 0)
+		return ret;
+
+	ip = val / (int64_t)iio_fmt_pow10[IIO_FMT_MICRO];
+	if (ip > INT32_MAX || ip < INT32_MIN)
+		return -EINVAL;
+	*val0 = ip;
+	*val1 = val % (int64_t)iio_fmt_pow10[IIO_FMT_MICRO];
+	if (*val0 && *val1 < 0)
+		*val1 = -*val1;
+
+	return ret;
+}
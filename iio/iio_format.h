@@ -0,0 +1,103 @@
+/***************************************************************************//**
+ *   @file   iio_format.h
+ *   @brief  Integer and fixed point formatting and parsing of IIO attribute values.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef IIO_FORMAT_H_
+#define IIO_FORMAT_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* Decimals of the fixed point values. */
+#define IIO_FMT_MILLI		3
+#define IIO_FMT_MICRO		6
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/*
+ * The formatting functions write a NUL terminated string and return its
+ * length, or -ENOMEM if buf is too small. The optional suffix is appended.
+ */
+
+/* Copy a string. */
+ssize_t iio_fmt_str(char *buf, size_t len, const char *str);
+/* Unsigned integer. */
+ssize_t iio_fmt_uint(char *buf, size_t len, uint64_t val, const char *suffix);
+/* Signed integer. */
+ssize_t iio_fmt_int(char *buf, size_t len, int64_t val, const char *suffix);
+/* Fixed point value, val / 10^decimals printed with the given decimals. */
+ssize_t iio_fmt_fixed(char *buf, size_t len, int64_t val, uint8_t decimals,
+		      const char *suffix);
+/* IIO_VAL_INT_PLUS_MICRO value, val0 + val1 / 10^6. */
+ssize_t iio_fmt_int_plus_micro(char *buf, size_t len, int32_t val0,
+			       int32_t val1, const char *suffix);
+/* Range of values, as "[min step max]". */
+ssize_t iio_fmt_range(char *buf, size_t len, int64_t min, int64_t step,
+		      int64_t max);
+/* Strings of a list separated by spaces. */
+ssize_t iio_fmt_list(char *buf, size_t len, const char * const *list,
+		     uint32_t num);
+
+/*
+ * The parsing functions skip leading blanks and stop at the first character
+ * that is not part of the number. They return the number of characters used,
+ * or -EINVAL if there is no number or it does not fit.
+ */
+
+/* Unsigned integer. */
+ssize_t iio_parse_uint(const char *buf, uint64_t *val);
+/* Signed integer. */
+ssize_t iio_parse_int(const char *buf, int64_t *val);
+/* Fixed point value, scaled by 10^decimals. Extra decimals are truncated. */
+ssize_t iio_parse_fixed(const char *buf, uint8_t decimals, int64_t *val);
+/* IIO_VAL_INT_PLUS_MICRO value. */
+ssize_t iio_parse_int_plus_micro(const char *buf, int32_t *val0,
+				 int32_t *val1);
+
+#endif /* IIO_FORMAT_H_ */
@@ -0,0 +1,888 @@
+/***************************************************************************//**
+ *   @file   iio_jesd204_rx.c
+ *   @brief  Implementation of iio_jesd204_rx.
+ *   This exposes the JESD204 receive link status, the per lane status and
+ *   the link monitor events as an iio device.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <inttypes.h>
+#include <string.h>
+#include <errno.h>
+#include "error.h"
+#include "iio_jesd204_rx.h"
+#include "util.h"
+#include "xml.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* Longest line produced for a monitor event. */
+#define IIO_JESD204_RX_EVENT_LINE_MAX	48
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+struct iio_jesd204_rx {
+	struct axi_jesd204_rx *jesd;
+	struct axi_jesd204_rx_monitor *monitor;
+	struct irq_ctrl_desc *irq_desc;
+	uint32_t monitor_irq_id;
+};
+
+static const char * const iio_jesd204_rx_link_state[] = {
+	"reset", "wait_for_phy", "cgs", "data",
+};
+
+static const char * const iio_jesd204_rx_cgs_state[] = {
+	"init", "check", "data", "unknown",
+};
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Keep the periodic monitor poll out while the monitor is accessed.
+ * @param iio_jesd - Physical instance of a iio_jesd204_rx device.
+ */
+static void iio_jesd204_rx_monitor_lock(struct iio_jesd204_rx *iio_jesd)
+{
+	if (iio_jesd->irq_desc)
+		irq_disable(iio_jesd->irq_desc, iio_jesd->monitor_irq_id);
+}
+
+/**
+ * @brief Let the periodic monitor poll run again.
+ * @param iio_jesd - Physical instance of a iio_jesd204_rx device.
+ */
+static void iio_jesd204_rx_monitor_unlock(struct iio_jesd204_rx *iio_jesd)
+{
+	if (iio_jesd->irq_desc)
+		irq_enable(iio_jesd->irq_desc, iio_jesd->monitor_irq_id);
+}
+
+/**
+ * @brief Read the link status of the device.
+ * @param device - Physical instance of a iio_jesd204_rx device.
+ * @param status - Where the status is stored.
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+static int32_t iio_jesd204_rx_link(void *device,
+				   struct jesd204_rx_link_status *status)
+{
+	struct iio_jesd204_rx *iio_jesd = (struct iio_jesd204_rx *)device;
+
+	return axi_jesd204_rx_link_status_get(iio_jesd->jesd, status);
+}
+
+/**
+ * @brief Read the status of the lane a channel refers to.
+ * @param device - Physical instance of a iio_jesd204_rx device.
+ * @param channel - Channel properties.
+ * @param status - Where the status is stored.
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+static int32_t iio_jesd204_rx_lane(void *device,
+				   const struct iio_ch_info *channel,
+				   struct jesd204_rx_lane_status *status)
+{
+	struct iio_jesd204_rx *iio_jesd = (struct iio_jesd204_rx *)device;
+
+	if (!channel || channel->ch_num < 0)
+		return -EINVAL;
+
+	return axi_jesd204_rx_lane_status_get(iio_jesd->jesd, channel->ch_num,
+					      status);
+}
+
+/**
+ * @brief get_link_state().
+ * @param device - Physical instance of a iio_jesd204_rx device.
+ * @param buf - Where value is stored.
+ * @param len - Maximum length of value to be stored in buf.
+ * @param channel - Channel properties.
+ * @return Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_link_state(void *device, char *buf, size_t len,
+			      const struct iio_ch_info *channel)
+{
+	struct jesd204_rx_link_status status;
+	int32_t ret;
+
+	ret = iio_jesd204_rx_link(device, &status);
+	if (ret < 0)
+		return ret;
+
+	if (status.link_disabled)
+		return snprintf(buf, len, "disabled");
+
+	return snprintf(buf, len, "%s",
+			iio_jesd204_rx_link_state[status.link_state]);
+}
+
+/**
+ * @brief get_measured_link_clock().
+ * @param device - Physical instance of a iio_jesd204_rx device.
+ * @param buf - Where value is stored.
+ * @param len - Maximum length of value to be stored in buf.
+ * @param channel - Channel properties.
+ * @return Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_measured_link_clock(void *device, char *buf, size_t len,
+				       const struct iio_ch_info *channel)
+{
+	struct jesd204_rx_link_status status;
+	int32_t ret;
+
+	ret = iio_jesd204_rx_link(device, &status);
+	if (ret < 0)
+		return ret;
+
+	return snprintf(buf, len, "%"PRIu32"", status.measured_clk_khz);
+}
+
+/**
+ * @brief get_reported_link_clock().
+ * @param device - Physical instance of a iio_jesd204_rx device.
+ * @param buf - Where value is stored.
+ * @param len - Maximum length of value to be stored in buf.
+ * @param channel - Channel properties.
+ * @return Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_reported_link_clock(void *device, char *buf, size_t len,
+				       const struct iio_ch_info *channel)
+{
+	struct iio_jesd204_rx *iio_jesd = (struct iio_jesd204_rx *)device;
+
+	return snprintf(buf, len, "%"PRIu32"", iio_jesd->jesd->device_clk_khz);
+}
+
+/**
+ * @brief get_lane_rate().
+ * @param device - Physical instance of a iio_jesd204_rx device.
+ * @param buf - Where value is stored.
+ * @param len - Maximum length of value to be stored in buf.
+ * @param channel - Channel properties.
+ * @return Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_lane_rate(void *device, char *buf, size_t len,
+			     const struct iio_ch_info *channel)
+{
+	struct iio_jesd204_rx *iio_jesd = (struct iio_jesd204_rx *)device;
+
+	return snprintf(buf, len, "%"PRIu32"", iio_jesd->jesd->lane_clk_khz);
+}
+
+/**
+ * @brief get_sysref_captured().
+ * @param device - Physical instance of a iio_jesd204_rx device.
+ * @param buf - Where value is stored.
+ * @param len - Maximum length of value to be stored in buf.
+ * @param channel - Channel properties.
+ * @return Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_sysref_captured(void *device, char *buf, size_t len,
+				   const struct iio_ch_info *channel)
+{
+	struct jesd204_rx_link_status status;
+	int32_t ret;
+
+	ret = iio_jesd204_rx_link(device, &status);
+	if (ret < 0)
+		return ret;
+
+	if (status.sysref_disabled)
+		return snprintf(buf, len, "disabled");
+
+	return snprintf(buf, len, "%d", status.sysref_captured);
+}
+
+/**
+ * @brief get_sysref_alignment_error().
+ * @param device - Physical instance of a iio_jesd204_rx device.
+ * @param buf - Where value is stored.
+ * @param len - Maximum length of value to be stored in buf.
+ * @param channel - Channel properties.
+ * @return Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_sysref_alignment_error(void *device, char *buf, size_t len,
+		const struct iio_ch_info *channel)
+{
+	struct jesd204_rx_link_status status;
+	int32_t ret;
+
+	ret = iio_jesd204_rx_link(device, &status);
+	if (ret < 0)
+		return ret;
+
+	if (status.sysref_disabled)
+		return snprintf(buf, len, "disabled");
+
+	return snprintf(buf, len, "%d", status.sysref_alignment_error);
+}
+
+/**
+ * @brief get_events().
+ * List the oldest monitor events that fit in buf, one per line:
+ * "<seq> <lane|link> <link state> <cgs state> <new errors>".
+ * The events are recorded by the periodic monitor poll of the application.
+ * Reading does not remove the events, see set_events().
+ * @param device - Physical instance of a iio_jesd204_rx device.
+ * @param buf - Where value is stored.
+ * @param len - Maximum length of value to be stored in buf.
+ * @param channel - Channel properties.
+ * @return Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_events(void *device, char *buf, size_t len,
+			  const struct iio_ch_info *channel)
+{
+	struct iio_jesd204_rx *iio_jesd = (struct iio_jesd204_rx *)device;
+	struct jesd204_rx_event event;
+	uint32_t nb_events;
+	uint32_t n = 0;
+	char lane[8];
+	size_t i = 0;
+	int32_t ret;
+
+	if (!iio_jesd->monitor)
+		return -ENOENT;
+
+	buf[0] = '\0';
+	while (len - i > IIO_JESD204_RX_EVENT_LINE_MAX) {
+		iio_jesd204_rx_monitor_lock(iio_jesd);
+		ret = axi_jesd204_rx_monitor_peek(iio_jesd->monitor, n++, &event, 1,
+						  &nb_events);
+		iio_jesd204_rx_monitor_unlock(iio_jesd);
+		if (ret < 0)
+			return ret;
+		if (!nb_events)
+			break;
+
+		if (event.lane == JESD204_RX_EVENT_LINK)
+			snprintf(lane, sizeof(lane), "link");
+		else
+			snprintf(lane, sizeof(lane), "%"PRIu8"", event.lane);
+
+		i += snprintf(buf + i, len - i, "%"PRIu32" %s %s %s %"PRIu32"\n",
+			      event.seq, lane,
+			      iio_jesd204_rx_link_state[event.link_state & 0x3],
+			      iio_jesd204_rx_cgs_state[event.cgs_state & 0x3],
+			      event.errors_delta);
+	}
+
+	return i;
+}
+
+/**
+ * @brief set_events().
+ * Remove the given number of the oldest monitor events, a reader writes the
+ * number of lines it has processed.
+ * @param device - Physical instance of a iio_jesd204_rx device.
+ * @param buf - Value to be written to attribute.
+ * @param len - Length of the data in "buf".
+ * @param channel - Channel properties.
+ * @return Number of bytes written to device, or negative value on failure.
+ */
+static ssize_t set_events(void *device, char *buf, size_t len,
+			  const struct iio_ch_info *channel)
+{
+	struct iio_jesd204_rx *iio_jesd = (struct iio_jesd204_rx *)device;
+	int32_t nb_events;
+	int32_t ret;
+
+	if (!iio_jesd->monitor)
+		return -ENOENT;
+
+	nb_events = str_to_int32(buf);
+	if (nb_events < 0)
+		return -EINVAL;
+
+	iio_jesd204_rx_monitor_lock(iio_jesd);
+	ret = axi_jesd204_rx_monitor_clear(iio_jesd->monitor, nb_events);
+	iio_jesd204_rx_monitor_unlock(iio_jesd);
+	if (ret != SUCCESS)
+		return FAILURE;
+
+	return len;
+}
+
+/**
+ * @brief get_events_dropped().
+ * @param device - Physical instance of a iio_jesd204_rx device.
+ * @param buf - Where value is stored.
+ * @param len - Maximum length of value to be stored in buf.
+ * @param channel - Channel properties.
+ * @return Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_events_dropped(void *device, char *buf, size_t len,
+				  const struct iio_ch_info *channel)
+{
+	struct iio_jesd204_rx *iio_jesd = (struct iio_jesd204_rx *)device;
+
+	if (!iio_jesd->monitor)
+		return -ENOENT;
+
+	return snprintf(buf, len, "%"PRIu32"", iio_jesd->monitor->dropped);
+}
+
+/**
+ * @brief get_cgs_state().
+ * @param device - Physical instance of a iio_jesd204_rx device.
+ * @param buf - Where value is stored.
+ * @param len - Maximum length of value to be stored in buf.
+ * @param channel - Channel properties.
+ * @return Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_cgs_state(void *device, char *buf, size_t len,
+			     const struct iio_ch_info *channel)
+{
+	struct jesd204_rx_lane_status status;
+	int32_t ret;
+
+	ret = iio_jesd204_rx_lane(device, channel, &status);
+	if (ret < 0)
+		return ret;
+
+	return snprintf(buf, len, "%s",
+			iio_jesd204_rx_cgs_state[status.cgs_state]);
+}
+
+/**
+ * @brief get_errors().
+ * @param device - Physical instance of a iio_jesd204_rx device.
+ * @param buf - Where value is stored.
+ * @param len - Maximum length of value to be stored in buf.
+ * @param channel - Channel properties.
+ * @return Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_errors(void *device, char *buf, size_t len,
+			  const struct iio_ch_info *channel)
+{
+	struct jesd204_rx_lane_status status;
+	int32_t ret;
+
+	ret = iio_jesd204_rx_lane(device, channel, &status);
+	if (ret < 0)
+		return ret;
+	if (!status.errors_valid)
+		return -ENOENT;
+
+	return snprintf(buf, len, "%"PRIu32"", status.errors);
+}
+
+/**
+ * @brief get_total_errors().
+ * @param device - Physical instance of a iio_jesd204_rx device.
+ * @param buf - Where value is stored.
+ * @param len - Maximum length of value to be stored in buf.
+ * @param channel - Channel properties.
+ * @return Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_total_errors(void *device, char *buf, size_t len,
+				const struct iio_ch_info *channel)
+{
+	struct iio_jesd204_rx *iio_jesd = (struct iio_jesd204_rx *)device;
+	uint64_t total_errors;
+
+	if (!iio_jesd->monitor || channel->ch_num < 0 ||
+	    channel->ch_num >= JESD204_RX_MAX_LANES)
+		return -ENOENT;
+
+	iio_jesd204_rx_monitor_lock(iio_jesd);
+	total_errors = iio_jesd->monitor->total_errors[channel->ch_num];
+	iio_jesd204_rx_monitor_unlock(iio_jesd);
+
+	return snprintf(buf, len, "%"PRIu64"", total_errors);
+}
+
+/**
+ * @brief get_latency().
+ * Lane latency as "<multiframes> <octets>".
+ * @param device - Physical instance of a iio_jesd204_rx device.
+ * @param buf - Where value is stored.
+ * @param len - Maximum length of value to be stored in buf.
+ * @param channel - Channel properties.
+ * @return Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_latency(void *device, char *buf, size_t len,
+			   const struct iio_ch_info *channel)
+{
+	struct jesd204_rx_lane_status status;
+	int32_t ret;
+
+	ret = iio_jesd204_rx_lane(device, channel, &status);
+	if (ret < 0)
+		return ret;
+	if (!status.ifs_ready)
+		return -EAGAIN;
+
+	return snprintf(buf, len, "%"PRIu32" %"PRIu32"",
+			status.latency_multiframes, status.latency_octets);
+}
+
+/**
+ * @brief get_ilas().
+ * ILAS configuration as "name=value" pairs.
+ * @param device - Physical instance of a iio_jesd204_rx device.
+ * @param buf - Where value is stored.
+ * @param len - Maximum length of value to be stored in buf.
+ * @param channel - Channel properties.
+ * @return Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_ilas(void *device, char *buf, size_t len,
+			const struct iio_ch_info *channel)
+{
+	struct jesd204_rx_lane_status status;
+	struct jesd204_rx_ilas *ilas = &status.ilas;
+	int32_t ret;
+
+	ret = iio_jesd204_rx_lane(device, channel, &status);
+	if (ret < 0)
+		return ret;
+	if (!status.ilas_ready)
+		return -EAGAIN;
+
+	return snprintf(buf, len, "DID=%d BID=%d LID=%d L=%d SCR=%d F=%d K=%d "
+			"M=%d N=%d CS=%d NP=%d S=%d HD=%d FCHK=%d CF=%d "
+			"ADJCNT=%d PHADJ=%d ADJDIR=%d JESDV=%d SUBCLASS=%d",
+			ilas->did, ilas->bid, ilas->lid, ilas->l, ilas->scr,
+			ilas->f, ilas->k, ilas->m, ilas->n, ilas->cs, ilas->np,
+			ilas->s, ilas->hd, ilas->fchk, ilas->cf, ilas->adjcnt,
+			ilas->phadj, ilas->adjdir, ilas->jesdv, ilas->subclass);
+}
+
+static struct iio_attribute iio_attr_link_state = {
+	.name = "link_state",
+	.show = get_link_state,
+	.store = NULL,
+};
+
+static struct iio_attribute iio_attr_measured_link_clock = {
+	.name = "measured_link_clock",
+	.show = get_measured_link_clock,
+	.store = NULL,
+};
+
+static struct iio_attribute iio_attr_reported_link_clock = {
+	.name = "reported_link_clock",
+	.show = get_reported_link_clock,
+	.store = NULL,
+};
+
+static struct iio_attribute iio_attr_lane_rate = {
+	.name = "lane_rate",
+	.show = get_lane_rate,
+	.store = NULL,
+};
+
+static struct iio_attribute iio_attr_sysref_captured = {
+	.name = "sysref_captured",
+	.show = get_sysref_captured,
+	.store = NULL,
+};
+
+static struct iio_attribute iio_attr_sysref_alignment_error = {
+	.name = "sysref_alignment_error",
+	.show = get_sysref_alignment_error,
+	.store = NULL,
+};
+
+static struct iio_attribute iio_attr_events = {
+	.name = "events",
+	.show = get_events,
+	.store = set_events,
+};
+
+static struct iio_attribute iio_attr_events_dropped = {
+	.name = "events_dropped",
+	.show = get_events_dropped,
+	.store = NULL,
+};
+
+static struct iio_attribute *global_attributes[] = {
+	&iio_attr_link_state,
+	&iio_attr_measured_link_clock,
+	&iio_attr_reported_link_clock,
+	&iio_attr_lane_rate,
+	&iio_attr_sysref_captured,
+	&iio_attr_sysref_alignment_error,
+	&iio_attr_events,
+	&iio_attr_events_dropped,
+	NULL,
+};
+
+static struct iio_attribute iio_attr_cgs_state = {
+	.name = "cgs_state",
+	.show = get_cgs_state,
+	.store = NULL,
+};
+
+static struct iio_attribute iio_attr_errors = {
+	.name = "errors",
+	.show = get_errors,
+	.store = NULL,
+};
+
+static struct iio_attribute iio_attr_total_errors = {
+	.name = "total_errors",
+	.show = get_total_errors,
+	.store = NULL,
+};
+
+static struct iio_attribute iio_attr_latency = {
+	.name = "latency",
+	.show = get_latency,
+	.store = NULL,
+};
+
+static struct iio_attribute iio_attr_ilas = {
+	.name = "ilas",
+	.show = get_ilas,
+	.store = NULL,
+};
+
+static struct iio_attribute *lane_attributes[] = {
+	&iio_attr_cgs_state,
+	&iio_attr_errors,
+	&iio_attr_total_errors,
+	&iio_attr_latency,
+	&iio_attr_ilas,
+	NULL,
+};
+
+/**
+ * @brief Add "attribute" nodes for a list of attributes.
+ * @param parent - Node the attributes are added to.
+ * @param attributes - List of attributes.
+ * @param prefix - Filename prefix, NULL for device attributes.
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+static ssize_t iio_jesd204_rx_xml_attributes(struct xml_node *parent,
+		struct iio_attribute **attributes,
+		const char *prefix)
+{
+	struct xml_attribute *att;
+	struct xml_node *node;
+	char buff[64];
+	ssize_t ret;
+	uint16_t i;
+
+	for (i = 0; attributes[i]; i++) {
+		ret = xml_create_node(&node, "attribute");
+		if (ret < 0)
+			return ret;
+		ret = xml_create_attribute(&att, "name", attributes[i]->name);
+		if (ret < 0)
+			goto error;
+		ret = xml_add_attribute(node, att);
+		if (ret < 0)
+			goto error;
+		if (prefix) {
+			snprintf(buff, sizeof(buff), "%s_%s", prefix,
+				 attributes[i]->name);
+			ret = xml_create_attribute(&att, "filename", buff);
+			if (ret < 0)
+				goto error;
+			ret = xml_add_attribute(node, att);
+			if (ret < 0)
+				goto error;
+		}
+		ret = xml_add_node(parent, node);
+		if (ret < 0)
+			goto error;
+	}
+
+	return SUCCESS;
+
+error:
+	xml_delete_node(node);
+
+	return ret;
+}
+
+/**
+ * @brief Get xml corresponding to a "jesd204_rx" device.
+ * @param xml - Xml containing description of a device.
+ * @param iio_dev - Structure describing a device, channels and attributes.
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+static ssize_t iio_jesd204_rx_get_xml(char **xml, struct iio_device *iio_dev)
+{
+	struct xml_document *document = NULL;
+	struct xml_attribute *att = NULL;
+	struct xml_node *channel = NULL;
+	struct xml_node *device = NULL;
+	char buff[32];
+	ssize_t ret;
+	uint16_t i;
+
+	if (!xml || !iio_dev)
+		return FAILURE;
+
+	ret = xml_create_node(&device, "device");
+	if (ret < 0)
+		goto error;
+	ret = xml_create_attribute(&att, "id", iio_dev->name);
+	if (ret < 0)
+		goto error;
+	ret = xml_add_attribute(device, att);
+	if (ret < 0)
+		goto error;
+	ret = xml_create_attribute(&att, "name", iio_dev->name);
+	if (ret < 0)
+		goto error;
+	ret = xml_add_attribute(device, att);
+	if (ret < 0)
+		goto error;
+
+	for (i = 0; i < iio_dev->num_ch; i++) {
+		ret = xml_create_node(&channel, "channel");
+		if (ret < 0)
+			goto error;
+		ret = xml_create_attribute(&att, "id", iio_dev->channels[i]->name);
+		if (ret < 0)
+			goto error;
+		ret = xml_add_attribute(channel, att);
+		if (ret < 0)
+			goto error;
+		ret = xml_create_attribute(&att, "type", "input");
+		if (ret < 0)
+			goto error;
+		ret = xml_add_attribute(channel, att);
+		if (ret < 0)
+			goto error;
+		snprintf(buff, sizeof(buff), "in_%s", iio_dev->channels[i]->name);
+		ret = iio_jesd204_rx_xml_attributes(channel, lane_attributes, buff);
+		if (ret < 0)
+			goto error;
+		ret = xml_add_node(device, channel);
+		if (ret < 0)
+			goto error;
+	}
+
+	ret = iio_jesd204_rx_xml_attributes(device, global_attributes, NULL);
+	if (ret < 0)
+		goto error;
+
+	ret = xml_create_document(&document, device);
+	if (ret < 0) {
+		if (document)
+			xml_delete_document(document);
+		goto error;
+	}
+	*xml = document->buff;
+	free(document);
+
+error:
+	if (device)
+		xml_delete_node(device);
+
+	return ret;
+}
+
+/**
+ * @brief Delete iio_device.
+ * @param iio_device - Structure describing a device, channels and attributes.
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+static ssize_t iio_jesd204_rx_delete_device(struct iio_device *iio_device)
+{
+	uint16_t i = 0;
+
+	if (!iio_device)
+		return FAILURE;
+
+	if (iio_device->channels) {
+		while (iio_device->channels[i]) {
+			free(iio_device->channels[i]->name);
+			free(iio_device->channels[i]);
+			i++;
+		}
+		free(iio_device->channels);
+	}
+	free(iio_device);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Create structure describing a device, one channel per lane.
+ * @param device_name - Device name.
+ * @param num_lanes - Number of lanes of the link.
+ * @return iio_device or NULL, in case of failure.
+ */
+static struct iio_device *iio_jesd204_rx_create_device(const char *device_name,
+		uint16_t num_lanes)
+{
+	struct iio_device *iio_device;
+	const uint8_t len = sizeof("lane") + 3;
+	uint16_t i;
+
+	iio_device = (struct iio_device *)calloc(1, sizeof(struct iio_device));
+	if (!iio_device)
+		return NULL;
+
+	iio_device->name = device_name;
+	iio_device->num_ch = num_lanes;
+	iio_device->attributes = global_attributes;
+	iio_device->channels = calloc(num_lanes + 1, sizeof(struct iio_channel *));
+	if (!iio_device->channels)
+		goto error;
+
+	for (i = 0; i < num_lanes; i++) {
+		iio_device->channels[i] = calloc(1, sizeof(struct iio_channel));
+		if (!iio_device->channels[i])
+			goto error;
+		iio_device->channels[i]->name = calloc(1, len);
+		if (!iio_device->channels[i]->name)
+			goto error;
+		snprintf(iio_device->channels[i]->name, len, "lane%d", i);
+		iio_device->channels[i]->attributes = lane_attributes;
+		iio_device->channels[i]->ch_out = false;
+	}
+
+	return iio_device;
+
+error:
+	iio_jesd204_rx_delete_device(iio_device);
+
+	return NULL;
+}
+
+/**
+ * @brief Init for reading the status of a JESD204 receive link.
+ * @param desc - Descriptor.
+ * @param init - Configuration structure.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t iio_jesd204_rx_init(struct iio_jesd204_rx_desc **desc,
+			    struct iio_jesd204_rx_init_param *init)
+{
+	struct iio_interface *iio_interface;
+	struct iio_device *iio_device;
+	struct iio_jesd204_rx *iio_jesd;
+	int32_t status;
+
+	if (!init || !init->jesd)
+		return FAILURE;
+
+	iio_jesd = (struct iio_jesd204_rx *)calloc(1, sizeof(*iio_jesd));
+	if (!iio_jesd)
+		return FAILURE;
+
+	iio_jesd->jesd = init->jesd;
+	iio_jesd->monitor = init->monitor;
+	iio_jesd->irq_desc = init->irq_desc;
+	iio_jesd->monitor_irq_id = init->monitor_irq_id;
+
+	iio_device = iio_jesd204_rx_create_device(init->jesd->name,
+			min_t(uint32_t, init->jesd->num_lanes,
+			      JESD204_RX_MAX_LANES));
+	if (!iio_device)
+		goto error_free_iio_jesd;
+
+	iio_interface = (struct iio_interface *)calloc(1, sizeof(struct iio_interface));
+	if (!iio_interface)
+		goto error_delete_device;
+
+	*iio_interface = (struct iio_interface) {
+		.name = init->jesd->name,
+		.dev_instance = iio_jesd,
+		.iio = iio_device,
+		.get_xml = iio_jesd204_rx_get_xml,
+		.transfer_dev_to_mem = NULL,
+		.transfer_mem_to_dev = NULL,
+		.read_data = NULL,
+		.write_data = NULL,
+	};
+
+	status = iio_register(iio_interface);
+	if (status < 0)
+		goto error_free_iio_interface;
+
+	*desc = calloc(1, sizeof(struct iio_jesd204_rx_desc));
+	if (!(*desc))
+		goto error_unregister;
+
+	(*desc)->iio_interface = iio_interface;
+
+	return SUCCESS;
+
+error_unregister:
+	iio_unregister(iio_interface);
+error_free_iio_interface:
+	free(iio_interface);
+error_delete_device:
+	iio_jesd204_rx_delete_device(iio_device);
+error_free_iio_jesd:
+	free(iio_jesd);
+
+	return FAILURE;
+}
+
+/**
+ * @brief Release resources.
+ * @param desc - Descriptor.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t iio_jesd204_rx_remove(struct iio_jesd204_rx_desc *desc)
+{
+	int32_t status;
+
+	if (!desc)
+		return FAILURE;
+
+	status = iio_unregister(desc->iio_interface);
+	if (status < 0)
+		return FAILURE;
+
+	status = iio_jesd204_rx_delete_device(desc->iio_interface->iio);
+	if (status < 0)
+		return FAILURE;
+
+	free(desc->iio_interface->dev_instance);
+	free(desc->iio_interface);
+	free(desc);
+
+	return SUCCESS;
+}
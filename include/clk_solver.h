@@ -0,0 +1,110 @@
+/***************************************************************************//**
+ *   @file   clk_solver.h
+ *   @brief  Header file of the clock divider solver.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+#ifndef CLK_SOLVER_H_
+#define CLK_SOLVER_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define CLK_SOLVER_CACHE_SIZE	4
+#define CLK_SOLVER_MAX_PARAMS	5
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+/**
+ * @struct clk_solver_cache_entry
+ * @brief Solved divider settings for one input/output frequency pair.
+ */
+struct clk_solver_cache_entry {
+	/** Input frequency */
+	uint32_t	fin;
+	/** Requested output frequency */
+	uint32_t	fout;
+	/** Solver specific divider settings */
+	uint32_t	params[CLK_SOLVER_MAX_PARAMS];
+	/** Last use, 0 if the entry is empty */
+	uint32_t	stamp;
+};
+
+/**
+ * @struct clk_solver_cache
+ * @brief Small least recently used cache of solver results.
+ */
+struct clk_solver_cache {
+	struct clk_solver_cache_entry	entry[CLK_SOLVER_CACHE_SIZE];
+	uint32_t			stamp;
+};
+
+/**
+ * @struct clk_solver_mmcm_limits
+ * @brief Operating ranges of a Xilinx MMCM, in kHz.
+ */
+struct clk_solver_mmcm_limits {
+	uint32_t	fpfd_min;
+	uint32_t	fpfd_max;
+	uint32_t	fvco_min;
+	uint32_t	fvco_max;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+/* Look up the divider settings of a frequency pair. */
+bool clk_solver_cache_lookup(struct clk_solver_cache *cache, uint32_t fin,
+			     uint32_t fout, uint32_t *params,
+			     uint8_t nb_params);
+/* Store the divider settings of a frequency pair. */
+void clk_solver_cache_store(struct clk_solver_cache *cache, uint32_t fin,
+			    uint32_t fout, const uint32_t *params,
+			    uint8_t nb_params);
+/* Drop all cached results. */
+void clk_solver_cache_flush(struct clk_solver_cache *cache);
+/* Compute the MMCM D, M and output divider for the requested rate. */
+void clk_solver_mmcm(const struct clk_solver_mmcm_limits *limits,
+		     uint32_t fin, uint32_t fout, uint32_t *best_d,
+		     uint32_t *best_m, uint32_t *best_dout);
+
+#endif
@@ -0,0 +1,182 @@
+/***************************************************************************//**
+ *   @file   hal_trace.h
+ *   @brief  HAL access tracing.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+#ifndef HAL_TRACE_H_
+#define HAL_TRACE_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdint.h>
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+/* "HALT", first word of a dumped trace. */
+#define HAL_TRACE_MAGIC		0x544C4148
+#define HAL_TRACE_VERSION	2
+/* Bytes of each SPI transfer kept in a record, in each direction. */
+#define HAL_TRACE_SPI_BYTES	16
+/* Return addresses kept above the caller, with HAL_TRACE_PARENT. */
+#define HAL_TRACE_PARENTS	3
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+/**
+ * @enum hal_trace_type
+ * @brief Kind of a trace record.
+ */
+enum hal_trace_type {
+	/** spi_write_and_read() */
+	HAL_TRACE_SPI,
+	/** axi_io_read() */
+	HAL_TRACE_AXI_READ,
+	/** axi_io_write() */
+	HAL_TRACE_AXI_WRITE,
+	/** udelay() */
+	HAL_TRACE_UDELAY,
+	/** mdelay() */
+	HAL_TRACE_MDELAY,
+	/** hal_trace_mark() */
+	HAL_TRACE_MARK,
+};
+
+/**
+ * @struct hal_trace_record
+ * @brief One HAL call. The layout is also the on-wire format of the dump.
+ */
+struct hal_trace_record {
+	/** Time at which the call started, in ns */
+	uint64_t	ts_ns;
+	/** Return address of the call, resolved to a function by the decoder */
+	uint64_t	caller;
+	/**
+	 * Return addresses of the frames above the caller, nearest first. 0
+	 * past the outermost frame, or unless built with HAL_TRACE_PARENT
+	 */
+	uint64_t	parent[HAL_TRACE_PARENTS];
+	/** Position of the record in the trace, plus 1 */
+	uint32_t	seq;
+	/** Duration of the call, in ns */
+	uint32_t	duration_ns;
+	/** Chip select, AXI address, delay or mark id */
+	uint32_t	addr;
+	/** First 4 bytes sent (big endian) or AXI data written */
+	uint32_t	wdata;
+	/** First 4 bytes received (big endian) or AXI data read */
+	uint32_t	rdata;
+	/** SPI transfer length */
+	uint16_t	bytes;
+	/** enum hal_trace_type */
+	uint8_t		type;
+	/** The HAL call failed */
+	uint8_t		error;
+	/** First bytes of the SPI transfer, sent */
+	uint8_t		tx[HAL_TRACE_SPI_BYTES];
+	/** First bytes of the SPI transfer, received */
+	uint8_t		rx[HAL_TRACE_SPI_BYTES];
+};
+
+/**
+ * @struct hal_trace_header
+ * @brief Header of a dumped trace, followed by count records.
+ */
+struct hal_trace_header {
+	/** HAL_TRACE_MAGIC */
+	uint32_t	magic;
+	/** HAL_TRACE_VERSION */
+	uint16_t	version;
+	/** sizeof(struct hal_trace_record) */
+	uint16_t	record_size;
+	/** Number of records that follow */
+	uint32_t	count;
+	/** Number of records overwritten before the dump */
+	uint32_t	lost;
+	/** Run time address of hal_trace_init(), to relocate the callers */
+	uint64_t	anchor;
+};
+
+/**
+ * @struct hal_trace_init_param
+ * @brief Parameters of the trace ring.
+ */
+struct hal_trace_init_param {
+	/** Number of records kept, must be a power of 2 */
+	uint32_t	num_records;
+	/** Monotonic time source in ns, NULL to only keep the order */
+	uint64_t	(*get_time_ns)(void);
+};
+
+/**
+ * @struct hal_trace_desc
+ * @brief Trace ring.
+ */
+struct hal_trace_desc {
+	struct hal_trace_record	*records;
+	uint32_t		mask;
+	/** Number of records reserved so far */
+	uint32_t		head;
+	/** Recording is enabled */
+	uint8_t			enabled;
+	uint64_t		(*get_time_ns)(void);
+};
+
+/* Dump sink, returns the number of bytes written or a negative error. */
+typedef int32_t (*hal_trace_write_cb)(void *ctx, const void *buf,
+				      uint32_t len);
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+/* Allocate the trace ring and start recording. */
+int32_t hal_trace_init(struct hal_trace_desc **desc,
+		       const struct hal_trace_init_param *param);
+/* Stop recording and free the trace ring. */
+int32_t hal_trace_remove(struct hal_trace_desc *desc);
+/* Pause or resume recording. */
+void hal_trace_enable(struct hal_trace_desc *desc, uint8_t enable);
+/* Drop the recorded calls. */
+void hal_trace_clear(struct hal_trace_desc *desc);
+/* Record a user marker, e.g. the start of a bring-up phase. */
+void hal_trace_mark(uint32_t id);
+/* Write the header and the records, oldest first, to a sink. */
+int32_t hal_trace_dump(struct hal_trace_desc *desc, hal_trace_write_cb write,
+		       void *ctx);
+
+#endif // HAL_TRACE_H_
@@ -0,0 +1,120 @@
+/***************************************************************************//**
+ *   @file   spi_seq.h
+ *   @brief  Register sequence engine for SPI converters and clock chips.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+#ifndef SPI_SEQ_H_
+#define SPI_SEQ_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "spi.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+/* Largest number of data bytes sent in a single streaming transaction. */
+#define SPI_SEQ_MAX_STREAM	32
+
+#define SPI_SEQ_OP_WRITE	0
+#define SPI_SEQ_OP_DELAY	1
+#define SPI_SEQ_OP_VERIFY	2
+
+/* Write val to reg. */
+#define SPI_SEQ_WR(reg, val) \
+	{ SPI_SEQ_OP_WRITE, (reg), (val), 0xFF }
+/* Wait the given number of milliseconds. */
+#define SPI_SEQ_DELAY_MS(ms) \
+	{ SPI_SEQ_OP_DELAY, (ms), 0, 0 }
+/* Read reg back and fail unless (reg & mask) == val. */
+#define SPI_SEQ_VERIFY(reg, mask, val) \
+	{ SPI_SEQ_OP_VERIFY, (reg), (val), (mask) }
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+/**
+ * @struct spi_seq_entry
+ * @brief One step of a register sequence.
+ */
+struct spi_seq_entry {
+	/** SPI_SEQ_OP_WRITE, SPI_SEQ_OP_DELAY or SPI_SEQ_OP_VERIFY */
+	uint8_t		op;
+	/** Register address, or the delay in ms for SPI_SEQ_OP_DELAY */
+	uint16_t	reg;
+	/** Value to write or expected value */
+	uint8_t		val;
+	/** Compare mask used by SPI_SEQ_OP_VERIFY */
+	uint8_t		mask;
+};
+
+/**
+ * @struct spi_seq_config
+ * @brief Register access format of the target device.
+ *
+ * The device is addressed with a 16-bit big endian instruction word
+ * (read_flag | (reg & addr_mask)) followed by one or more data bytes.
+ */
+struct spi_seq_config {
+	/** SPI descriptor */
+	struct spi_desc	*spi;
+	/** Instruction bits set for a read access */
+	uint16_t	read_flag;
+	/** Instruction bits holding the register address */
+	uint16_t	addr_mask;
+	/** Streaming address direction the device is configured for */
+	bool		addr_ascending;
+	/** Maximum data bytes per transaction, 1 disables streaming */
+	uint8_t		max_stream;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+/* Write a single register. */
+int32_t spi_seq_write(const struct spi_seq_config *cfg, uint16_t reg,
+		      uint8_t val);
+/* Read a single register. */
+int32_t spi_seq_read(const struct spi_seq_config *cfg, uint16_t reg,
+		     uint8_t *val);
+/* Run a register sequence, stopping at the first failing step. */
+int32_t spi_seq_run(const struct spi_seq_config *cfg,
+		    const struct spi_seq_entry *seq, uint32_t num);
+
+#endif
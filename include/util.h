@@ -135,5 +135,7 @@ uint64_t div_u64(uint64_t dividend, uint32_t divisor);
 int32_t str_to_int32(const char *str);
 /* Converts from string to uint32_t */
 uint32_t srt_to_uint32(const char *str);
+/* Bits to test error free for a target bit error rate and confidence */
+uint64_t ber_bits_required(uint32_t ber_exp, uint32_t confidence);
 #endif // UTIL_H_
 
@@ -44,6 +44,8 @@
 /***************************** Include Files **********************************/
 /******************************************************************************/
 
+#include <stdbool.h>
+#include <stdint.h>
 #include "stdio.h"
 
 /******************************************************************************/
@@ -89,6 +91,40 @@ struct xml_document {
 	uint32_t index;
 };
 
+/**
+ * @brief Sink of a xml_writer, receives consecutive chunks of the document.
+ * @return Negative value in case of error.
+ */
+typedef ssize_t (*xml_write_cb)(void *ctx, const char *data, uint32_t len);
+
+/**
+ * @struct xml_writer
+ * @brief Streaming XML writer. Depending on the buffer and the sink given to
+ * xml_writer_init(), the document is:
+ * - only measured (no buffer, no sink),
+ * - rendered into the buffer (buffer, no sink),
+ * - passed to the sink in chunks of the buffer size (buffer and sink),
+ * - passed to the sink token by token (no buffer, sink).
+ */
+struct xml_writer {
+	/** Output buffer */
+	char		*buff;
+	/** Buffer size */
+	uint32_t	size;
+	/** Bytes used in the buffer */
+	uint32_t	index;
+	/** Sink the buffer is emptied to */
+	xml_write_cb	write;
+	/** Sink context */
+	void		*ctx;
+	/** Length of the document so far, also counts what did not fit */
+	uint32_t	len;
+	/** A start tag is waiting for attributes */
+	bool		tag_open;
+	/** First error */
+	ssize_t		error;
+};
+
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
@@ -120,4 +156,30 @@ ssize_t xml_create_document(struct xml_document **document,
 /* Delete xml document. */
 ssize_t xml_delete_document(struct xml_document *document);
 
+/* Initialize a streaming xml writer. */
+void xml_writer_init(struct xml_writer *writer, char *buff, uint32_t size,
+		     xml_write_cb write, void *ctx);
+
+/* Write text as it is. */
+ssize_t xml_write_raw(struct xml_writer *writer, const char *data);
+
+/* Write text, escaping the xml special characters. */
+ssize_t xml_write_escaped(struct xml_writer *writer, const char *data);
+
+/* Write the start tag of an element, attributes may follow. */
+ssize_t xml_write_start(struct xml_writer *writer, const char *name);
+
+/* Write an attribute of the last started element. */
+ssize_t xml_write_attribute(struct xml_writer *writer, const char *name,
+			    const char *value);
+
+/* Close an element. */
+ssize_t xml_write_end(struct xml_writer *writer, const char *name);
+
+/* Write a xml tree. */
+ssize_t xml_write_node(struct xml_writer *writer, struct xml_node *node);
+
+/* Pass the buffered data to the sink, or terminate the buffer string. */
+ssize_t xml_writer_flush(struct xml_writer *writer);
+
 #endif // ___XML_H__
@@ -41,25 +41,50 @@
 /***************************** Include Files **********************************/
 /******************************************************************************/
 
+#ifdef LINUX_PLATFORM
+#define _GNU_SOURCE		/* fallocate() */
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #include "ff.h"			/* Obtains integer types */
 #include "diskio.h"		/* Declarations of disk functions */
+#include "adi_diskio.h"
 
 #include "sd.h"
 #include "error.h"
 #include <stdio.h>
+#include <string.h>
 
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
 /******************************************************************************/
 
-#define DEV_SD		0	/* Example: Map MMC/SD card to physical drive 0 */
-#define DEV_RAM		1	/* Example: Map Ramdisk to physical drive 1 */
-#define DEV_USB		2	/* Example: Map USB MSD to physical drive 2 */
+#define DEV_SD		0	/* MMC/SD card, physical drive 0 */
+#define DEV_RAM		1	/* Ramdisk, physical drive 1 */
+#define DEV_FILE	2	/* Image file on the host, physical drive 2 */
+
+/* Sector size in FatFs is the name for data block size in the SD card
+ * specification */
+#define SECTOR_SIZE	DATA_BLOCK_LEN
 
-#define ERASE_SECTOR_SIZE	1u
 uint8_t			sd_init_var = false;
 extern struct sd_desc	*sd_desc;
 
+/* Memory region of the ramdisk */
+static struct {
+	BYTE	*mem;
+	LBA_t	sectors;
+} ram_disk;
+
+#ifdef LINUX_PLATFORM
+/* Image file backing the host drive */
+static struct {
+	FILE	*file;
+	LBA_t	sectors;
+} file_disk;
+#endif
+
 /******************************************************************************/
 /************************ Functions Definitions *******************************/
 /******************************************************************************/
@@ -67,7 +92,18 @@ extern struct sd_desc	*sd_desc;
 DSTATUS SD_disk_status();
 DSTATUS SD_disk_initialize();
 DRESULT SD_disk_read(BYTE *buff, LBA_t sector, UINT count);
-DRESULT SD_disk_write(BYTE *buff, LBA_t sector, UINT count);
+DRESULT SD_disk_write(const BYTE *buff, LBA_t sector, UINT count);
+DRESULT SD_disk_ioctl(BYTE cmd, void *buff);
+
+static DRESULT RAM_disk_read(BYTE *buff, LBA_t sector, UINT count);
+static DRESULT RAM_disk_write(const BYTE *buff, LBA_t sector, UINT count);
+static DRESULT RAM_disk_ioctl(BYTE cmd, void *buff);
+
+#ifdef LINUX_PLATFORM
+static DRESULT FILE_disk_read(BYTE *buff, LBA_t sector, UINT count);
+static DRESULT FILE_disk_write(const BYTE *buff, LBA_t sector, UINT count);
+static DRESULT FILE_disk_ioctl(BYTE cmd, void *buff);
+#endif
 
 /*-----------------------------------------------------------------------*/
 /* Get Drive Status                                                      */
@@ -80,9 +116,11 @@ DSTATUS disk_status (
 	case DEV_SD :
 		return SD_disk_status();;
 	case DEV_RAM :
-		return STA_NODISK;
-	case DEV_USB :
-		return STA_NODISK;
+		return ram_disk.mem ? 0 : STA_NOINIT;
+#ifdef LINUX_PLATFORM
+	case DEV_FILE :
+		return file_disk.file ? 0 : STA_NOINIT;
+#endif
 	default:
 		return STA_NODISK;
 	}
@@ -100,9 +138,11 @@ DSTATUS disk_initialize (
 	case DEV_SD :
 		return SD_disk_initialize();
 	case DEV_RAM :
-		return STA_NODISK;
-	case DEV_USB :
-		return STA_NODISK;
+#ifdef LINUX_PLATFORM
+	case DEV_FILE :
+#endif
+		/* Ready once attached */
+		return disk_status(pdrv);
 	}
 	return STA_NOINIT;
 }
@@ -122,9 +162,11 @@ DRESULT disk_read (
 	case DEV_SD :
 		return SD_disk_read(buff, sector, count);
 	case DEV_RAM :
-		return RES_NOTRDY;
-	case DEV_USB :
-		return RES_NOTRDY;
+		return RAM_disk_read(buff, sector, count);
+#ifdef LINUX_PLATFORM
+	case DEV_FILE :
+		return FILE_disk_read(buff, sector, count);
+#endif
 	}
 	return RES_PARERR;
 }
@@ -146,9 +188,11 @@ DRESULT disk_write (
 	case DEV_SD:
 		return SD_disk_write(buff, sector, count);
 	case DEV_RAM :
-		return RES_NOTRDY;
-	case DEV_USB :
-		return RES_NOTRDY;
+		return RAM_disk_write(buff, sector, count);
+#ifdef LINUX_PLATFORM
+	case DEV_FILE :
+		return FILE_disk_write(buff, sector, count);
+#endif
 	}
 
 	return RES_PARERR;
@@ -167,32 +211,32 @@ DRESULT disk_ioctl (
 {
 	switch(pdrv) {
 	case DEV_SD:
-		switch (cmd){
-		case CTRL_SYNC: return RES_OK;
-		case GET_SECTOR_COUNT:
-			*(LBA_t *)buff = sd_desc->memory_size / DATA_BLOCK_LEN;
-			return RES_OK;
-		case GET_SECTOR_SIZE:
-			/* Sector size in FatFs is the name for
-			 * data block size in the SD card specification */
-			*(WORD *)buff = DATA_BLOCK_LEN;
-			return RES_OK;
-		case GET_BLOCK_SIZE:
-			/* Block size in FatFs is the name for
-			 * sector size in the SD card specification */
-			*(DWORD *)buff = ERASE_SECTOR_SIZE;
-			return RES_OK;
-		default: return RES_OK;
-		}
-		return RES_PARERR;
+		return SD_disk_ioctl(cmd, buff);
 	case DEV_RAM:
-		return RES_NOTRDY;
-	case DEV_USB:
-		return RES_NOTRDY;
+		return RAM_disk_ioctl(cmd, buff);
+#ifdef LINUX_PLATFORM
+	case DEV_FILE:
+		return FILE_disk_ioctl(cmd, buff);
+#endif
 	}
 	return RES_PARERR;
 }
 
+/**
+ * Check that a sector range is inside a drive.
+ * @param sector - First sector.
+ * @param count - Number of sectors.
+ * @param sectors - Number of sectors of the drive.
+ * @return RES_OK if the range is valid, RES_PARERR otherwise.
+ */
+static DRESULT check_range(LBA_t sector, LBA_t count, LBA_t sectors)
+{
+	if (!count || sector >= sectors || count > sectors - sector)
+		return RES_PARERR;
+
+	return RES_OK;
+}
+
 DSTATUS SD_disk_status()
 {
 	if (sd_init_var)
@@ -220,14 +264,244 @@ DRESULT SD_disk_read(BYTE *buff, LBA_t sector, UINT count)
 	return RES_OK;
 }
 
-DRESULT SD_disk_write(BYTE *buff, LBA_t sector, UINT count)
+DRESULT SD_disk_write(const BYTE *buff, LBA_t sector, UINT count)
 {
 	if (!sd_init_var)
 		return RES_NOTRDY;
-	if (SUCCESS != sd_write(sd_desc, buff, (uint64_t)sector * 512, (uint64_t)count * 512))
+	if (SUCCESS != sd_write(sd_desc, (BYTE *)buff, (uint64_t)sector * 512,
+				(uint64_t)count * 512))
+		return RES_ERROR;
+
+	return RES_OK;
+}
+
+DRESULT SD_disk_ioctl(BYTE cmd, void *buff)
+{
+	LBA_t	*range;
+
+	if (!sd_init_var)
+		return RES_NOTRDY;
+
+	switch (cmd) {
+	case CTRL_SYNC:
+		/* Write the blocks held by the SD block cache */
+		if (SUCCESS != sd_flush(sd_desc))
+			return RES_ERROR;
+		return RES_OK;
+	case GET_SECTOR_COUNT:
+		*(LBA_t *)buff = sd_desc->memory_size / SECTOR_SIZE;
+		return RES_OK;
+	case GET_SECTOR_SIZE:
+		*(WORD *)buff = SECTOR_SIZE;
+		return RES_OK;
+	case GET_BLOCK_SIZE:
+		/* Block size in FatFs is the name for
+		 * erase sector size in the SD card specification */
+		*(DWORD *)buff = sd_desc->erase_blocks;
+		return RES_OK;
+	case CTRL_TRIM:
+		/* Inclusive range of sectors */
+		range = buff;
+		if (range[1] < range[0] ||
+		    check_range(range[0], range[1] - range[0] + 1,
+				sd_desc->memory_size / SECTOR_SIZE) != RES_OK)
+			return RES_PARERR;
+		if (SUCCESS != sd_erase(sd_desc, (uint64_t)range[0] * SECTOR_SIZE,
+					(uint64_t)(range[1] - range[0] + 1) *
+					SECTOR_SIZE))
+			return RES_ERROR;
+		return RES_OK;
+	default:
+		return RES_PARERR;
+	}
+}
+
+/**
+ * Attach the ramdisk (physical drive 1) to a memory region.
+ * @param mem - The memory region, NULL to detach the ramdisk.
+ * @param size - Size of the region in bytes, rounded down to a whole number
+ * 		 of sectors.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t ram_disk_attach(uint8_t *mem, uint64_t size)
+{
+	if (mem && size < SECTOR_SIZE)
+		return FAILURE;
+
+	ram_disk.mem = mem;
+	ram_disk.sectors = mem ? size / SECTOR_SIZE : 0;
+
+	return SUCCESS;
+}
+
+static DRESULT RAM_disk_read(BYTE *buff, LBA_t sector, UINT count)
+{
+	if (!ram_disk.mem)
+		return RES_NOTRDY;
+	if (check_range(sector, count, ram_disk.sectors) != RES_OK)
+		return RES_PARERR;
+
+	memcpy(buff, ram_disk.mem + (size_t)sector * SECTOR_SIZE,
+	       (size_t)count * SECTOR_SIZE);
+
+	return RES_OK;
+}
+
+static DRESULT RAM_disk_write(const BYTE *buff, LBA_t sector, UINT count)
+{
+	if (!ram_disk.mem)
+		return RES_NOTRDY;
+	if (check_range(sector, count, ram_disk.sectors) != RES_OK)
+		return RES_PARERR;
+
+	memcpy(ram_disk.mem + (size_t)sector * SECTOR_SIZE, buff,
+	       (size_t)count * SECTOR_SIZE);
+
+	return RES_OK;
+}
+
+static DRESULT RAM_disk_ioctl(BYTE cmd, void *buff)
+{
+	if (!ram_disk.mem)
+		return RES_NOTRDY;
+
+	switch (cmd) {
+	case CTRL_SYNC:
+		return RES_OK;
+	case GET_SECTOR_COUNT:
+		*(LBA_t *)buff = ram_disk.sectors;
+		return RES_OK;
+	case GET_SECTOR_SIZE:
+		*(WORD *)buff = SECTOR_SIZE;
+		return RES_OK;
+	case GET_BLOCK_SIZE:
+		/* Not a flash memory */
+		*(DWORD *)buff = 1;
+		return RES_OK;
+	case CTRL_TRIM:
+		/* Nothing to release */
+		return RES_OK;
+	default:
+		return RES_PARERR;
+	}
+}
+
+#ifdef LINUX_PLATFORM
+
+/**
+ * Attach the host drive (physical drive 2) to an image file.
+ * @param path - The image file, NULL to detach the drive.
+ * @param size - Drive size in bytes, 0 to use the size of the image. The
+ * 		 image is created or extended to this size if needed.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t file_disk_attach(const char *path, uint64_t size)
+{
+	FILE	*file;
+	off_t	len;
+
+	if (file_disk.file) {
+		fclose(file_disk.file);
+		file_disk.file = NULL;
+		file_disk.sectors = 0;
+	}
+	if (!path)
+		return SUCCESS;
+
+	file = fopen(path, "r+b");
+	if (!file && size)
+		file = fopen(path, "w+b");
+	if (!file)
+		return FAILURE;
+
+	if (fseeko(file, 0, SEEK_END) || (len = ftello(file)) < 0)
+		goto error;
+	if (!size)
+		size = len;
+	else if ((uint64_t)len < size && ftruncate(fileno(file), size))
+		goto error;
+	if (size < SECTOR_SIZE)
+		goto error;
+
+	file_disk.file = file;
+	file_disk.sectors = size / SECTOR_SIZE;
+
+	return SUCCESS;
+error:
+	fclose(file);
+	return FAILURE;
+}
+
+static DRESULT FILE_disk_read(BYTE *buff, LBA_t sector, UINT count)
+{
+	if (!file_disk.file)
+		return RES_NOTRDY;
+	if (check_range(sector, count, file_disk.sectors) != RES_OK)
+		return RES_PARERR;
+
+	if (fseeko(file_disk.file, (off_t)sector * SECTOR_SIZE, SEEK_SET))
+		return RES_ERROR;
+	if (fread(buff, SECTOR_SIZE, count, file_disk.file) != count)
+		return RES_ERROR;
+
+	return RES_OK;
+}
+
+static DRESULT FILE_disk_write(const BYTE *buff, LBA_t sector, UINT count)
+{
+	if (!file_disk.file)
+		return RES_NOTRDY;
+	if (check_range(sector, count, file_disk.sectors) != RES_OK)
+		return RES_PARERR;
+
+	if (fseeko(file_disk.file, (off_t)sector * SECTOR_SIZE, SEEK_SET))
+		return RES_ERROR;
+	if (fwrite(buff, SECTOR_SIZE, count, file_disk.file) != count)
 		return RES_ERROR;
 
 	return RES_OK;
 }
 
+static DRESULT FILE_disk_ioctl(BYTE cmd, void *buff)
+{
+	LBA_t	*range;
+
+	if (!file_disk.file)
+		return RES_NOTRDY;
 
+	switch (cmd) {
+	case CTRL_SYNC:
+		if (fflush(file_disk.file))
+			return RES_ERROR;
+		return RES_OK;
+	case GET_SECTOR_COUNT:
+		*(LBA_t *)buff = file_disk.sectors;
+		return RES_OK;
+	case GET_SECTOR_SIZE:
+		*(WORD *)buff = SECTOR_SIZE;
+		return RES_OK;
+	case GET_BLOCK_SIZE:
+		/* Not a flash memory */
+		*(DWORD *)buff = 1;
+		return RES_OK;
+	case CTRL_TRIM:
+		/* Inclusive range of sectors, released from the image */
+		range = buff;
+		if (range[1] < range[0] ||
+		    check_range(range[0], range[1] - range[0] + 1,
+				file_disk.sectors) != RES_OK)
+			return RES_PARERR;
+		if (fflush(file_disk.file))
+			return RES_ERROR;
+		/* Advisory, file systems without hole punching keep the data */
+		fallocate(fileno(file_disk.file),
+			  FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+			  (off_t)range[0] * SECTOR_SIZE,
+			  (off_t)(range[1] - range[0] + 1) * SECTOR_SIZE);
+		return RES_OK;
+	default:
+		return RES_PARERR;
+	}
+}
+
+#endif
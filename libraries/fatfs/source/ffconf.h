@@ -38,8 +38,11 @@
 /  f_findnext(). (0:Disable, 1:Enable 2:Enable with matching altname[] too) */
 
 
+#ifndef FF_USE_MKFS
 #define FF_USE_MKFS		0
-/* This option switches f_mkfs() function. (0:Disable or 1:Enable) */
+#endif
+/* This option switches f_mkfs() function. (0:Disable or 1:Enable)
+/  Projects formatting the ramdisk or file drives build with -D FF_USE_MKFS=1. */
 
 
 #define FF_USE_FASTSEEK	0
@@ -163,8 +166,11 @@
 / Drive/Volume Configurations
 /---------------------------------------------------------------------------*/
 
+#ifndef FF_VOLUMES
 #define FF_VOLUMES		1
-/* Number of volumes (logical drives) to be used. (1-10) */
+#endif
+/* Number of volumes (logical drives) to be used. (1-10)
+/  Projects using the ramdisk or file drives build with -D FF_VOLUMES=3. */
 
 
 #define FF_STR_VOLUME_ID	0
@@ -13,16 +13,19 @@ SRCS := $(PROJECT)/src/main.c
 SRCS += $(PROJECT)/src/ad9361_api.c					\
 	$(PROJECT)/src/ad9361.c						\
 	$(PROJECT)/src/ad9361_conv.c					\
-	$(PROJECT)/src/ad9361_util.c
+	$(PROJECT)/src/ad9361_util.c					\
+	$(PROJECT)/src/ad9361_sweep.c
 SRCS += $(DRIVERS)/axi_core/axi_adc_core/axi_adc_core.c			\
 	$(DRIVERS)/axi_core/axi_dac_core/axi_dac_core.c			\
 	$(DRIVERS)/axi_core/axi_dmac/axi_dmac.c				\
 	$(DRIVERS)/axi_core/clk_axi_clkgen/clk_axi_clkgen.c		\
 	$(DRIVERS)/axi_core/jesd204/axi_adxcvr.c			\
+	$(DRIVERS)/axi_core/jesd204/axi_adxcvr_eyescan.c		\
 	$(DRIVERS)/axi_core/jesd204/axi_jesd204_rx.c			\
 	$(DRIVERS)/axi_core/jesd204/axi_jesd204_tx.c			\
 	$(DRIVERS)/axi_core/jesd204/xilinx_transceiver.c		\
-	$(NO-OS)/util/util.c
+	$(NO-OS)/util/util.c						\
+	$(NO-OS)/util/clk_solver.c
 SRCS +=	$(PLATFORM_DRIVERS)/axi_io.c					\
 	$(PLATFORM_DRIVERS)/spi.c					\
 	$(PLATFORM_DRIVERS)/gpio.c					\
@@ -33,7 +36,9 @@ SRCS += $(PLATFORM_DRIVERS)/uart.c					\
 	$(NO-OS)/util/xml.c						\
 	$(NO-OS)/util/fifo.c						\
 	$(NO-OS)/iio/iio.c						\
+	$(NO-OS)/iio/iio_format.c					\
 	$(NO-OS)/iio/iio_ad9361/iio_ad9361.c				\
+	$(NO-OS)/iio/iio_ad9361_sweep/iio_ad9361_sweep.c		\
 	$(NO-OS)/iio/iio_app/iio_app.c					\
 	$(NO-OS)/iio/iio_axi_adc/iio_axi_adc.c				\
 	$(NO-OS)/iio/iio_axi_dac/iio_axi_dac.c
@@ -43,12 +48,14 @@ INCS := $(PROJECT)/src/common.h						\
 INCS += $(PROJECT)/src/ad9361.h						\
 	$(PROJECT)/src/parameters.h					\
 	$(PROJECT)/src/ad9361_util.h					\
-	$(PROJECT)/src/ad9361_api.h
+	$(PROJECT)/src/ad9361_api.h					\
+	$(PROJECT)/src/ad9361_sweep.h
 INCS += $(DRIVERS)/axi_core/axi_adc_core/axi_adc_core.h			\
 	$(DRIVERS)/axi_core/axi_dac_core/axi_dac_core.h			\
 	$(DRIVERS)/axi_core/axi_dmac/axi_dmac.h				\
 	$(DRIVERS)/axi_core/clk_axi_clkgen/clk_axi_clkgen.h		\
 	$(DRIVERS)/axi_core/jesd204/axi_adxcvr.h			\
+	$(DRIVERS)/axi_core/jesd204/axi_adxcvr_eyescan.h		\
 	$(DRIVERS)/axi_core/jesd204/axi_jesd204_rx.h			\
 	$(DRIVERS)/axi_core/jesd204/axi_jesd204_tx.h			\
 	$(DRIVERS)/axi_core/jesd204/xilinx_transceiver.h
@@ -59,7 +66,8 @@ INCS +=	$(INCLUDE)/axi_io.h						\
 	$(INCLUDE)/gpio.h						\
 	$(INCLUDE)/error.h						\
 	$(INCLUDE)/delay.h						\
-	$(INCLUDE)/util.h
+	$(INCLUDE)/util.h						\
+	$(INCLUDE)/clk_solver.h
 ifeq (y,$(strip $(TINYIIOD)))
 INCS += $(INCLUDE)/xml.h						\
 	$(INCLUDE)/fifo.h						\
@@ -69,7 +77,9 @@ INCS += $(INCLUDE)/xml.h						\
 	$(PLATFORM_DRIVERS)/uart_extra.h				\
 	$(NO-OS)/iio/iio.h						\
 	$(NO-OS)/iio/iio_types.h					\
+	$(NO-OS)/iio/iio_format.h					\
 	$(NO-OS)/iio/iio_ad9361/iio_ad9361.h				\
+	$(NO-OS)/iio/iio_ad9361_sweep/iio_ad9361_sweep.h		\
 	$(NO-OS)/iio/iio_app/iio_app.h					\
 	$(NO-OS)/iio/iio_axi_adc/iio_axi_adc.h				\
 	$(NO-OS)/iio/iio_axi_dac/iio_axi_dac.h				\
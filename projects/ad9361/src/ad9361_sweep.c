@@ -0,0 +1,592 @@
+/***************************************************************************//**
+ *   @file   ad9361_sweep.c
+ *   @brief  Implementation of the AD9361 wideband spectrum sweep engine.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include "ad9361_api.h"
+#include "ad9361_sweep.h"
+#include "axi_adc_core.h"
+#include "axi_dmac.h"
+#include "delay.h"
+#include "error.h"
+#include "util.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define AD9361_SWEEP_NEON
+#endif
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define AD9361_SWEEP_PI			3.14159265358979f
+/* Equivalent noise bandwidth of the Hann window, in 1/2 bins. */
+#define AD9361_SWEEP_HANN_ENBW_X2	3
+/* Coherent gain of the Hann window. */
+#define AD9361_SWEEP_HANN_CG		0.5f
+/* 10 * log10(2) * 1000, converts log2(power) to milli-dB. */
+#define AD9361_SWEEP_LOG2_TO_MDB	3010.29996f
+/* Floor applied to the normalized power before the logarithm. */
+#define AD9361_SWEEP_POWER_FLOOR	1e-20f
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * Fast base 2 logarithm, accurate to about 1e-4.
+ * @param x - Strictly positive input.
+ * @return log2(x).
+ */
+static inline float ad9361_sweep_log2f(float x)
+{
+	union {
+		float f;
+		uint32_t i;
+	} u = { .f = x };
+	float e, m;
+
+	/* x = m * 2^e, with m in [0.5, 1) */
+	e = (float)((int32_t)((u.i >> 23) & 0xFF) - 126);
+	u.i = (u.i & 0x007FFFFF) | 0x3F000000;
+	m = u.f;
+
+	return e + ((((1.23149591f * m) - 4.11852516f) * m + 6.02197014f) * m -
+		    3.13396450f);
+}
+
+#ifdef AD9361_SWEEP_NEON
+/**
+ * Vector version of ad9361_sweep_log2f().
+ * @param x - Strictly positive inputs.
+ * @return log2(x).
+ */
+static inline float32x4_t ad9361_sweep_log2q_f32(float32x4_t x)
+{
+	uint32x4_t bits = vreinterpretq_u32_f32(x);
+	int32x4_t exp;
+	float32x4_t e, m, y;
+
+	exp = vreinterpretq_s32_u32(vshrq_n_u32(bits, 23));
+	exp = vsubq_s32(vandq_s32(exp, vdupq_n_s32(0xFF)), vdupq_n_s32(126));
+	e = vcvtq_f32_s32(exp);
+	bits = vorrq_u32(vandq_u32(bits, vdupq_n_u32(0x007FFFFF)),
+			 vdupq_n_u32(0x3F000000));
+	m = vreinterpretq_f32_u32(bits);
+
+	y = vmlaq_f32(vdupq_n_f32(-4.11852516f), vdupq_n_f32(1.23149591f), m);
+	y = vmlaq_f32(vdupq_n_f32(6.02197014f), y, m);
+	y = vmlaq_f32(vdupq_n_f32(-3.13396450f), y, m);
+
+	return vaddq_f32(e, y);
+}
+#endif
+
+/**
+ * Release the plan buffers.
+ * @param desc - The sweep descriptor.
+ */
+static void ad9361_sweep_free_plan(struct ad9361_sweep_desc *desc)
+{
+	free(desc->window);
+	free(desc->twiddle);
+	free(desc->bitrev);
+	free(desc->fft_buf);
+	free(desc->trace);
+	desc->window = NULL;
+	desc->twiddle = NULL;
+	desc->bitrev = NULL;
+	desc->fft_buf = NULL;
+	desc->trace = NULL;
+	desc->plan_valid = false;
+}
+
+/**
+ * Smallest FFT length giving a Hann window resolution bandwidth at or below
+ * the requested one.
+ * @param fs - Sample rate (Hz).
+ * @param rbw_hz - Requested resolution bandwidth (Hz).
+ * @return The FFT length, 0 if it would exceed AD9361_SWEEP_FFT_SIZE_MAX.
+ */
+static uint32_t ad9361_sweep_fft_size(uint32_t fs, uint32_t rbw_hz)
+{
+	uint32_t n;
+
+	for (n = AD9361_SWEEP_FFT_SIZE_MIN; n <= AD9361_SWEEP_FFT_SIZE_MAX;
+	     n <<= 1)
+		if ((uint64_t)fs * AD9361_SWEEP_HANN_ENBW_X2 <=
+		    (uint64_t)rbw_hz * n * 2)
+			return n;
+
+	return 0;
+}
+
+/**
+ * Compute the sweep plan for the current settings.
+ *
+ * The FFT length is the smallest power of two giving a Hann window
+ * resolution bandwidth at or below the requested one. Only the central
+ * AD9361_SWEEP_USABLE_BW_PCT of every step is kept, so the LO is advanced
+ * by exactly that many bins and the steps stitch without gaps.
+ * @param desc - The sweep descriptor.
+ * @return 0 in case of success, -EINVAL if the requested resolution
+ *         bandwidth cannot be reached with AD9361_SWEEP_FFT_SIZE_MAX points,
+ *         negative error code otherwise.
+ */
+int32_t ad9361_sweep_plan(struct ad9361_sweep_desc *desc)
+{
+	uint32_t fs, n, bits, i, j, r;
+	int32_t ret;
+
+	if (!desc)
+		return -EINVAL;
+
+	ret = ad9361_get_rx_sampling_freq(desc->phy, &fs);
+	if (ret < 0)
+		return ret;
+
+	if (desc->plan_valid && desc->sampling_freq_hz == fs)
+		return SUCCESS;
+
+	if (!fs || !desc->rbw_hz || !desc->span_hz)
+		return -EINVAL;
+
+	n = ad9361_sweep_fft_size(fs, desc->rbw_hz);
+	if (!n)
+		return -EINVAL;
+
+	ad9361_sweep_free_plan(desc);
+
+	desc->sampling_freq_hz = fs;
+	desc->fft_size = n;
+	/* Multiple of 8 so each half splits into 4-bin vectors */
+	desc->bins_per_step = ((n * AD9361_SWEEP_USABLE_BW_PCT) / 100) & ~7;
+	desc->step_hz = div_u64((uint64_t)desc->bins_per_step * fs, n);
+	desc->num_steps = DIV_ROUND_UP(desc->span_hz, desc->step_hz);
+	desc->num_points = desc->num_steps * desc->bins_per_step;
+
+	desc->window = calloc(n, sizeof(*desc->window));
+	desc->twiddle = calloc(n, sizeof(*desc->twiddle));
+	desc->bitrev = calloc(n, sizeof(*desc->bitrev));
+	desc->fft_buf = calloc(2 * n, sizeof(*desc->fft_buf));
+	desc->trace = calloc(desc->num_points, sizeof(*desc->trace));
+	if (!desc->window || !desc->twiddle || !desc->bitrev ||
+	    !desc->fft_buf || !desc->trace) {
+		ad9361_sweep_free_plan(desc);
+		return -ENOMEM;
+	}
+
+	bits = log_base_2(n);
+	for (i = 0; i < n; i++) {
+		desc->window[i] = 0.5f - 0.5f *
+				  cosf(2 * AD9361_SWEEP_PI * i / n);
+		for (j = 0, r = 0; j < bits; j++)
+			r |= ((i >> j) & 1) << (bits - 1 - j);
+		desc->bitrev[i] = r;
+	}
+	for (i = 0; i < n / 2; i++) {
+		desc->twiddle[2 * i] = cosf(2 * AD9361_SWEEP_PI * i / n);
+		desc->twiddle[2 * i + 1] = -sinf(2 * AD9361_SWEEP_PI * i / n);
+	}
+
+	desc->plan_valid = true;
+
+	return SUCCESS;
+}
+
+/**
+ * Load the captured samples of the sweep channel into the FFT buffer,
+ * applying the window.
+ * @param desc - The sweep descriptor.
+ */
+static void ad9361_sweep_load(struct ad9361_sweep_desc *desc)
+{
+	const int16_t *data = (const int16_t *)(uintptr_t)desc->ddr_base;
+	uint32_t stride = desc->phy->rx_adc->num_channels;
+	uint32_t n = desc->fft_size;
+	float *x = desc->fft_buf;
+	uint32_t i;
+
+	data += 2 * desc->rx_ch;
+	for (i = 0; i < n; i++) {
+		x[2 * i] = data[i * stride];
+		x[2 * i + 1] = data[i * stride + 1];
+	}
+
+#ifdef AD9361_SWEEP_NEON
+	for (i = 0; i < n; i += 4) {
+		float32x4x2_t v = vld2q_f32(&x[2 * i]);
+		float32x4_t w = vld1q_f32(&desc->window[i]);
+
+		v.val[0] = vmulq_f32(v.val[0], w);
+		v.val[1] = vmulq_f32(v.val[1], w);
+		vst2q_f32(&x[2 * i], v);
+	}
+#else
+	for (i = 0; i < n; i++) {
+		x[2 * i] *= desc->window[i];
+		x[2 * i + 1] *= desc->window[i];
+	}
+#endif
+}
+
+/**
+ * In place radix-2 decimation in time FFT of the work buffer.
+ * @param desc - The sweep descriptor.
+ */
+static void ad9361_sweep_fft(struct ad9361_sweep_desc *desc)
+{
+	const float *tw = desc->twiddle;
+	uint32_t n = desc->fft_size;
+	float *x = desc->fft_buf;
+	uint32_t i, j, k, len, half, step, a, b;
+	float tr, ti, wr, wi;
+
+	for (i = 0; i < n; i++) {
+		j = desc->bitrev[i];
+		if (j > i) {
+			tr = x[2 * i];
+			ti = x[2 * i + 1];
+			x[2 * i] = x[2 * j];
+			x[2 * i + 1] = x[2 * j + 1];
+			x[2 * j] = tr;
+			x[2 * j + 1] = ti;
+		}
+	}
+
+	for (len = 2; len <= n; len <<= 1) {
+		half = len >> 1;
+		step = n / len;
+		for (i = 0; i < n; i += len) {
+			for (k = 0; k < half; k++) {
+				wr = tw[2 * k * step];
+				wi = tw[2 * k * step + 1];
+				a = 2 * (i + k);
+				b = 2 * (i + k + half);
+				tr = x[b] * wr - x[b + 1] * wi;
+				ti = x[b] * wi + x[b + 1] * wr;
+				x[b] = x[a] - tr;
+				x[b + 1] = x[a + 1] - ti;
+				x[a] += tr;
+				x[a + 1] += ti;
+			}
+		}
+	}
+}
+
+/**
+ * Convert consecutive FFT bins to milli-dBFS.
+ * @param x - Interleaved re/im bins.
+ * @param out - Output power values.
+ * @param count - Number of bins, multiple of 4.
+ * @param scale - Normalization factor applied to the bin power.
+ */
+static void ad9361_sweep_power(const float *x, int32_t *out, uint32_t count,
+			       float scale)
+{
+	uint32_t i;
+#ifdef AD9361_SWEEP_NEON
+	float32x4_t vscale = vdupq_n_f32(scale);
+	float32x4_t vfloor = vdupq_n_f32(AD9361_SWEEP_POWER_FLOOR);
+	float32x4_t vmdb = vdupq_n_f32(AD9361_SWEEP_LOG2_TO_MDB);
+
+	for (i = 0; i < count; i += 4) {
+		float32x4x2_t v = vld2q_f32(&x[2 * i]);
+		float32x4_t p;
+
+		p = vmulq_f32(v.val[0], v.val[0]);
+		p = vmlaq_f32(p, v.val[1], v.val[1]);
+		p = vmaxq_f32(vmulq_f32(p, vscale), vfloor);
+		p = vmulq_f32(ad9361_sweep_log2q_f32(p), vmdb);
+		vst1q_s32(&out[i], vcvtq_s32_f32(p));
+	}
+#else
+	float p;
+
+	for (i = 0; i < count; i++) {
+		p = x[2 * i] * x[2 * i] + x[2 * i + 1] * x[2 * i + 1];
+		p = max(p * scale, AD9361_SWEEP_POWER_FLOOR);
+		out[i] = (int32_t)(ad9361_sweep_log2f(p) * AD9361_SWEEP_LOG2_TO_MDB);
+	}
+#endif
+}
+
+/**
+ * Compute the spectrum of the loaded step and store its central bins into
+ * the trace, lowest frequency first.
+ * @param desc - The sweep descriptor.
+ * @param step - Step index.
+ */
+static void ad9361_sweep_process(struct ad9361_sweep_desc *desc,
+				 uint32_t step)
+{
+	uint32_t n = desc->fft_size;
+	uint32_t half = desc->bins_per_step / 2;
+	int32_t *out = desc->trace + step * desc->bins_per_step;
+	float fs_amp, scale;
+
+	ad9361_sweep_fft(desc);
+
+	fs_amp = (float)AD9361_SWEEP_FULL_SCALE * n * AD9361_SWEEP_HANN_CG;
+	scale = 1.0f / (fs_amp * fs_amp);
+
+	/* Negative frequencies first, then DC and the positive ones */
+	ad9361_sweep_power(&desc->fft_buf[2 * (n - half)], out, half, scale);
+	ad9361_sweep_power(desc->fft_buf, out + half, half, scale);
+
+	/* Hide the LO leakage in the DC bin */
+	out[half] = (out[half - 1] + out[half + 1]) / 2;
+}
+
+/**
+ * Capture one step worth of samples.
+ * @param desc - The sweep descriptor.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t ad9361_sweep_capture(struct ad9361_sweep_desc *desc)
+{
+	uint32_t bytes;
+	int32_t ret;
+
+	bytes = desc->fft_size * desc->phy->rx_adc->num_channels *
+		sizeof(int16_t);
+
+	desc->phy->rx_dmac->flags = 0;
+	ret = axi_dmac_transfer(desc->phy->rx_dmac, desc->ddr_base, bytes);
+	if (ret < 0)
+		return ret;
+
+	if (desc->dcache_invalidate_range)
+		desc->dcache_invalidate_range(desc->ddr_base, bytes);
+
+	return SUCCESS;
+}
+
+/**
+ * Get the LO frequency of a step.
+ * @param desc - The sweep descriptor.
+ * @param step - Step index.
+ * @return The LO frequency (Hz).
+ */
+static inline uint64_t ad9361_sweep_step_lo(struct ad9361_sweep_desc *desc,
+		uint32_t step)
+{
+	return desc->start_freq_hz + desc->step_hz * step + desc->step_hz / 2;
+}
+
+/**
+ * Run a full sweep and stitch the steps into the trace.
+ *
+ * The retune of step k + 1 is issued right after the samples of step k are
+ * loaded, so the synthesizer settles while step k is transformed. The dwell
+ * time is only waited after the processing is done.
+ * The RX LO is restored to its initial frequency at the end of the sweep.
+ * @param desc - The sweep descriptor.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_sweep_run(struct ad9361_sweep_desc *desc)
+{
+	uint64_t lo_freq_hz;
+	uint32_t step;
+	int32_t ret, ret2;
+
+	if (!desc)
+		return -EINVAL;
+
+	ret = ad9361_sweep_plan(desc);
+	if (ret < 0)
+		return ret;
+
+	ret = ad9361_get_rx_lo_freq(desc->phy, &lo_freq_hz);
+	if (ret < 0)
+		return ret;
+
+	ret = ad9361_set_rx_lo_freq(desc->phy, ad9361_sweep_step_lo(desc, 0));
+	if (ret < 0)
+		goto restore;
+	udelay(desc->dwell_us);
+	ret = ad9361_sweep_capture(desc);
+	if (ret < 0)
+		goto restore;
+
+	for (step = 0; step < desc->num_steps; step++) {
+		ad9361_sweep_load(desc);
+
+		if (step + 1 < desc->num_steps) {
+			ret = ad9361_set_rx_lo_freq(desc->phy,
+						    ad9361_sweep_step_lo(desc, step + 1));
+			if (ret < 0)
+				goto restore;
+		}
+
+		ad9361_sweep_process(desc, step);
+
+		if (step + 1 < desc->num_steps) {
+			udelay(desc->dwell_us);
+			ret = ad9361_sweep_capture(desc);
+			if (ret < 0)
+				goto restore;
+		}
+	}
+
+restore:
+	ret2 = ad9361_set_rx_lo_freq(desc->phy, lo_freq_hz);
+
+	return ret < 0 ? ret : ret2;
+}
+
+/**
+ * Set the swept span.
+ * @param desc - The sweep descriptor.
+ * @param start_freq_hz - Lower edge of the span (Hz).
+ * @param span_hz - Span (Hz).
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_sweep_set_span(struct ad9361_sweep_desc *desc,
+			      uint64_t start_freq_hz, uint64_t span_hz)
+{
+	if (!desc || !span_hz)
+		return -EINVAL;
+
+	desc->start_freq_hz = start_freq_hz;
+	desc->span_hz = span_hz;
+	desc->plan_valid = false;
+
+	return SUCCESS;
+}
+
+/**
+ * Set the resolution bandwidth.
+ * @param desc - The sweep descriptor.
+ * @param rbw_hz - Requested resolution bandwidth (Hz).
+ * @return 0 in case of success, -EINVAL if the resolution bandwidth cannot be
+ *         reached at the current sample rate, negative error code otherwise.
+ */
+int32_t ad9361_sweep_set_rbw(struct ad9361_sweep_desc *desc, uint32_t rbw_hz)
+{
+	uint32_t fs;
+	int32_t ret;
+
+	if (!desc || !rbw_hz)
+		return -EINVAL;
+
+	ret = ad9361_get_rx_sampling_freq(desc->phy, &fs);
+	if (ret < 0)
+		return ret;
+	if (!ad9361_sweep_fft_size(fs, rbw_hz))
+		return -EINVAL;
+
+	desc->rbw_hz = rbw_hz;
+	desc->plan_valid = false;
+
+	return SUCCESS;
+}
+
+/**
+ * Set the per step settling time.
+ * @param desc - The sweep descriptor.
+ * @param dwell_us - Settling time (us).
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_sweep_set_dwell(struct ad9361_sweep_desc *desc,
+			       uint32_t dwell_us)
+{
+	if (!desc)
+		return -EINVAL;
+
+	desc->dwell_us = dwell_us;
+
+	return SUCCESS;
+}
+
+/**
+ * Initialize the sweep engine.
+ * @param desc - The sweep descriptor.
+ * @param init - The initialization parameters.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_sweep_init(struct ad9361_sweep_desc **desc,
+			  const struct ad9361_sweep_init_param *init)
+{
+	struct ad9361_sweep_desc *sweep;
+
+	if (!desc || !init || !init->phy)
+		return -EINVAL;
+
+	if (!init->phy->rx_adc || !init->phy->rx_dmac || init->rx_ch > 1)
+		return -EINVAL;
+
+	sweep = calloc(1, sizeof(*sweep));
+	if (!sweep)
+		return -ENOMEM;
+
+	sweep->phy = init->phy;
+	sweep->rx_ch = init->rx_ch;
+	sweep->ddr_base = init->ddr_base;
+	sweep->start_freq_hz = init->start_freq_hz;
+	sweep->span_hz = init->span_hz;
+	sweep->rbw_hz = init->rbw_hz;
+	sweep->dwell_us = init->dwell_us;
+	sweep->dcache_invalidate_range = init->dcache_invalidate_range;
+
+	*desc = sweep;
+
+	return SUCCESS;
+}
+
+/**
+ * Free the resources allocated by ad9361_sweep_init().
+ * @param desc - The sweep descriptor.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_sweep_remove(struct ad9361_sweep_desc *desc)
+{
+	if (!desc)
+		return -EINVAL;
+
+	ad9361_sweep_free_plan(desc);
+	free(desc);
+
+	return SUCCESS;
+}
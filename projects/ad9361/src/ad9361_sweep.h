@@ -0,0 +1,153 @@
+/***************************************************************************//**
+ *   @file   ad9361_sweep.h
+ *   @brief  Header file of the AD9361 wideband spectrum sweep engine.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+#ifndef AD9361_SWEEP_H_
+#define AD9361_SWEEP_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "ad9361.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define AD9361_SWEEP_FFT_SIZE_MIN	64
+#define AD9361_SWEEP_FFT_SIZE_MAX	4096
+/* Percentage of the sampled band that is kept from every sweep step. */
+#define AD9361_SWEEP_USABLE_BW_PCT	80
+/* Full scale of the 12-bit AD9361 samples. */
+#define AD9361_SWEEP_FULL_SCALE		2048
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+/**
+ * @struct ad9361_sweep_init_param
+ * @brief Sweep engine initialization parameters.
+ */
+struct ad9361_sweep_init_param {
+	/** AD9361 device instance */
+	struct ad9361_rf_phy *phy;
+	/** Receive channel used for the sweep (0 or 1) */
+	uint8_t rx_ch;
+	/** DDR address used by the receive DMA for the step captures */
+	uint32_t ddr_base;
+	/** Lower edge of the swept span */
+	uint64_t start_freq_hz;
+	/** Swept span */
+	uint64_t span_hz;
+	/** Requested resolution bandwidth */
+	uint32_t rbw_hz;
+	/** Settling time waited between the retune and the capture of a step */
+	uint32_t dwell_us;
+	/** Invalidate the Data cache for the given address range */
+	void (*dcache_invalidate_range)(uint32_t address, uint32_t bytes_count);
+};
+
+/**
+ * @struct ad9361_sweep_desc
+ * @brief Sweep engine descriptor.
+ */
+struct ad9361_sweep_desc {
+	/** AD9361 device instance */
+	struct ad9361_rf_phy *phy;
+	/** Receive channel used for the sweep */
+	uint8_t rx_ch;
+	/** DDR address used by the receive DMA */
+	uint32_t ddr_base;
+	/** Lower edge of the swept span */
+	uint64_t start_freq_hz;
+	/** Swept span */
+	uint64_t span_hz;
+	/** Requested resolution bandwidth */
+	uint32_t rbw_hz;
+	/** Settling time waited between the retune and the capture of a step */
+	uint32_t dwell_us;
+	/** Invalidate the Data cache for the given address range */
+	void (*dcache_invalidate_range)(uint32_t address, uint32_t bytes_count);
+	/** Sample rate the current plan was computed for */
+	uint32_t sampling_freq_hz;
+	/** FFT length of every step */
+	uint32_t fft_size;
+	/** Number of FFT bins kept from every step */
+	uint32_t bins_per_step;
+	/** LO increment between two consecutive steps */
+	uint64_t step_hz;
+	/** Number of LO steps needed to cover the span */
+	uint32_t num_steps;
+	/** Number of points of the stitched trace */
+	uint32_t num_points;
+	/** Set when the plan matches the current settings */
+	bool plan_valid;
+	/** Hann window coefficients */
+	float *window;
+	/** Interleaved cos/sin FFT twiddle factors */
+	float *twiddle;
+	/** Bit reversal permutation */
+	uint16_t *bitrev;
+	/** Interleaved re/im FFT work buffer */
+	float *fft_buf;
+	/** Stitched power trace, in milli-dBFS */
+	int32_t *trace;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+/* Initialize the sweep engine. */
+int32_t ad9361_sweep_init(struct ad9361_sweep_desc **desc,
+			  const struct ad9361_sweep_init_param *init);
+/* Free the resources allocated by ad9361_sweep_init(). */
+int32_t ad9361_sweep_remove(struct ad9361_sweep_desc *desc);
+/* Set the swept span. */
+int32_t ad9361_sweep_set_span(struct ad9361_sweep_desc *desc,
+			      uint64_t start_freq_hz, uint64_t span_hz);
+/* Set the resolution bandwidth. */
+int32_t ad9361_sweep_set_rbw(struct ad9361_sweep_desc *desc, uint32_t rbw_hz);
+/* Set the per step settling time. */
+int32_t ad9361_sweep_set_dwell(struct ad9361_sweep_desc *desc,
+			       uint32_t dwell_us);
+/* Compute the sweep plan for the current settings. */
+int32_t ad9361_sweep_plan(struct ad9361_sweep_desc *desc);
+/* Run a full sweep and stitch the steps into the trace. */
+int32_t ad9361_sweep_run(struct ad9361_sweep_desc *desc);
+
+#endif /* AD9361_SWEEP_H_ */
@@ -64,6 +64,8 @@
 #include "iio_axi_adc.h"
 #include "iio_axi_dac.h"
 #include "iio_ad9361.h"
+#include "iio_ad9361_sweep.h"
+#include "ad9361_sweep.h"
 #include "irq.h"
 #include "irq_extra.h"
 #include "uart.h"
@@ -719,6 +721,26 @@ int main(void)
 	 */
 	struct iio_ad9361_desc *iio_ad9361_desc;
 
+	/**
+	 * Sweep engine configurations.
+	 */
+	struct ad9361_sweep_init_param ad9361_sweep_init_param;
+
+	/**
+	 * Sweep engine instance.
+	 */
+	struct ad9361_sweep_desc *ad9361_sweep_desc;
+
+	/**
+	 * iio sweep configurations.
+	 */
+	struct iio_ad9361_sweep_init_param iio_ad9361_sweep_init_param;
+
+	/**
+	 * iio sweep instance descriptor.
+	 */
+	struct iio_ad9361_sweep_desc *iio_ad9361_sweep_desc;
+
 	/**
 	 * Xilinx platform dependent initialization for IRQ.
 	 */
@@ -821,6 +843,31 @@ int main(void)
 	if (status < 0)
 		return status;
 
+	ad9361_sweep_init_param = (struct ad9361_sweep_init_param) {
+		.phy = ad9361_phy,
+		.rx_ch = 0,
+		.ddr_base = ADC_DDR_BASEADDR,
+		.start_freq_hz = 2400000000ULL,
+		.span_hz = 100000000ULL,
+		.rbw_hz = 30000,
+		.dwell_us = 100,
+		.dcache_invalidate_range = (void (*)(uint32_t,
+						     uint32_t))Xil_DCacheInvalidateRange
+	};
+
+	status = ad9361_sweep_init(&ad9361_sweep_desc, &ad9361_sweep_init_param);
+	if (status < 0)
+		return status;
+
+	iio_ad9361_sweep_init_param = (struct iio_ad9361_sweep_init_param) {
+		.sweep = ad9361_sweep_desc,
+	};
+
+	status = iio_ad9361_sweep_init(&iio_ad9361_sweep_desc,
+				       &iio_ad9361_sweep_init_param);
+	if (status < 0)
+		return status;
+
 	return iio_app(iio_app_desc);
 
 #endif // IIO_EXAMPLE
@@ -30,10 +30,12 @@ SRCS += $(DRIVERS)/axi_core/axi_adc_core/axi_adc_core.c			\
 	$(DRIVERS)/axi_core/axi_dmac/axi_dmac.c				\
 	$(DRIVERS)/axi_core/jesd204/axi_jesd204_rx.c			\
 	$(DRIVERS)/axi_core/jesd204/axi_jesd204_tx.c			\
-	$(NO-OS)/util/util.c
+	$(NO-OS)/util/util.c						\
+	$(NO-OS)/util/clk_solver.c
 ifeq (xilinx,$(strip $(PLATFORM)))
 SRCS += $(DRIVERS)/axi_core/jesd204/xilinx_transceiver.c		\
 	$(DRIVERS)/axi_core/jesd204/axi_adxcvr.c			\
+	$(DRIVERS)/axi_core/jesd204/axi_adxcvr_eyescan.c		\
 	$(DRIVERS)/axi_core/clk_axi_clkgen/clk_axi_clkgen.c
 else
 SRCS += $(DRIVERS)/axi_core/clk_altera_a10_fpll/clk_altera_a10_fpll.c	\
@@ -78,6 +80,7 @@ INCS += $(DRIVERS)/axi_core/axi_adc_core/axi_adc_core.h			\
 ifeq (xilinx,$(strip $(PLATFORM)))
 INCS += $(DRIVERS)/axi_core/jesd204/xilinx_transceiver.h		\
 	$(DRIVERS)/axi_core/jesd204/axi_adxcvr.h			\
+	$(DRIVERS)/axi_core/jesd204/axi_adxcvr_eyescan.h		\
 	$(DRIVERS)/axi_core/clk_axi_clkgen/clk_axi_clkgen.h
 else
 INCS += $(DRIVERS)/axi_core/clk_altera_a10_fpll/clk_altera_a10_fpll.h	\
@@ -92,7 +95,8 @@ INCS +=	$(INCLUDE)/axi_io.h						\
 	$(INCLUDE)/gpio.h						\
 	$(INCLUDE)/error.h						\
 	$(INCLUDE)/delay.h						\
-	$(INCLUDE)/util.h
+	$(INCLUDE)/util.h						\
+	$(INCLUDE)/clk_solver.h
 ifeq (y,$(strip $(TINYIIOD)))
 INCS += $(INCLUDE)/xml.h						\
 	$(INCLUDE)/fifo.h						\
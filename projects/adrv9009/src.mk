@@ -47,13 +47,18 @@ SRCS += $(NO-OS)/util/xml.c						\
 	$(NO-OS)/iio/iio_app/iio_app.c					\
 	$(NO-OS)/iio/iio_axi_adc/iio_axi_adc.c				\
 	$(NO-OS)/iio/iio_axi_dac/iio_axi_dac.c                          \
+	$(NO-OS)/iio/iio_jesd204_rx/iio_jesd204_rx.c			\
 	$(PLATFORM_DRIVERS)/uart.c					\
-	$(PLATFORM_DRIVERS)/irq.c
+	$(PLATFORM_DRIVERS)/irq.c					\
+	$(PLATFORM_DRIVERS)/timer.c
 endif
-SRCS +=	$(NO-OS)/util/util.c
+SRCS +=	$(NO-OS)/util/util.c						\
+	$(NO-OS)/util/clk_solver.c					\
+	$(NO-OS)/util/spi_seq.c
 ifeq (xilinx,$(strip $(PLATFORM)))
 SRCS += $(DRIVERS)/axi_core/jesd204/xilinx_transceiver.c		\
 	$(DRIVERS)/axi_core/jesd204/axi_adxcvr.c			\
+	$(DRIVERS)/axi_core/jesd204/axi_adxcvr_eyescan.c		\
 	$(DRIVERS)/axi_core/clk_axi_clkgen/clk_axi_clkgen.c
 else
 SRCS += $(DRIVERS)/axi_core/clk_altera_a10_fpll/clk_altera_a10_fpll.c	\
@@ -111,6 +116,7 @@ INCS += $(DRIVERS)/axi_core/axi_adc_core/axi_adc_core.h			\
 ifeq (xilinx,$(strip $(PLATFORM)))
 INCS += $(DRIVERS)/axi_core/jesd204/xilinx_transceiver.h		\
 	$(DRIVERS)/axi_core/jesd204/axi_adxcvr.h			\
+	$(DRIVERS)/axi_core/jesd204/axi_adxcvr_eyescan.h		\
 	$(DRIVERS)/axi_core/clk_axi_clkgen/clk_axi_clkgen.h
 else
 INCS += $(DRIVERS)/axi_core/clk_altera_a10_fpll/clk_altera_a10_fpll.h	\
@@ -125,19 +131,24 @@ INCS +=	$(INCLUDE)/axi_io.h						\
 	$(INCLUDE)/gpio.h						\
 	$(INCLUDE)/error.h						\
 	$(INCLUDE)/delay.h						\
-	$(INCLUDE)/util.h
+	$(INCLUDE)/util.h						\
+	$(INCLUDE)/clk_solver.h						\
+	$(INCLUDE)/spi_seq.h
 ifeq (y,$(strip $(TINYIIOD)))
 INCS +=	$(INCLUDE)/xml.h						\
 	$(INCLUDE)/fifo.h						\
 	$(INCLUDE)/irq.h						\
 	$(INCLUDE)/uart.h						\
+	$(INCLUDE)/timer.h						\
 	$(PLATFORM_DRIVERS)/irq_extra.h					\
 	$(PLATFORM_DRIVERS)/uart_extra.h                                \
+	$(PLATFORM_DRIVERS)/timer_extra.h				\
 	$(NO-OS)/iio/iio.h						\
 	$(NO-OS)/iio/iio_types.h					\
 	$(NO-OS)/iio/iio_app/iio_app.h					\
 	$(NO-OS)/iio/iio_axi_adc/iio_axi_adc.h				\
 	$(NO-OS)/iio/iio_axi_dac/iio_axi_dac.h				\
+	$(NO-OS)/iio/iio_jesd204_rx/iio_jesd204_rx.h			\
 	$(NO-OS)/libraries/libtinyiiod/tinyiiod.h			\
 	$(NO-OS)/libraries/libtinyiiod/compat.h
 endif
@@ -156,3 +156,7 @@ void jesd_rx_watchdog(void)
 	axi_jesd204_rx_watchdog(rx_os_jesd);
 }
 
+struct axi_jesd204_rx *jesd_rx_get(void)
+{
+	return rx_jesd;
+}
@@ -42,6 +42,8 @@
 #include <stdint.h>
 #include "adi_hal.h"
 
+struct axi_jesd204_rx;
+
 adiHalErr_t jesd_init(uint32_t rx_div40_rate_hz,
 		      uint32_t tx_div40_rate_hz,
 		      uint32_t rx_os_div40_rate_hz);
@@ -49,5 +51,6 @@ adiHalErr_t jesd_init(uint32_t rx_div40_rate_hz,
 void jesd_deinit(void);
 void jesd_status(void);
 void jesd_rx_watchdog(void);
+struct axi_jesd204_rx *jesd_rx_get(void);
 
 #endif /* __APP_JESD_H */
\ No newline at end of file
@@ -39,10 +39,15 @@
 #include "iio_app.h"
 #include "iio_axi_adc.h"
 #include "iio_axi_dac.h"
+#include "iio_jesd204_rx.h"
 #include "irq.h"
 #include "irq_extra.h"
 #include "uart.h"
 #include "uart_extra.h"
+#ifdef TIMER_DEVICE_ID
+#include "timer.h"
+#include "timer_extra.h"
+#endif
 
 static struct uart_desc *uart_desc;
 
@@ -68,6 +73,25 @@ static ssize_t iio_uart_read(char *buf, size_t len)
 	return uart_read(uart_desc, (uint8_t *)buf, len);
 }
 
+#ifdef TIMER_DEVICE_ID
+static struct timer_desc *monitor_timer;
+
+/**
+ * monitor_timer_isr() - Poll the receive link monitor, every timer period,
+ * so the link drops are recorded while no client reads the events.
+ * @ctx - The receive link monitor.
+ * @event - Unused.
+ * @extra - Unused.
+ */
+static void monitor_timer_isr(void *ctx, uint32_t event, void *extra)
+{
+	struct xil_timer_desc *xdesc = monitor_timer->extra;
+
+	XScuTimer_ClearInterruptStatus((XScuTimer *)xdesc->instance);
+	axi_jesd204_rx_monitor_poll(ctx);
+}
+#endif
+
 #endif // IIO_EXAMPLE
 
 /**********************************************************/
@@ -304,6 +328,11 @@ int main(void)
 	 */
 	struct iio_axi_dac_init_param iio_axi_dac_init_par;
 
+	/**
+	 * iio jesd204 rx configurations.
+	 */
+	struct iio_jesd204_rx_init_param iio_jesd204_rx_init_par;
+
 	/**
 	 * UART server read/write callbacks.
 	 */
@@ -324,6 +353,42 @@ int main(void)
 	 */
 	struct iio_axi_dac_desc *iio_axi_dac_desc;
 
+	/**
+	 * Receive link monitor, polled from the timer interrupt.
+	 */
+	struct axi_jesd204_rx_monitor *rx_jesd_monitor = NULL;
+
+#ifdef TIMER_DEVICE_ID
+	/**
+	 * Xilinx platform dependent initialization for the monitor timer.
+	 */
+	struct xil_timer_init_param xil_timer_init_par = {
+		.type = TIMER_PS,
+	};
+
+	/**
+	 * Monitor timer initial configuration.
+	 */
+	struct timer_init_param timer_init_par = {
+		.id = TIMER_DEVICE_ID,
+		.freq_hz = TIMER_FREQ_HZ,
+		.load_value = TIMER_LOAD_VALUE,
+		.extra = &xil_timer_init_par,
+	};
+
+	/**
+	 * Monitor timer interrupt callback.
+	 */
+	struct callback_desc monitor_timer_callback = {
+		.callback = monitor_timer_isr,
+	};
+#endif
+
+	/**
+	 * iio instance descriptor.
+	 */
+	struct iio_jesd204_rx_desc *iio_jesd204_rx_desc;
+
 	/**
 	 * Xilinx platform dependent initialization for IRQ.
 	 */
@@ -418,6 +483,43 @@ int main(void)
 	if(status < 0)
 		return status;
 
+#ifdef TIMER_DEVICE_ID
+	status = axi_jesd204_rx_monitor_init(&rx_jesd_monitor, jesd_rx_get(), 32);
+	if(status < 0)
+		return status;
+
+	status = timer_init(&monitor_timer, &timer_init_par);
+	if(status < 0)
+		return status;
+
+	monitor_timer_callback.ctx = rx_jesd_monitor;
+	status = irq_register_callback(irq_desc, TIMER_IRQ_ID,
+				       &monitor_timer_callback);
+	if(status < 0)
+		return status;
+
+	status = irq_enable(irq_desc, TIMER_IRQ_ID);
+	if(status < 0)
+		return status;
+
+	status = timer_start(monitor_timer);
+	if(status < 0)
+		return status;
+#endif
+
+	iio_jesd204_rx_init_par = (struct iio_jesd204_rx_init_param) {
+		.jesd = jesd_rx_get(),
+		.monitor = rx_jesd_monitor,
+#ifdef TIMER_DEVICE_ID
+		.irq_desc = irq_desc,
+		.monitor_irq_id = TIMER_IRQ_ID,
+#endif
+	};
+
+	status = iio_jesd204_rx_init(&iio_jesd204_rx_desc, &iio_jesd204_rx_init_par);
+	if(status < 0)
+		return status;
+
 	return iio_app(iio_app_desc);
 
 #endif // IIO_EXAMPLE
@@ -256,6 +256,14 @@
 #define UART_IRQ_ID			XPAR_XUARTPS_1_INTR
 #endif
 #define INTC_DEVICE_ID			XPAR_SCUGIC_SINGLE_DEVICE_ID
+#ifdef XPAR_XSCUTIMER_NUM_INSTANCES
+#define TIMER_DEVICE_ID			XPAR_SCUTIMER_DEVICE_ID
+#define TIMER_IRQ_ID			XPAR_SCUTIMER_INTR
+/* The private timer counts at half the CPU clock */
+#define TIMER_FREQ_HZ			(XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ / 2)
+/* Receive link monitor poll period */
+#define TIMER_LOAD_VALUE		(TIMER_FREQ_HZ / 100)
+#endif
 #endif
 
 #endif
@@ -0,0 +1,524 @@
+/***************************************************************************//**
+ *   @file   clk_solver_test.c
+ *   @brief  Host test and benchmark of the clock solvers.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "error.h"
+#include "util.h"
+#include "clk_solver.h"
+#include "hmc7044.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define MMCM_M_MAX		64
+#define MMCM_D_MAX		80
+#define MMCM_DOUT_MAX		128
+
+/* Output rates swept by the benchmark, in kHz */
+#define BENCH_FOUT_MIN		10000
+#define BENCH_FOUT_MAX		600000
+#define BENCH_FOUT_STEP		125
+
+#define CHECK(cond) do { \
+	if (!(cond)) { \
+		printf("%s:%d: %s failed\n", __func__, __LINE__, #cond); \
+		return FAILURE; \
+	} \
+} while (0)
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+struct mmcm_plan {
+	const char	*name;
+	uint32_t	fin;
+	uint32_t	fout;
+	/* The rate can be generated without error */
+	bool		exact;
+};
+
+/******************************************************************************/
+/************************ Variables Definitions *******************************/
+/******************************************************************************/
+/* 7 series, speed grade 1 defaults of axi_clkgen_calc_params() */
+static const struct clk_solver_mmcm_limits mmcm_limits = {
+	.fpfd_min = 10000,
+	.fpfd_max = 300000,
+	.fvco_min = 600000,
+	.fvco_max = 1200000,
+};
+
+static const struct mmcm_plan mmcm_plans[] = {
+	/* Pixel clocks of the HDMI modes, from the 200 MHz system clock. The
+	 * 297/400 ratio of the 74.25 MHz multiples needs M >= 297. */
+	{ "hdmi 1080p60", 200000, 148500, false },
+	{ "hdmi 720p60", 200000, 74250, false },
+	{ "hdmi 480p", 200000, 27000, true },
+	{ "hdmi vga", 200000, 25175, false },
+	/* Core clocks from the AD9523 outputs of the fmcdaq2 modes */
+	{ "ad9523 500M/2", 500000, 250000, true },
+	{ "ad9523 125M*2", 125000, 250000, true },
+	{ "ad9523 1G/4", 1000000, 250000, true },
+	/* Core clocks from the HMC7044 outputs of the ad9172 project */
+	{ "hmc7044 368.64M/4", 368640, 92160, true },
+	{ "hmc7044 122.88M*2", 122880, 245760, true },
+	{ "hmc7044 368.64M*2/3", 368640, 245760, true },
+};
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief The exhaustive (M, D) search clk_solver_mmcm() replaces, used as the
+ * reference of the results and of the timing.
+ */
+static void ref_mmcm(const struct clk_solver_mmcm_limits *limits,
+		     uint32_t fin, uint32_t fout, uint32_t *best_d,
+		     uint32_t *best_m, uint32_t *best_dout)
+{
+	uint32_t d, d_min, d_max, _d_min, _d_max;
+	uint32_t m, m_min, m_max;
+	uint32_t fvco, dout;
+	int32_t f, best_f = 0x7fffffff;
+
+	*best_d = 0;
+	*best_m = 0;
+	*best_dout = 0;
+
+	d_min = max(DIV_ROUND_UP(fin, limits->fpfd_max), 1);
+	d_max = min(fin / limits->fpfd_min, MMCM_D_MAX);
+
+	m_min = max(DIV_ROUND_UP(limits->fvco_min, fin) * d_min, 1);
+	m_max = min(limits->fvco_max * d_max / fin, MMCM_M_MAX);
+
+	for (m = m_min; m <= m_max; m++) {
+		_d_min = max(d_min, DIV_ROUND_UP(fin * m, limits->fvco_max));
+		_d_max = min(d_max, fin * m / limits->fvco_min);
+
+		for (d = _d_min; d <= _d_max; d++) {
+			fvco = fin * m / d;
+			dout = DIV_ROUND_CLOSEST(fvco, fout);
+			dout = clamp(dout, 1, MMCM_DOUT_MAX);
+			f = fvco / dout;
+			if (abs(f - (int32_t)fout) <
+			    abs(best_f - (int32_t)fout)) {
+				best_f = f;
+				*best_d = d;
+				*best_m = m;
+				*best_dout = dout;
+				if (best_f == (int32_t)fout)
+					return;
+			}
+		}
+	}
+}
+
+/**
+ * @brief Output frequency of a MMCM setting, in Hz.
+ */
+static uint64_t mmcm_rate(uint32_t fin, uint32_t d, uint32_t m, uint32_t dout)
+{
+	return DIV_ROUND_CLOSEST_ULL(1000ULL * fin * m, d * dout);
+}
+
+/**
+ * @brief Check that a MMCM setting stays within the operating ranges.
+ */
+static int32_t mmcm_valid(uint32_t fin, uint32_t d, uint32_t m, uint32_t dout)
+{
+	CHECK(d >= 1 && d <= MMCM_D_MAX);
+	CHECK(m >= 1 && m <= MMCM_M_MAX);
+	CHECK(dout >= 1 && dout <= MMCM_DOUT_MAX);
+	CHECK(fin / d >= mmcm_limits.fpfd_min);
+	CHECK(DIV_ROUND_UP(fin, d) <= mmcm_limits.fpfd_max);
+	CHECK((uint64_t)fin * m >= (uint64_t)mmcm_limits.fvco_min * d);
+	CHECK((uint64_t)fin * m <= (uint64_t)mmcm_limits.fvco_max * d);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief The solver finds the known MMCM settings, exactly when the rate can
+ * be generated and never farther from the rate than the exhaustive search.
+ */
+static int32_t test_mmcm_plans(void)
+{
+	const struct mmcm_plan *p;
+	uint32_t d, m, dout, rd, rm, rdout;
+	uint64_t f, rf, err, rerr;
+	uint32_t i;
+
+	for (i = 0; i < ARRAY_SIZE(mmcm_plans); i++) {
+		p = &mmcm_plans[i];
+		clk_solver_mmcm(&mmcm_limits, p->fin, p->fout, &d, &m, &dout);
+		ref_mmcm(&mmcm_limits, p->fin, p->fout, &rd, &rm, &rdout);
+		if (mmcm_valid(p->fin, d, m, dout)) {
+			printf("%s: D %u M %u DOUT %u\n", p->name, d, m, dout);
+			return FAILURE;
+		}
+
+		f = mmcm_rate(p->fin, d, m, dout);
+		rf = mmcm_rate(p->fin, rd, rm, rdout);
+		err = f > 1000ULL * p->fout ? f - 1000ULL * p->fout :
+		      1000ULL * p->fout - f;
+		rerr = rf > 1000ULL * p->fout ? rf - 1000ULL * p->fout :
+		       1000ULL * p->fout - rf;
+		if (p->exact)
+			CHECK((uint64_t)p->fin * m == (uint64_t)p->fout * d * dout);
+		else
+			CHECK(err > 0);
+		CHECK(err <= rerr);
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Rates that cannot be generated report a zero setting.
+ */
+static int32_t test_mmcm_unreachable(void)
+{
+	uint32_t d, m, dout;
+
+	/* No input or output */
+	clk_solver_mmcm(&mmcm_limits, 0, 100000, &d, &m, &dout);
+	CHECK(!d && !m && !dout);
+	clk_solver_mmcm(&mmcm_limits, 100000, 0, &d, &m, &dout);
+	CHECK(!d && !m && !dout);
+
+	/* Input below the minimum phase detector frequency */
+	clk_solver_mmcm(&mmcm_limits, mmcm_limits.fpfd_min - 1, 100000,
+			&d, &m, &dout);
+	CHECK(!d && !m && !dout);
+
+	/* Input too fast to be divided down to the phase detector range */
+	clk_solver_mmcm(&mmcm_limits, mmcm_limits.fpfd_max * (MMCM_D_MAX + 1),
+			100000, &d, &m, &dout);
+	CHECK(!d && !m && !dout);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Results are returned for their own frequency pair only and the least
+ * recently used entry is the one replaced.
+ */
+static int32_t test_cache(void)
+{
+	struct clk_solver_cache cache;
+	uint32_t params[CLK_SOLVER_MAX_PARAMS];
+	uint32_t i;
+
+	memset(&cache, 0, sizeof(cache));
+	CHECK(!clk_solver_cache_lookup(&cache, 0, 0, params, 3));
+
+	for (i = 0; i < CLK_SOLVER_CACHE_SIZE; i++) {
+		params[0] = i;
+		params[1] = i * 2;
+		params[2] = i * 3;
+		clk_solver_cache_store(&cache, 100000, 1000 + i, params, 3);
+	}
+	for (i = 0; i < CLK_SOLVER_CACHE_SIZE; i++) {
+		CHECK(clk_solver_cache_lookup(&cache, 100000, 1000 + i,
+					      params, 3));
+		CHECK(params[0] == i && params[1] == i * 2 &&
+		      params[2] == i * 3);
+	}
+	CHECK(!clk_solver_cache_lookup(&cache, 200000, 1000, params, 3));
+
+	/* Entry 0 is now the least recently used, unless touched again */
+	CHECK(clk_solver_cache_lookup(&cache, 100000, 1000, params, 3));
+	clk_solver_cache_store(&cache, 100000, 2000, params, 3);
+	CHECK(clk_solver_cache_lookup(&cache, 100000, 1000, params, 3));
+	CHECK(!clk_solver_cache_lookup(&cache, 100000, 1001, params, 3));
+	CHECK(clk_solver_cache_lookup(&cache, 100000, 2000, params, 3));
+
+	clk_solver_cache_flush(&cache);
+	for (i = 0; i < CLK_SOLVER_CACHE_SIZE; i++)
+		CHECK(!clk_solver_cache_lookup(&cache, 100000, 1000 + i,
+					       params, 3));
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Check that a HMC7044 plan generates the requested frequencies.
+ */
+static int32_t hmc7044_plan_valid(const struct hmc7044_clk_plan_req *req,
+				  const struct hmc7044_clk_plan *plan)
+{
+	uint32_t i;
+
+	CHECK(plan->r2 && plan->n2);
+	CHECK((uint64_t)req->vcxo_freq * (plan->doubler_en ? 2 : 1) *
+	      plan->n2 == (uint64_t)plan->pll2_freq * plan->r2);
+	for (i = 0; i < HMC7044_NUM_CHAN; i++) {
+		if (!req->out_freq[i]) {
+			CHECK(!plan->out_div[i]);
+			continue;
+		}
+		CHECK((uint64_t)req->out_freq[i] * plan->out_div[i] ==
+		      plan->pll2_freq);
+	}
+	if (req->sysref_freq)
+		CHECK((uint64_t)req->sysref_freq * plan->sysref_timer_div ==
+		      plan->pll2_freq);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief The HMC7044 solver finds the plans of the ad9172 and ad9208
+ * projects, and keeps the hinted VCO frequency when it fits.
+ */
+static int32_t test_hmc7044_plans(void)
+{
+	struct hmc7044_clk_plan_req req;
+	struct hmc7044_clk_plan plan;
+
+	/* ad9172: 2949.12 MHz VCO, DAC and FPGA clocks divided by 8 */
+	memset(&req, 0, sizeof(req));
+	req.vcxo_freq = 122880000;
+	req.out_freq[2] = 368640000;
+	req.out_freq[3] = 5760000;
+	req.out_freq[12] = 368640000;
+	req.out_freq[13] = 5760000;
+	req.sysref_freq = 5760000;
+	CHECK(hmc7044_clk_plan_solve(&req, &plan) == SUCCESS);
+	CHECK(hmc7044_plan_valid(&req, &plan) == SUCCESS);
+
+	req.pll2_freq_hint = 2949120000;
+	CHECK(hmc7044_clk_plan_solve(&req, &plan) == SUCCESS);
+	CHECK(hmc7044_plan_valid(&req, &plan) == SUCCESS);
+	CHECK(plan.pll2_freq == 2949120000);
+	CHECK(plan.out_div[2] == 8 && plan.out_div[12] == 8);
+	CHECK(plan.out_div[3] == 512 && plan.sysref_timer_div == 512);
+
+	/* ad9208: the undivided 3 GHz ADC clock fixes the VCO frequency */
+	memset(&req, 0, sizeof(req));
+	req.vcxo_freq = 125000000;
+	req.out_freq[0] = 3000000000;
+	req.out_freq[1] = 5859375;
+	req.out_freq[2] = 3000000000;
+	req.out_freq[3] = 5859375;
+	req.out_freq[8] = 750000000;
+	req.out_freq[9] = 375000000;
+	CHECK(hmc7044_clk_plan_solve(&req, &plan) == SUCCESS);
+	CHECK(hmc7044_plan_valid(&req, &plan) == SUCCESS);
+	CHECK(plan.pll2_freq == 3000000000);
+	CHECK(plan.out_div[0] == 1 && plan.out_div[1] == 512);
+	CHECK(plan.out_div[8] == 4 && plan.out_div[9] == 8);
+	CHECK(plan.high_vco_en);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Requests the HMC7044 cannot generate exactly are rejected.
+ */
+static int32_t test_hmc7044_unreachable(void)
+{
+	struct hmc7044_clk_plan_req req;
+	struct hmc7044_clk_plan plan;
+
+	/* No VCXO or no output */
+	memset(&req, 0, sizeof(req));
+	req.out_freq[0] = 245760000;
+	CHECK(hmc7044_clk_plan_solve(&req, &plan) == FAILURE);
+	memset(&req, 0, sizeof(req));
+	req.vcxo_freq = 122880000;
+	CHECK(hmc7044_clk_plan_solve(&req, &plan) == FAILURE);
+
+	/* Above the VCO range with the smallest divider */
+	req.out_freq[0] = 3300000000;
+	CHECK(hmc7044_clk_plan_solve(&req, &plan) == FAILURE);
+
+	/* Only odd divide ratios 1, 3 and 5 are supported, the hint is dropped */
+	req.out_freq[0] = 368640000;
+	req.pll2_freq_hint = 368640000U * 7;
+	CHECK(hmc7044_clk_plan_solve(&req, &plan) == SUCCESS);
+	CHECK(hmc7044_plan_valid(&req, &plan) == SUCCESS);
+	CHECK(plan.pll2_freq != 368640000U * 7);
+	CHECK(!(plan.out_div[0] % 2));
+
+	/* A prime rate no VCO frequency is a multiple of */
+	req.out_freq[0] = 999999937;
+	req.pll2_freq_hint = 0;
+	CHECK(hmc7044_clk_plan_solve(&req, &plan) == FAILURE);
+
+	/* SYSREF not a multiple of the output periods */
+	req.out_freq[0] = 245760000;
+	req.sysref_freq = 7680000 * 3 / 2;
+	CHECK(hmc7044_clk_plan_solve(&req, &plan) == FAILURE);
+
+	/* A hint outside of the VCO range is dropped as well */
+	req.sysref_freq = 7680000;
+	req.pll2_freq_hint = 245760000U * 14;
+	CHECK(hmc7044_clk_plan_solve(&req, &plan) == SUCCESS);
+	CHECK(hmc7044_plan_valid(&req, &plan) == SUCCESS);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Monotonic time in ns.
+ */
+static uint64_t time_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * @brief Time the exhaustive search and the solver over a set of rates.
+ * @param fin - Input frequency in kHz.
+ * @param fout - Output frequencies in kHz.
+ * @param n - Number of output frequencies.
+ * @param t_ref - Time of the exhaustive search, in ns.
+ * @param t_solver - Time of the solver, in ns.
+ */
+static void bench_mmcm(uint32_t fin, const uint32_t *fout, uint32_t n,
+		       uint64_t *t_ref, uint64_t *t_solver)
+{
+	uint32_t d, m, dout, i;
+	uint64_t t;
+
+	t = time_ns();
+	for (i = 0; i < n; i++)
+		ref_mmcm(&mmcm_limits, fin, fout[i], &d, &m, &dout);
+	*t_ref = time_ns() - t;
+
+	t = time_ns();
+	for (i = 0; i < n; i++)
+		clk_solver_mmcm(&mmcm_limits, fin, fout[i], &d, &m, &dout);
+	*t_solver = time_ns() - t;
+}
+
+/**
+ * @brief Check the solver over a sweep of output rates and time it against
+ * the exhaustive search and a cached lookup.
+ *
+ * Rates with an exact setting are where the search is pruned, so the gain is
+ * checked on those. The rates without one still go through the full search
+ * and are only reported.
+ */
+static int32_t test_bench(void)
+{
+	static uint32_t all[(BENCH_FOUT_MAX - BENCH_FOUT_MIN) /
+			    BENCH_FOUT_STEP + 1];
+	static uint32_t exact[ARRAY_SIZE(all)];
+	struct clk_solver_cache cache;
+	uint32_t params[3];
+	uint32_t d, m, dout, rd, rm, rdout;
+	uint32_t fin = 200000;
+	uint32_t fout, n = 0, n_exact = 0, i;
+	uint64_t t, t_ref, t_solver, t_ref_exact, t_solver_exact, t_cache;
+	uint64_t f, rf;
+
+	for (fout = BENCH_FOUT_MIN; fout <= BENCH_FOUT_MAX;
+	     fout += BENCH_FOUT_STEP) {
+		clk_solver_mmcm(&mmcm_limits, fin, fout, &d, &m, &dout);
+		ref_mmcm(&mmcm_limits, fin, fout, &rd, &rm, &rdout);
+		CHECK(mmcm_valid(fin, d, m, dout) == SUCCESS);
+		f = mmcm_rate(fin, d, m, dout);
+		rf = mmcm_rate(fin, rd, rm, rdout);
+		CHECK((f > 1000ULL * fout ? f - 1000ULL * fout :
+		       1000ULL * fout - f) <=
+		      (rf > 1000ULL * fout ? rf - 1000ULL * fout :
+		       1000ULL * fout - rf));
+		if ((uint64_t)fin * m == (uint64_t)fout * d * dout)
+			exact[n_exact++] = fout;
+		all[n++] = fout;
+	}
+	CHECK(n_exact > 0);
+
+	bench_mmcm(fin, all, n, &t_ref, &t_solver);
+	bench_mmcm(fin, exact, n_exact, &t_ref_exact, &t_solver_exact);
+
+	memset(&cache, 0, sizeof(cache));
+	params[0] = 1;
+	params[1] = 6;
+	params[2] = 8;
+	clk_solver_cache_store(&cache, fin, BENCH_FOUT_MIN, params, 3);
+	t = time_ns();
+	for (i = 0; i < n; i++)
+		clk_solver_cache_lookup(&cache, fin, BENCH_FOUT_MIN, params, 3);
+	t_cache = time_ns() - t;
+
+	printf("mmcm sweep from %u kHz, ns/rate:\n", fin);
+	printf("  %-20s %10s %10s\n", "", "exhaustive", "solver");
+	printf("  %-20s %10llu %10llu\n", "exact rates",
+	       (unsigned long long)(t_ref_exact / n_exact),
+	       (unsigned long long)(t_solver_exact / n_exact));
+	printf("  %-20s %10llu %10llu\n", "all rates",
+	       (unsigned long long)(t_ref / n),
+	       (unsigned long long)(t_solver / n));
+	printf("  cache hit %llu ns, %u of %u rates exact\n",
+	       (unsigned long long)(t_cache / n), n_exact, n);
+
+	CHECK(t_solver_exact * 2 < t_ref_exact);
+	CHECK(t_cache * n_exact < t_solver_exact * n);
+
+	return SUCCESS;
+}
+
+int main(void)
+{
+	int32_t ret = SUCCESS;
+
+	ret |= test_mmcm_plans();
+	ret |= test_mmcm_unreachable();
+	ret |= test_cache();
+	ret |= test_hmc7044_plans();
+	ret |= test_hmc7044_unreachable();
+	ret |= test_bench();
+
+	printf("clk_solver_test: %s\n", ret ? "FAILED" : "PASSED");
+
+	return ret ? 1 : 0;
+}
@@ -0,0 +1,297 @@
+/***************************************************************************//**
+ *   @file   dmac_ring_test.c
+ *   @brief  Host test of the DMAC ring capture helper.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "error.h"
+#include "axi_io.h"
+#include "sim_models.h"
+#include "dmac_ring.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define DMAC_BASEADDR		0x7c400000
+#define MEM_BASEADDR		0x00800000
+#define SEGMENT_SIZE		1024
+#define NO_OF_SEGMENTS		4
+/* 1024 bytes at 128 bytes/us, one transfer every 8 us */
+#define BYTES_PER_US		128
+#define TRANSFER_NS		8000
+
+#define DMAC_REG_IRQ_MASK	0x80
+#define DMAC_REG_IRQ_PENDING	0x84
+
+#define CHECK(cond) do { \
+	if (!(cond)) { \
+		printf("%s:%d: %s failed\n", __func__, __LINE__, #cond); \
+		return FAILURE; \
+	} \
+} while (0)
+
+/******************************************************************************/
+/************************ Variables Definitions *******************************/
+/******************************************************************************/
+static uint8_t mem[(NO_OF_SEGMENTS + 1) * SEGMENT_SIZE];
+/* Sequence number of the next transfer, written to every word of it */
+static uint32_t sequence;
+static uint32_t callbacks;
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief DMA source tagging each transfer with its sequence number.
+ * @param ctx - Unused.
+ * @param buf - The transfer data.
+ * @param bytes - The transfer size.
+ */
+static void test_source(void *ctx, uint8_t *buf, uint32_t bytes)
+{
+	uint32_t i;
+
+	for (i = 0; i + 4 <= bytes; i += 4)
+		memcpy(buf + i, &sequence, 4);
+	sequence++;
+}
+
+/**
+ * @brief Segment callback.
+ */
+static void test_callback(void *ctx, uint32_t segment, uint32_t address)
+{
+	callbacks++;
+}
+
+/**
+ * @brief Let time pass, then raise the DMAC interrupt if one is pending.
+ * @param ring - The ring.
+ * @param ns - The time to let pass.
+ */
+static void test_run(dmac_ring *ring, uint64_t ns)
+{
+	uint32_t pending, mask;
+
+	sim_advance(ns);
+	axi_io_read(DMAC_BASEADDR, DMAC_REG_IRQ_PENDING, &pending);
+	axi_io_read(DMAC_BASEADDR, DMAC_REG_IRQ_MASK, &mask);
+	if (pending & ~mask)
+		dmac_ring_isr(ring);
+}
+
+/**
+ * @brief Sequence number of the transfer that filled a segment.
+ * @param address - The segment address.
+ * @return The sequence number.
+ */
+static uint32_t test_tag(uint32_t address)
+{
+	uint32_t tag;
+
+	memcpy(&tag, mem + address - MEM_BASEADDR, 4);
+
+	return tag;
+}
+
+/**
+ * @brief Set up a ring over the test memory.
+ * @param ring - The ring.
+ * @param no_of_transfers - Transfers to run, 0 for continuous.
+ */
+static void test_ring_init(dmac_ring *ring, uint32_t no_of_transfers)
+{
+	memset(ring, 0, sizeof(*ring));
+	ring->dmac_baseaddr = DMAC_BASEADDR;
+	ring->start_address = MEM_BASEADDR;
+	ring->segment_size = SEGMENT_SIZE;
+	ring->no_of_segments = NO_OF_SEGMENTS;
+	ring->no_of_transfers = no_of_transfers;
+	ring->callback = test_callback;
+	sequence = 0;
+	callbacks = 0;
+}
+
+/**
+ * @brief A bounded capture ends even when several transfers complete behind
+ * a single interrupt.
+ */
+static int32_t test_bounded(void)
+{
+	dmac_ring ring;
+	uint32_t address, i;
+	uint32_t loops = 0;
+
+	test_ring_init(&ring, NO_OF_SEGMENTS);
+	CHECK(dmac_ring_start(&ring) == SUCCESS);
+
+	while (dmac_ring_busy(&ring)) {
+		CHECK(++loops < 100);
+		test_run(&ring, 3 * TRANSFER_NS);
+	}
+	dmac_ring_stop(&ring);
+
+	CHECK(ring.completed == NO_OF_SEGMENTS);
+	CHECK(callbacks == NO_OF_SEGMENTS);
+	CHECK(ring.overruns == 0);
+	for (i = 0; i < NO_OF_SEGMENTS; i++) {
+		CHECK(dmac_ring_get(&ring, &address) == SUCCESS);
+		CHECK(test_tag(address) == i);
+		CHECK(dmac_ring_put(&ring) == SUCCESS);
+	}
+	CHECK(dmac_ring_get(&ring, &address) == FAILURE);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief A segment held by a slow consumer is never overwritten, the
+ * transfers that find the ring full are dropped and counted.
+ */
+static int32_t test_overrun(void)
+{
+	dmac_ring ring;
+	uint32_t address, tag, last, i;
+	uint32_t released, resumed;
+
+	test_ring_init(&ring, 0);
+	CHECK(dmac_ring_start(&ring) == SUCCESS);
+
+	test_run(&ring, TRANSFER_NS);
+	CHECK(dmac_ring_get(&ring, &address) == SUCCESS);
+	tag = test_tag(address);
+
+	/* Hold the segment while the DMAC laps the ring several times. */
+	for (i = 0; i < 8 * NO_OF_SEGMENTS; i++)
+		test_run(&ring, TRANSFER_NS);
+	CHECK(test_tag(address) == tag);
+	CHECK(ring.overruns > 0);
+	CHECK(dmac_ring_available(&ring) == NO_OF_SEGMENTS);
+
+	/* Release everything. The capture resumes once the dropped transfers
+	 * already queued are done, then runs without gaps. */
+	last = tag;
+	CHECK(dmac_ring_put(&ring) == SUCCESS);
+	while (dmac_ring_get(&ring, &address) == SUCCESS) {
+		CHECK(test_tag(address) > last);
+		last = test_tag(address);
+		CHECK(dmac_ring_put(&ring) == SUCCESS);
+	}
+	released = sequence;
+	resumed = 0;
+	for (i = 0; i < 4 * NO_OF_SEGMENTS; i++) {
+		test_run(&ring, TRANSFER_NS);
+		while (dmac_ring_get(&ring, &address) == SUCCESS) {
+			if (resumed++)
+				CHECK(test_tag(address) == last + 1);
+			else
+				CHECK(test_tag(address) >= released &&
+				      test_tag(address) <= released +
+				      DMAC_RING_DEPTH);
+			last = test_tag(address);
+			CHECK(dmac_ring_put(&ring) == SUCCESS);
+		}
+	}
+	dmac_ring_stop(&ring);
+
+	CHECK(resumed > 0);
+	CHECK(ring.completed + ring.overruns == sequence);
+	CHECK(ring.consumed == ring.completed);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief A consumer keeping up sees every transfer, without overruns.
+ */
+static int32_t test_continuous(void)
+{
+	dmac_ring ring;
+	uint32_t address, i;
+	uint32_t expected = 0;
+
+	test_ring_init(&ring, 0);
+	CHECK(dmac_ring_start(&ring) == SUCCESS);
+
+	for (i = 0; i < 64; i++) {
+		test_run(&ring, (i % 3 + 1) * TRANSFER_NS);
+		while (dmac_ring_get(&ring, &address) == SUCCESS) {
+			CHECK(test_tag(address) == expected);
+			expected++;
+			CHECK(dmac_ring_put(&ring) == SUCCESS);
+		}
+	}
+	dmac_ring_stop(&ring);
+
+	CHECK(ring.overruns == 0);
+	CHECK(expected == ring.completed);
+	CHECK(callbacks == ring.completed);
+
+	return SUCCESS;
+}
+
+int main(void)
+{
+	struct sim_axi_dmac_init dmac_init = {
+		.name = "dmac",
+		.bytes_per_us = BYTES_PER_US,
+		.mem = mem,
+		.mem_base = MEM_BASEADDR,
+		.mem_size = sizeof(mem),
+		.source = test_source,
+	};
+	struct sim_model *dmac;
+	int32_t ret = SUCCESS;
+
+	if (sim_axi_dmac_init(&dmac, &dmac_init))
+		return 1;
+	sim_axi_attach(DMAC_BASEADDR, 0x1000, dmac);
+
+	ret |= test_bounded();
+	ret |= test_overrun();
+	ret |= test_continuous();
+
+	sim_axi_dmac_remove(dmac);
+	printf("dmac_ring_test: %s\n", ret ? "FAILED" : "PASSED");
+
+	return ret ? 1 : 0;
+}
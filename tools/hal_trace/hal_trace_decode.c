@@ -0,0 +1,488 @@
+/***************************************************************************//**
+ *   @file   hal_trace_decode.c
+ *   @brief  Host decoder of HAL access traces.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/*
+ * Usage: hal_trace_decode [-s symbols] [-f flag] [-a mask] [-w] [-i]
+ *			   [-H helper]... [-n] trace.bin
+ *
+ * symbols is the output of "nm -n app.elf" for the traced application; the
+ * caller addresses are resolved to the enclosing function. Without it, the
+ * raw caller addresses are reported.
+ *
+ * Calls made from a register helper (a function named *_read, *_write,
+ * *_readm, *_writem, *_update_bits, *_seq or spi_seq_*, or given with -H)
+ * are charged to the first calling function that is not a helper, up to
+ * HAL_TRACE_PARENTS frames up, when the trace was recorded with
+ * HAL_TRACE_PARENT. -n charges them to the helper itself.
+ *
+ * SPI transfers made of one instruction word and data bytes are decoded as
+ * register accesses, one per data byte: -f gives the read/write flag of the
+ * instruction word (default 0x8000), -w tells the flag marks writes instead
+ * of reads (as on the AD9361), -a gives the address mask (default 0x7FFF)
+ * and -i tells streamed bytes go to ascending addresses (default
+ * descending). Only the first HAL_TRACE_SPI_BYTES bytes of a transfer are
+ * recorded.
+ */
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "hal_trace.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define REG_CACHE_SIZE	(1 << 16)
+#define MAX_HELPERS	32
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+struct symbol {
+	uint64_t	addr;
+	char		*name;
+};
+
+struct func_stats {
+	const char	*name;
+	uint64_t	caller;
+	uint32_t	spi;
+	uint32_t	axi;
+	uint32_t	delays;
+	uint64_t	bytes;
+	uint64_t	bus_ns;
+	uint64_t	delay_ns;
+	/** Writes of the value the register already held */
+	uint32_t	same_writes;
+	/** Read-modify-writes that did not modify anything */
+	uint32_t	null_rmw;
+};
+
+struct reg_state {
+	uint8_t		valid;
+	uint8_t		bus;
+	uint8_t		last_read;
+	uint32_t	addr;
+	uint32_t	value;
+	struct func_stats *last_func;
+};
+
+/******************************************************************************/
+/************************ Variable Declarations *******************************/
+/******************************************************************************/
+static struct symbol *symbols;
+static uint32_t num_symbols;
+static struct func_stats *funcs;
+static uint32_t num_funcs;
+static struct reg_state reg_cache[REG_CACHE_SIZE];
+static const char *helpers[MAX_HELPERS];
+static uint32_t num_helpers;
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+static int load_symbols(const char *path)
+{
+	char line[512], name[400], type;
+	unsigned long long addr;
+	uint32_t size = 0;
+	FILE *f;
+
+	f = fopen(path, "r");
+	if (!f)
+		return -1;
+
+	while (fgets(line, sizeof(line), f)) {
+		if (sscanf(line, "%llx %c %399s", &addr, &type, name) != 3)
+			continue;
+		if (type != 'T' && type != 't' && type != 'W' && type != 'w')
+			continue;
+		if (num_symbols == size) {
+			size = size ? size * 2 : 1024;
+			symbols = realloc(symbols, size * sizeof(*symbols));
+			if (!symbols)
+				exit(1);
+		}
+		symbols[num_symbols].addr = addr;
+		symbols[num_symbols].name = strdup(name);
+		num_symbols++;
+	}
+	fclose(f);
+
+	return 0;
+}
+
+static int cmp_symbol(const void *a, const void *b)
+{
+	const struct symbol *sa = a, *sb = b;
+
+	return sa->addr < sb->addr ? -1 : sa->addr > sb->addr;
+}
+
+static const char *find_symbol(uint64_t addr)
+{
+	uint32_t lo = 0, hi = num_symbols, mid;
+
+	if (!num_symbols || addr < symbols[0].addr)
+		return NULL;
+
+	while (hi - lo > 1) {
+		mid = (lo + hi) / 2;
+		if (symbols[mid].addr <= addr)
+			lo = mid;
+		else
+			hi = mid;
+	}
+
+	return symbols[lo].name;
+}
+
+static uint64_t symbol_addr(const char *name)
+{
+	uint32_t i;
+
+	for (i = 0; i < num_symbols; i++)
+		if (!strcmp(symbols[i].name, name))
+			return symbols[i].addr;
+
+	return 0;
+}
+
+static int ends_with(const char *name, const char *suffix)
+{
+	size_t n = strlen(name), m = strlen(suffix);
+
+	return n > m && !strcmp(name + n - m, suffix);
+}
+
+/* The function only wraps bus accesses for its callers. */
+static int is_helper(const char *name)
+{
+	static const char *const suffixes[] = {
+		"_read", "_write", "_readm", "_writem", "_update_bits", "_seq",
+	};
+	uint32_t i;
+
+	if (!name)
+		return 0;
+
+	for (i = 0; i < num_helpers; i++)
+		if (!strcmp(name, helpers[i]))
+			return 1;
+	for (i = 0; i < sizeof(suffixes) / sizeof(suffixes[0]); i++)
+		if (ends_with(name, suffixes[i]))
+			return 1;
+
+	return !strncmp(name, "spi_seq_", 8);
+}
+
+static struct func_stats *get_func(uint64_t caller)
+{
+	static uint32_t size;
+	const char *name = find_symbol(caller);
+	uint32_t i;
+
+	for (i = 0; i < num_funcs; i++)
+		if (name ? funcs[i].name == name : funcs[i].caller == caller)
+			return &funcs[i];
+
+	if (num_funcs == size) {
+		size = size ? size * 2 : 256;
+		funcs = realloc(funcs, size * sizeof(*funcs));
+		if (!funcs)
+			exit(1);
+	}
+	memset(&funcs[num_funcs], 0, sizeof(*funcs));
+	funcs[num_funcs].name = name;
+	funcs[num_funcs].caller = caller;
+
+	return &funcs[num_funcs++];
+}
+
+static struct reg_state *get_reg(uint8_t bus, uint32_t addr)
+{
+	uint32_t h = (addr * 2654435761u + bus) & (REG_CACHE_SIZE - 1);
+	uint32_t n;
+
+	for (n = 0; n < REG_CACHE_SIZE; n++) {
+		struct reg_state *r = &reg_cache[(h + n) & (REG_CACHE_SIZE - 1)];
+
+		if (!r->valid) {
+			r->valid = 1;
+			r->bus = bus;
+			r->addr = addr;
+			r->last_func = NULL;
+			return r;
+		}
+		if (r->bus == bus && r->addr == addr)
+			return r;
+	}
+
+	return NULL;
+}
+
+/* A read of a register, value as seen by func. */
+static void reg_read(uint8_t bus, uint32_t addr, uint32_t value,
+		     struct func_stats *func)
+{
+	struct reg_state *r = get_reg(bus, addr);
+
+	if (!r)
+		return;
+	r->value = value;
+	r->last_read = 1;
+	r->last_func = func;
+}
+
+/*
+ * A write of a register, flagged when it does not change the value. A write
+ * right after a read of the same register closes a read-modify-write,
+ * whichever functions issued the two accesses.
+ */
+static void reg_write(uint8_t bus, uint32_t addr, uint32_t value,
+		      struct func_stats *func)
+{
+	struct reg_state *r = get_reg(bus, addr);
+
+	if (!r)
+		return;
+	if (r->last_func && r->value == value) {
+		func->same_writes++;
+		if (r->last_read)
+			func->null_rmw++;
+	}
+	r->value = value;
+	r->last_read = 0;
+	r->last_func = func;
+}
+
+static int cmp_func(const void *a, const void *b)
+{
+	const struct func_stats *fa = a, *fb = b;
+	uint64_t ta = fa->bus_ns + fa->delay_ns;
+	uint64_t tb = fb->bus_ns + fb->delay_ns;
+
+	return ta > tb ? -1 : ta < tb;
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr, "Usage: %s [-s symbols] [-f flag] [-a mask] [-w] "
+		"[-i] [-H helper]... [-n] trace.bin\n", name);
+	exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t flag = 0x8000, mask = 0x7FFF, flag_is_write = 0;
+	uint32_t ascending = 0, fold_helpers = 1;
+	struct hal_trace_header hdr;
+	struct hal_trace_record rec;
+	const char *sym_path = NULL;
+	uint64_t bias = 0, anchor, total_bus = 0, total_delay = 0;
+	uint64_t first_ts = 0, last_ts = 0;
+	uint32_t i, j, n, skipped = 0, instr, reg;
+	uint64_t caller;
+	struct func_stats *func;
+	int opt, write;
+	FILE *f;
+
+	while ((opt = getopt(argc, argv, "s:f:a:wiH:n")) != -1) {
+		switch (opt) {
+		case 's':
+			sym_path = optarg;
+			break;
+		case 'f':
+			flag = strtoul(optarg, NULL, 0);
+			break;
+		case 'a':
+			mask = strtoul(optarg, NULL, 0);
+			break;
+		case 'w':
+			flag_is_write = 1;
+			break;
+		case 'i':
+			ascending = 1;
+			break;
+		case 'H':
+			if (num_helpers == MAX_HELPERS)
+				usage(argv[0]);
+			helpers[num_helpers++] = optarg;
+			break;
+		case 'n':
+			fold_helpers = 0;
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+	if (optind != argc - 1)
+		usage(argv[0]);
+
+	f = fopen(argv[optind], "rb");
+	if (!f) {
+		perror(argv[optind]);
+		return 1;
+	}
+	if (fread(&hdr, sizeof(hdr), 1, f) != 1 ||
+	    hdr.magic != HAL_TRACE_MAGIC ||
+	    hdr.version != HAL_TRACE_VERSION ||
+	    hdr.record_size != sizeof(rec)) {
+		fprintf(stderr, "%s: not a HAL trace\n", argv[optind]);
+		return 1;
+	}
+
+	if (sym_path) {
+		if (load_symbols(sym_path)) {
+			perror(sym_path);
+			return 1;
+		}
+		qsort(symbols, num_symbols, sizeof(*symbols), cmp_symbol);
+		/* Relocate position independent executables */
+		anchor = symbol_addr("hal_trace_init");
+		if (anchor)
+			bias = hdr.anchor - anchor;
+	}
+
+	for (i = 0; i < hdr.count; i++) {
+		if (fread(&rec, sizeof(rec), 1, f) != 1)
+			break;
+		if (!rec.seq) {
+			skipped++;
+			continue;
+		}
+		if (!first_ts)
+			first_ts = rec.ts_ns;
+		last_ts = rec.ts_ns + rec.duration_ns;
+
+		caller = rec.caller - bias;
+		for (j = 0; fold_helpers && j < HAL_TRACE_PARENTS &&
+		     rec.parent[j] && is_helper(find_symbol(caller)); j++)
+			caller = rec.parent[j] - bias;
+		func = get_func(caller);
+
+		switch (rec.type) {
+		case HAL_TRACE_SPI:
+			func->spi++;
+			func->bytes += rec.bytes;
+			func->bus_ns += rec.duration_ns;
+			if (rec.bytes < 3 || rec.error)
+				break;
+			instr = (rec.tx[0] << 8) | rec.tx[1];
+			write = !(instr & flag) ^ flag_is_write;
+			n = (rec.bytes < HAL_TRACE_SPI_BYTES ? rec.bytes :
+			     HAL_TRACE_SPI_BYTES) - 2;
+			/* Streamed bytes go to consecutive registers */
+			for (j = 0; j < n; j++) {
+				reg = ascending ? instr + j : instr - j;
+				reg = (rec.addr << 16) | (reg & mask);
+				if (write)
+					reg_write(HAL_TRACE_SPI, reg,
+						  rec.tx[2 + j], func);
+				else
+					reg_read(HAL_TRACE_SPI, reg,
+						 rec.rx[2 + j], func);
+			}
+			break;
+		case HAL_TRACE_AXI_READ:
+			func->axi++;
+			func->bytes += rec.bytes;
+			func->bus_ns += rec.duration_ns;
+			if (!rec.error)
+				reg_read(HAL_TRACE_AXI_READ, rec.addr,
+					 rec.rdata, func);
+			break;
+		case HAL_TRACE_AXI_WRITE:
+			func->axi++;
+			func->bytes += rec.bytes;
+			func->bus_ns += rec.duration_ns;
+			/* Reads and writes share the register state */
+			if (!rec.error)
+				reg_write(HAL_TRACE_AXI_READ, rec.addr,
+					  rec.wdata, func);
+			break;
+		case HAL_TRACE_UDELAY:
+		case HAL_TRACE_MDELAY:
+			func->delays++;
+			func->delay_ns += rec.duration_ns;
+			break;
+		case HAL_TRACE_MARK:
+			printf("mark %u at %.3f ms (%s)\n", rec.addr,
+			       (rec.ts_ns - first_ts) / 1e6,
+			       func->name ? func->name : "?");
+			break;
+		default:
+			skipped++;
+			break;
+		}
+	}
+	fclose(f);
+
+	qsort(funcs, num_funcs, sizeof(*funcs), cmp_func);
+
+	printf("%u records, %u lost, %u skipped, %.3f ms traced\n\n",
+	       hdr.count, hdr.lost, skipped, (last_ts - first_ts) / 1e6);
+	printf("%-36s %7s %7s %6s %9s %11s %11s %6s %6s\n", "function",
+	       "spi", "axi", "delay", "bytes", "bus_us", "delay_us",
+	       "same_w", "rmw");
+	for (i = 0; i < num_funcs; i++) {
+		func = &funcs[i];
+		total_bus += func->bus_ns;
+		total_delay += func->delay_ns;
+		if (func->name)
+			printf("%-36.36s", func->name);
+		else
+			printf("0x%-34llx", (unsigned long long)func->caller);
+		printf(" %7u %7u %6u %9llu %11.1f %11.1f %6u %6u\n",
+		       func->spi, func->axi, func->delays,
+		       (unsigned long long)func->bytes, func->bus_ns / 1e3,
+		       func->delay_ns / 1e3, func->same_writes,
+		       func->null_rmw);
+	}
+	printf("\n%-36s %43.1f %11.1f\n", "total", total_bus / 1e3,
+	       total_delay / 1e3);
+
+	return 0;
+}
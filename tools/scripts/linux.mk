@@ -102,6 +102,21 @@ endif
 LDFLAGS = -T $(LSCRIPT)							\
 	  $(LIBS)
 
+# HAL_TRACE=y records every SPI, AXI and delay call, see include/hal_trace.h
+ifeq (y,$(strip $(HAL_TRACE)))
+CFLAGS += -D HAL_TRACE
+# Record the callers of the driver register helpers too, frame pointers
+# are only walked where backtrace() is not available
+CFLAGS += -D HAL_TRACE_PARENT -fno-omit-frame-pointer
+LDFLAGS += -Wl,--wrap=spi_write_and_read				\
+	   -Wl,--wrap=axi_io_read					\
+	   -Wl,--wrap=axi_io_write					\
+	   -Wl,--wrap=udelay						\
+	   -Wl,--wrap=mdelay
+SRCS += $(NO-OS)/util/hal_trace.c
+INCS += $(INCLUDE)/hal_trace.h
+endif
+
 #------------------------------------------------------------------------------
 #                             PLATFORM HANDLING                                
 #------------------------------------------------------------------------------
@@ -0,0 +1,210 @@
+/***************************************************************************//**
+ *   @file   clk_solver.c
+ *   @brief  Clock divider solver with result caching.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include "clk_solver.h"
+#include "util.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define CLK_SOLVER_MMCM_M_MAX		64
+#define CLK_SOLVER_MMCM_D_MAX		80
+#define CLK_SOLVER_MMCM_DOUT_MAX	128
+
+/******************************************************************************/
+/************************** Functions Implementation **************************/
+/******************************************************************************/
+
+/**
+ * @brief Look up the divider settings of a frequency pair.
+ * @param cache - The cache.
+ * @param fin - Input frequency.
+ * @param fout - Requested output frequency.
+ * @param params - Filled with the cached settings on a hit.
+ * @param nb_params - Number of settings, at most CLK_SOLVER_MAX_PARAMS.
+ * @return true on a cache hit, false otherwise.
+ */
+bool clk_solver_cache_lookup(struct clk_solver_cache *cache, uint32_t fin,
+			     uint32_t fout, uint32_t *params,
+			     uint8_t nb_params)
+{
+	struct clk_solver_cache_entry *e;
+	uint32_t i;
+
+	for (i = 0; i < CLK_SOLVER_CACHE_SIZE; i++) {
+		e = &cache->entry[i];
+		if (e->stamp && e->fin == fin && e->fout == fout) {
+			e->stamp = ++cache->stamp;
+			memcpy(params, e->params, nb_params * sizeof(*params));
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * @brief Store the divider settings of a frequency pair, evicting the least
+ *        recently used entry if the cache is full.
+ * @param cache - The cache.
+ * @param fin - Input frequency.
+ * @param fout - Requested output frequency.
+ * @param params - Settings to store.
+ * @param nb_params - Number of settings, at most CLK_SOLVER_MAX_PARAMS.
+ * @return None.
+ */
+void clk_solver_cache_store(struct clk_solver_cache *cache, uint32_t fin,
+			    uint32_t fout, const uint32_t *params,
+			    uint8_t nb_params)
+{
+	struct clk_solver_cache_entry *e = &cache->entry[0];
+	uint32_t i;
+
+	for (i = 1; i < CLK_SOLVER_CACHE_SIZE; i++)
+		if (cache->entry[i].stamp < e->stamp)
+			e = &cache->entry[i];
+
+	e->fin = fin;
+	e->fout = fout;
+	memcpy(e->params, params, nb_params * sizeof(*params));
+	e->stamp = ++cache->stamp;
+}
+
+/**
+ * @brief Drop all cached results.
+ * @param cache - The cache.
+ * @return None.
+ */
+void clk_solver_cache_flush(struct clk_solver_cache *cache)
+{
+	memset(cache, 0, sizeof(*cache));
+}
+
+/**
+ * @brief Compute the MMCM D, M and output divider for the requested rate.
+ *
+ * Exact solutions satisfy M / (D * DOUT) == fout / fin, so the reduced
+ * fraction of the two rates gives the step of M and the product D * DOUT
+ * directly; only multiples of it are tried. The full search over (M, D) is
+ * used only when no exact solution fits the MMCM ranges.
+ *
+ * @param limits - MMCM operating ranges in kHz.
+ * @param fin - Input frequency in kHz.
+ * @param fout - Requested output frequency in kHz.
+ * @param best_d - Input divider, 0 if no solution was found.
+ * @param best_m - Feedback multiplier, 0 if no solution was found.
+ * @param best_dout - Output divider, 0 if no solution was found.
+ * @return None.
+ */
+void clk_solver_mmcm(const struct clk_solver_mmcm_limits *limits,
+		     uint32_t fin, uint32_t fout, uint32_t *best_d,
+		     uint32_t *best_m, uint32_t *best_dout)
+{
+	uint32_t d, d_min, d_max, _d_min, _d_max;
+	uint32_t m, m_min, m_max;
+	uint32_t num, den, dd;
+	uint32_t dout, div, best_div;
+	uint64_t err, best_err;
+
+	*best_d = 0;
+	*best_m = 0;
+	*best_dout = 0;
+
+	if (!fin || !fout)
+		return;
+
+	d_min = max(DIV_ROUND_UP(fin, limits->fpfd_max), 1);
+	d_max = min(fin / limits->fpfd_min, CLK_SOLVER_MMCM_D_MAX);
+
+	m_min = max(DIV_ROUND_UP(limits->fvco_min, fin) * d_min, 1);
+	m_max = min(limits->fvco_max * d_max / fin, CLK_SOLVER_MMCM_M_MAX);
+
+	rational_best_approximation(fout, fin, CLK_SOLVER_MMCM_M_MAX,
+				    CLK_SOLVER_MMCM_D_MAX *
+				    CLK_SOLVER_MMCM_DOUT_MAX, &num, &den);
+	if (num) {
+		for (m = num * DIV_ROUND_UP(m_min, num); m <= m_max; m += num) {
+			dd = den * (m / num);
+			_d_min = max(d_min, DIV_ROUND_UP(fin * m,
+							 limits->fvco_max));
+			_d_max = min(d_max, fin * m / limits->fvco_min);
+
+			for (d = _d_min; d <= _d_max; d++) {
+				if (dd % d || dd / d > CLK_SOLVER_MMCM_DOUT_MAX)
+					continue;
+				*best_d = d;
+				*best_m = m;
+				*best_dout = dd / d;
+				return;
+			}
+		}
+	}
+
+	/* Compare |fin * M / (D * DOUT) - fout| without rounding the rates */
+	best_err = 0;
+	best_div = 1;
+	for (m = m_min; m <= m_max; m++) {
+		_d_min = max(d_min, DIV_ROUND_UP(fin * m, limits->fvco_max));
+		_d_max = min(d_max, fin * m / limits->fvco_min);
+
+		for (d = _d_min; d <= _d_max; d++) {
+			dout = DIV_ROUND_CLOSEST((uint64_t)fin * m,
+						 (uint64_t)fout * d);
+			dout = clamp_t(uint32_t, dout, 1, CLK_SOLVER_MMCM_DOUT_MAX);
+			div = d * dout;
+			err = (uint64_t)fin * m > (uint64_t)fout * div ?
+			      (uint64_t)fin * m - (uint64_t)fout * div :
+			      (uint64_t)fout * div - (uint64_t)fin * m;
+			if (!*best_m || err * best_div < best_err * div) {
+				best_err = err;
+				best_div = div;
+				*best_d = d;
+				*best_m = m;
+				*best_dout = dout;
+				if (!err)
+					return;
+			}
+		}
+	}
+}
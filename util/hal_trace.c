@@ -0,0 +1,459 @@
+/***************************************************************************//**
+ *   @file   hal_trace.c
+ *   @brief  HAL access tracing.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#if defined(HAL_TRACE_PARENT) && defined(__GLIBC__)
+#include <execinfo.h>
+#endif
+#include "hal_trace.h"
+#include "spi.h"
+#include "axi_io.h"
+#include "delay.h"
+#include "error.h"
+
+/*
+ * The HAL calls are interposed at link time: with
+ *   -Wl,--wrap=spi_write_and_read,--wrap=axi_io_read,--wrap=axi_io_write,
+ *   --wrap=udelay,--wrap=mdelay
+ * every call to one of these functions outside of its own translation unit
+ * lands in the matching __wrap_ function below, which calls the platform
+ * implementation through __real_ and records the call. No driver or
+ * platform source has to change.
+ */
+
+/*
+ * Drivers usually reach the HAL through register helpers such as
+ * ad9361_spi_read(), sometimes nested (spi_seq_run() called by
+ * ad9144_spi_write_seq()), so the return address only names a helper. With
+ * -DHAL_TRACE_PARENT the return addresses of the HAL_TRACE_PARENTS frames
+ * above are recorded too, and the decoder charges the accesses made by
+ * helpers to the first caller that is not one. On glibc the frames are
+ * walked with backtrace(), which uses the unwind tables and stops at the
+ * outermost frame. Elsewhere only the frame above is recorded, which needs
+ * frame pointers (-fno-omit-frame-pointer).
+ */
+#if defined(HAL_TRACE_PARENT) && defined(__GLIBC__)
+#define HAL_TRACE_SET_PARENTS(parent) do {				\
+	void *frames[HAL_TRACE_PARENTS + 2];				\
+	int i, n = backtrace(frames, HAL_TRACE_PARENTS + 2);		\
+	/* frames[0] is the wrapper, frames[1] the caller */		\
+	for (i = 2; i < n; i++)						\
+		(parent)[i - 2] = (uintptr_t)frames[i];			\
+} while (0)
+#elif defined(HAL_TRACE_PARENT)
+#define HAL_TRACE_SET_PARENTS(parent) do {				\
+	_Pragma("GCC diagnostic push")					\
+	_Pragma("GCC diagnostic ignored \"-Wframe-address\"")		\
+	(parent)[0] = (uintptr_t)__builtin_return_address(1);		\
+	_Pragma("GCC diagnostic pop")					\
+} while (0)
+#else
+#define HAL_TRACE_SET_PARENTS(parent)	do {} while (0)
+#endif
+
+/******************************************************************************/
+/************************ Variable Declarations *******************************/
+/******************************************************************************/
+static struct hal_trace_desc *hal_trace;
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+int32_t __real_spi_write_and_read(struct spi_desc *desc, uint8_t *data,
+				  uint16_t bytes_number);
+int32_t __real_axi_io_read(uint32_t base, uint32_t offset, uint32_t *data);
+int32_t __real_axi_io_write(uint32_t base, uint32_t offset, uint32_t data);
+void __real_udelay(uint32_t usecs);
+void __real_mdelay(uint32_t msecs);
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Get the trace ring, if recording.
+ * @return The trace ring or NULL.
+ */
+static inline struct hal_trace_desc *hal_trace_get(void)
+{
+	struct hal_trace_desc *desc;
+
+	desc = __atomic_load_n(&hal_trace, __ATOMIC_ACQUIRE);
+	if (!desc || !__atomic_load_n(&desc->enabled, __ATOMIC_RELAXED))
+		return NULL;
+
+	return desc;
+}
+
+/**
+ * @brief Current time.
+ * @param desc - The trace ring.
+ * @return The time in ns, 0 without a time source.
+ */
+static inline uint64_t hal_trace_now(struct hal_trace_desc *desc)
+{
+	return desc->get_time_ns ? desc->get_time_ns() : 0;
+}
+
+/**
+ * @brief Pack the first bytes of a buffer, big endian.
+ * @param data - The buffer.
+ * @param bytes - The buffer length.
+ * @return Up to 4 bytes, the first one in the most significant position.
+ */
+static uint32_t hal_trace_pack(const uint8_t *data, uint16_t bytes)
+{
+	uint32_t word = 0;
+	uint16_t i;
+
+	for (i = 0; i < 4; i++)
+		word = (word << 8) | (i < bytes ? data[i] : 0);
+
+	return word;
+}
+
+/**
+ * @brief Store a record. Writers reserve their slot with an atomic increment,
+ *        so calls from interrupt context or other threads never lock; a slot
+ *        is valid once its sequence number is published.
+ * @param desc - The trace ring.
+ * @param rec - The record, seq and duration_ns are filled in here.
+ */
+static void hal_trace_log(struct hal_trace_desc *desc,
+			  struct hal_trace_record *rec)
+{
+	struct hal_trace_record *slot;
+	uint32_t pos;
+
+	if (desc->get_time_ns)
+		rec->duration_ns = desc->get_time_ns() - rec->ts_ns;
+
+	pos = __atomic_fetch_add(&desc->head, 1, __ATOMIC_RELAXED);
+	slot = &desc->records[pos & desc->mask];
+
+	__atomic_store_n(&slot->seq, 0, __ATOMIC_RELAXED);
+	rec->seq = 0;
+	memcpy(slot, rec, sizeof(*slot));
+	__atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Traced spi_write_and_read().
+ */
+int32_t __wrap_spi_write_and_read(struct spi_desc *desc, uint8_t *data,
+				  uint16_t bytes_number)
+{
+	struct hal_trace_desc *trace = hal_trace_get();
+	struct hal_trace_record rec;
+	uint16_t len;
+	int32_t ret;
+
+	if (!trace)
+		return __real_spi_write_and_read(desc, data, bytes_number);
+
+	len = bytes_number < HAL_TRACE_SPI_BYTES ? bytes_number :
+	      HAL_TRACE_SPI_BYTES;
+
+	memset(&rec, 0, sizeof(rec));
+	rec.caller = (uintptr_t)__builtin_return_address(0);
+	HAL_TRACE_SET_PARENTS(rec.parent);
+	rec.type = HAL_TRACE_SPI;
+	rec.addr = desc->chip_select;
+	rec.bytes = bytes_number;
+	rec.wdata = hal_trace_pack(data, bytes_number);
+	memcpy(rec.tx, data, len);
+	rec.ts_ns = hal_trace_now(trace);
+	ret = __real_spi_write_and_read(desc, data, bytes_number);
+	rec.rdata = hal_trace_pack(data, bytes_number);
+	memcpy(rec.rx, data, len);
+	rec.error = ret < 0;
+	hal_trace_log(trace, &rec);
+
+	return ret;
+}
+
+/**
+ * @brief Traced axi_io_read().
+ */
+int32_t __wrap_axi_io_read(uint32_t base, uint32_t offset, uint32_t *data)
+{
+	struct hal_trace_desc *trace = hal_trace_get();
+	struct hal_trace_record rec;
+	int32_t ret;
+
+	if (!trace)
+		return __real_axi_io_read(base, offset, data);
+
+	memset(&rec, 0, sizeof(rec));
+	rec.caller = (uintptr_t)__builtin_return_address(0);
+	HAL_TRACE_SET_PARENTS(rec.parent);
+	rec.type = HAL_TRACE_AXI_READ;
+	rec.addr = base + offset;
+	rec.bytes = 4;
+	rec.ts_ns = hal_trace_now(trace);
+	ret = __real_axi_io_read(base, offset, data);
+	rec.rdata = *data;
+	rec.error = ret < 0;
+	hal_trace_log(trace, &rec);
+
+	return ret;
+}
+
+/**
+ * @brief Traced axi_io_write().
+ */
+int32_t __wrap_axi_io_write(uint32_t base, uint32_t offset, uint32_t data)
+{
+	struct hal_trace_desc *trace = hal_trace_get();
+	struct hal_trace_record rec;
+	int32_t ret;
+
+	if (!trace)
+		return __real_axi_io_write(base, offset, data);
+
+	memset(&rec, 0, sizeof(rec));
+	rec.caller = (uintptr_t)__builtin_return_address(0);
+	HAL_TRACE_SET_PARENTS(rec.parent);
+	rec.type = HAL_TRACE_AXI_WRITE;
+	rec.addr = base + offset;
+	rec.bytes = 4;
+	rec.wdata = data;
+	rec.ts_ns = hal_trace_now(trace);
+	ret = __real_axi_io_write(base, offset, data);
+	rec.error = ret < 0;
+	hal_trace_log(trace, &rec);
+
+	return ret;
+}
+
+/**
+ * @brief Traced udelay().
+ */
+void __wrap_udelay(uint32_t usecs)
+{
+	struct hal_trace_desc *trace = hal_trace_get();
+	struct hal_trace_record rec;
+
+	if (!trace) {
+		__real_udelay(usecs);
+		return;
+	}
+
+	memset(&rec, 0, sizeof(rec));
+	rec.caller = (uintptr_t)__builtin_return_address(0);
+	HAL_TRACE_SET_PARENTS(rec.parent);
+	rec.type = HAL_TRACE_UDELAY;
+	rec.addr = usecs;
+	rec.ts_ns = hal_trace_now(trace);
+	__real_udelay(usecs);
+	hal_trace_log(trace, &rec);
+}
+
+/**
+ * @brief Traced mdelay().
+ */
+void __wrap_mdelay(uint32_t msecs)
+{
+	struct hal_trace_desc *trace = hal_trace_get();
+	struct hal_trace_record rec;
+
+	if (!trace) {
+		__real_mdelay(msecs);
+		return;
+	}
+
+	memset(&rec, 0, sizeof(rec));
+	rec.caller = (uintptr_t)__builtin_return_address(0);
+	HAL_TRACE_SET_PARENTS(rec.parent);
+	rec.type = HAL_TRACE_MDELAY;
+	rec.addr = msecs;
+	rec.ts_ns = hal_trace_now(trace);
+	__real_mdelay(msecs);
+	hal_trace_log(trace, &rec);
+}
+
+/**
+ * @brief Record a user marker, e.g. the start of a bring-up phase.
+ * @param id - The marker id, reported by the decoder.
+ */
+void hal_trace_mark(uint32_t id)
+{
+	struct hal_trace_desc *trace = hal_trace_get();
+	struct hal_trace_record rec;
+
+	if (!trace)
+		return;
+
+	memset(&rec, 0, sizeof(rec));
+	rec.caller = (uintptr_t)__builtin_return_address(0);
+	rec.type = HAL_TRACE_MARK;
+	rec.addr = id;
+	rec.ts_ns = hal_trace_now(trace);
+	hal_trace_log(trace, &rec);
+}
+
+/**
+ * @brief Pause or resume recording.
+ * @param desc - The trace ring.
+ * @param enable - 1 to record, 0 to pause.
+ */
+void hal_trace_enable(struct hal_trace_desc *desc, uint8_t enable)
+{
+	__atomic_store_n(&desc->enabled, enable, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Drop the recorded calls. Recording should be paused.
+ * @param desc - The trace ring.
+ */
+void hal_trace_clear(struct hal_trace_desc *desc)
+{
+	memset(desc->records, 0, (desc->mask + 1) * sizeof(*desc->records));
+	__atomic_store_n(&desc->head, 0, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Write the header and the records, oldest first, to a sink.
+ *        Recording is paused during the dump. Records that were still being
+ *        written are sent with seq 0 and skipped by the decoder.
+ * @param desc - The trace ring.
+ * @param write - The sink.
+ * @param ctx - The sink context.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t hal_trace_dump(struct hal_trace_desc *desc, hal_trace_write_cb write,
+		       void *ctx)
+{
+	struct hal_trace_header hdr;
+	struct hal_trace_record rec;
+	uint32_t head, first, pos;
+	uint8_t enabled;
+	int32_t ret = SUCCESS;
+
+	enabled = __atomic_exchange_n(&desc->enabled, 0, __ATOMIC_ACQ_REL);
+
+	head = __atomic_load_n(&desc->head, __ATOMIC_ACQUIRE);
+	first = head > desc->mask + 1 ? head - (desc->mask + 1) : 0;
+
+	hdr.magic = HAL_TRACE_MAGIC;
+	hdr.version = HAL_TRACE_VERSION;
+	hdr.record_size = sizeof(rec);
+	hdr.count = head - first;
+	hdr.lost = first;
+	hdr.anchor = (uintptr_t)hal_trace_init;
+
+	if (write(ctx, &hdr, sizeof(hdr)) != sizeof(hdr)) {
+		ret = FAILURE;
+		goto out;
+	}
+
+	for (pos = first; pos != head; pos++) {
+		memcpy(&rec, &desc->records[pos & desc->mask], sizeof(rec));
+		if (rec.seq != pos + 1)
+			rec.seq = 0;
+		if (write(ctx, &rec, sizeof(rec)) != sizeof(rec)) {
+			ret = FAILURE;
+			break;
+		}
+	}
+
+out:
+	hal_trace_enable(desc, enabled);
+
+	return ret;
+}
+
+/**
+ * @brief Allocate the trace ring and start recording. Only one trace ring
+ *        can be active at a time.
+ * @param desc - The trace ring.
+ * @param param - The trace ring parameters.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t hal_trace_init(struct hal_trace_desc **desc,
+		       const struct hal_trace_init_param *param)
+{
+	struct hal_trace_desc *dev;
+
+	if (!param->num_records ||
+	    (param->num_records & (param->num_records - 1)) || hal_trace)
+		return FAILURE;
+
+	dev = (struct hal_trace_desc *)calloc(1, sizeof(*dev));
+	if (!dev)
+		return FAILURE;
+
+	dev->records = (struct hal_trace_record *)calloc(param->num_records,
+			sizeof(*dev->records));
+	if (!dev->records) {
+		free(dev);
+		return FAILURE;
+	}
+
+	dev->mask = param->num_records - 1;
+	dev->get_time_ns = param->get_time_ns;
+	dev->enabled = 1;
+
+	__atomic_store_n(&hal_trace, dev, __ATOMIC_RELEASE);
+
+	*desc = dev;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Stop recording and free the trace ring. No HAL call may be in
+ *        progress.
+ * @param desc - The trace ring.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t hal_trace_remove(struct hal_trace_desc *desc)
+{
+	if (__atomic_load_n(&hal_trace, __ATOMIC_ACQUIRE) == desc)
+		__atomic_store_n(&hal_trace, NULL, __ATOMIC_RELEASE);
+
+	free(desc->records);
+	free(desc);
+
+	return SUCCESS;
+}
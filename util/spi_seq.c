@@ -0,0 +1,189 @@
+/***************************************************************************//**
+ *   @file   spi_seq.c
+ *   @brief  Register sequence engine for SPI converters and clock chips.
+ *   @author Analog Devices Inc.
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include "spi_seq.h"
+#include "delay.h"
+#include "error.h"
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Write a single register.
+ * @param cfg - The register access format of the device.
+ * @param reg - The register address.
+ * @param val - The register data.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t spi_seq_write(const struct spi_seq_config *cfg, uint16_t reg,
+		      uint8_t val)
+{
+	uint8_t buf[3];
+	uint16_t cmd;
+
+	cmd = reg & cfg->addr_mask;
+	buf[0] = cmd >> 8;
+	buf[1] = cmd & 0xFF;
+	buf[2] = val;
+
+	return spi_write_and_read(cfg->spi, buf, 3);
+}
+
+/**
+ * @brief Read a single register.
+ * @param cfg - The register access format of the device.
+ * @param reg - The register address.
+ * @param val - The register data.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t spi_seq_read(const struct spi_seq_config *cfg, uint16_t reg,
+		     uint8_t *val)
+{
+	uint8_t buf[3];
+	uint16_t cmd;
+	int32_t ret;
+
+	cmd = cfg->read_flag | (reg & cfg->addr_mask);
+	buf[0] = cmd >> 8;
+	buf[1] = cmd & 0xFF;
+	buf[2] = 0;
+
+	ret = spi_write_and_read(cfg->spi, buf, 3);
+	if (ret < 0)
+		return ret;
+
+	*val = buf[2];
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Count the write steps that can share one streaming transaction.
+ *
+ * Consecutive writes are merged while each register follows the previous one
+ * in the direction the device auto-increments or auto-decrements its address.
+ * @param cfg - The register access format of the device.
+ * @param seq - The first write of the run.
+ * @param num - Number of steps left in the sequence.
+ * @return Number of writes in the run, at least 1.
+ */
+static uint32_t spi_seq_run_length(const struct spi_seq_config *cfg,
+				   const struct spi_seq_entry *seq,
+				   uint32_t num)
+{
+	uint32_t max;
+	uint32_t n;
+	int32_t step;
+
+	max = cfg->max_stream;
+	if (max > SPI_SEQ_MAX_STREAM)
+		max = SPI_SEQ_MAX_STREAM;
+	if (num < max)
+		max = num;
+	step = cfg->addr_ascending ? 1 : -1;
+
+	for (n = 1; n < max; n++) {
+		if (seq[n].op != SPI_SEQ_OP_WRITE ||
+		    seq[n].reg != (uint16_t)(seq[n - 1].reg + step))
+			break;
+	}
+
+	return n;
+}
+
+/**
+ * @brief Run a register sequence.
+ *
+ * Writes to consecutive registers are sent as streaming transactions of up to
+ * cfg->max_stream data bytes. Delay steps wait, verify steps read the register
+ * back and compare it against the expected value. The sequence stops at the
+ * first failing step.
+ * @param cfg - The register access format of the device.
+ * @param seq - The sequence.
+ * @param num - Number of steps in the sequence.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t spi_seq_run(const struct spi_seq_config *cfg,
+		    const struct spi_seq_entry *seq, uint32_t num)
+{
+	uint8_t buf[2 + SPI_SEQ_MAX_STREAM];
+	uint16_t cmd;
+	uint32_t n;
+	uint32_t i;
+	uint8_t val;
+	int32_t ret;
+
+	while (num) {
+		switch (seq->op) {
+		case SPI_SEQ_OP_WRITE:
+			n = spi_seq_run_length(cfg, seq, num);
+			cmd = seq->reg & cfg->addr_mask;
+			buf[0] = cmd >> 8;
+			buf[1] = cmd & 0xFF;
+			for (i = 0; i < n; i++)
+				buf[2 + i] = seq[i].val;
+			ret = spi_write_and_read(cfg->spi, buf, 2 + n);
+			break;
+		case SPI_SEQ_OP_DELAY:
+			n = 1;
+			mdelay(seq->reg);
+			ret = SUCCESS;
+			break;
+		case SPI_SEQ_OP_VERIFY:
+			n = 1;
+			ret = spi_seq_read(cfg, seq->reg, &val);
+			if (!ret && (val & seq->mask) != seq->val)
+				ret = FAILURE;
+			break;
+		default:
+			return FAILURE;
+		}
+		if (ret < 0)
+			return ret;
+
+		seq += n;
+		num -= n;
+	}
+
+	return SUCCESS;
+}
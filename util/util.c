@@ -97,14 +97,18 @@ int32_t log_base_2(uint32_t x)
 uint32_t greatest_common_divisor(uint32_t a,
 				 uint32_t b)
 {
-	uint32_t div;
-	uint32_t common_div = 1;
+	uint32_t tmp;
 
-	for (div = 1; (div <= a) && (div <= b); div++)
-		if (!(a % div) && !(b % div))
-			common_div = div;
+	if (!a || !b)
+		return 1;
 
-	return common_div;
+	while (b) {
+		tmp = a % b;
+		a = b;
+		b = tmp;
+	}
+
+	return a;
 }
 
 /**
@@ -222,3 +226,48 @@ uint32_t srt_to_uint32(const char *str)
 	else
 		return value;
 }
+
+/**
+ * Number of bits that must be received without errors to claim, with the
+ * given confidence level, that the bit error rate is below 10^-ber_exp.
+ * N = -ln(1 - CL) / BER, evaluated in Q16 fixed point.
+ * @param ber_exp - Target bit error rate exponent, at most 18.
+ * @param confidence - Confidence level in per mille, below 1000.
+ * @return The number of bits, 0 on invalid arguments.
+ */
+uint64_t ber_bits_required(uint32_t ber_exp, uint32_t confidence)
+{
+	uint64_t x, pow10 = 1;
+	uint32_t log2_q16 = 0;
+	uint32_t ln_q16;
+	int32_t i;
+
+	if (confidence >= 1000 || ber_exp > 18)
+		return 0;
+
+	/* x = 1 / (1 - CL) in Q16, at most 1000 */
+	x = (1000ULL << 16) / (1000 - confidence);
+
+	/* Integer part of log2(x) */
+	while (x >= (2 << 16)) {
+		x >>= 1;
+		log2_q16 += 1 << 16;
+	}
+	/* Fractional part, one bit per squaring */
+	for (i = 15; i >= 0; i--) {
+		x = (x * x) >> 16;
+		if (x >= (2 << 16)) {
+			x >>= 1;
+			log2_q16 |= 1 << i;
+		}
+	}
+
+	/* ln(x) = log2(x) * ln(2), ln(2) = 45426 in Q16 */
+	ln_q16 = ((uint64_t)log2_q16 * 45426) >> 16;
+
+	while (ber_exp--)
+		pow10 *= 10;
+
+	return (pow10 >> 16) * ln_q16 +
+	       (((pow10 & 0xFFFF) * ln_q16 + 0xFFFF) >> 16);
+}
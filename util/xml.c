@@ -54,7 +54,7 @@
  * create attribute
  * @param **attribute pointer to new attribute
  * @param *name attribute name
- * @param *value attribute value
+ * @param *value attribute value, as plain text, escaped when written
  * @return SUCCESS in case of success or negative value otherwise
  */
 ssize_t xml_create_attribute(struct xml_attribute **attribute, char *name,
@@ -213,30 +213,251 @@ ssize_t xml_delete_node(struct xml_node *node)
 }
 
 /**
- * print string to xml_document.
- * @param *doc
- * @param *data to be written.
+ * initialize a streaming xml writer
+ * @param *writer
+ * @param *buff output buffer, NULL to write straight to the sink
+ * @param size buffer size
+ * @param write sink, NULL to keep the document in the buffer. With neither
+ * buffer nor sink, the writer only computes the document length.
+ * @param *ctx sink context
+ */
+void xml_writer_init(struct xml_writer *writer, char *buff, uint32_t size,
+		     xml_write_cb write, void *ctx)
+{
+	writer->buff = buff;
+	writer->size = buff ? size : 0;
+	writer->index = 0;
+	writer->write = write;
+	writer->ctx = ctx;
+	writer->len = 0;
+	writer->tag_open = false;
+	writer->error = SUCCESS;
+}
+
+/**
+ * pass the buffered data to the sink
+ * @param *writer
  * @return SUCCESS in case of success or negative value otherwise
  */
-static ssize_t xml_print_to_doc(struct xml_document *doc, char *data)
+static ssize_t xml_writer_drain(struct xml_writer *writer)
 {
-	uint32_t calc_len, print_len;
+	ssize_t ret;
 
-	calc_len = strlen(data) + 1;
-	char *buff = realloc(doc->buff, doc->index + calc_len);
-	if (!buff)
-		return FAILURE;
-	doc->buff = buff;
-	print_len = sprintf(&(doc->buff[doc->index]), "%s", data);
-	if(print_len != calc_len - 1)
+	if (writer->index) {
+		ret = writer->write(writer->ctx, writer->buff, writer->index);
+		if (ret < 0 && writer->error == SUCCESS)
+			writer->error = ret;
+		writer->index = 0;
+	}
+
+	return writer->error;
+}
+
+/**
+ * append data to the document
+ * @param *writer
+ * @param *data
+ * @param len data length
+ * @return SUCCESS in case of success or negative value otherwise
+ */
+static ssize_t xml_writer_put(struct xml_writer *writer, const char *data,
+			      uint32_t len)
+{
+	uint32_t n;
+	ssize_t ret;
+
+	writer->len += len;
+	if (!writer->buff) {
+		if (!writer->write)
+			return SUCCESS;
+		ret = writer->write(writer->ctx, data, len);
+		if (ret < 0 && writer->error == SUCCESS)
+			writer->error = ret;
+		return writer->error;
+	}
+
+	while (len) {
+		if (writer->index == writer->size) {
+			if (!writer->write) {
+				/* Keep counting, the length tells the needed size */
+				writer->error = FAILURE;
+				return FAILURE;
+			}
+			xml_writer_drain(writer);
+		}
+		n = writer->size - writer->index;
+		if (n > len)
+			n = len;
+		memcpy(writer->buff + writer->index, data, n);
+		writer->index += n;
+		data += n;
+		len -= n;
+	}
+
+	return writer->error;
+}
+
+/**
+ * write text as it is
+ * @param *writer
+ * @param *data
+ * @return SUCCESS in case of success or negative value otherwise
+ */
+ssize_t xml_write_raw(struct xml_writer *writer, const char *data)
+{
+	return xml_writer_put(writer, data, strlen(data));
+}
+
+/**
+ * write text, escaping the characters that can not appear in attribute
+ * values. Runs of plain characters are copied at once.
+ * @param *writer
+ * @param *data
+ * @return SUCCESS in case of success or negative value otherwise
+ */
+ssize_t xml_write_escaped(struct xml_writer *writer, const char *data)
+{
+	const char *run = data;
+	const char *entity;
+
+	for (; *data; data++) {
+		switch (*data) {
+		case '&':
+			entity = "&amp;";
+			break;
+		case '<':
+			entity = "&lt;";
+			break;
+		case '>':
+			entity = "&gt;";
+			break;
+		case '"':
+			entity = "&quot;";
+			break;
+		case '\'':
+			entity = "&apos;";
+			break;
+		default:
+			continue;
+		}
+		xml_writer_put(writer, run, data - run);
+		xml_write_raw(writer, entity);
+		run = data + 1;
+	}
+
+	return xml_writer_put(writer, run, data - run);
+}
+
+/**
+ * end the start tag waiting for attributes, before content follows
+ * @param *writer
+ */
+static void xml_writer_close_tag(struct xml_writer *writer)
+{
+	if (writer->tag_open) {
+		xml_writer_put(writer, ">\n", 2);
+		writer->tag_open = false;
+	}
+}
+
+/**
+ * write the start tag of an element
+ * @param *writer
+ * @param *name element name
+ * @return SUCCESS in case of success or negative value otherwise
+ */
+ssize_t xml_write_start(struct xml_writer *writer, const char *name)
+{
+	xml_writer_close_tag(writer);
+	xml_writer_put(writer, "<", 1);
+	xml_write_raw(writer, name);
+	writer->tag_open = true;
+
+	return xml_writer_put(writer, " ", 1);
+}
+
+/**
+ * write an attribute of the last started element
+ * @param *writer
+ * @param *name attribute name
+ * @param *value attribute value, as plain text: it is escaped here
+ * @return SUCCESS in case of success or negative value otherwise
+ */
+ssize_t xml_write_attribute(struct xml_writer *writer, const char *name,
+			    const char *value)
+{
+	if (!writer->tag_open)
 		return FAILURE;
-	doc->index +=print_len;
 
-	return SUCCESS;
+	xml_write_raw(writer, name);
+	xml_writer_put(writer, "=\"", 2);
+	xml_write_escaped(writer, value);
+
+	return xml_writer_put(writer, "\" ", 2);
+}
+
+/**
+ * close an element, as an empty element tag if it has no content
+ * @param *writer
+ * @param *name element name
+ * @return SUCCESS in case of success or negative value otherwise
+ */
+ssize_t xml_write_end(struct xml_writer *writer, const char *name)
+{
+	if (writer->tag_open) {
+		writer->tag_open = false;
+		return xml_writer_put(writer, "/>\n", 3);
+	}
+
+	xml_writer_put(writer, "</", 2);
+	xml_write_raw(writer, name);
+
+	return xml_writer_put(writer, ">\n", 2);
 }
 
 /**
- * print xml tree into a xml document
+ * write a xml tree
+ * @param *writer
+ * @param *node pointer to parent node, that contains the xml tree
+ * @return SUCCESS in case of success or negative value otherwise
+ */
+ssize_t xml_write_node(struct xml_writer *writer, struct xml_node *node)
+{
+	uint16_t i;
+
+	xml_write_start(writer, node->name);
+	for (i = 0; i < node->attr_cnt; i++)
+		xml_write_attribute(writer, node->attributes[i]->name,
+				    node->attributes[i]->value);
+	for (i = 0; i < node->children_cnt; i++)
+		xml_write_node(writer, node->children[i]);
+
+	return xml_write_end(writer, node->name);
+}
+
+/**
+ * pass the buffered data to the sink. Without sink, terminate the string in
+ * the buffer, which needs one byte more than the document length.
+ * @param *writer
+ * @return SUCCESS in case of success or negative value otherwise
+ */
+ssize_t xml_writer_flush(struct xml_writer *writer)
+{
+	if (writer->write)
+		return writer->buff ? xml_writer_drain(writer) : writer->error;
+
+	if (writer->buff) {
+		if (writer->index == writer->size)
+			return FAILURE;
+		writer->buff[writer->index] = '\0';
+	}
+
+	return writer->error;
+}
+
+/**
+ * print xml tree into a xml document. The document length is computed
+ * first so that the buffer grows once.
  * @param **document
  * @param *node pointer to parent node, that contains the xml tree
  * @return SUCCESS in case of success or negative value otherwise
@@ -244,9 +465,9 @@ static ssize_t xml_print_to_doc(struct xml_document *doc, char *data)
 ssize_t xml_create_document(struct xml_document **document,
 			    struct xml_node *node)
 {
-	uint16_t i;
-	ssize_t ret;
+	struct xml_writer writer;
 	struct xml_document *doc;
+	char *buff;
 
 	if(!document)
 		return FAILURE;
@@ -260,64 +481,27 @@ ssize_t xml_create_document(struct xml_document **document,
 	}
 	doc = *document;
 
-	ret = xml_print_to_doc(doc, "<");
-	if (ret < 0)
-		goto error;
-	ret = xml_print_to_doc(doc, node->name);
-	if (ret < 0)
-		goto error;
-	ret = xml_print_to_doc(doc, " ");
-	if (ret < 0)
-		goto error;
-
-	for (i = 0; i < node->attr_cnt; i++) {
-		ret = xml_print_to_doc(doc, node->attributes[i]->name);
-		if (ret < 0)
-			goto error;
-		ret = xml_print_to_doc(doc, "=\"");
-		if (ret < 0)
-			goto error;
-		ret = xml_print_to_doc(doc, node->attributes[i]->value);
-		if (ret < 0)
-			goto error;
-		ret = xml_print_to_doc(doc, "\" ");
-		if (ret < 0)
-			goto error;
-	}
+	xml_writer_init(&writer, NULL, 0, NULL, NULL);
+	xml_write_node(&writer, node);
 
-	if (node->children_cnt == 0) {
-		ret = xml_print_to_doc(doc, "/>\n");
-		if (ret < 0)
-			goto error;
-
-		return SUCCESS;
-	} else {
-		ret = xml_print_to_doc(doc, ">\n");
-		if (ret < 0)
-			goto error;
-	}
-
-	for (i = 0; i < node->children_cnt; i++) {
-		ret = xml_create_document(document, node->children[i]);
-		if (ret < 0)
-			return ret;
-	}
-
-	ret = xml_print_to_doc(doc, "</");
-	if (ret < 0)
-		goto error;
-	ret = xml_print_to_doc(doc, node->name);
-	if (ret < 0)
+	buff = realloc(doc->buff, doc->index + writer.len + 1);
+	if (!buff)
 		goto error;
-	ret = xml_print_to_doc(doc, ">\n");
-	if (ret < 0)
+	doc->buff = buff;
+
+	xml_writer_init(&writer, doc->buff + doc->index, writer.len + 1, NULL,
+			NULL);
+	xml_write_node(&writer, node);
+	if (xml_writer_flush(&writer) < 0)
 		goto error;
+	doc->index += writer.len;
 
 	return SUCCESS;
 
 error:
 	free(doc->buff);
 	free(doc);
+	*document = NULL;
 
 	return FAILURE;
 }